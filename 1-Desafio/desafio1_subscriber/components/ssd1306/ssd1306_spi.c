@@ -6,6 +6,7 @@
 #include "driver/spi_master.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "esp_attr.h"
 
 #include "ssd1306.h"
 
@@ -19,9 +20,57 @@
 #define HOST_ID SPI2_HOST // If i2c is selected
 #endif
 
+#ifndef CONFIG_SPI_FREQUENCY
+#define CONFIG_SPI_FREQUENCY 1000 // If i2c is selected
+#endif
+
+#ifndef CONFIG_SPI_PAGES_IN_FLIGHT
+#define CONFIG_SPI_PAGES_IN_FLIGHT 1 // If i2c is selected
+#endif
+
 static const int SPI_Command_Mode = 0;
 static const int SPI_Data_Mode = 1;
-static const int SPI_Frequency = 1000000; // 1MHz
+static const int SPI_Frequency = CONFIG_SPI_FREQUENCY * 1000; // kHz -> Hz
+
+// Each page update is queued as two DMA transactions: address-set (DC=0) and data (DC=1)
+#define SPI_TRANS_PER_PAGE 2
+#define SPI_QUEUE_SIZE (CONFIG_SPI_PAGES_IN_FLIGHT * SPI_TRANS_PER_PAGE)
+
+typedef struct {
+	spi_transaction_t cmd_trans;
+	spi_transaction_t data_trans;
+	uint8_t cmd[4];
+	uint8_t data[128];
+} spi_page_slot_t;
+
+static DMA_ATTR spi_page_slot_t spi_slots[CONFIG_SPI_PAGES_IN_FLIGHT];
+static int spi_slot_next = 0;
+static int spi_trans_pending = 0;
+static int spi_dc_gpio = -1;
+
+// Runs in ISR context right before each transaction: drives DC from t->user
+static void IRAM_ATTR spi_pre_transfer_callback(spi_transaction_t *t)
+{
+	if (t->user != NULL) {
+		gpio_set_level( spi_dc_gpio, *(const int *)t->user );
+	}
+}
+
+// Reaps one finished queued transaction
+static void spi_reap_one(SSD1306_t * dev)
+{
+	spi_transaction_t *done;
+	esp_err_t ret = spi_device_get_trans_result( dev->_SPIHandle, &done, portMAX_DELAY );
+	assert(ret==ESP_OK);
+	spi_trans_pending--;
+}
+
+void spi_wait_idle(SSD1306_t * dev)
+{
+	while (spi_trans_pending > 0) {
+		spi_reap_one(dev);
+	}
+}
 
 void spi_master_init(SSD1306_t * dev, int16_t GPIO_MOSI, int16_t GPIO_SCLK, int16_t GPIO_CS, int16_t GPIO_DC, int16_t GPIO_RESET)
 {
@@ -65,7 +114,8 @@ void spi_master_init(SSD1306_t * dev, int16_t GPIO_MOSI, int16_t GPIO_SCLK, int1
 	memset( &devcfg, 0, sizeof( spi_device_interface_config_t ) );
 	devcfg.clock_speed_hz = SPI_Frequency;
 	devcfg.spics_io_num = GPIO_CS;
-	devcfg.queue_size = 1;
+	devcfg.queue_size = SPI_QUEUE_SIZE;
+	devcfg.pre_cb = spi_pre_transfer_callback;
 
 	spi_device_handle_t handle;
 	ret = spi_bus_add_device( HOST_ID, &devcfg, &handle);
@@ -73,6 +123,7 @@ void spi_master_init(SSD1306_t * dev, int16_t GPIO_MOSI, int16_t GPIO_SCLK, int1
 	assert(ret==ESP_OK);
 	dev->_dc = GPIO_DC;
 	dev->_SPIHandle = handle;
+	spi_dc_gpio = GPIO_DC;
 	dev->_address = SPIAddress;
 	dev->_flip = false;
 }
@@ -95,6 +146,8 @@ bool spi_master_write_byte(spi_device_handle_t SPIHandle, const uint8_t* Data, s
 bool spi_master_write_command(SSD1306_t * dev, uint8_t Command )
 {
 	static uint8_t CommandByte = 0;
+	// spi_device_transmit() must not overlap queued transactions
+	spi_wait_idle(dev);
 	CommandByte = Command;
 	gpio_set_level( dev->_dc, SPI_Command_Mode );
 	return spi_master_write_byte( dev->_SPIHandle, &CommandByte, 1 );
@@ -102,6 +155,7 @@ bool spi_master_write_command(SSD1306_t * dev, uint8_t Command )
 
 bool spi_master_write_data(SSD1306_t * dev, const uint8_t* Data, size_t DataLength )
 {
+	spi_wait_idle(dev);
 	gpio_set_level( dev->_dc, SPI_Data_Mode );
 	return spi_master_write_byte( dev->_SPIHandle, Data, DataLength );
 }
@@ -157,6 +211,8 @@ void spi_display_image(SSD1306_t * dev, int page, int seg, uint8_t * images, int
 {
 	if (page >= dev->_pages) return;
 	if (seg >= dev->_width) return;
+	if (width <= 0) return;
+	if (width > 128) width = 128;
 
 	int _seg = seg + CONFIG_OFFSETX;
 	uint8_t columLow = _seg & 0x0F;
@@ -167,15 +223,38 @@ void spi_display_image(SSD1306_t * dev, int page, int seg, uint8_t * images, int
 		_page = (dev->_pages - page) - 1;
 	}
 
-	// Set Lower Column Start Address for Page Addressing Mode
-	spi_master_write_command(dev, (0x00 + columLow));
-	// Set Higher Column Start Address for Page Addressing Mode
-	spi_master_write_command(dev, (0x10 + columHigh));
-	// Set Page Start Address for Page Addressing Mode
-	spi_master_write_command(dev, 0xB0 | _page);
-
-	spi_master_write_data(dev, images, width);
+	// Reuse the oldest slot only after both of its transactions have completed
+	if (spi_trans_pending > SPI_QUEUE_SIZE - SPI_TRANS_PER_PAGE) {
+		spi_reap_one(dev);
+		spi_reap_one(dev);
+	}
+	spi_page_slot_t *slot = &spi_slots[spi_slot_next];
+	spi_slot_next = (spi_slot_next + 1) % CONFIG_SPI_PAGES_IN_FLIGHT;
+
+	// Set Lower/Higher Column Start Address and Page Start Address for Page Addressing Mode
+	slot->cmd[0] = 0x00 + columLow;
+	slot->cmd[1] = 0x10 + columHigh;
+	slot->cmd[2] = 0xB0 | _page;
+	// Caller buffers may live on the stack, so the data is copied into the slot
+	memcpy(slot->data, images, width);
+
+	memset( &slot->cmd_trans, 0, sizeof( spi_transaction_t ) );
+	slot->cmd_trans.length = 3 * 8;
+	slot->cmd_trans.tx_buffer = slot->cmd;
+	slot->cmd_trans.user = (void *)&SPI_Command_Mode;
+
+	memset( &slot->data_trans, 0, sizeof( spi_transaction_t ) );
+	slot->data_trans.length = width * 8;
+	slot->data_trans.tx_buffer = slot->data;
+	slot->data_trans.user = (void *)&SPI_Data_Mode;
 
+	esp_err_t ret;
+	ret = spi_device_queue_trans( dev->_SPIHandle, &slot->cmd_trans, portMAX_DELAY );
+	assert(ret==ESP_OK);
+	spi_trans_pending++;
+	ret = spi_device_queue_trans( dev->_SPIHandle, &slot->data_trans, portMAX_DELAY );
+	assert(ret==ESP_OK);
+	spi_trans_pending++;
 }
 
 void spi_contrast(SSD1306_t * dev, int contrast) {
@@ -0,0 +1,22 @@
+#!/bin/sh
+# Compila e roda os testes de host (Linux, gcc) do driver SPI do SSD1306 das duas
+# aplicações, sobre o barramento simulado de stubs/spi_host.c, a 8, 10 e 20 MHz.
+# Uso, de qualquer diretório: tools/host_tests/run.sh
+set -e
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+ROOT=$(cd "$HERE/../.." && pwd)
+OUT=${OUT:-/tmp/host_tests_1}
+CFLAGS="-O2 -Wall -Wextra -Wno-unused-parameter -I$HERE/stubs"
+mkdir -p "$OUT"
+
+for app in desafio1_publisher desafio1_subscriber; do
+    SSD=$ROOT/$app/components/ssd1306
+    for khz in 8000 10000 20000; do
+        name=test_ssd1306_spi_${app}_$khz
+        echo "== $name"
+        gcc $CFLAGS -DCONFIG_SPI_FREQUENCY=$khz -I$SSD \
+            $SSD/ssd1306_spi.c $HERE/stubs/spi_host.c $HERE/test_ssd1306_spi.c -o "$OUT/$name"
+        "$OUT/$name"
+    done
+done
@@ -0,0 +1,5 @@
+#pragma once
+// Stand-in do esp_attr.h para os testes de host: sem seções de IRAM/DMA
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define DMA_ATTR
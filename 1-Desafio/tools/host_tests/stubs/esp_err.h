@@ -0,0 +1,8 @@
+#pragma once
+// Stand-in do esp_err.h para os testes de host
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
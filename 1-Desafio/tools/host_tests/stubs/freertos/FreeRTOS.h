@@ -0,0 +1,16 @@
+#pragma once
+// Stand-in do FreeRTOS para os testes de host: só ticks; o tempo é o do barramento
+// simulado (spi_host.c)
+#include <assert.h>      // Como no ESP-IDF, que o traz pela configuração do FreeRTOS
+#include <stdint.h>
+#include "sdkconfig.h"
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define portMAX_DELAY ((TickType_t)0xffffffffu)
+
+#define configTICK_RATE_HZ 100
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
@@ -0,0 +1,5 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+// Avança o relógio simulado, sem dormir de verdade
+void vTaskDelay(TickType_t ticks);
@@ -0,0 +1,12 @@
+#pragma once
+// Configuração dos testes de host: display SPI no SPI2. A frequência e as páginas
+// em voo podem vir do run.sh (-DCONFIG_SPI_FREQUENCY=...)
+#define CONFIG_SPI_INTERFACE 1
+#define CONFIG_SPI2_HOST 1
+#define CONFIG_OFFSETX 0
+#ifndef CONFIG_SPI_FREQUENCY
+#define CONFIG_SPI_FREQUENCY 1000
+#endif
+#ifndef CONFIG_SPI_PAGES_IN_FLIGHT
+#define CONFIG_SPI_PAGES_IN_FLIGHT 8
+#endif
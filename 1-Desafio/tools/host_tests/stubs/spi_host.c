@@ -0,0 +1,317 @@
+// Barramento SPI simulado para os testes de host do driver do SSD1306.
+//
+// As transações têm tempo simulado: cada uma ocupa o barramento por length bits
+// no clock do dispositivo, mais o custo do driver do ESP-IDF em volta dela. A task
+// que chama o driver tem um relógio próprio, que anda com o tempo de CPU real
+// gasto no driver e pula para a frente quando ela espera o barramento.
+//
+// Na outra ponta fica um SSD1306 em modo de endereçamento por página: os bytes
+// chegam a ele só quando a transação começa no tempo simulado, com o nível do DC
+// naquele instante e o conteúdo do buffer naquele instante. Assim um buffer
+// reaproveitado cedo demais, um DC trocado com transação em curso ou um
+// spi_device_transmit no meio da fila aparecem como erro ou como imagem errada.
+#include "driver/spi_master.h"
+#include "driver/gpio.h"
+#include "freertos/task.h"
+#include "spi_host.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Custo do driver por transação. Estimativas para o ESP32 com DMA e transações por
+// interrupção, na ordem da tabela "Transaction Interval" da documentação do
+// spi_master (algumas dezenas de µs entre transações de uma task); não são medidas
+#define SETUP_NS 12000  // queue_trans com o barramento parado até o primeiro clock
+#define CHAIN_NS 4000   // Fim de uma transação na fila até o início da próxima (ISR)
+#define WAKE_NS 16000   // Fim da transação até a task bloqueada voltar com o resultado
+#define QUEUE_NS 3000   // CPU da task em spi_device_queue_trans com o barramento ocupado
+
+#define MAX_IN_FLIGHT 64
+
+typedef struct {
+    spi_transaction_t *t;
+    uint64_t start_ns;
+    uint64_t end_ns;
+} in_flight_t;
+
+struct spi_device_t {
+    spi_device_interface_config_t config;
+};
+
+static struct spi_device_t device;
+
+static in_flight_t queue[MAX_IN_FLIGHT];
+static int queue_head = 0;      // Mais antiga ainda não devolvida
+static int queue_started = 0;   // Primeira que ainda não começou no barramento
+static int queue_tail = 0;
+
+static uint64_t now_ns = 0;
+static uint64_t bus_free_ns = 0;
+static uint64_t real_mark_ns = 0;
+static bool in_call = false;
+static bool in_pre_cb = false;
+static uint32_t transactions = 0;
+static uint32_t errors = 0;
+
+static int dc_gpio_level = 0;
+
+// SSD1306 simulado
+static uint8_t gddram[SPI_HOST_PAGES][SPI_HOST_COLUMNS];
+static int ram_page = 0;
+static int ram_column = 0;
+static int pending_command = -1;
+static int pending_args = 0;
+static int contrast = 0x7F;
+
+static void error(const char *what)
+{
+    printf("ERRO no barramento simulado: %s\n", what);
+    errors++;
+}
+
+static uint64_t real_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+// O tempo real gasto no driver desde a última marca entra no relógio da task
+static void charge_cpu(void)
+{
+    if (in_call) {
+        uint64_t real = real_ns();
+        now_ns += real - real_mark_ns;
+        real_mark_ns = real;
+    }
+}
+
+static int command_args(uint8_t cmd)
+{
+    switch (cmd) {
+        case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+            return 1;
+        case 0x21: case 0x22: case 0xA3:
+            return 2;
+        case 0x26: case 0x27:
+            return 6;
+        case 0x29: case 0x2A:
+            return 5;
+        default:
+            return 0;
+    }
+}
+
+static void display_command(uint8_t b)
+{
+    if (pending_args > 0) {
+        if (pending_command == 0x81) {
+            contrast = b;
+        }
+        pending_args--;
+        return;
+    }
+    if (b <= 0x0F) {
+        ram_column = (ram_column & 0xF0) | b;
+    } else if (b >= 0x10 && b <= 0x1F) {
+        ram_column = (ram_column & 0x0F) | ((b & 0x0F) << 4);
+    } else if (b >= 0xB0 && b <= 0xB7) {
+        ram_page = b & 0x07;
+    } else {
+        pending_command = b;
+        pending_args = command_args(b);
+    }
+}
+
+static void display_data(uint8_t b)
+{
+    gddram[ram_page][ram_column & (SPI_HOST_COLUMNS - 1)] = b;
+    ram_column = (ram_column + 1) & (SPI_HOST_COLUMNS - 1);
+}
+
+// Entrega ao display as transações que já começaram até `t`
+static void run_bus(uint64_t t)
+{
+    while (queue_started != queue_tail && queue[queue_started % MAX_IN_FLIGHT].start_ns <= t) {
+        spi_transaction_t *trans = queue[queue_started % MAX_IN_FLIGHT].t;
+        queue_started++;
+        if (device.config.pre_cb) {
+            in_pre_cb = true;
+            device.config.pre_cb(trans);
+            in_pre_cb = false;
+        }
+        const uint8_t *bytes = trans->tx_buffer;
+        for (size_t i = 0; i < trans->length / 8; i++) {
+            if (dc_gpio_level) {
+                display_data(bytes[i]);
+            } else {
+                display_command(bytes[i]);
+            }
+        }
+    }
+}
+
+static bool bus_busy_at(uint64_t t)
+{
+    for (int i = queue_head; i < queue_started; i++) {
+        if (queue[i % MAX_IN_FLIGHT].end_ns > t) {
+            return true;
+        }
+    }
+    return false;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num)
+{
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode)
+{
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    // Só o DC interessa; CS e RESET ficam nos níveis da inicialização
+    if (gpio_num != SPI_HOST_DC_GPIO) {
+        return ESP_OK;
+    }
+    if (!in_pre_cb) {
+        charge_cpu();
+        run_bus(now_ns);
+        if (bus_busy_at(now_ns)) {
+            error("DC trocado pela task com uma transação em curso");
+        }
+    }
+    dc_gpio_level = level != 0;
+    return ESP_OK;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    charge_cpu();
+    now_ns += (uint64_t)ticks * (1000000000u / configTICK_RATE_HZ);
+    run_bus(now_ns);
+}
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t *bus_config, int dma_chan)
+{
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host_id, const spi_device_interface_config_t *dev_config,
+                             spi_device_handle_t *handle)
+{
+    if (dev_config->queue_size < 1 || dev_config->queue_size > MAX_IN_FLIGHT || dev_config->clock_speed_hz <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    device.config = *dev_config;
+    *handle = &device;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans_desc, TickType_t ticks_to_wait)
+{
+    charge_cpu();
+    if (queue_tail - queue_head >= handle->config.queue_size) {
+        // No ESP-IDF a task ficaria presa esperando alguém devolver as transações
+        error("fila do dispositivo cheia");
+        return ESP_FAIL;
+    }
+
+    uint64_t bits_ns = (uint64_t)trans_desc->length * 1000000000u / handle->config.clock_speed_hz;
+    uint64_t start;
+    if (bus_free_ns <= now_ns) {
+        start = now_ns + SETUP_NS;
+    } else {
+        start = bus_free_ns + CHAIN_NS;
+        now_ns += QUEUE_NS;
+    }
+    queue[queue_tail % MAX_IN_FLIGHT] = (in_flight_t) { trans_desc, start, start + bits_ns };
+    queue_tail++;
+    bus_free_ns = start + bits_ns;
+    transactions++;
+    run_bus(now_ns);
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans_desc,
+                                      TickType_t ticks_to_wait)
+{
+    charge_cpu();
+    if (queue_head == queue_tail) {
+        error("get_trans_result sem transação na fila");
+        return ESP_FAIL;
+    }
+    in_flight_t *oldest = &queue[queue_head % MAX_IN_FLIGHT];
+    if (oldest->end_ns + WAKE_NS > now_ns) {
+        now_ns = oldest->end_ns + WAKE_NS;
+    }
+    run_bus(now_ns);
+    *trans_desc = oldest->t;
+    queue_head++;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t *trans_desc)
+{
+    // O ESP-IDF não aceita misturar com transações ainda na fila
+    if (queue_head != queue_tail) {
+        error("spi_device_transmit com transações na fila");
+    }
+    spi_transaction_t *done;
+    esp_err_t err = spi_device_queue_trans(handle, trans_desc, portMAX_DELAY);
+    if (err == ESP_OK) {
+        err = spi_device_get_trans_result(handle, &done, portMAX_DELAY);
+    }
+    return err;
+}
+
+void spi_host_call_begin(void)
+{
+    in_call = true;
+    real_mark_ns = real_ns();
+}
+
+void spi_host_call_end(void)
+{
+    charge_cpu();
+    in_call = false;
+}
+
+uint64_t spi_host_now_ns(void)
+{
+    return now_ns;
+}
+
+uint64_t spi_host_bus_done_ns(void)
+{
+    return bus_free_ns > now_ns ? bus_free_ns : now_ns;
+}
+
+void spi_host_settle(void)
+{
+    now_ns = spi_host_bus_done_ns();
+    run_bus(now_ns);
+}
+
+uint32_t spi_host_transactions(void)
+{
+    return transactions;
+}
+
+uint32_t spi_host_errors(void)
+{
+    return errors;
+}
+
+const uint8_t *spi_host_gddram_page(int page)
+{
+    return gddram[page];
+}
+
+int spi_host_contrast(void)
+{
+    return contrast;
+}
@@ -0,0 +1,28 @@
+#pragma once
+// Controle do barramento SPI simulado (spi_host.c) pelos testes
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SPI_HOST_DC_GPIO 4      // Pino que o display simulado lê como DC
+#define SPI_HOST_PAGES 8
+#define SPI_HOST_COLUMNS 128
+
+// O tempo de CPU real só conta para a task entre begin e end (dentro do driver)
+void spi_host_call_begin(void);
+void spi_host_call_end(void);
+
+// Relógio simulado da task que chama o driver
+uint64_t spi_host_now_ns(void);
+
+// Quando o barramento termina o que já está na fila
+uint64_t spi_host_bus_done_ns(void);
+
+// Leva a task até o barramento parado e entrega tudo ao display
+void spi_host_settle(void);
+
+uint32_t spi_host_transactions(void);
+uint32_t spi_host_errors(void);
+
+// Estado do SSD1306 simulado
+const uint8_t *spi_host_gddram_page(int page);
+int spi_host_contrast(void);
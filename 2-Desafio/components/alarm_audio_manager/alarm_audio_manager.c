@@ -1,99 +1,194 @@
 #include "alarm_audio_manager.h"
+#include "audio_sink.h"
+#include "audio_wav.h"
+#include "audio_store.h"
 #include "esp_log.h"
-#include "esp_spiffs.h"
-#include "driver/dac_continuous.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
+#include "freertos/semphr.h"
 #include <string.h>
 #include <stdio.h>
 
 #define TAG "ALARM_AUDIO_MANAGER"
 #define AUDIO_SAMPLE_RATE_HZ 11025
-#define AUDIO_BUFFER_SIZE 1024
-#define WAV_HEADER_SIZE 44
-
-static dac_continuous_handle_t dac_handle = NULL;
-static bool is_playing = false;
-static TaskHandle_t audio_task_handle = NULL;
-
-static const char *audio_paths[] = {
-    [ALARM_AUDIO_TYPE_NORMAL] = "/spiffs/audio/normal.wav",
-    [ALARM_AUDIO_TYPE_INTERVAL] = "/spiffs/audio/interval.wav",
-    [ALARM_AUDIO_TYPE_EMERGENCY] = "/spiffs/audio/emergency.wav",
-    [ALARM_AUDIO_TYPE_SPECIAL] = "/spiffs/audio/special.wav"
+
+// Uma origem a mais que vozes: a voz preemptada ainda fecha a sua enquanto a nova abre
+#define SOURCE_POOL_SIZE (AUDIO_PIPELINE_MAX_VOICES + 1)
+
+typedef struct {
+    audio_source_mem_t mem;
+    audio_source_wav_t wav;
+    audio_voice_t voice;
+} clip_slot_t;
+
+typedef struct {
+    audio_source_tone_t tone;
+    audio_voice_t voice;
+} tone_slot_t;
+
+typedef struct {
+    audio_source_synth_t synth;
+    audio_voice_t voice;
+} synth_slot_t;
+
+static audio_pipeline_t pipeline;
+static audio_sink_dac_t dac_sink;
+static clip_slot_t clip_pool[SOURCE_POOL_SIZE];
+static tone_slot_t tone_pool[SOURCE_POOL_SIZE];
+static synth_slot_t synth_pool[SOURCE_POOL_SIZE];
+static SemaphoreHandle_t pool_lock = NULL;
+static bool initialized = false;
+static bool store_ready = false;
+
+// Nomes na partição de áudio (arquivo sem extensão, ver tools/pack_audio.py)
+static const char *audio_names[] = {
+    [ALARM_AUDIO_TYPE_NORMAL] = "normal",
+    [ALARM_AUDIO_TYPE_INTERVAL] = "interval",
+    [ALARM_AUDIO_TYPE_EMERGENCY] = "emergency",
+    [ALARM_AUDIO_TYPE_SPECIAL] = "special"
+};
+
+// A emergência abafa o resto; os demais alarmes tocam juntos em volume cheio
+static const audio_voice_params_t audio_params[] = {
+    [ALARM_AUDIO_TYPE_NORMAL] = { .priority = ALARM_AUDIO_PRIORITY_ALARM, .gain = AUDIO_GAIN_UNITY },
+    [ALARM_AUDIO_TYPE_INTERVAL] = { .priority = ALARM_AUDIO_PRIORITY_ALARM, .gain = AUDIO_GAIN_UNITY },
+    [ALARM_AUDIO_TYPE_EMERGENCY] = { .priority = ALARM_AUDIO_PRIORITY_EMERGENCY, .gain = AUDIO_GAIN_UNITY, .duck = true },
+    [ALARM_AUDIO_TYPE_SPECIAL] = { .priority = ALARM_AUDIO_PRIORITY_ALARM, .gain = AUDIO_GAIN_UNITY }
 };
 
-static void audio_task(void *param) {
-    alarm_audio_type_t type = (alarm_audio_type_t)(intptr_t)param;
+void alarm_audio_manager_init(void) {
+    esp_err_t err = audio_sink_dac_init(&dac_sink, AUDIO_SAMPLE_RATE_HZ);
+    if (err != ESP_OK) {
+        return;
+    }
 
-    const char *path = audio_paths[type];
-    FILE *f = fopen(path, "rb");
-    if (!f) {
-        ESP_LOGE(TAG, "Erro ao abrir arquivo: %s", path);
-        is_playing = false;
-        audio_task_handle = NULL;
-        vTaskDelete(NULL);
+    audio_pipeline_config_t cfg = AUDIO_PIPELINE_CONFIG_DEFAULT();
+    cfg.sample_rate_hz = AUDIO_SAMPLE_RATE_HZ;
+    err = audio_pipeline_init(&pipeline, &cfg, &dac_sink.base);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Erro ao criar pipeline de áudio: %s", esp_err_to_name(err));
         return;
     }
 
-    fseek(f, WAV_HEADER_SIZE, SEEK_SET);
-    uint8_t buffer[AUDIO_BUFFER_SIZE];
-    size_t bytes_read;
-    is_playing = true;
+    // Sem a partição (ou com imagem inválida) só os tons e a síntese tocam
+    store_ready = audio_store_open(ALARM_AUDIO_PARTITION) == ESP_OK;
+
+    for (int i = 0; i < SOURCE_POOL_SIZE; i++) {
+        clip_pool[i].voice = AUDIO_VOICE_NONE;
+        tone_pool[i].voice = AUDIO_VOICE_NONE;
+        synth_pool[i].voice = AUDIO_VOICE_NONE;
+    }
+    pool_lock = xSemaphoreCreateMutex();
+    initialized = true;
+}
+
+esp_err_t alarm_audio_manager_play(alarm_audio_type_t type) {
+    if (!initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (type < 0 || type >= sizeof(audio_names) / sizeof(audio_names[0])) {
+        ESP_LOGE(TAG, "Tipo de áudio inválido");
+        return ESP_ERR_INVALID_ARG;
+    }
+    const uint8_t *data;
+    uint32_t len;
+    if (!store_ready || !audio_store_find(audio_names[type], &data, &len)) {
+        ESP_LOGE(TAG, "Clipe '%s' não está na partição de áudio", audio_names[type]);
+        return ESP_ERR_NOT_FOUND;
+    }
 
-    while ((bytes_read = fread(buffer, 1, AUDIO_BUFFER_SIZE, f)) > 0 && is_playing) {
-        esp_err_t err = dac_continuous_write(dac_handle, buffer, bytes_read, NULL, -1);
-        if (err != ESP_OK) {
-            ESP_LOGE(TAG, "Erro ao escrever no DAC: %s", esp_err_to_name(err));
-            break;
+    esp_err_t err = ESP_ERR_NO_MEM;
+    xSemaphoreTake(pool_lock, portMAX_DELAY);
+    for (int i = 0; i < SOURCE_POOL_SIZE; i++) {
+        clip_slot_t *slot = &clip_pool[i];
+        // Origem só é reaproveitada quando o pipeline terminou de usá-la
+        if (audio_pipeline_voice_active(&pipeline, slot->voice)) {
+            continue;
         }
+        // PCM já no formato do DAC é mixado direto do flash mapeado; os demais são
+        // decodificados na task de leitura
+        audio_source_mem_init(&slot->mem, data, len);
+        audio_source_wav_init(&slot->wav, &slot->mem.base, AUDIO_SAMPLE_RATE_HZ);
+        slot->voice = audio_pipeline_play(&pipeline, &slot->wav.base, &audio_params[type]);
+        err = (slot->voice == AUDIO_VOICE_NONE) ? ESP_FAIL : ESP_OK;
+        break;
     }
+    xSemaphoreGive(pool_lock);
 
-    fclose(f);
-    is_playing = false;
-    audio_task_handle = NULL;
-    vTaskDelete(NULL);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Sem voz livre para o áudio %d", type);
+    }
+    return err;
 }
 
-void alarm_audio_manager_init(void) {
-    dac_continuous_config_t cfg = {
-        .chan_mask = DAC_CHANNEL_MASK_CH1,
-        .desc_num = 4,
-        .buf_size = 2048,
-        .freq_hz = AUDIO_SAMPLE_RATE_HZ,
-        .offset = 0,
-        .clk_src = DAC_DIGI_CLK_SRC_APLL,
-        .chan_mode = DAC_CHANNEL_MODE_SIMUL,
+esp_err_t alarm_audio_manager_play_tone(uint32_t freq_hz, uint32_t duration_ms, uint8_t priority) {
+    if (!initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const audio_voice_params_t params = {
+        .priority = priority,
+        .gain = AUDIO_GAIN_UNITY,
     };
 
-    esp_err_t err = dac_continuous_new_channels(&cfg, &dac_handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Erro ao criar canais DAC: %s", esp_err_to_name(err));
-        return;
+    esp_err_t err = ESP_ERR_NO_MEM;
+    xSemaphoreTake(pool_lock, portMAX_DELAY);
+    for (int i = 0; i < SOURCE_POOL_SIZE; i++) {
+        tone_slot_t *slot = &tone_pool[i];
+        if (audio_pipeline_voice_active(&pipeline, slot->voice)) {
+            continue;
+        }
+        audio_source_tone_init(&slot->tone, freq_hz, duration_ms, 64, AUDIO_SAMPLE_RATE_HZ);
+        slot->voice = audio_pipeline_play(&pipeline, &slot->tone.base, &params);
+        err = (slot->voice == AUDIO_VOICE_NONE) ? ESP_FAIL : ESP_OK;
+        break;
     }
-
-    ESP_ERROR_CHECK(dac_continuous_enable(dac_handle));
+    xSemaphoreGive(pool_lock);
+    return err;
 }
 
-esp_err_t alarm_audio_manager_play(alarm_audio_type_t type) {
-    if (is_playing || audio_task_handle != NULL) {
-        ESP_LOGW(TAG, "Áudio já está sendo reproduzido");
-        return ESP_FAIL;
+esp_err_t alarm_audio_manager_play_synth(const audio_synth_track_t *tracks, uint8_t track_count, uint8_t priority) {
+    if (!initialized) {
+        return ESP_ERR_INVALID_STATE;
     }
-
-    if (type < 0 || type >= sizeof(audio_paths) / sizeof(audio_paths[0])) {
-        ESP_LOGE(TAG, "Tipo de áudio inválido");
+    if (tracks == NULL || track_count == 0) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    return xTaskCreate(audio_task, "audio_task", 4096, (void *)(intptr_t)type, 5, &audio_task_handle) == pdPASS
-           ? ESP_OK : ESP_FAIL;
+    const audio_voice_params_t params = {
+        .priority = priority,
+        .gain = AUDIO_GAIN_UNITY,
+    };
+
+    esp_err_t err = ESP_ERR_NO_MEM;
+    xSemaphoreTake(pool_lock, portMAX_DELAY);
+    for (int i = 0; i < SOURCE_POOL_SIZE; i++) {
+        synth_slot_t *slot = &synth_pool[i];
+        if (audio_pipeline_voice_active(&pipeline, slot->voice)) {
+            continue;
+        }
+        audio_source_synth_init(&slot->synth, tracks, track_count, AUDIO_SAMPLE_RATE_HZ);
+        slot->voice = audio_pipeline_play(&pipeline, &slot->synth.base, &params);
+        err = (slot->voice == AUDIO_VOICE_NONE) ? ESP_FAIL : ESP_OK;
+        break;
+    }
+    xSemaphoreGive(pool_lock);
+    return err;
 }
 
 void alarm_audio_manager_stop(void) {
-    is_playing = false;
+    if (initialized) {
+        audio_pipeline_stop(&pipeline);
+    }
 }
 
 bool alarm_audio_manager_is_playing(void) {
-    return is_playing;
+    return initialized && audio_pipeline_is_playing(&pipeline);
+}
+
+void alarm_audio_manager_get_stats(audio_pipeline_stats_t *out) {
+    if (!initialized) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    audio_pipeline_get_stats(&pipeline, out);
 }
@@ -0,0 +1,55 @@
+#include "audio_adpcm.h"
+
+static const int16_t step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767
+};
+
+static const int8_t index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+// Reconstrução com deslocamentos, idêntica à referência da IMA
+static inline int32_t decode_nibble(uint8_t nibble, int32_t *predictor, int32_t *index)
+{
+    int32_t step = step_table[*index];
+    int32_t diff = step >> 3;
+    if (nibble & 4) diff += step;
+    if (nibble & 2) diff += step >> 1;
+    if (nibble & 1) diff += step >> 2;
+
+    int32_t p = (nibble & 8) ? *predictor - diff : *predictor + diff;
+    if (p > INT16_MAX) p = INT16_MAX;
+    if (p < INT16_MIN) p = INT16_MIN;
+    *predictor = p;
+
+    int32_t i = *index + index_table[nibble];
+    if (i < 0) i = 0;
+    if (i > 88) i = 88;
+    *index = i;
+    return p;
+}
+
+size_t audio_adpcm_decode_block(const uint8_t *block, size_t block_len, int16_t *out)
+{
+    if (block_len < AUDIO_ADPCM_BLOCK_HEADER) {
+        return 0;
+    }
+
+    int32_t predictor = (int16_t)(block[0] | (block[1] << 8));
+    int32_t index = block[2] > 88 ? 88 : block[2];
+    size_t n = 0;
+    out[n++] = (int16_t)predictor;
+
+    for (size_t i = AUDIO_ADPCM_BLOCK_HEADER; i < block_len; i++) {
+        out[n++] = (int16_t)decode_nibble(block[i] & 0x0F, &predictor, &index);
+        out[n++] = (int16_t)decode_nibble(block[i] >> 4, &predictor, &index);
+    }
+    return n;
+}
@@ -0,0 +1,63 @@
+#include "audio_convert.h"
+
+void audio_pcm_u8_to_s16(const uint8_t *in, int16_t *out, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (int16_t)((in[i] - 128) << 8);
+    }
+}
+
+void audio_pcm_s16le_to_s16(const uint8_t *in, int16_t *out, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (int16_t)(in[2 * i] | (in[2 * i + 1] << 8));
+    }
+}
+
+static inline int16_t alaw_to_s16(uint8_t a)
+{
+    a ^= 0x55;
+    int32_t t = (a & 0x0F) << 4;
+    int32_t seg = (a & 0x70) >> 4;
+    if (seg == 0) {
+        t += 8;
+    } else {
+        t = (t + 0x108) << (seg - 1);
+    }
+    return (int16_t)((a & 0x80) ? t : -t);
+}
+
+static inline int16_t ulaw_to_s16(uint8_t u)
+{
+    u = ~u;
+    int32_t t = (((u & 0x0F) << 3) + 0x84) << ((u & 0x70) >> 4);
+    return (int16_t)((u & 0x80) ? (0x84 - t) : (t - 0x84));
+}
+
+void audio_pcm_alaw_to_s16(const uint8_t *in, int16_t *out, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        out[i] = alaw_to_s16(in[i]);
+    }
+}
+
+void audio_pcm_ulaw_to_s16(const uint8_t *in, int16_t *out, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        out[i] = ulaw_to_s16(in[i]);
+    }
+}
+
+void audio_pcm_stereo_to_mono(const int16_t *in, int16_t *out, size_t frames)
+{
+    for (size_t i = 0; i < frames; i++) {
+        out[i] = (int16_t)((in[2 * i] + in[2 * i + 1]) >> 1);
+    }
+}
+
+void audio_pcm_s16_to_u8(const int16_t *in, uint8_t *out, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (uint8_t)((in[i] >> 8) + 128);
+    }
+}
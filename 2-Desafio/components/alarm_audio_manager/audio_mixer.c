@@ -0,0 +1,19 @@
+#include "audio_mixer.h"
+#include "esp_attr.h"
+
+void IRAM_ATTR audio_mix_accumulate(int32_t *acc, const uint8_t *in, int32_t gain_q15, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        acc[i] += ((int32_t)in[i] - 128) * gain_q15;
+    }
+}
+
+void IRAM_ATTR audio_mix_output(const int32_t *acc, uint8_t *out, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        int32_t v = (acc[i] >> 15) + 128;
+        v = v < 0 ? 0 : v;
+        v = v > 255 ? 255 : v;
+        out[i] = (uint8_t)v;
+    }
+}
@@ -0,0 +1,512 @@
+#include "audio_pipeline.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TAG "AUDIO_PIPELINE"
+
+#define READER_POLL_MS 20 // Folga caso uma notificação do sink se perca
+#define VOICE_SLOT_BITS 4 // audio_voice_t = (geração << VOICE_SLOT_BITS) | slot
+
+static uint32_t ms_to_bytes(const audio_pipeline_t *pipe, uint32_t ms)
+{
+    return (uint32_t)((uint64_t)pipe->config.sample_rate_hz * ms / 1000);
+}
+
+static uint32_t round_up_pow2(uint32_t v)
+{
+    uint32_t p = 1;
+    while (p < v) {
+        p <<= 1;
+    }
+    return p;
+}
+
+static inline int voice_slot(audio_voice_t voice)
+{
+    return voice & ((1 << VOICE_SLOT_BITS) - 1);
+}
+
+static inline bool voice_mixing(const audio_pipe_voice_t *v)
+{
+    return (v->state == AUDIO_PIPE_RUNNING || v->state == AUDIO_PIPE_DRAINING) && !v->stop_requested;
+}
+
+static void set_state(audio_pipeline_t *pipe, audio_pipe_voice_t *v, audio_pipe_state_t state)
+{
+    portENTER_CRITICAL(&pipe->mux);
+    v->state = state;
+    portEXIT_CRITICAL(&pipe->mux);
+}
+
+static void finish_voice(audio_pipeline_t *pipe, audio_pipe_voice_t *v)
+{
+    // Com a voz fora da mixagem o sink não toca mais na fila...
+    portENTER_CRITICAL(&pipe->mux);
+    v->state = AUDIO_PIPE_IDLE;
+    v->stop_requested = false;
+    portEXIT_CRITICAL(&pipe->mux);
+
+    // ...depois de terminar o trecho que talvez esteja mixando em outro núcleo
+    while (v->rendering) {
+    }
+    audio_ring_reset(&v->ring);
+
+    v->source->close(v->source);
+    v->source = NULL;
+    v->direct = NULL;
+}
+
+static void begin_voice(audio_pipeline_t *pipe, audio_pipe_voice_t *v)
+{
+    portENTER_CRITICAL(&pipe->mux);
+    v->source = v->pending;
+    v->params = v->pending_params;
+    v->id = v->pending_id;
+    v->pending = NULL;
+    v->stop_requested = false;
+    portEXIT_CRITICAL(&pipe->mux);
+
+    v->first_sample = false;
+    v->drained = false;
+    pipe->stats.clips++;
+
+    if (v->source->open(v->source) != ESP_OK) {
+        v->source = NULL;
+        return;
+    }
+
+    // Origem mapeada: já está toda disponível, entra direto na mixagem
+    if (v->source->map) {
+        v->direct_pos = 0;
+        v->direct = v->source->map(v->source, &v->direct_len);
+        if (v->direct) {
+            set_state(pipe, v, AUDIO_PIPE_DRAINING);
+            return;
+        }
+    }
+    set_state(pipe, v, AUDIO_PIPE_PREFILL);
+}
+
+// Lê da origem direto para a fila até enchê-la; retorna false no fim do clipe
+static bool fill_ring(audio_pipeline_t *pipe, audio_pipe_voice_t *v)
+{
+    uint8_t *dst;
+    uint32_t space;
+
+    while ((space = audio_ring_write_region(&v->ring, &dst)) > 0) {
+        if (v->stop_requested) {
+            return true;
+        }
+        if (space > pipe->config.read_chunk) {
+            space = pipe->config.read_chunk;
+        }
+
+        int64_t t0 = esp_timer_get_time();
+        int n = v->source->read(v->source, dst, space);
+        uint32_t read_us = (uint32_t)(esp_timer_get_time() - t0);
+        if (read_us > pipe->stats.max_read_us) {
+            pipe->stats.max_read_us = read_us;
+        }
+
+        if (n <= 0) {
+            if (n < 0) {
+                ESP_LOGE(TAG, "Erro lendo a origem de áudio");
+            }
+            return false;
+        }
+        audio_ring_commit(&v->ring, (uint32_t)n);
+    }
+    return true;
+}
+
+// Avança uma voz; retorna true se ela continua ocupando o slot
+static bool service_voice(audio_pipeline_t *pipe, audio_pipe_voice_t *v, uint32_t start_bytes)
+{
+    if (v->state != AUDIO_PIPE_IDLE && v->stop_requested) {
+        finish_voice(pipe, v);
+    }
+    if (v->state == AUDIO_PIPE_IDLE) {
+        if (!v->pending) {
+            return false;
+        }
+        begin_voice(pipe, v);
+        if (v->state == AUDIO_PIPE_IDLE) {
+            return false;
+        }
+    }
+
+    bool more = true;
+    if (v->state == AUDIO_PIPE_PREFILL || v->state == AUDIO_PIPE_RUNNING) {
+        more = fill_ring(pipe, v);
+    }
+    if (v->stop_requested) {
+        finish_voice(pipe, v);
+        return v->pending != NULL;
+    }
+
+    if (v->state == AUDIO_PIPE_PREFILL && (!more || audio_ring_used(&v->ring) >= start_bytes)) {
+        set_state(pipe, v, AUDIO_PIPE_RUNNING);
+    }
+    if (v->state == AUDIO_PIPE_RUNNING && !more) {
+        set_state(pipe, v, AUDIO_PIPE_DRAINING);
+    }
+    if (v->state == AUDIO_PIPE_DRAINING && v->drained) {
+        finish_voice(pipe, v);
+        return v->pending != NULL;
+    }
+    return true;
+}
+
+static void reader_task(void *param)
+{
+    audio_pipeline_t *pipe = (audio_pipeline_t *)param;
+    uint32_t start_bytes = ms_to_bytes(pipe, pipe->config.start_ms);
+    bool busy = false;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, busy ? pdMS_TO_TICKS(READER_POLL_MS) : portMAX_DELAY);
+
+        uint32_t active = 0;
+        bool mixing = false;
+        for (int i = 0; i < AUDIO_PIPELINE_MAX_VOICES; i++) {
+            audio_pipe_voice_t *v = &pipe->voices[i];
+            uint32_t limit = start_bytes > v->ring.size ? v->ring.size : start_bytes;
+            if (service_voice(pipe, v, limit)) {
+                active++;
+            }
+            mixing |= voice_mixing(v);
+        }
+        pipe->stats.active_voices = active;
+
+        if (mixing && !pipe->sink_running) {
+            pipe->idle_blocks = 0;
+            if (pipe->sink->start(pipe->sink, pipe) == ESP_OK) {
+                pipe->sink_running = true;
+            } else {
+                ESP_LOGE(TAG, "Erro ao iniciar o sink de áudio");
+            }
+        } else if (!active && pipe->sink_running && pipe->idle_blocks >= pipe->sink->flush_blocks) {
+            pipe->sink->stop(pipe->sink);
+            pipe->sink_running = false;
+        }
+        busy = active > 0 || pipe->sink_running;
+    }
+}
+
+esp_err_t audio_pipeline_init(audio_pipeline_t *pipe, const audio_pipeline_config_t *config,
+                              audio_sink_t *sink)
+{
+    memset(pipe, 0, sizeof(*pipe));
+    pipe->config = *config;
+    pipe->sink = sink;
+    portMUX_INITIALIZE(&pipe->mux);
+
+    uint32_t size = round_up_pow2(ms_to_bytes(pipe, config->prefetch_ms));
+    for (int i = 0; i < AUDIO_PIPELINE_MAX_VOICES; i++) {
+        uint8_t *buf = malloc(size);
+        if (!buf) {
+            ESP_LOGE(TAG, "Sem memória para a fila de áudio (%lu bytes)", (unsigned long)size);
+            while (--i >= 0) {
+                free(pipe->voices[i].ring.buf);
+            }
+            return ESP_ERR_NO_MEM;
+        }
+        audio_ring_init(&pipe->voices[i].ring, buf, size);
+        pipe->voices[i].id = AUDIO_VOICE_NONE;
+        pipe->voices[i].pending_id = AUDIO_VOICE_NONE;
+    }
+    pipe->stats.ring_bytes = size;
+    pipe->stats.min_buffered_bytes = size;
+
+    // Sem buffer de leitura na pilha: as origens escrevem direto nas filas
+    if (xTaskCreate(reader_task, "audio_reader", 3072, pipe, config->task_priority, &pipe->task) != pdPASS) {
+        for (int i = 0; i < AUDIO_PIPELINE_MAX_VOICES; i++) {
+            free(pipe->voices[i].ring.buf);
+        }
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+// Prioridade com que o slot disputa uma preempção (a do que vai tocar nele)
+static int slot_priority(const audio_pipe_voice_t *v)
+{
+    if (v->pending) {
+        return v->pending_params.priority;
+    }
+    if (v->state == AUDIO_PIPE_IDLE && v->source == NULL) {
+        return -1;
+    }
+    return v->params.priority;
+}
+
+audio_voice_t audio_pipeline_play(audio_pipeline_t *pipe, audio_source_t *source,
+                                  const audio_voice_params_t *params)
+{
+    audio_voice_t id = AUDIO_VOICE_NONE;
+
+    portENTER_CRITICAL(&pipe->mux);
+    int slot = -1;
+    int lowest = params->priority;
+    for (int i = 0; i < AUDIO_PIPELINE_MAX_VOICES; i++) {
+        int prio = slot_priority(&pipe->voices[i]);
+        if (prio < lowest) {
+            lowest = prio;
+            slot = i;
+        }
+    }
+
+    if (slot < 0) {
+        pipe->stats.rejected++;
+    } else {
+        audio_pipe_voice_t *v = &pipe->voices[slot];
+        if (lowest >= 0) {
+            pipe->stats.preempted++;
+        }
+        // A voz atual sai da mixagem já no próximo trecho; a leitura fecha a origem
+        if (v->state != AUDIO_PIPE_IDLE || v->source != NULL) {
+            v->stop_requested = true;
+        }
+        id = (audio_voice_t)((++pipe->next_id << VOICE_SLOT_BITS) | slot) & INT32_MAX;
+        v->pending = source;
+        v->pending_params = *params;
+        v->pending_id = id;
+        v->request_us = esp_timer_get_time();
+    }
+    portEXIT_CRITICAL(&pipe->mux);
+
+    if (id != AUDIO_VOICE_NONE) {
+        xTaskNotifyGive(pipe->task);
+    }
+    return id;
+}
+
+void audio_pipeline_stop_voice(audio_pipeline_t *pipe, audio_voice_t voice)
+{
+    if (voice == AUDIO_VOICE_NONE) {
+        return;
+    }
+    audio_pipe_voice_t *v = &pipe->voices[voice_slot(voice)];
+
+    portENTER_CRITICAL(&pipe->mux);
+    if (v->pending && v->pending_id == voice) {
+        v->pending = NULL;
+    } else if ((v->state != AUDIO_PIPE_IDLE || v->source != NULL) && v->id == voice) {
+        v->stop_requested = true;
+    }
+    portEXIT_CRITICAL(&pipe->mux);
+    xTaskNotifyGive(pipe->task);
+}
+
+void audio_pipeline_stop(audio_pipeline_t *pipe)
+{
+    portENTER_CRITICAL(&pipe->mux);
+    for (int i = 0; i < AUDIO_PIPELINE_MAX_VOICES; i++) {
+        audio_pipe_voice_t *v = &pipe->voices[i];
+        v->pending = NULL;
+        if (v->state != AUDIO_PIPE_IDLE) {
+            v->stop_requested = true;
+        }
+    }
+    portEXIT_CRITICAL(&pipe->mux);
+    xTaskNotifyGive(pipe->task);
+}
+
+bool audio_pipeline_voice_active(audio_pipeline_t *pipe, audio_voice_t voice)
+{
+    if (voice == AUDIO_VOICE_NONE) {
+        return false;
+    }
+    audio_pipe_voice_t *v = &pipe->voices[voice_slot(voice)];
+
+    portENTER_CRITICAL(&pipe->mux);
+    bool active = (v->pending && v->pending_id == voice) ||
+                  ((v->state != AUDIO_PIPE_IDLE || v->source != NULL) && v->id == voice);
+    portEXIT_CRITICAL(&pipe->mux);
+    return active;
+}
+
+bool audio_pipeline_is_playing(audio_pipeline_t *pipe)
+{
+    for (int i = 0; i < AUDIO_PIPELINE_MAX_VOICES; i++) {
+        const audio_pipe_voice_t *v = &pipe->voices[i];
+        if (v->state != AUDIO_PIPE_IDLE || v->pending != NULL) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void audio_pipeline_get_stats(audio_pipeline_t *pipe, audio_pipeline_stats_t *out)
+{
+    *out = pipe->stats;
+}
+
+// Soma a voz em acc; retorna as amostras que ela realmente tinha
+static uint32_t IRAM_ATTR mix_voice(audio_pipe_voice_t *v, int32_t *acc, uint32_t n, int32_t gain)
+{
+    if (v->direct) {
+        uint32_t len = v->direct_len - v->direct_pos;
+        if (len > n) {
+            len = n;
+        }
+        audio_mix_accumulate(acc, &v->direct[v->direct_pos], gain, len);
+        v->direct_pos += len;
+        return len;
+    }
+
+    uint32_t got = 0;
+    while (got < n) {
+        const uint8_t *data;
+        uint32_t len = audio_ring_read_region(&v->ring, &data);
+        if (len == 0) {
+            break;
+        }
+        if (len > n - got) {
+            len = n - got;
+        }
+        audio_mix_accumulate(&acc[got], data, gain, len);
+        audio_ring_consume(&v->ring, len);
+        got += len;
+    }
+    return got;
+}
+
+static inline void IRAM_ATTR mux_enter(audio_pipeline_t *pipe, bool from_isr)
+{
+    if (from_isr) {
+        portENTER_CRITICAL_ISR(&pipe->mux);
+    } else {
+        portENTER_CRITICAL(&pipe->mux);
+    }
+}
+
+static inline void IRAM_ATTR mux_exit(audio_pipeline_t *pipe, bool from_isr)
+{
+    if (from_isr) {
+        portEXIT_CRITICAL_ISR(&pipe->mux);
+    } else {
+        portEXIT_CRITICAL(&pipe->mux);
+    }
+}
+
+typedef struct {
+    audio_pipe_voice_t *v;
+    audio_pipe_state_t state;   // Estado na escolha: DRAINING garante que a origem já entregou tudo
+    int32_t gain;
+    uint32_t got;
+} mix_job_t;
+
+void IRAM_ATTR audio_pipeline_render(audio_pipeline_t *pipe, uint8_t *out, uint32_t n, bool from_isr)
+{
+    static DRAM_ATTR int32_t acc[AUDIO_MIX_CHUNK];
+    audio_pipeline_stats_t *stats = &pipe->stats;
+    int64_t t0 = esp_timer_get_time();
+    mix_job_t jobs[AUDIO_PIPELINE_MAX_VOICES];
+    uint32_t mixed = 0;
+
+    memset(acc, 0, n * sizeof(acc[0]));
+
+    // Sob o lock só a escolha das vozes e dos ganhos; a soma roda fora dele, com a
+    // voz marcada para a leitura não zerar a fila no meio. A decodificação não passa
+    // por aqui: a fila já traz PCM decodificado pela task de leitura (fill_ring)
+    mux_enter(pipe, from_isr);
+
+    // Prioridade mínima que escapa do abafamento
+    int duck_below = -1;
+    for (int i = 0; i < AUDIO_PIPELINE_MAX_VOICES; i++) {
+        const audio_pipe_voice_t *v = &pipe->voices[i];
+        if (voice_mixing(v) && v->params.duck && v->params.priority > duck_below) {
+            duck_below = v->params.priority;
+        }
+    }
+
+    for (int i = 0; i < AUDIO_PIPELINE_MAX_VOICES; i++) {
+        audio_pipe_voice_t *v = &pipe->voices[i];
+        if (!voice_mixing(v)) {
+            continue;
+        }
+
+        int32_t gain = v->params.gain;
+        if (v->params.priority < duck_below) {
+            gain = (int32_t)(((uint32_t)gain * pipe->config.duck_gain) >> 15);
+        }
+        v->rendering = true;
+        jobs[mixed++] = (mix_job_t) { .v = v, .state = v->state, .gain = gain };
+    }
+    mux_exit(pipe, from_isr);
+
+    for (uint32_t i = 0; i < mixed; i++) {
+        jobs[i].got = mix_voice(jobs[i].v, acc, n, jobs[i].gain);
+    }
+
+    mux_enter(pipe, from_isr);
+    for (uint32_t i = 0; i < mixed; i++) {
+        audio_pipe_voice_t *v = jobs[i].v;
+        uint32_t got = jobs[i].got;
+
+        if (got > 0 && !v->first_sample) {
+            v->first_sample = true;
+            stats->start_latency_us = (uint32_t)(t0 - v->request_us);
+            if (stats->start_latency_us > stats->max_start_latency_us) {
+                stats->max_start_latency_us = stats->start_latency_us;
+            }
+            if (v->direct) {
+                stats->start_latency_mapped_us = stats->start_latency_us;
+            } else {
+                stats->start_latency_stream_us = stats->start_latency_us;
+            }
+        }
+        if (got < n) {
+            if (jobs[i].state == AUDIO_PIPE_RUNNING) {
+                // Faltou dado com a origem ainda ativa: falha audível
+                stats->underruns++;
+                stats->underrun_bytes += n - got;
+            } else if (got == 0) {
+                v->drained = true;
+            }
+        }
+
+        uint32_t used = audio_ring_used(&v->ring);
+        if (jobs[i].state == AUDIO_PIPE_RUNNING && used < stats->min_buffered_bytes) {
+            stats->min_buffered_bytes = used;
+        }
+        v->rendering = false;
+    }
+
+    mux_exit(pipe, from_isr);
+
+    audio_mix_output(acc, out, n);
+
+    if (mixed > 0) {
+        pipe->idle_blocks = 0;
+        uint32_t mix_us = (uint32_t)(esp_timer_get_time() - t0);
+        stats->mix_us += mix_us;
+        stats->mix_voice_samples += (uint64_t)n * mixed;
+        if (mix_us > stats->max_mix_us) {
+            stats->max_mix_us = mix_us;
+        }
+    }
+}
+
+bool IRAM_ATTR audio_pipeline_sink_done(audio_pipeline_t *pipe, bool from_isr)
+{
+    bool any = false;
+    for (int i = 0; i < AUDIO_PIPELINE_MAX_VOICES; i++) {
+        any |= voice_mixing(&pipe->voices[i]);
+    }
+    if (!any) {
+        pipe->idle_blocks++;
+    }
+
+    if (!from_isr) {
+        xTaskNotifyGive(pipe->task);
+        return false;
+    }
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(pipe->task, &woken);
+    return woken == pdTRUE;
+}
@@ -0,0 +1,49 @@
+#include "audio_resampler.h"
+
+void audio_resampler_init(audio_resampler_t *rs, uint32_t in_rate_hz, uint32_t out_rate_hz)
+{
+    rs->step = (uint32_t)(((uint64_t)in_rate_hz << 16) / out_rate_hz);
+    rs->pos = 0;
+}
+
+size_t audio_resample_linear(audio_resampler_t *rs, const int16_t *in, size_t in_len,
+                             int16_t *out, size_t out_cap)
+{
+    if (in_len < 2) {
+        return 0;
+    }
+
+    // Quantas saídas cabem antes de precisar de in[in_len]
+    uint32_t last = (uint32_t)(in_len - 1) << 16;
+    if (rs->pos >= last) {
+        return 0;
+    }
+    size_t n = (last - rs->pos - 1) / rs->step + 1;
+    if (n > out_cap) {
+        n = out_cap;
+    }
+
+    // Contagem fixa e sem desvios: só aritmética inteira no laço
+    uint32_t pos = rs->pos;
+    const uint32_t step = rs->step;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t idx = pos >> 16;
+        int32_t frac = (int32_t)((pos & 0xFFFF) >> 1); // Q15 para o produto caber em 32 bits
+        int32_t a = in[idx];
+        int32_t b = in[idx + 1];
+        out[i] = (int16_t)(a + (((b - a) * frac) >> 15));
+        pos += step;
+    }
+    rs->pos = pos;
+    return n;
+}
+
+size_t audio_resampler_advance(audio_resampler_t *rs, size_t in_len)
+{
+    size_t whole = rs->pos >> 16;
+    if (whole > in_len) {
+        whole = in_len;
+    }
+    rs->pos -= (uint32_t)whole << 16;
+    return whole;
+}
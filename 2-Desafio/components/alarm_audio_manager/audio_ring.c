@@ -0,0 +1,68 @@
+#include "audio_ring.h"
+#include "esp_attr.h"
+
+bool audio_ring_init(audio_ring_t *ring, uint8_t *buf, uint32_t size)
+{
+    if (buf == NULL || size == 0 || (size & (size - 1)) != 0) {
+        return false;
+    }
+    ring->buf = buf;
+    ring->size = size;
+    ring->head = 0;
+    ring->tail = 0;
+    return true;
+}
+
+void audio_ring_reset(audio_ring_t *ring)
+{
+    __atomic_store_n(&ring->head, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->tail, 0, __ATOMIC_RELEASE);
+}
+
+uint32_t IRAM_ATTR audio_ring_used(const audio_ring_t *ring)
+{
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    return head - tail;
+}
+
+uint32_t audio_ring_free(const audio_ring_t *ring)
+{
+    return ring->size - audio_ring_used(ring);
+}
+
+uint32_t audio_ring_write_region(audio_ring_t *ring, uint8_t **ptr)
+{
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    uint32_t offset = head & (ring->size - 1);
+    uint32_t space = ring->size - (head - tail);
+    uint32_t to_end = ring->size - offset;
+
+    *ptr = &ring->buf[offset];
+    return space < to_end ? space : to_end;
+}
+
+void audio_ring_commit(audio_ring_t *ring, uint32_t len)
+{
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->head, head + len, __ATOMIC_RELEASE);
+}
+
+uint32_t IRAM_ATTR audio_ring_read_region(audio_ring_t *ring, const uint8_t **ptr)
+{
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t offset = tail & (ring->size - 1);
+    uint32_t avail = head - tail;
+    uint32_t to_end = ring->size - offset;
+
+    *ptr = &ring->buf[offset];
+    return avail < to_end ? avail : to_end;
+}
+
+void IRAM_ATTR audio_ring_consume(audio_ring_t *ring, uint32_t len)
+{
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->tail, tail + len, __ATOMIC_RELEASE);
+}
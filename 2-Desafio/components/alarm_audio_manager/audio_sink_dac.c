@@ -0,0 +1,99 @@
+#include "audio_sink.h"
+#include "driver/dac_continuous.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include <string.h>
+
+#define TAG "AUDIO_SINK_DAC"
+
+#define DAC_DESC_NUM 4
+#define DAC_BUF_SIZE 2048
+
+#if CONFIG_IDF_TARGET_ESP32
+#define DAC_DMA_BYTES_PER_SAMPLE 2 // O DMA do I2S0 usa 16 bits por amostra
+#else
+#define DAC_DMA_BYTES_PER_SAMPLE 1
+#endif
+
+static DRAM_ATTR uint8_t mix_buf[AUDIO_MIX_CHUNK];
+
+// Cada descritor do DMA que termina é reabastecido com a mixagem das vozes
+static bool IRAM_ATTR on_convert_done(dac_continuous_handle_t handle, const dac_event_data_t *event, void *user_data)
+{
+    audio_sink_dac_t *dac = (audio_sink_dac_t *)user_data;
+    uint8_t *dma = (uint8_t *)event->buf;
+    size_t dma_left = event->buf_size;
+
+    while (dma_left > 0) {
+        uint32_t n = dma_left / DAC_DMA_BYTES_PER_SAMPLE;
+        if (n > AUDIO_MIX_CHUNK) {
+            n = AUDIO_MIX_CHUNK;
+        }
+        audio_pipeline_render(dac->pipe, mix_buf, n, true);
+
+        size_t loaded = 0;
+        dac_continuous_write_asynchronously(handle, dma, dma_left, mix_buf, n, &loaded);
+        if (loaded == 0) {
+            break;
+        }
+        dma += loaded * DAC_DMA_BYTES_PER_SAMPLE;
+        dma_left -= loaded * DAC_DMA_BYTES_PER_SAMPLE;
+    }
+
+    return audio_pipeline_sink_done(dac->pipe, true);
+}
+
+static esp_err_t dac_start(audio_sink_t *sink, audio_pipeline_t *pipe)
+{
+    audio_sink_dac_t *dac = (audio_sink_dac_t *)sink;
+    dac->pipe = pipe;
+    return dac_continuous_start_async_writing(dac->handle);
+}
+
+static void dac_stop(audio_sink_t *sink)
+{
+    audio_sink_dac_t *dac = (audio_sink_dac_t *)sink;
+    dac_continuous_stop_async_writing(dac->handle);
+}
+
+esp_err_t audio_sink_dac_init(audio_sink_dac_t *dac, uint32_t sample_rate_hz)
+{
+    dac->base.start = dac_start;
+    dac->base.stop = dac_stop;
+    dac->base.flush_blocks = DAC_DESC_NUM;
+    dac->pipe = NULL;
+
+    dac_continuous_config_t cfg = {
+        .chan_mask = DAC_CHANNEL_MASK_CH1,
+        .desc_num = DAC_DESC_NUM,
+        .buf_size = DAC_BUF_SIZE,
+        .freq_hz = sample_rate_hz,
+        .offset = 0,
+        .clk_src = DAC_DIGI_CLK_SRC_APLL,
+        .chan_mode = DAC_CHANNEL_MODE_SIMUL,
+    };
+
+    dac_continuous_handle_t handle;
+    esp_err_t err = dac_continuous_new_channels(&cfg, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Erro ao criar canais DAC: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    // O callback precisa ser registrado antes de habilitar os canais
+    const dac_event_callbacks_t cbs = {
+        .on_convert_done = on_convert_done,
+    };
+    err = dac_continuous_register_event_callback(handle, &cbs, dac);
+    if (err == ESP_OK) {
+        err = dac_continuous_enable(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Erro ao configurar DAC: %s", esp_err_to_name(err));
+        dac_continuous_del_channels(handle);
+        return err;
+    }
+
+    dac->handle = handle;
+    return ESP_OK;
+}
@@ -0,0 +1,51 @@
+#include "audio_sink.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#define TAG "AUDIO_SINK_NULL"
+
+// Mixa um bloco por período, como o DMA faria, mas sem tocar nada
+static void null_tick(void *arg)
+{
+    audio_sink_null_t *ns = (audio_sink_null_t *)arg;
+
+    for (uint32_t done = 0; done < ns->block_samples; done += AUDIO_MIX_CHUNK) {
+        uint32_t n = ns->block_samples - done;
+        audio_pipeline_render(ns->pipe, ns->buf, n > AUDIO_MIX_CHUNK ? AUDIO_MIX_CHUNK : n, false);
+    }
+    audio_pipeline_sink_done(ns->pipe, false);
+}
+
+static esp_err_t null_start(audio_sink_t *sink, audio_pipeline_t *pipe)
+{
+    audio_sink_null_t *ns = (audio_sink_null_t *)sink;
+    ns->pipe = pipe;
+    return esp_timer_start_periodic(ns->timer, ns->period_us);
+}
+
+static void null_stop(audio_sink_t *sink)
+{
+    audio_sink_null_t *ns = (audio_sink_null_t *)sink;
+    esp_timer_stop(ns->timer);
+}
+
+esp_err_t audio_sink_null_init(audio_sink_null_t *ns, uint32_t sample_rate_hz, uint32_t period_ms)
+{
+    ns->base.start = null_start;
+    ns->base.stop = null_stop;
+    ns->base.flush_blocks = 0;
+    ns->pipe = NULL;
+    ns->period_us = period_ms * 1000;
+    ns->block_samples = sample_rate_hz * period_ms / 1000;
+
+    const esp_timer_create_args_t args = {
+        .callback = null_tick,
+        .arg = ns,
+        .name = "audio_null_sink"
+    };
+    esp_err_t err = esp_timer_create(&args, &ns->timer);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Erro ao criar timer: %s", esp_err_to_name(err));
+    }
+    return err;
+}
@@ -0,0 +1,52 @@
+#include "audio_source.h"
+#include "esp_log.h"
+
+#define TAG "AUDIO_SOURCE"
+
+static esp_err_t file_open(audio_source_t *src)
+{
+    audio_source_file_t *fs = (audio_source_file_t *)src;
+
+    fs->f = fopen(fs->path, "rb");
+    if (!fs->f) {
+        ESP_LOGE(TAG, "Erro ao abrir arquivo: %s", fs->path);
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (fseek(fs->f, fs->offset, SEEK_SET) != 0) {
+        ESP_LOGE(TAG, "Erro ao posicionar em %ld: %s", fs->offset, fs->path);
+        fclose(fs->f);
+        fs->f = NULL;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+static int file_read(audio_source_t *src, uint8_t *dst, size_t len)
+{
+    audio_source_file_t *fs = (audio_source_file_t *)src;
+    size_t n = fread(dst, 1, len, fs->f);
+    if (n == 0 && ferror(fs->f)) {
+        return -1;
+    }
+    return (int)n;
+}
+
+static void file_close(audio_source_t *src)
+{
+    audio_source_file_t *fs = (audio_source_file_t *)src;
+    if (fs->f) {
+        fclose(fs->f);
+        fs->f = NULL;
+    }
+}
+
+void audio_source_file_init(audio_source_file_t *fs, const char *path, long offset)
+{
+    fs->base.open = file_open;
+    fs->base.read = file_read;
+    fs->base.close = file_close;
+    fs->base.map = NULL;
+    fs->path = path;
+    fs->offset = offset;
+    fs->f = NULL;
+}
@@ -0,0 +1,43 @@
+#include "audio_source.h"
+#include <string.h>
+
+static esp_err_t mem_open(audio_source_t *src)
+{
+    audio_source_mem_t *mem = (audio_source_mem_t *)src;
+    mem->pos = 0;
+    return ESP_OK;
+}
+
+static int mem_read(audio_source_t *src, uint8_t *dst, size_t len)
+{
+    audio_source_mem_t *mem = (audio_source_mem_t *)src;
+    uint32_t left = mem->len - mem->pos;
+    if (len > left) {
+        len = left;
+    }
+    memcpy(dst, &mem->data[mem->pos], len);
+    mem->pos += len;
+    return (int)len;
+}
+
+static void mem_close(audio_source_t *src)
+{
+}
+
+static const uint8_t *mem_map(audio_source_t *src, uint32_t *len)
+{
+    audio_source_mem_t *mem = (audio_source_mem_t *)src;
+    *len = mem->len - mem->pos;
+    return &mem->data[mem->pos];
+}
+
+void audio_source_mem_init(audio_source_mem_t *mem, const uint8_t *data, uint32_t len)
+{
+    mem->base.open = mem_open;
+    mem->base.read = mem_read;
+    mem->base.close = mem_close;
+    mem->base.map = mem_map;
+    mem->data = data;
+    mem->len = len;
+    mem->pos = 0;
+}
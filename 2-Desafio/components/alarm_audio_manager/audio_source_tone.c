@@ -0,0 +1,46 @@
+#include "audio_source.h"
+
+static esp_err_t tone_open(audio_source_t *src)
+{
+    audio_source_tone_t *tone = (audio_source_tone_t *)src;
+    tone->phase = 0;
+    tone->left = tone->samples;
+    return ESP_OK;
+}
+
+static int tone_read(audio_source_t *src, uint8_t *dst, size_t len)
+{
+    audio_source_tone_t *tone = (audio_source_tone_t *)src;
+    if (len > tone->left) {
+        len = tone->left;
+    }
+
+    uint8_t high = 128 + tone->amplitude;
+    uint8_t low = 128 - tone->amplitude;
+    uint32_t phase = tone->phase;
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = (phase & 0x80000000u) ? low : high;
+        phase += tone->step;
+    }
+    tone->phase = phase;
+    tone->left -= len;
+    return (int)len;
+}
+
+static void tone_close(audio_source_t *src)
+{
+}
+
+void audio_source_tone_init(audio_source_tone_t *tone, uint32_t freq_hz, uint32_t duration_ms,
+                            uint8_t amplitude, uint32_t sample_rate_hz)
+{
+    tone->base.open = tone_open;
+    tone->base.read = tone_read;
+    tone->base.close = tone_close;
+    tone->base.map = NULL;
+    tone->step = (uint32_t)(((uint64_t)freq_hz << 32) / sample_rate_hz);
+    tone->samples = (uint32_t)((uint64_t)sample_rate_hz * duration_ms / 1000);
+    tone->amplitude = amplitude > 127 ? 127 : amplitude;
+    tone->phase = 0;
+    tone->left = 0;
+}
@@ -0,0 +1,83 @@
+#include "audio_store.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include <string.h>
+
+#define TAG "AUDIO_STORE"
+
+#define STORE_MAGIC "ACLP"
+#define STORE_VERSION 2
+
+typedef struct __attribute__((packed)) {
+    char magic[4];
+    uint16_t version;
+    uint16_t count;
+    uint32_t reserved;
+    uint32_t total_size;
+} store_header_t;
+
+typedef struct __attribute__((packed)) {
+    char name[AUDIO_STORE_NAME_LEN];
+    uint32_t offset;
+    uint32_t length;
+} store_entry_t;
+
+static const uint8_t *store_base = NULL;
+static const store_entry_t *store_index = NULL;
+static uint16_t store_count = 0;
+static esp_partition_mmap_handle_t store_map;
+
+esp_err_t audio_store_open(const char *label)
+{
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, AUDIO_STORE_SUBTYPE, label);
+    if (!part) {
+        ESP_LOGW(TAG, "Partição de áudio '%s' não encontrada", label);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    store_header_t hdr;
+    esp_err_t err = esp_partition_read(part, 0, &hdr, sizeof(hdr));
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (memcmp(hdr.magic, STORE_MAGIC, sizeof(hdr.magic)) != 0 || hdr.version != STORE_VERSION ||
+        hdr.total_size > part->size || hdr.total_size < sizeof(hdr) + hdr.count * sizeof(store_entry_t)) {
+        ESP_LOGW(TAG, "Partição de áudio sem imagem válida");
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    // Só o que a imagem ocupa; o resto da partição não gasta páginas do MMU
+    const void *ptr;
+    err = esp_partition_mmap(part, 0, hdr.total_size, ESP_PARTITION_MMAP_DATA, &ptr, &store_map);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Erro ao mapear partição de áudio: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    const store_entry_t *index = (const store_entry_t *)((const uint8_t *)ptr + sizeof(hdr));
+    for (int i = 0; i < hdr.count; i++) {
+        if (index[i].offset > hdr.total_size || index[i].length > hdr.total_size - index[i].offset) {
+            ESP_LOGE(TAG, "Índice da partição de áudio corrompido");
+            esp_partition_munmap(store_map);
+            return ESP_ERR_INVALID_SIZE;
+        }
+    }
+
+    store_base = ptr;
+    store_index = index;
+    store_count = hdr.count;
+    ESP_LOGI(TAG, "%u clipes mapeados da partição '%s'", store_count, label);
+    return ESP_OK;
+}
+
+bool audio_store_find(const char *name, const uint8_t **data, uint32_t *len)
+{
+    for (int i = 0; i < store_count; i++) {
+        if (strncmp(store_index[i].name, name, AUDIO_STORE_NAME_LEN) == 0) {
+            *data = store_base + store_index[i].offset;
+            *len = store_index[i].length;
+            return true;
+        }
+    }
+    return false;
+}
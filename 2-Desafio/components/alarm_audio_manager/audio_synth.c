@@ -0,0 +1,223 @@
+#include "audio_synth.h"
+#include <math.h>
+#include <string.h>
+
+static int8_t sine_table[AUDIO_SYNTH_TABLE_SIZE];
+static int8_t triangle_table[AUDIO_SYNTH_TABLE_SIZE];
+static bool tables_ready = false;
+
+static void build_tables(void)
+{
+    for (int i = 0; i < AUDIO_SYNTH_TABLE_SIZE; i++) {
+        sine_table[i] = (int8_t)lrintf(127.0f * sinf(2.0f * (float)M_PI * i / AUDIO_SYNTH_TABLE_SIZE));
+        // Sobe de -127 a 127 na primeira metade e desce na segunda
+        int t = (i < AUDIO_SYNTH_TABLE_SIZE / 2) ? i : AUDIO_SYNTH_TABLE_SIZE - 1 - i;
+        triangle_table[i] = (int8_t)(t * 254 / (AUDIO_SYNTH_TABLE_SIZE / 2 - 1) - 127);
+    }
+    tables_ready = true;
+}
+
+void audio_synth_render(int32_t *acc, const int8_t *table, uint32_t *phase, uint32_t step,
+                        int32_t amp, size_t n)
+{
+    uint32_t p = *phase;
+    for (size_t i = 0; i < n; i++) {
+        acc[i] += table[p >> 24] * amp;
+        p += step;
+    }
+    *phase = p;
+}
+
+// Passo por bloco de controle para percorrer 'range' em 'ms'
+static int32_t env_rate(const audio_source_synth_t *synth, uint32_t ms, int32_t range)
+{
+    uint32_t blocks = (uint32_t)((uint64_t)synth->sample_rate_hz * ms / 1000 / AUDIO_SYNTH_CONTROL);
+    if (blocks == 0) {
+        return range > 0 ? range : 1;
+    }
+    int32_t rate = range / (int32_t)blocks;
+    return rate > 0 ? rate : 1;
+}
+
+static void start_note(audio_source_synth_t *synth, audio_synth_voice_t *v)
+{
+    const audio_synth_note_t *note = v->note;
+    v->note_left = (uint32_t)((uint64_t)synth->sample_rate_hz * note->duration_ms / 1000);
+
+    if (note->freq <= 0) {
+        if (v->env_state != SYNTH_ENV_IDLE) {
+            v->env_state = SYNTH_ENV_RELEASE;
+        }
+        return;
+    }
+
+    // Redisparo a partir do nível atual, sem zerar a fase: sem estalo entre notas
+    v->step = (uint32_t)(((uint64_t)note->freq << 32) / synth->sample_rate_hz);
+    v->env_state = SYNTH_ENV_ATTACK;
+}
+
+static void advance_envelope(audio_synth_voice_t *v, const audio_synth_instrument_t *ins)
+{
+    switch (v->env_state) {
+        case SYNTH_ENV_ATTACK:
+            v->env += v->attack_rate;
+            if (v->env >= INT16_MAX) {
+                v->env = INT16_MAX;
+                v->env_state = SYNTH_ENV_DECAY;
+            }
+            break;
+        case SYNTH_ENV_DECAY:
+            v->env -= v->decay_rate;
+            if (v->env <= ins->sustain) {
+                v->env = ins->sustain;
+                v->env_state = SYNTH_ENV_SUSTAIN;
+            }
+            break;
+        case SYNTH_ENV_RELEASE:
+            v->env -= v->release_rate;
+            if (v->env <= 0) {
+                v->env = 0;
+                v->env_state = SYNTH_ENV_IDLE;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// Avança a partitura da voz em um bloco de controle; retorna false quando ela acabou e silenciou
+static bool advance_track(audio_source_synth_t *synth, audio_synth_voice_t *v)
+{
+    if (v->note == NULL) {
+        return v->env_state != SYNTH_ENV_IDLE;
+    }
+
+    if (v->note_left <= AUDIO_SYNTH_CONTROL) {
+        v->note++;
+        if (v->note->freq < 0) {
+            v->note = NULL;
+            if (v->env_state != SYNTH_ENV_IDLE) {
+                v->env_state = SYNTH_ENV_RELEASE;
+            }
+            return v->env_state != SYNTH_ENV_IDLE;
+        }
+        start_note(synth, v);
+    } else {
+        v->note_left -= AUDIO_SYNTH_CONTROL;
+    }
+    return true;
+}
+
+static esp_err_t synth_open(audio_source_t *src)
+{
+    audio_source_synth_t *synth = (audio_source_synth_t *)src;
+    synth->block_pos = AUDIO_SYNTH_CONTROL;
+
+    if (!tables_ready) {
+        build_tables();
+    }
+
+    for (int t = 0; t < synth->track_count; t++) {
+        audio_synth_voice_t *v = &synth->voices[t];
+        const audio_synth_track_t *track = &synth->tracks[t];
+        const audio_synth_instrument_t *ins = &track->instrument;
+
+        memset(v, 0, sizeof(*v));
+        v->track = track;
+        v->table = (ins->wave == AUDIO_SYNTH_WAVE_CUSTOM && ins->custom) ? ins->custom :
+                   (ins->wave == AUDIO_SYNTH_WAVE_TRIANGLE) ? triangle_table : sine_table;
+        v->attack_rate = env_rate(synth, ins->attack_ms, INT16_MAX);
+        v->decay_rate = env_rate(synth, ins->decay_ms, INT16_MAX - ins->sustain);
+        v->release_rate = env_rate(synth, ins->release_ms, ins->sustain ? ins->sustain : INT16_MAX);
+        v->env_state = SYNTH_ENV_IDLE;
+
+        if (track->notes && track->notes[0].freq >= 0) {
+            v->note = track->notes;
+            start_note(synth, v);
+        }
+    }
+    return ESP_OK;
+}
+
+// Gera um bloco de controle; retorna false quando todas as trilhas terminaram
+static bool render_block(audio_source_synth_t *synth, uint8_t *out)
+{
+    bool playing = false;
+    memset(synth->acc, 0, sizeof(synth->acc));
+
+    for (int t = 0; t < synth->track_count; t++) {
+        audio_synth_voice_t *v = &synth->voices[t];
+        if (!advance_track(synth, v)) {
+            continue;
+        }
+        playing = true;
+        advance_envelope(v, &v->track->instrument);
+
+        // O envelope fica constante dentro do bloco
+        int32_t amp = (v->env * v->track->instrument.gain) >> 15;
+        if (amp > 0) {
+            audio_synth_render(synth->acc, v->table, &v->phase, v->step, amp, AUDIO_SYNTH_CONTROL);
+        }
+    }
+    if (!playing) {
+        return false;
+    }
+
+    // Tabela em 8 bits com sinal x amplitude Q15: >> 15 já dá a escala do DAC
+    for (int i = 0; i < AUDIO_SYNTH_CONTROL; i++) {
+        int32_t v = (synth->acc[i] >> 15) + 128;
+        v = v < 0 ? 0 : v;
+        v = v > 255 ? 255 : v;
+        out[i] = (uint8_t)v;
+    }
+    return true;
+}
+
+static int synth_read(audio_source_t *src, uint8_t *dst, size_t len)
+{
+    audio_source_synth_t *synth = (audio_source_synth_t *)src;
+    size_t produced = 0;
+
+    while (produced < len) {
+        // Sobra de um bloco que não coube na leitura anterior
+        if (synth->block_pos < AUDIO_SYNTH_CONTROL) {
+            size_t n = AUDIO_SYNTH_CONTROL - synth->block_pos;
+            if (n > len - produced) {
+                n = len - produced;
+            }
+            memcpy(&dst[produced], &synth->block[synth->block_pos], n);
+            synth->block_pos += n;
+            produced += n;
+            continue;
+        }
+
+        if (len - produced >= AUDIO_SYNTH_CONTROL) {
+            if (!render_block(synth, &dst[produced])) {
+                break;
+            }
+            produced += AUDIO_SYNTH_CONTROL;
+        } else {
+            if (!render_block(synth, synth->block)) {
+                break;
+            }
+            synth->block_pos = 0;
+        }
+    }
+    return (int)produced;
+}
+
+static void synth_close(audio_source_t *src)
+{
+}
+
+void audio_source_synth_init(audio_source_synth_t *synth, const audio_synth_track_t *tracks,
+                             uint8_t track_count, uint32_t sample_rate_hz)
+{
+    synth->base.open = synth_open;
+    synth->base.read = synth_read;
+    synth->base.close = synth_close;
+    synth->base.map = NULL;
+    synth->tracks = tracks;
+    synth->track_count = track_count > AUDIO_SYNTH_MAX_TRACKS ? AUDIO_SYNTH_MAX_TRACKS : track_count;
+    synth->sample_rate_hz = sample_rate_hz;
+}
@@ -0,0 +1,318 @@
+#include "audio_wav.h"
+#include "audio_convert.h"
+#include "audio_adpcm.h"
+#include "esp_log.h"
+#include <string.h>
+
+#define TAG "AUDIO_WAV"
+
+#define WAV_FORMAT_PCM 1
+#define WAV_FORMAT_ALAW 6
+#define WAV_FORMAT_ULAW 7
+#define WAV_FORMAT_IMA_ADPCM 0x11
+#define WAV_FORMAT_EXTENSIBLE 0xFFFE
+
+static uint16_t le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Lê exatamente len bytes (a origem pode devolver menos por chamada)
+static bool read_exact(audio_source_t *input, uint8_t *dst, size_t len)
+{
+    while (len > 0) {
+        int n = input->read(input, dst, len);
+        if (n <= 0) {
+            return false;
+        }
+        dst += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+// Pula um chunk sem seek: a origem pode ser só sequencial
+static bool skip_bytes(audio_source_wav_t *wav, uint32_t len)
+{
+    while (len > 0) {
+        size_t n = len < sizeof(wav->raw) ? len : sizeof(wav->raw);
+        if (!read_exact(wav->input, wav->raw, n)) {
+            return false;
+        }
+        len -= n;
+    }
+    return true;
+}
+
+static bool parse_fmt(audio_source_wav_t *wav, uint32_t size)
+{
+    uint8_t b[16];
+    if (size < sizeof(b) || !read_exact(wav->input, b, sizeof(b))) {
+        return false;
+    }
+
+    audio_wav_format_t *fmt = &wav->fmt;
+    fmt->format = le16(&b[0]);
+    fmt->channels = le16(&b[2]);
+    fmt->sample_rate_hz = le32(&b[4]);
+    fmt->block_align = le16(&b[12]);
+    fmt->bits_per_sample = le16(&b[14]);
+
+    // Resto do chunk (cbSize, extensões) mais o byte de preenchimento
+    return skip_bytes(wav, size - sizeof(b) + (size & 1));
+}
+
+static bool format_supported(const audio_wav_format_t *fmt)
+{
+    if (fmt->format == WAV_FORMAT_IMA_ADPCM) {
+        // Um bloco inteiro precisa caber em raw[] e, decodificado, em work[]
+        return fmt->channels == 1 && fmt->bits_per_sample == 4 && fmt->sample_rate_hz > 0 &&
+               fmt->block_align > AUDIO_ADPCM_BLOCK_HEADER && fmt->block_align <= AUDIO_WAV_RAW_BYTES &&
+               audio_adpcm_block_samples(fmt->block_align) < AUDIO_WAV_WORK_SAMPLES;
+    }
+    if (fmt->format == WAV_FORMAT_ALAW || fmt->format == WAV_FORMAT_ULAW) {
+        return fmt->channels >= 1 && fmt->channels <= 2 && fmt->sample_rate_hz > 0 &&
+               fmt->bits_per_sample == 8 && fmt->block_align == fmt->channels;
+    }
+    if (fmt->format != WAV_FORMAT_PCM && fmt->format != WAV_FORMAT_EXTENSIBLE) {
+        return false;
+    }
+    if (fmt->channels < 1 || fmt->channels > 2 || fmt->sample_rate_hz == 0) {
+        return false;
+    }
+    if (fmt->bits_per_sample != 8 && fmt->bits_per_sample != 16) {
+        return false;
+    }
+    return fmt->block_align == fmt->channels * fmt->bits_per_sample / 8;
+}
+
+// Percorre os chunks até o "data"; o que não for "fmt " é ignorado
+static esp_err_t parse_header(audio_source_wav_t *wav)
+{
+    uint8_t hdr[12];
+    if (!read_exact(wav->input, hdr, sizeof(hdr)) ||
+        memcmp(hdr, "RIFF", 4) != 0 || memcmp(&hdr[8], "WAVE", 4) != 0) {
+        ESP_LOGE(TAG, "Arquivo não é RIFF/WAVE");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bool have_fmt = false;
+    while (read_exact(wav->input, hdr, 8)) {
+        uint32_t size = le32(&hdr[4]);
+
+        if (memcmp(hdr, "fmt ", 4) == 0) {
+            if (!parse_fmt(wav, size)) {
+                break;
+            }
+            have_fmt = true;
+        } else if (memcmp(hdr, "data", 4) == 0) {
+            if (!have_fmt || !format_supported(&wav->fmt)) {
+                ESP_LOGE(TAG, "Formato WAV não suportado (fmt=%u canais=%u bits=%u)",
+                         wav->fmt.format, wav->fmt.channels, wav->fmt.bits_per_sample);
+                return ESP_ERR_NOT_SUPPORTED;
+            }
+            wav->data_left = size;
+            return ESP_OK;
+        } else if (!skip_bytes(wav, size + (size & 1))) {
+            break;
+        }
+    }
+
+    ESP_LOGE(TAG, "Chunk \"data\" não encontrado");
+    return ESP_ERR_INVALID_SIZE;
+}
+
+static esp_err_t wav_open(audio_source_t *src)
+{
+    audio_source_wav_t *wav = (audio_source_wav_t *)src;
+
+    esp_err_t err = wav->input->open(wav->input);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    memset(&wav->fmt, 0, sizeof(wav->fmt));
+    wav->raw_len = 0;
+    wav->work_len = 0;
+
+    err = parse_header(wav);
+    if (err != ESP_OK) {
+        wav->input->close(wav->input);
+        return err;
+    }
+
+    wav->passthrough = wav->fmt.format == WAV_FORMAT_PCM && wav->fmt.bits_per_sample == 8 &&
+                       wav->fmt.channels == 1 && wav->fmt.sample_rate_hz == wav->out_rate_hz;
+    audio_resampler_init(&wav->rs, wav->fmt.sample_rate_hz, wav->out_rate_hz);
+    ESP_LOGI(TAG, "WAV %lu Hz, %u bits, %u canal(is), %lu bytes",
+             (unsigned long)wav->fmt.sample_rate_hz, wav->fmt.bits_per_sample,
+             wav->fmt.channels, (unsigned long)wav->data_left);
+    return ESP_OK;
+}
+
+static int read_data(audio_source_wav_t *wav, uint8_t *dst, size_t len)
+{
+    if (len > wav->data_left) {
+        len = wav->data_left;
+    }
+    if (len == 0) {
+        return 0;
+    }
+    int n = wav->input->read(wav->input, dst, len);
+    if (n > 0) {
+        wav->data_left -= (uint32_t)n;
+    }
+    return n;
+}
+
+// Decodifica o próximo bloco ADPCM no fim de work[]
+static bool refill_adpcm(audio_source_wav_t *wav)
+{
+    size_t block = wav->fmt.block_align;
+    if (AUDIO_WAV_WORK_SAMPLES - wav->work_len < audio_adpcm_block_samples(block)) {
+        return true;
+    }
+
+    // O último bloco do arquivo pode vir incompleto
+    while (wav->raw_len < block) {
+        int n = read_data(wav, &wav->raw[wav->raw_len], block - wav->raw_len);
+        if (n <= 0) {
+            break;
+        }
+        wav->raw_len += (size_t)n;
+    }
+    if (wav->raw_len <= AUDIO_ADPCM_BLOCK_HEADER) {
+        wav->raw_len = 0;
+        return false;
+    }
+
+    wav->work_len += audio_adpcm_decode_block(wav->raw, wav->raw_len, &wav->work[wav->work_len]);
+    wav->raw_len = 0;
+    return true;
+}
+
+// Converte quadros crus para int16 mono no fim de work[]; retorna false no fim dos dados
+static bool refill_work(audio_source_wav_t *wav)
+{
+    const audio_wav_format_t *fmt = &wav->fmt;
+    size_t bytes_per_sample = fmt->bits_per_sample / 8;
+
+    if (fmt->format == WAV_FORMAT_IMA_ADPCM) {
+        return refill_adpcm(wav);
+    }
+
+    // Quadros que cabem em work[] (antes do downmix ocupam channels amostras cada)
+    size_t room = (AUDIO_WAV_WORK_SAMPLES - wav->work_len) / fmt->channels;
+    size_t want = room * fmt->block_align;
+    if (want > sizeof(wav->raw)) {
+        want = sizeof(wav->raw) - sizeof(wav->raw) % fmt->block_align;
+    }
+    if (want <= wav->raw_len) {
+        return true;
+    }
+
+    int n = read_data(wav, &wav->raw[wav->raw_len], want - wav->raw_len);
+    if (n < 0) {
+        return false;
+    }
+    wav->raw_len += (size_t)n;
+
+    size_t frames = wav->raw_len / fmt->block_align;
+    if (frames == 0) {
+        return n > 0;
+    }
+
+    int16_t *dst = &wav->work[wav->work_len];
+    size_t samples = frames * fmt->channels;
+    if (fmt->format == WAV_FORMAT_ALAW) {
+        audio_pcm_alaw_to_s16(wav->raw, dst, samples);
+    } else if (fmt->format == WAV_FORMAT_ULAW) {
+        audio_pcm_ulaw_to_s16(wav->raw, dst, samples);
+    } else if (bytes_per_sample == 1) {
+        audio_pcm_u8_to_s16(wav->raw, dst, samples);
+    } else {
+        audio_pcm_s16le_to_s16(wav->raw, dst, samples);
+    }
+    if (fmt->channels == 2) {
+        audio_pcm_stereo_to_mono(dst, dst, frames);
+    }
+    wav->work_len += frames;
+
+    // Sobra de um quadro incompleto fica para a próxima leitura
+    size_t used = frames * fmt->block_align;
+    memmove(wav->raw, &wav->raw[used], wav->raw_len - used);
+    wav->raw_len -= used;
+    return true;
+}
+
+static int wav_read(audio_source_t *src, uint8_t *dst, size_t len)
+{
+    audio_source_wav_t *wav = (audio_source_wav_t *)src;
+
+    if (wav->passthrough) {
+        return read_data(wav, dst, len);
+    }
+
+    size_t produced = 0;
+    while (produced < len) {
+        size_t cap = len - produced;
+        if (cap > AUDIO_WAV_WORK_SAMPLES / 2) {
+            cap = AUDIO_WAV_WORK_SAMPLES / 2;
+        }
+        size_t n = audio_resample_linear(&wav->rs, wav->work, wav->work_len, wav->out16, cap);
+        if (n > 0) {
+            audio_pcm_s16_to_u8(wav->out16, &dst[produced], n);
+            produced += n;
+            continue;
+        }
+
+        // Entrada esgotada: mantém só o necessário para interpolar e busca mais
+        size_t drop = audio_resampler_advance(&wav->rs, wav->work_len);
+        memmove(wav->work, &wav->work[drop], (wav->work_len - drop) * sizeof(int16_t));
+        wav->work_len -= drop;
+
+        size_t before = wav->work_len;
+        if (!refill_work(wav) || (wav->work_len == before && wav->data_left == 0)) {
+            break;
+        }
+    }
+    return (int)produced;
+}
+
+// Só o PCM já no formato do DAC pode ser mixado direto da origem, sem read()
+static const uint8_t *wav_map(audio_source_t *src, uint32_t *len)
+{
+    audio_source_wav_t *wav = (audio_source_wav_t *)src;
+    if (!wav->passthrough || !wav->input->map) {
+        return NULL;
+    }
+    uint32_t avail;
+    const uint8_t *data = wav->input->map(wav->input, &avail);
+    if (!data) {
+        return NULL;
+    }
+    *len = avail < wav->data_left ? avail : wav->data_left;
+    return data;
+}
+
+static void wav_close(audio_source_t *src)
+{
+    audio_source_wav_t *wav = (audio_source_wav_t *)src;
+    wav->input->close(wav->input);
+}
+
+void audio_source_wav_init(audio_source_wav_t *wav, audio_source_t *input, uint32_t out_rate_hz)
+{
+    wav->base.open = wav_open;
+    wav->base.read = wav_read;
+    wav->base.close = wav_close;
+    wav->base.map = wav_map;
+    wav->input = input;
+    wav->out_rate_hz = out_rate_hz;
+    wav->data_left = 0;
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "esp_err.h"
+#include "audio_pipeline.h"
+#include "audio_synth.h"
 #include <stdbool.h>
 
 typedef enum {
@@ -10,7 +12,38 @@ typedef enum {
     ALARM_AUDIO_TYPE_SPECIAL
 } alarm_audio_type_t;
 
+// Prioridades na mixagem: uma voz nova só toma o lugar de outra de prioridade menor
+#define ALARM_AUDIO_PRIORITY_UI 0
+#define ALARM_AUDIO_PRIORITY_ALARM 1
+#define ALARM_AUDIO_PRIORITY_EMERGENCY 2
+
+// Partição crua com os clipes (tools/pack_audio.py)
+#define ALARM_AUDIO_PARTITION "audio"
+
 void alarm_audio_manager_init(void);
+
+/**
+ * @brief Toca o clipe junto com o que já estiver tocando.
+ *
+ * Sem voz livre, substitui a de menor prioridade; a emergência abafa as demais.
+ */
 esp_err_t alarm_audio_manager_play(alarm_audio_type_t type);
+
+/**
+ * @brief Mixa um tom quadrado sintetizado (ex.: bipes da interface).
+ */
+esp_err_t alarm_audio_manager_play_tone(uint32_t freq_hz, uint32_t duration_ms, uint8_t priority);
+
+/**
+ * @brief Sintetiza uma partitura (trilhas simultâneas com onda e ADSR próprios) no DAC.
+ *
+ * @param tracks Precisa existir até o fim da reprodução (tipicamente const).
+ */
+esp_err_t alarm_audio_manager_play_synth(const audio_synth_track_t *tracks, uint8_t track_count, uint8_t priority);
 void alarm_audio_manager_stop(void);
 bool alarm_audio_manager_is_playing(void);
+
+/**
+ * @brief Contadores do pipeline: underruns, latência de início, ocupação da fila.
+ */
+void alarm_audio_manager_get_stats(audio_pipeline_stats_t *out);
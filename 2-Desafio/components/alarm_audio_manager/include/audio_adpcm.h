@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Decodificador IMA-ADPCM (4 bits por amostra) no layout de blocos do WAV
+// (formatTag 0x11, mono): cabeçalho de 4 bytes com a primeira amostra e o
+// índice de passo, seguido de nibbles, o menos significativo primeiro.
+
+#define AUDIO_ADPCM_BLOCK_HEADER 4
+
+/**
+ * @brief Amostras contidas num bloco de block_len bytes.
+ */
+static inline size_t audio_adpcm_block_samples(size_t block_len)
+{
+    return block_len < AUDIO_ADPCM_BLOCK_HEADER ? 0 : 1 + (block_len - AUDIO_ADPCM_BLOCK_HEADER) * 2;
+}
+
+/**
+ * @brief Decodifica um bloco mono inteiro.
+ *
+ * @param out Precisa comportar audio_adpcm_block_samples(block_len) amostras.
+ * @return Amostras escritas.
+ */
+size_t audio_adpcm_decode_block(const uint8_t *block, size_t block_len, int16_t *out);
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Conversões de formato PCM. O formato intermediário é int16 com sinal;
+// o DAC recebe 8 bits sem sinal. Laços sem desvios para o compilador vetorizar.
+
+void audio_pcm_u8_to_s16(const uint8_t *in, int16_t *out, size_t n);
+
+// Amostras de 16 bits little-endian como vêm do arquivo, independente do alinhamento
+void audio_pcm_s16le_to_s16(const uint8_t *in, int16_t *out, size_t n);
+
+// G.711 (formatTag 6 e 7), expandidos para a escala de 16 bits
+void audio_pcm_alaw_to_s16(const uint8_t *in, int16_t *out, size_t n);
+void audio_pcm_ulaw_to_s16(const uint8_t *in, int16_t *out, size_t n);
+
+/**
+ * @brief Média dos dois canais. Pode operar no mesmo buffer (out == in).
+ */
+void audio_pcm_stereo_to_mono(const int16_t *in, int16_t *out, size_t frames);
+
+void audio_pcm_s16_to_u8(const int16_t *in, uint8_t *out, size_t n);
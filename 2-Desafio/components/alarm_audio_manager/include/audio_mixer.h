@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Núcleo da mixagem em ponto fixo. Cada voz soma (amostra - 128) * ganho Q15 num
+// acumulador de 32 bits; a saída satura de volta para 8 bits sem sinal.
+// Laços de contagem fixa e sem desvios, para o compilador vetorizar.
+
+#define AUDIO_MIX_CHUNK 256 // Amostras mixadas por passada
+
+void audio_mix_accumulate(int32_t *acc, const uint8_t *in, int32_t gain_q15, size_t n);
+void audio_mix_output(const int32_t *acc, uint8_t *out, size_t n);
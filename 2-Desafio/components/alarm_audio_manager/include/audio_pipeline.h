@@ -0,0 +1,156 @@
+#pragma once
+
+#include "audio_ring.h"
+#include "audio_source.h"
+#include "audio_mixer.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Pipeline de reprodução com mixagem:
+//  - uma task de leitura busca cada origem antecipadamente e enche a fila da voz;
+//  - o sink (DMA do DAC, ou um timer no sink nulo) mixa as vozes ativas no próprio
+//    callback de conclusão, sem passar por nenhuma task.
+// Uma pausa da origem (ex.: SPIFFS) só vira falha audível se durar mais que a fila.
+// Uma voz nova entra no próximo bloco do DMA, sem esperar o que já foi buscado.
+
+#define AUDIO_PIPELINE_MAX_VOICES 4
+#define AUDIO_GAIN_UNITY 32768  // Ganho Q15
+#define AUDIO_VOICE_NONE (-1)
+
+typedef struct audio_pipeline audio_pipeline_t;
+typedef struct audio_sink audio_sink_t;
+
+// Identifica uma reprodução; deixa de ser ativo quando ela termina ou é preemptada
+typedef int32_t audio_voice_t;
+
+struct audio_sink {
+    esp_err_t (*start)(audio_sink_t *sink, audio_pipeline_t *pipe);
+    void (*stop)(audio_sink_t *sink);
+    uint32_t flush_blocks;  // Blocos a completar após o fim dos dados para o final do clipe sair
+};
+
+typedef struct {
+    uint32_t sample_rate_hz;
+    uint32_t prefetch_ms;   // Capacidade da fila de cada voz (arredondada para potência de 2)
+    uint32_t start_ms;      // Quanto acumular antes de a voz entrar na mixagem
+    uint32_t read_chunk;    // Maior leitura individual na origem
+    uint16_t duck_gain;     // Ganho Q15 aplicado às vozes abafadas
+    UBaseType_t task_priority;
+} audio_pipeline_config_t;
+
+#define AUDIO_PIPELINE_CONFIG_DEFAULT() {   \
+    .sample_rate_hz = 11025,                \
+    .prefetch_ms = 300,                     \
+    .start_ms = 100,                        \
+    .read_chunk = 1024,                     \
+    .duck_gain = AUDIO_GAIN_UNITY / 4,      \
+    .task_priority = 6,                     \
+}
+
+typedef struct {
+    uint8_t priority;       // Maior vence na preempção
+    uint16_t gain;          // Q15, AUDIO_GAIN_UNITY = 1.0
+    bool duck;              // Abafa as vozes de prioridade menor enquanto toca
+} audio_voice_params_t;
+
+typedef struct {
+    uint32_t clips;                 // Reproduções iniciadas
+    uint32_t preempted;             // Vozes interrompidas por outra de prioridade maior
+    uint32_t rejected;              // Pedidos recusados sem voz livre
+    uint32_t underruns;             // Trechos mixados com silêncio por falta de dados
+    uint32_t underrun_bytes;
+    uint32_t start_latency_us;      // Pedido de play -> primeira amostra mixada
+    uint32_t max_start_latency_us;
+    uint32_t start_latency_stream_us;   // Último início vindo da fila (WAV decodificado, tom)
+    uint32_t start_latency_mapped_us;   // Último início lido direto da memória (WAV já no formato do DAC)
+    uint32_t max_read_us;           // Leitura mais lenta na origem
+    uint32_t min_buffered_bytes;    // Menor ocupação de uma fila com a voz tocando
+    uint32_t ring_bytes;            // Capacidade da fila de cada voz
+    uint32_t active_voices;
+    uint32_t max_mix_us;            // Mixagem mais lenta de um trecho
+    uint64_t mix_us;                // Tempo total de mixagem...
+    uint64_t mix_voice_samples;     // ...e amostras x vozes mixadas nesse tempo
+} audio_pipeline_stats_t;
+
+typedef enum {
+    AUDIO_PIPE_IDLE,
+    AUDIO_PIPE_PREFILL,     // Enchendo a fila, fora da mixagem
+    AUDIO_PIPE_RUNNING,
+    AUDIO_PIPE_DRAINING     // Origem terminou, esvaziando a fila
+} audio_pipe_state_t;
+
+typedef struct {
+    audio_ring_t ring;
+    audio_source_t *source;
+    audio_voice_params_t params;
+    audio_voice_t id;
+    audio_source_t *pending;        // Próxima origem para este slot
+    audio_voice_params_t pending_params;
+    audio_voice_t pending_id;
+    int64_t request_us;
+    volatile audio_pipe_state_t state;
+    volatile bool stop_requested;
+    volatile bool drained;          // Todo o conteúdo já foi entregue ao sink
+    volatile bool rendering;        // O sink está mixando esta voz fora do lock
+    bool first_sample;
+    const uint8_t *direct;          // Amostras mapeadas (origem com map()); a fila fica sem uso
+    uint32_t direct_len;
+    uint32_t direct_pos;
+} audio_pipe_voice_t;
+
+struct audio_pipeline {
+    audio_pipeline_config_t config;
+    audio_pipe_voice_t voices[AUDIO_PIPELINE_MAX_VOICES];
+    audio_sink_t *sink;
+    bool sink_running;
+    uint32_t idle_blocks;           // Blocos seguidos sem nenhuma voz
+    uint32_t next_id;
+    TaskHandle_t task;
+    portMUX_TYPE mux;
+    audio_pipeline_stats_t stats;
+};
+
+/**
+ * @brief Aloca as filas das vozes e cria a task de leitura.
+ *
+ * @param sink Destino das amostras; precisa existir enquanto o pipeline existir.
+ */
+esp_err_t audio_pipeline_init(audio_pipeline_t *pipe, const audio_pipeline_config_t *config,
+                              audio_sink_t *sink);
+
+/**
+ * @brief Toca uma origem numa voz livre, ou no lugar da voz de menor prioridade.
+ *
+ * A origem pertence ao pipeline até audio_pipeline_voice_active() ficar falso.
+ *
+ * @return Identificador da voz, ou AUDIO_VOICE_NONE se todas as vozes têm
+ *         prioridade igual ou maior.
+ */
+audio_voice_t audio_pipeline_play(audio_pipeline_t *pipe, audio_source_t *source,
+                                  const audio_voice_params_t *params);
+void audio_pipeline_stop_voice(audio_pipeline_t *pipe, audio_voice_t voice);
+void audio_pipeline_stop(audio_pipeline_t *pipe);
+bool audio_pipeline_voice_active(audio_pipeline_t *pipe, audio_voice_t voice);
+bool audio_pipeline_is_playing(audio_pipeline_t *pipe);
+void audio_pipeline_get_stats(audio_pipeline_t *pipe, audio_pipeline_stats_t *out);
+
+// Lado do sink: chamadas no callback de conclusão (ISR ou task do esp_timer)
+
+/**
+ * @brief Mixa as vozes ativas em n amostras de 8 bits sem sinal.
+ *
+ * Falta de dados vira silêncio; n não pode passar de AUDIO_MIX_CHUNK.
+ *
+ * @param from_isr true no callback do DMA, false numa task (ex.: esp_timer).
+ */
+void audio_pipeline_render(audio_pipeline_t *pipe, uint8_t *out, uint32_t n, bool from_isr);
+
+/**
+ * @brief Fecha um bloco do sink e acorda a leitura.
+ *
+ * @return true se uma task de maior prioridade foi acordada (só em ISR).
+ */
+bool audio_pipeline_sink_done(audio_pipeline_t *pipe, bool from_isr);
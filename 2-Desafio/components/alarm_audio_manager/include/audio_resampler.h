@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Reamostragem linear em ponto fixo (posição Q16.16) de qualquer taxa para a do DAC.
+// O chamador mantém as amostras de entrada num buffer contínuo; o estado entre
+// blocos é só a fração da posição.
+
+typedef struct {
+    uint32_t step;  // Avanço na entrada por amostra de saída, Q16.16
+    uint32_t pos;   // Posição atual relativa a in[0], Q16.16
+} audio_resampler_t;
+
+void audio_resampler_init(audio_resampler_t *rs, uint32_t in_rate_hz, uint32_t out_rate_hz);
+
+/**
+ * @brief Gera amostras de saída enquanto houver duas amostras de entrada em volta da posição.
+ *
+ * @return Amostras escritas em out (no máximo out_cap).
+ */
+size_t audio_resample_linear(audio_resampler_t *rs, const int16_t *in, size_t in_len,
+                             int16_t *out, size_t out_cap);
+
+/**
+ * @brief Descarta as amostras de entrada já ultrapassadas pela posição.
+ *
+ * @return Quantas amostras do início de in[] (até in_len) não são mais necessárias.
+ */
+size_t audio_resampler_advance(audio_resampler_t *rs, size_t in_len);
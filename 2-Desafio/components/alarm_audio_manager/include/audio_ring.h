@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Fila de bytes SPSC sem lock. O produtor (task de leitura) e o consumidor
+// (callback do DMA, em ISR) acessam regiões contíguas direto no buffer,
+// sem cópia intermediária.
+
+typedef struct {
+    uint8_t *buf;
+    uint32_t size;      // Potência de 2
+    uint32_t head;      // Escrito só pelo produtor
+    uint32_t tail;      // Escrito só pelo consumidor
+} audio_ring_t;
+
+/**
+ * @brief Inicializa a fila sobre um buffer já alocado.
+ *
+ * @param size Tamanho do buffer; precisa ser potência de 2.
+ */
+bool audio_ring_init(audio_ring_t *ring, uint8_t *buf, uint32_t size);
+
+/**
+ * @brief Descarta o conteúdo. Só pode ser chamada com produtor e consumidor parados.
+ */
+void audio_ring_reset(audio_ring_t *ring);
+
+uint32_t audio_ring_used(const audio_ring_t *ring);
+uint32_t audio_ring_free(const audio_ring_t *ring);
+
+/**
+ * @brief Região contígua livre para o produtor escrever.
+ *
+ * @return Bytes disponíveis a partir de *ptr (pode ser menor que o espaço livre
+ *         total quando a região dá a volta no fim do buffer).
+ */
+uint32_t audio_ring_write_region(audio_ring_t *ring, uint8_t **ptr);
+void audio_ring_commit(audio_ring_t *ring, uint32_t len);
+
+/**
+ * @brief Região contígua com dados para o consumidor ler.
+ */
+uint32_t audio_ring_read_region(audio_ring_t *ring, const uint8_t **ptr);
+void audio_ring_consume(audio_ring_t *ring, uint32_t len);
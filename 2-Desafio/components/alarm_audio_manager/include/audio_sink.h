@@ -0,0 +1,29 @@
+#pragma once
+
+#include "audio_pipeline.h"
+#include "driver/dac_continuous.h"
+#include "esp_timer.h"
+
+// DAC em modo contínuo: o callback do DMA (on_convert_done) mixa as vozes
+typedef struct {
+    audio_sink_t base;
+    dac_continuous_handle_t handle;
+    audio_pipeline_t *pipe;
+} audio_sink_dac_t;
+
+/**
+ * @brief Cria os canais DAC em modo contínuo e registra o callback de DMA.
+ */
+esp_err_t audio_sink_dac_init(audio_sink_dac_t *dac, uint32_t sample_rate_hz);
+
+// Descarta as amostras no ritmo real, para testar o pipeline sem hardware de áudio
+typedef struct {
+    audio_sink_t base;
+    esp_timer_handle_t timer;
+    audio_pipeline_t *pipe;
+    uint32_t block_samples;
+    uint32_t period_us;
+    uint8_t buf[AUDIO_MIX_CHUNK];
+} audio_sink_null_t;
+
+esp_err_t audio_sink_null_init(audio_sink_null_t *ns, uint32_t sample_rate_hz, uint32_t period_ms);
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "esp_err.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Origem de amostras do pipeline (8 bits sem sinal, mono, na taxa do DAC).
+typedef struct audio_source audio_source_t;
+
+struct audio_source {
+    esp_err_t (*open)(audio_source_t *src);
+    /**
+     * @return Bytes lidos, 0 no fim do clipe ou negativo em caso de erro.
+     */
+    int (*read)(audio_source_t *src, uint8_t *dst, size_t len);
+    void (*close)(audio_source_t *src);
+    /**
+     * @brief Opcional: amostras já na memória (ex.: flash mapeado), no formato do DAC.
+     *
+     * Chamado depois de open(); devolve o que falta a partir da posição atual. Se
+     * devolver um endereço, o pipeline mixa direto dele, sem fila e sem read();
+     * NULL faz a voz seguir pela fila.
+     */
+    const uint8_t *(*map)(audio_source_t *src, uint32_t *len);
+};
+
+// Arquivo PCM cru a partir de um deslocamento fixo (ex.: depois do cabeçalho WAV)
+typedef struct {
+    audio_source_t base;
+    const char *path;
+    long offset;
+    FILE *f;
+} audio_source_file_t;
+
+void audio_source_file_init(audio_source_file_t *fs, const char *path, long offset);
+
+// Clipe residente na memória; com map() o pipeline lê sem copiar
+typedef struct {
+    audio_source_t base;
+    const uint8_t *data;
+    uint32_t len;
+    uint32_t pos;
+} audio_source_mem_t;
+
+void audio_source_mem_init(audio_source_mem_t *mem, const uint8_t *data, uint32_t len);
+
+// Tom quadrado sintetizado, sem arquivo
+typedef struct {
+    audio_source_t base;
+    uint32_t phase;         // Acumulador de fase de 32 bits
+    uint32_t step;
+    uint32_t samples;       // Duração total
+    uint32_t left;
+    uint8_t amplitude;
+} audio_source_tone_t;
+
+/**
+ * @param amplitude Desvio em torno do meio da escala (0-127).
+ */
+void audio_source_tone_init(audio_source_tone_t *tone, uint32_t freq_hz, uint32_t duration_ms,
+                            uint8_t amplitude, uint32_t sample_rate_hz);
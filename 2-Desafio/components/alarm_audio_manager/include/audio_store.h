@@ -0,0 +1,24 @@
+#pragma once
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Clipes numa partição crua mapeada em memória (imagem gerada por tools/pack_audio.py).
+// Cada clipe é um arquivo WAV lido direto do cache do flash, sem VFS: IMA-ADPCM, ou
+// PCM de 8 bits mono na taxa do DAC, que o pipeline mixa sem cópia.
+
+#define AUDIO_STORE_SUBTYPE 0x40
+#define AUDIO_STORE_NAME_LEN 16
+
+/**
+ * @brief Mapeia a partição e valida o índice.
+ */
+esp_err_t audio_store_open(const char *label);
+
+/**
+ * @brief Procura um clipe pelo nome (nome do arquivo sem extensão).
+ *
+ * @return true se encontrado; *data aponta para o arquivo WAV no flash mapeado.
+ */
+bool audio_store_find(const char *name, const uint8_t **data, uint32_t *len);
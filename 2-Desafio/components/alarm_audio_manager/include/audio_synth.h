@@ -0,0 +1,84 @@
+#pragma once
+
+#include "audio_source.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Sintetizador DDS: cada voz tem um acumulador de fase de 32 bits que percorre
+// uma tabela de onda de 256 amostras, com envelope ADSR em ponto fixo.
+// Toca uma partitura de trilhas monofônicas simultâneas (uma voz por trilha).
+
+#define AUDIO_SYNTH_MAX_TRACKS 4
+#define AUDIO_SYNTH_TABLE_SIZE 256
+#define AUDIO_SYNTH_CONTROL 32 // Amostras entre atualizações do envelope
+
+typedef enum {
+    AUDIO_SYNTH_WAVE_SINE,
+    AUDIO_SYNTH_WAVE_TRIANGLE,
+    AUDIO_SYNTH_WAVE_CUSTOM
+} audio_synth_wave_t;
+
+typedef struct {
+    int16_t freq;           // Hz; 0 = pausa, -1 = fim da trilha
+    uint16_t duration_ms;
+} audio_synth_note_t;
+
+typedef struct {
+    audio_synth_wave_t wave;
+    const int8_t *custom;   // AUDIO_SYNTH_TABLE_SIZE amostras, se wave == CUSTOM
+    uint16_t attack_ms;
+    uint16_t decay_ms;
+    uint16_t sustain;       // Nível Q15
+    uint16_t release_ms;
+    uint16_t gain;          // Q15; a soma das trilhas satura em 8 bits
+} audio_synth_instrument_t;
+
+typedef struct {
+    const audio_synth_note_t *notes;
+    audio_synth_instrument_t instrument;
+} audio_synth_track_t;
+
+typedef enum {
+    SYNTH_ENV_IDLE,
+    SYNTH_ENV_ATTACK,
+    SYNTH_ENV_DECAY,
+    SYNTH_ENV_SUSTAIN,
+    SYNTH_ENV_RELEASE
+} audio_synth_env_state_t;
+
+typedef struct {
+    const audio_synth_track_t *track;
+    const audio_synth_note_t *note;     // Nota atual
+    const int8_t *table;
+    uint32_t phase;
+    uint32_t step;
+    uint32_t note_left;                 // Amostras até a próxima nota
+    audio_synth_env_state_t env_state;
+    int32_t env;                        // Q15
+    int32_t attack_rate;                // Por bloco de controle
+    int32_t decay_rate;
+    int32_t release_rate;
+} audio_synth_voice_t;
+
+typedef struct {
+    audio_source_t base;
+    const audio_synth_track_t *tracks;
+    uint8_t track_count;
+    uint32_t sample_rate_hz;
+    audio_synth_voice_t voices[AUDIO_SYNTH_MAX_TRACKS];
+    int32_t acc[AUDIO_SYNTH_CONTROL];
+    uint8_t block[AUDIO_SYNTH_CONTROL];     // Bloco gerado e ainda não entregue
+    uint8_t block_pos;
+} audio_source_synth_t;
+
+/**
+ * @param tracks Partitura; precisa existir enquanto o som tocar.
+ */
+void audio_source_synth_init(audio_source_synth_t *synth, const audio_synth_track_t *tracks,
+                             uint8_t track_count, uint32_t sample_rate_hz);
+
+/**
+ * @brief Núcleo DDS: soma n amostras de uma voz com amplitude constante (Q15) em acc.
+ */
+void audio_synth_render(int32_t *acc, const int8_t *table, uint32_t *phase, uint32_t step,
+                        int32_t amp, size_t n);
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "audio_source.h"
+#include "audio_resampler.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define AUDIO_WAV_RAW_BYTES 512
+#define AUDIO_WAV_WORK_SAMPLES 512
+
+typedef struct {
+    uint16_t format;        // 1 = PCM, 6/7 = A-law/µ-law, 0x11 = IMA-ADPCM
+    uint16_t channels;
+    uint32_t sample_rate_hz;
+    uint16_t bits_per_sample;
+    uint16_t block_align;   // Bytes por quadro (todas as amostras de um instante)
+} audio_wav_format_t;
+
+// Origem que lê um WAV de outra origem de bytes, percorrendo os chunks RIFF
+// e convertendo PCM de 8/16 bits e G.711 (mono/estéreo) ou IMA-ADPCM mono para o
+// formato do DAC. Se o WAV já estiver no formato do DAC e a entrada tiver map(),
+// o chunk "data" é exposto por map() e o pipeline o lê sem passar pela fila.
+typedef struct {
+    audio_source_t base;
+    audio_source_t *input;
+    uint32_t out_rate_hz;
+    audio_wav_format_t fmt;
+    uint32_t data_left;     // Bytes restantes no chunk "data"
+    bool passthrough;       // Já está em 8 bits mono na taxa do DAC
+    audio_resampler_t rs;
+    uint8_t raw[AUDIO_WAV_RAW_BYTES];
+    size_t raw_len;
+    int16_t work[AUDIO_WAV_WORK_SAMPLES];
+    size_t work_len;
+    int16_t out16[AUDIO_WAV_WORK_SAMPLES / 2];
+} audio_source_wav_t;
+
+/**
+ * @param input Origem com o arquivo WAV completo (cabeçalho incluso).
+ * @param out_rate_hz Taxa do DAC.
+ */
+void audio_source_wav_init(audio_source_wav_t *wav, audio_source_t *input, uint32_t out_rate_hz);
@@ -0,0 +1,372 @@
+#include "alarm_actions.h"
+#include "buzzer_manager.h"
+#include "alarm_audio_manager.h"
+#include "led_rgb.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_http_client.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "sdkconfig.h"
+#include <sys/time.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TAG "ALARM_ACTIONS"
+
+#define ACTION_QUEUE_LEN 16
+#define NOTIFY_QUEUE_LEN 4
+#define ALARM_ACTIONS_MAX_ATTEMPTS 3
+#define RETRY_BASE_US (100 * 1000) // Dobra a cada tentativa
+#define RETRY_SLOTS 8
+#define BATCH_SLOTS 4
+#define RECENT_SLOTS 8
+#define BUZZER_ALARM_DURATION_MS (3000)
+#define NOTIFY_TIMEOUT_MS 3000
+
+typedef struct {
+    alarm_action_t action;
+    uint32_t batch;
+    uint8_t batch_size;
+    uint8_t attempts;
+    int64_t fire_us;        // Relógio de parede
+    int64_t retry_at_us;    // esp_timer
+} action_job_t;
+
+// Ações de um mesmo alarme; a latência é medida quando a última começa
+typedef struct {
+    uint32_t id;
+    uint8_t remaining;
+    bool melody_started;
+} batch_t;
+
+typedef struct {
+    alarm_action_type_t type;
+    uint16_t param;
+    int64_t fire_us;
+} recent_t;
+
+typedef struct {
+    uint16_t alarm_id;
+    int64_t fire_us;
+} notify_job_t;
+
+static const led_rgb_step_t pattern_flash[] = {
+    { 0, 255, 0, 1000 }, { 0, 0, 0, 0 }
+};
+
+static const led_rgb_step_t pattern_blink[] = {
+    { 255, 0, 0, 250 }, { 0, 0, 0, 250 }, { 0, 0, 0, 0 }
+};
+
+static QueueHandle_t action_queue = NULL;
+static QueueHandle_t notify_queue = NULL;
+static uint32_t next_batch = 1;
+static alarm_action_stats_t stats;            // Escrito pelo chamador do submit, pelo executor e pela notify_task
+static portMUX_TYPE stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Estado do executor, acessado só pela alarm_actions_task
+static action_job_t retries[RETRY_SLOTS];
+static int retry_count = 0;
+static batch_t batches[BATCH_SLOTS];
+static recent_t recent[RECENT_SLOTS];
+static int recent_pos = 0;
+
+static int64_t wall_time_us(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static batch_t *find_batch(const action_job_t *job)
+{
+    batch_t *free_slot = NULL;
+    for (int i = 0; i < BATCH_SLOTS; i++) {
+        if (batches[i].id == job->batch) {
+            return &batches[i];
+        }
+        if (batches[i].remaining == 0 && !free_slot) {
+            free_slot = &batches[i];
+        }
+    }
+    // Primeira ação do alarme; sem vaga, o lote mais antigo perde a medida
+    batch_t *batch = free_slot ? free_slot : &batches[job->batch % BATCH_SLOTS];
+    batch->id = job->batch;
+    batch->remaining = job->batch_size;
+    batch->melody_started = false;
+    return batch;
+}
+
+// A ação saiu do executor (começou, desistiu ou foi aglutinada)
+static void finish_job(const action_job_t *job)
+{
+    batch_t *batch = find_batch(job);
+    if (batch->remaining > 0 && --batch->remaining == 0) {
+        int64_t latency = wall_time_us() - job->fire_us;
+        uint32_t latency_us = latency > 0 ? (uint32_t)latency : 0;
+        portENTER_CRITICAL(&stats_mux);
+        stats.last_start_latency_us = latency_us;
+        if (latency_us > stats.max_start_latency_us) {
+            stats.max_start_latency_us = latency_us;
+        }
+        portEXIT_CRITICAL(&stats_mux);
+        batch->id = 0;
+    }
+}
+
+// Mesma ação para o mesmo instante de disparo (ex.: dois alarmes com a mesma melodia)
+static bool already_started(const action_job_t *job)
+{
+    for (int i = 0; i < RECENT_SLOTS; i++) {
+        if (recent[i].fire_us == job->fire_us && recent[i].type == job->action.type &&
+            recent[i].param == job->action.param) {
+            return true;
+        }
+    }
+    for (int i = 0; i < retry_count; i++) {
+        if (retries[i].fire_us == job->fire_us && retries[i].action.type == job->action.type &&
+            retries[i].action.param == job->action.param && retries[i].batch != job->batch) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void remember_started(const action_job_t *job)
+{
+    recent[recent_pos].type = job->action.type;
+    recent[recent_pos].param = job->action.param;
+    recent[recent_pos].fire_us = job->fire_us;
+    recent_pos = (recent_pos + 1) % RECENT_SLOTS;
+}
+
+static const led_rgb_step_t *led_pattern(uint16_t pattern)
+{
+    switch (pattern) {
+        case ALARM_LED_PATTERN_BLINK: return pattern_blink;
+        case ALARM_LED_PATTERN_FLASH:
+        default: return pattern_flash;
+    }
+}
+
+// Só inicia a ação; nenhuma delas bloqueia o executor
+static esp_err_t start_action(const action_job_t *job)
+{
+    uint16_t param = job->action.param;
+    switch (job->action.type) {
+        case ALARM_ACTION_MELODY: {
+            // A primeira melodia interrompe bipes da interface; as seguintes tocam em seguida
+            batch_t *batch = find_batch(job);
+            esp_err_t err = batch->melody_started
+                ? buzzer_manager_enqueue((buzzer_melody_t)param, BUZZER_ALARM_DURATION_MS, BUZZER_PRIORITY_ALARM)
+                : buzzer_manager_play_priority((buzzer_melody_t)param, BUZZER_ALARM_DURATION_MS,
+                                               BUZZER_PRIORITY_ALARM);
+            if (err == ESP_OK) {
+                batch->melody_started = true;
+            }
+            return err;
+        }
+        case ALARM_ACTION_AUDIO:
+            return alarm_audio_manager_play((alarm_audio_type_t)param);
+        case ALARM_ACTION_LED:
+            led_rgb_play_pattern(led_pattern(param), 1);
+            return ESP_OK;
+        case ALARM_ACTION_NOTIFY: {
+            notify_job_t notify = { .alarm_id = param, .fire_us = job->fire_us };
+            return xQueueSend(notify_queue, &notify, 0) == pdTRUE ? ESP_OK : ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+static void run_job(action_job_t *job)
+{
+    if (job->attempts == 0 && already_started(job)) {
+        portENTER_CRITICAL(&stats_mux);
+        stats.coalesced++;
+        portEXIT_CRITICAL(&stats_mux);
+        finish_job(job);
+        return;
+    }
+
+    job->attempts++;
+    if (start_action(job) == ESP_OK) {
+        portENTER_CRITICAL(&stats_mux);
+        stats.started++;
+        portEXIT_CRITICAL(&stats_mux);
+        remember_started(job);
+        finish_job(job);
+        return;
+    }
+
+    if (job->attempts >= ALARM_ACTIONS_MAX_ATTEMPTS || retry_count >= RETRY_SLOTS) {
+        ESP_LOGW(TAG, "Ação %d (%u) falhou após %u tentativas", job->action.type, job->action.param,
+                 job->attempts);
+        portENTER_CRITICAL(&stats_mux);
+        stats.failed++;
+        portEXIT_CRITICAL(&stats_mux);
+        finish_job(job);
+        return;
+    }
+
+    portENTER_CRITICAL(&stats_mux);
+    stats.retried++;
+    portEXIT_CRITICAL(&stats_mux);
+    job->retry_at_us = esp_timer_get_time() + ((int64_t)RETRY_BASE_US << (job->attempts - 1));
+    retries[retry_count++] = *job;
+}
+
+static void run_due_retries(void)
+{
+    int64_t now = esp_timer_get_time();
+    for (int i = 0; i < retry_count;) {
+        if (retries[i].retry_at_us > now) {
+            i++;
+            continue;
+        }
+        action_job_t job = retries[i];
+        retries[i] = retries[--retry_count];
+        run_job(&job);
+    }
+}
+
+static TickType_t next_retry_wait(void)
+{
+    if (retry_count == 0) {
+        return portMAX_DELAY;
+    }
+    int64_t earliest = retries[0].retry_at_us;
+    for (int i = 1; i < retry_count; i++) {
+        if (retries[i].retry_at_us < earliest) {
+            earliest = retries[i].retry_at_us;
+        }
+    }
+    int64_t wait_us = earliest - esp_timer_get_time();
+    return wait_us > 0 ? pdMS_TO_TICKS((wait_us + 999) / 1000) + 1 : 0;
+}
+
+static void alarm_actions_task(void *param)
+{
+    action_job_t job;
+    while (1) {
+        if (xQueueReceive(action_queue, &job, next_retry_wait()) == pdTRUE) {
+            run_job(&job);
+        }
+        run_due_retries();
+    }
+}
+
+// O POST pode levar segundos; fica numa task própria para não atrasar as outras ações
+static void notify_task(void *param)
+{
+    notify_job_t job;
+    char body[64];
+    while (1) {
+        if (xQueueReceive(notify_queue, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        int len = snprintf(body, sizeof(body), "{\"alarm\":%u,\"fire_at\":%lld}", job.alarm_id,
+                           (long long)(job.fire_us / 1000000));
+
+        esp_http_client_config_t config = {
+            .url = CONFIG_ALARM_WEBHOOK_URL,
+            .method = HTTP_METHOD_POST,
+            .timeout_ms = NOTIFY_TIMEOUT_MS,
+        };
+
+        esp_err_t err = ESP_FAIL;
+        for (int attempt = 0; attempt < ALARM_ACTIONS_MAX_ATTEMPTS && err != ESP_OK; attempt++) {
+            if (attempt > 0) {
+                vTaskDelay(pdMS_TO_TICKS((RETRY_BASE_US / 1000) << attempt));
+            }
+            esp_http_client_handle_t client = esp_http_client_init(&config);
+            if (!client) {
+                continue;
+            }
+            esp_http_client_set_header(client, "Content-Type", "application/json");
+            esp_http_client_set_post_field(client, body, len);
+            err = esp_http_client_perform(client);
+            if (err == ESP_OK && esp_http_client_get_status_code(client) >= 300) {
+                err = ESP_FAIL;
+            }
+            esp_http_client_cleanup(client);
+        }
+
+        portENTER_CRITICAL(&stats_mux);
+        if (err == ESP_OK) {
+            stats.notify_sent++;
+        } else {
+            stats.notify_failed++;
+        }
+        portEXIT_CRITICAL(&stats_mux);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Webhook do alarme %u falhou", job.alarm_id);
+        }
+    }
+}
+
+esp_err_t alarm_actions_init(void)
+{
+    action_queue = xQueueCreate(ACTION_QUEUE_LEN, sizeof(action_job_t));
+    if (action_queue == NULL) {
+        ESP_LOGE(TAG, "Erro ao criar fila de ações");
+        return ESP_ERR_NO_MEM;
+    }
+    xTaskCreate(alarm_actions_task, "alarm_actions", 3072, NULL, 6, NULL);
+
+    if (strlen(CONFIG_ALARM_WEBHOOK_URL) > 0) {
+        notify_queue = xQueueCreate(NOTIFY_QUEUE_LEN, sizeof(notify_job_t));
+        if (notify_queue) {
+            xTaskCreate(notify_task, "alarm_notify", 4096, NULL, 4, NULL);
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t alarm_actions_submit(const alarm_action_t *actions, int count, time_t fire_at)
+{
+    if (action_queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Sem webhook configurado a notificação nem entra na fila
+    int kept = 0;
+    alarm_action_t list[ALARM_ACTIONS_MAX_PER_ALARM];
+    for (int i = 0; i < count && kept < ALARM_ACTIONS_MAX_PER_ALARM; i++) {
+        if (actions[i].type != ALARM_ACTION_NOTIFY || notify_queue != NULL) {
+            list[kept++] = actions[i];
+        }
+    }
+
+    action_job_t job = {
+        .batch = next_batch++,
+        .batch_size = kept,
+        .fire_us = (int64_t)fire_at * 1000000,
+    };
+
+    esp_err_t err = ESP_OK;
+    for (int i = 0; i < kept; i++) {
+        job.action = list[i];
+        // Conta antes de enfileirar: o executor nunca vê mais ações do que as enviadas
+        portENTER_CRITICAL(&stats_mux);
+        stats.submitted++;
+        portEXIT_CRITICAL(&stats_mux);
+        if (xQueueSend(action_queue, &job, 0) != pdTRUE) {
+            // O lote nunca fecha; a latência desse alarme fica sem medida
+            portENTER_CRITICAL(&stats_mux);
+            stats.dropped++;
+            portEXIT_CRITICAL(&stats_mux);
+            err = ESP_ERR_NO_MEM;
+        }
+    }
+    return err;
+}
+
+void alarm_actions_get_stats(alarm_action_stats_t *out)
+{
+    portENTER_CRITICAL(&stats_mux);
+    *out = stats;
+    portEXIT_CRITICAL(&stats_mux);
+}
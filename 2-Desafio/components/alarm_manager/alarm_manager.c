@@ -1,79 +1,164 @@
 #include "alarm_manager.h"
-#include "nvs_storage.h"
-#include "buzzer_manager.h"
-#include "led_rgb.h"
+#include "alarm_schedule.h"
+#include "alarm_store.h"
+#include "alarm_actions.h"
 #include "ntp_manager.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "time.h"
+#include <sys/time.h>
 #include <string.h>
 
-#define CHECK_INTERVAL_MS (1000) // Verifica alarmes a cada 1 segundo
-#define BUZZER_ALARM_DURATION_MS (3000) // Duração padrão da melodia
+#define MISSED_FIRE_WINDOW_S (60) // Disparo atrasado além disso (relógio saltou) é descartado
+
+// Bits de notificação da alarm_manager_task
+#define NOTIFY_FIRE         (1 << 0) // Timer venceu
+#define NOTIFY_RESCHEDULE   (1 << 1) // Relógio ou fuso mudou
+#define NOTIFY_RELOAD       (1 << 2) // Lista de alarmes editada
 
 static const char *TAG = "ALARM_MANAGER";
 
-// Definições internas
-static alarm_t alarm_list[MAX_ALARMS];
-static int num_alarms = 0;
-static int last_triggered_minute = -1;
 static bool alarms_enabled = true;
 
-static void check_alarms(void)
+// Estado do agendador, acessado só pela alarm_manager_task; os índices do heap
+// apontam para a lista fixada em `alarms`
+static const alarm_snapshot_t *alarms = NULL;
+static alarm_schedule_t schedule;
+static time_t last_fired_at = 0;
+static esp_timer_handle_t fire_timer = NULL;
+static TaskHandle_t alarm_task = NULL;
+
+static void notify_task(uint32_t bits)
 {
-    if (!alarms_enabled) {
-        return;
+    if (alarm_task) {
+        xTaskNotify(alarm_task, bits, eSetBits);
     }
+}
 
-    if (!ntp_manager_is_time_synced()) {
-        ESP_LOGW(TAG, "Hora ainda não sincronizada. Ignorando checagem de alarmes.");
-        return;
-    }
+static void fire_timer_cb(void *arg)
+{
+    notify_task(NOTIFY_FIRE);
+}
 
-    struct tm now;
-    if (!ntp_manager_get_time(&now)) {
-        ESP_LOGW(TAG, "Erro ao obter horário atual.");
-        return;
+static void on_time_changed(void)
+{
+    notify_task(NOTIFY_RESCHEDULE);
+}
+
+static void on_alarms_changed(const alarm_snapshot_t *snapshot, void *ctx)
+{
+    notify_task(NOTIFY_RELOAD);
+}
+
+static void reload_alarms(void)
+{
+    const alarm_snapshot_t *next = alarm_store_acquire();
+    if (alarms) {
+        alarm_store_release(alarms);
     }
+    alarms = next;
+    ESP_LOGI(TAG, "Agendando %d alarmes (versão %lu)", alarms->count, (unsigned long)alarms->generation);
+}
 
-    if (now.tm_min == last_triggered_minute) {
-        
+static void rebuild_schedule(void)
+{
+    // Roda também no relógio provisório; a sincronização NTP reagenda tudo
+    if (!ntp_manager_is_time_valid()) {
+        schedule.count = 0;
         return;
     }
 
-    ESP_LOGI(TAG, "Verificando alarmes para %02d:%02d, Dia %d", now.tm_hour, now.tm_min, now.tm_wday);
-
-    for (int i = 0; i < num_alarms; i++) {
-        if (alarm_list[i].hour == now.tm_hour &&
-            alarm_list[i].minute == now.tm_min &&
-            alarm_list[i].weekday == now.tm_wday) {
+    // Alarmes do minuto corrente ainda disparam, exceto os que já dispararam.
+    // O horário restaurado da NVS pode cair num minuto já tratado antes da queda.
+    time_t now = time(NULL);
+    time_t after = now - now % 60 - 1;
+    if (ntp_manager_get_quality() == NTP_CLOCK_RESTORED) {
+        after = now;
+    }
+    if (last_fired_at > after && last_fired_at <= now + MISSED_FIRE_WINDOW_S) {
+        after = last_fired_at;
+    }
 
-            ESP_LOGI(TAG, "Alarme encontrado! Executando...");
-            
+    alarm_schedule_build(&schedule, alarms, after);
+}
 
-            // Toca melodia se o buzzer estiver livre
-            if (!buzzer_manager_is_playing()) {
-                buzzer_manager_play((buzzer_melody_t)alarm_list[i].melody, BUZZER_ALARM_DURATION_MS);
-            } else {
-                ESP_LOGW(TAG, "Buzzer ocupado. Alarme não pode tocar.");
+static void fire_due_alarms(void)
+{
+    time_t now = time(NULL);
+    alarm_schedule_entry_t entry;
+
+    while (alarm_schedule_peek(&schedule, &entry) && entry.fire_at <= now) {
+        alarm_t alarm = alarms->alarms[entry.index];
+        uint16_t id = alarms->ids[entry.index];
+        last_fired_at = entry.fire_at;
+
+        if (alarm.one_shot) {
+            // Sai do heap já; a lista nova chega pela notificação da store
+            alarm_schedule_replace_top(&schedule, -1);
+            alarm_t done = alarm;
+            done.enabled = 0;
+            uint16_t day;
+            int32_t date = (alarm.has_date && alarm_snapshot_date(alarms, entry.index, &day)) ? day : ALARM_NO_DATE;
+            if (alarm_store_update(id, &done, date) != ESP_OK) {
+                ESP_LOGW(TAG, "Erro ao desligar o alarme único %u", id);
             }
+        } else {
+            alarm_schedule_replace_top(&schedule, alarm_schedule_next_fire(&alarm, ALARM_NO_DATE, entry.fire_at));
+        }
 
-            led_rgb_set_color(0, 255, 0); 
-            vTaskDelay(pdMS_TO_TICKS(1000));
-            led_rgb_set_color(0, 0, 0);
+        if (!alarms_enabled || now - entry.fire_at >= MISSED_FIRE_WINDOW_S) {
+            continue;
+        }
 
-            last_triggered_minute = now.tm_min;
-            return; 
+        ESP_LOGI(TAG, "Alarme %u disparado (%02d:%02d, dias 0x%02x)", id, alarm_hour(&alarm),
+                 alarm_minute(&alarm), (unsigned)alarm.weekdays);
+
+        // Só enfileira; o executor inicia as ações sem travar o agendador
+        const alarm_action_t actions[] = {
+            { ALARM_ACTION_MELODY, (uint16_t)alarm.melody },
+            { ALARM_ACTION_LED, ALARM_LED_PATTERN_FLASH },
+            { ALARM_ACTION_NOTIFY, id },
+        };
+        if (alarm_actions_submit(actions, sizeof(actions) / sizeof(actions[0]), entry.fire_at) != ESP_OK) {
+            ESP_LOGW(TAG, "Fila de ações cheia; alarme %u incompleto", id);
         }
     }
 }
 
+static void arm_timer(void)
+{
+    esp_timer_stop(fire_timer);
+
+    alarm_schedule_entry_t entry;
+    if (!alarm_schedule_peek(&schedule, &entry)) {
+        return;
+    }
+
+    // esp_timer conta tempo monotônico; a deriva contra o relógio de parede é
+    // corrigida a cada ressincronização NTP, que reagenda tudo
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    int64_t delay_us = (int64_t)(entry.fire_at - tv.tv_sec) * 1000000 - tv.tv_usec;
+    esp_timer_start_once(fire_timer, delay_us > 0 ? delay_us : 0);
+}
+
+// Dorme até o próximo disparo ou até uma edição/mudança de relógio
 static void alarm_manager_task(void *param)
 {
     while (1) {
-        check_alarms();
-        vTaskDelay(pdMS_TO_TICKS(CHECK_INTERVAL_MS));
+        uint32_t bits = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &bits, portMAX_DELAY);
+
+        if (bits & NOTIFY_RELOAD) {
+            reload_alarms();
+        }
+        if (bits & (NOTIFY_RELOAD | NOTIFY_RESCHEDULE)) {
+            rebuild_schedule();
+        }
+        fire_due_alarms();
+        arm_timer();
     }
 }
 
@@ -81,13 +166,24 @@ void alarm_manager_init(void)
 {
     ESP_LOGI(TAG, "Inicializando Alarm Manager...");
 
-    num_alarms = nvs_storage_load_alarms(alarm_list, MAX_ALARMS);
-    ESP_LOGI(TAG, "Carregados %d alarmes.", num_alarms);
-
-    xTaskCreate(alarm_manager_task, "alarm_manager_task", 4096, NULL, 5, NULL);
+    if (alarm_store_init() != ESP_OK || alarm_actions_init() != ESP_OK) {
+        ESP_LOGE(TAG, "Erro ao carregar alarmes");
+        return;
+    }
+    reload_alarms();
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = fire_timer_cb,
+        .name = "alarm_fire"
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &fire_timer));
+
+    xTaskCreate(alarm_manager_task, "alarm_manager_task", 4096, NULL, 5, &alarm_task);
+    alarm_store_subscribe(on_alarms_changed, NULL);
+    ntp_manager_set_time_changed_callback(on_time_changed);
+    notify_task(NOTIFY_RESCHEDULE);
 }
 
-
 bool alarm_manager_is_enabled(void)
 {
     return alarms_enabled;
@@ -95,14 +191,19 @@ bool alarm_manager_is_enabled(void)
 
 int alarm_manager_count(void)
 {
-    return num_alarms;
+    const alarm_snapshot_t *snap = alarm_store_acquire();
+    int count = snap ? snap->count : 0;
+    alarm_store_release(snap);
+    return count;
 }
 
 bool alarm_manager_get_alarm(int index, alarm_t *alarm)
 {
-    if (index < 0 || index >= num_alarms) {
-        return false;
+    const alarm_snapshot_t *snap = alarm_store_acquire();
+    bool found = snap && index >= 0 && index < snap->count;
+    if (found) {
+        *alarm = snap->alarms[index];
     }
-    *alarm = alarm_list[index];
-    return true;
+    alarm_store_release(snap);
+    return found;
 }
@@ -0,0 +1,161 @@
+#include "alarm_schedule.h"
+
+#define DAYS_PER_WEEK 7
+#define DAYS_0000_TO_2000 730425 // 0000-03-01 até 2000-01-01, base do algoritmo civil
+
+static void sift_down(alarm_schedule_t *sched, int pos)
+{
+    alarm_schedule_entry_t *e = sched->entries;
+    alarm_schedule_entry_t moving = e[pos];
+    while (1) {
+        int child = 2 * pos + 1;
+        if (child >= sched->count) {
+            break;
+        }
+        if (child + 1 < sched->count && e[child + 1].fire_at < e[child].fire_at) {
+            child++;
+        }
+        if (moving.fire_at <= e[child].fire_at) {
+            break;
+        }
+        e[pos] = e[child];
+        pos = child;
+    }
+    e[pos] = moving;
+}
+
+static time_t fire_on_day(const struct tm *base, int day_offset, const alarm_t *alarm)
+{
+    struct tm target = *base;
+    target.tm_mday += day_offset;
+    target.tm_hour = alarm_hour(alarm);
+    target.tm_min = alarm_minute(alarm);
+    target.tm_sec = 0;
+    target.tm_isdst = -1; // mktime decide se o dia alvo está no horário de verão
+    return mktime(&target);
+}
+
+// Dias até o próximo dia marcado em `mask`, a partir de `wday` (inclusive se include_today)
+static int days_until(uint32_t mask, int wday, bool include_today)
+{
+    // Gira a máscara para que o bit 0 seja hoje
+    uint32_t rotated = ((mask >> wday) | (mask << (DAYS_PER_WEEK - wday))) & ALARM_WEEKDAYS_ALL;
+    if (!include_today) {
+        rotated &= ~1u;
+    }
+    if (rotated) {
+        return __builtin_ctz(rotated);
+    }
+    // Só hoje está marcado e o horário já passou: semana que vem
+    return (mask & ALARM_WEEKDAY_BIT(wday)) ? DAYS_PER_WEEK : -1;
+}
+
+static time_t fire_on_date(const alarm_t *alarm, int32_t day, time_t after)
+{
+    struct tm base = {
+        .tm_year = 100, // 2000
+        .tm_mon = 0,
+        .tm_mday = 1,
+    };
+    time_t fire = fire_on_day(&base, day, alarm);
+    return fire > after ? fire : -1;
+}
+
+time_t alarm_schedule_next_fire(const alarm_t *alarm, int32_t day, time_t after)
+{
+    if (!alarm->enabled || alarm->minute_of_day >= ALARM_MINUTES_PER_DAY) {
+        return -1;
+    }
+    if (day != ALARM_NO_DATE) {
+        return fire_on_date(alarm, day, after);
+    }
+
+    // Alarme único sem dias marcados toca na próxima vez que o horário chegar
+    uint32_t mask = alarm->weekdays;
+    if (mask == 0) {
+        if (!alarm->one_shot) {
+            return -1;
+        }
+        mask = ALARM_WEEKDAYS_ALL;
+    }
+
+    struct tm now;
+    localtime_r(&after, &now);
+
+    int days = days_until(mask, now.tm_wday, true);
+    time_t fire = fire_on_day(&now, days, alarm);
+    if (fire <= after) {
+        // Já passou hoje (ou caiu no buraco de uma transição de horário)
+        fire = fire_on_day(&now, days_until(mask, now.tm_wday, false), alarm);
+    }
+    return fire;
+}
+
+// Algoritmo de calendário civil (era de 400 anos), sem depender do fuso
+int32_t alarm_day_from_date(int year, int month, int mday)
+{
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yoe = year - era * 400;
+    int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + mday - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - DAYS_0000_TO_2000;
+}
+
+void alarm_day_to_date(int32_t day, int *year, int *month, int *mday)
+{
+    int32_t z = day + DAYS_0000_TO_2000;
+    int era = (z >= 0 ? z : z - 146096) / 146097;
+    int doe = z - era * 146097;
+    int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int mp = (5 * doy + 2) / 153;
+    *mday = doy - (153 * mp + 2) / 5 + 1;
+    *month = mp < 10 ? mp + 3 : mp - 9;
+    *year = yoe + era * 400 + (*month <= 2);
+}
+
+void alarm_schedule_build(alarm_schedule_t *sched, const alarm_snapshot_t *alarms, time_t after)
+{
+    sched->count = 0;
+    for (int i = 0; i < alarms->count && i < MAX_ALARMS; i++) {
+        const alarm_t *alarm = &alarms->alarms[i];
+        uint16_t day;
+        int32_t date = (alarm->has_date && alarm_snapshot_date(alarms, i, &day)) ? day : ALARM_NO_DATE;
+        time_t fire = alarm_schedule_next_fire(alarm, date, after);
+        if (fire < 0) {
+            continue;
+        }
+        sched->entries[sched->count].fire_at = fire;
+        sched->entries[sched->count].index = (uint16_t)i;
+        sched->count++;
+    }
+
+    for (int pos = sched->count / 2 - 1; pos >= 0; pos--) {
+        sift_down(sched, pos);
+    }
+}
+
+bool alarm_schedule_peek(const alarm_schedule_t *sched, alarm_schedule_entry_t *entry)
+{
+    if (sched->count == 0) {
+        return false;
+    }
+    *entry = sched->entries[0];
+    return true;
+}
+
+void alarm_schedule_replace_top(alarm_schedule_t *sched, time_t fire_at)
+{
+    if (sched->count == 0) {
+        return;
+    }
+    if (fire_at < 0) {
+        sched->entries[0] = sched->entries[--sched->count];
+    } else {
+        sched->entries[0].fire_at = fire_at;
+    }
+    if (sched->count > 0) {
+        sift_down(sched, 0);
+    }
+}
@@ -0,0 +1,485 @@
+#include "alarm_store.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "ALARM_STORE";
+
+#define FLUSH_DELAY_MS 1000         // Edições seguidas (ex.: importação) viram uma gravação só
+#define SHUTDOWN_LOCK_WAIT_MS 500
+
+typedef struct {
+    alarm_store_listener_t listener;
+    void *ctx;
+} listener_t;
+
+// O spinlock só protege a leitura do ponteiro junto com o incremento do refcount
+static portMUX_TYPE current_mux = portMUX_INITIALIZER_UNLOCKED;
+static alarm_snapshot_t *current = NULL;
+
+// Escritores são serializados; a gravação na NVS não trava os leitores
+static SemaphoreHandle_t write_lock = NULL;
+static listener_t listeners[ALARM_STORE_MAX_LISTENERS];
+static int listener_count = 0;
+static TaskHandle_t flush_task = NULL;
+static uint16_t next_id = 0;    // Protegido por write_lock
+
+static alarm_snapshot_t *snapshot_alloc(int count)
+{
+    alarm_snapshot_t *snap = malloc(sizeof(alarm_snapshot_t) + count * (sizeof(alarm_t) + sizeof(uint16_t)));
+    if (snap) {
+        snap->refcount = 1; // Referência da própria store
+        snap->count = count;
+        snap->date_count = 0;
+        snap->ids = (uint16_t *)&snap->alarms[count];
+    }
+    return snap;
+}
+
+static void snapshot_put(alarm_snapshot_t *snap)
+{
+    if (snap && __atomic_sub_fetch(&snap->refcount, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(snap);
+    }
+}
+
+// Troca a lista atual; chamada com write_lock
+static void publish(alarm_snapshot_t *next)
+{
+    portENTER_CRITICAL(&current_mux);
+    alarm_snapshot_t *old = current;
+    next->generation = old ? old->generation + 1 : 1;
+    current = next;
+    portEXIT_CRITICAL(&current_mux);
+
+    snapshot_put(old);
+
+    for (int i = 0; i < listener_count; i++) {
+        listeners[i].listener(next, listeners[i].ctx);
+    }
+}
+
+static alarm_snapshot_t *snapshot_from_records(const alarm_record_t *records, int count)
+{
+    alarm_snapshot_t *snap = snapshot_alloc(count);
+    if (!snap) {
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        snap->alarms[i] = records[i].alarm;
+        snap->ids[i] = records[i].id;
+        if (records[i].alarm.has_date) {
+            if (snap->date_count < MAX_ALARM_DATES) {
+                snap->dates[snap->date_count].index = i;
+                snap->dates[snap->date_count].day = records[i].day;
+                snap->date_count++;
+            } else {
+                snap->alarms[i].has_date = 0;
+            }
+        }
+    }
+    return snap;
+}
+
+static alarm_record_t snapshot_record(const alarm_snapshot_t *snap, int index)
+{
+    alarm_record_t record = { .id = snap->ids[index], .alarm = snap->alarms[index] };
+    uint16_t day;
+    if (record.alarm.has_date && alarm_snapshot_date(snap, index, &day)) {
+        record.day = day;
+    }
+    return record;
+}
+
+// Chamada com write_lock; a tabela nova já inclui as edições pendentes
+static void compact(void)
+{
+    int count = current->count;
+    alarm_record_t *records = malloc((count ? count : 1) * sizeof(alarm_record_t));
+    if (!records) {
+        nvs_storage_flush();
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        records[i] = snapshot_record(current, i);
+    }
+    if (!nvs_storage_compact_alarms(records, count)) {
+        nvs_storage_flush();
+    }
+    free(records);
+}
+
+// Write-behind: grava um tempo depois da última edição, fora da task de quem
+// editou; com log grande, regrava a tabela em vez de acrescentar ao log
+static void alarm_flush_task(void *param)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(FLUSH_DELAY_MS)) > 0) {
+            // Nova edição no intervalo: espera de novo
+        }
+
+        xSemaphoreTake(write_lock, portMAX_DELAY);
+        if (nvs_storage_alarm_log_length() + nvs_storage_pending() >= ALARM_LOG_COMPACT_AT) {
+            compact();
+        } else {
+            nvs_storage_flush();
+        }
+        xSemaphoreGive(write_lock);
+    }
+}
+
+static void schedule_flush(void)
+{
+    if (flush_task) {
+        xTaskNotifyGive(flush_task);
+    }
+}
+
+static void shutdown_flush(void)
+{
+    alarm_store_flush();
+}
+
+esp_err_t alarm_store_init(void)
+{
+    alarm_record_t *records = malloc(MAX_ALARMS * sizeof(alarm_record_t));
+    if (!records) {
+        return ESP_ERR_NO_MEM;
+    }
+    int count = nvs_storage_load_alarms(records, MAX_ALARMS);
+    next_id = nvs_storage_next_alarm_id();
+    alarm_snapshot_t *snap = snapshot_from_records(records, count);
+    free(records);
+    if (!snap) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    write_lock = xSemaphoreCreateMutex();
+    if (!write_lock) {
+        free(snap);
+        return ESP_ERR_NO_MEM;
+    }
+    publish(snap);
+    xTaskCreate(alarm_flush_task, "alarm_flush", 2560, NULL, 1, &flush_task);
+    esp_register_shutdown_handler(shutdown_flush);
+    if (nvs_storage_alarm_log_length() >= ALARM_LOG_COMPACT_AT) {
+        schedule_flush();
+    }
+    ESP_LOGI(TAG, "Carregados %d alarmes.", snap->count);
+    return ESP_OK;
+}
+
+const alarm_snapshot_t *alarm_store_acquire(void)
+{
+    portENTER_CRITICAL(&current_mux);
+    alarm_snapshot_t *snap = current;
+    if (snap) {
+        __atomic_add_fetch(&snap->refcount, 1, __ATOMIC_RELAXED);
+    }
+    portEXIT_CRITICAL(&current_mux);
+    return snap;
+}
+
+void alarm_store_release(const alarm_snapshot_t *snapshot)
+{
+    snapshot_put((alarm_snapshot_t *)snapshot);
+}
+
+// Copia a lista atual com `extra` posições livres no fim
+static alarm_snapshot_t *copy_current(int count, int extra)
+{
+    alarm_snapshot_t *next = snapshot_alloc(count + extra);
+    if (next) {
+        memcpy(next->alarms, current->alarms, count * sizeof(alarm_t));
+        memcpy(next->ids, current->ids, count * sizeof(uint16_t));
+        memcpy(next->dates, current->dates, current->date_count * sizeof(alarm_date_t));
+        next->date_count = current->date_count;
+    }
+    return next;
+}
+
+static void remove_date(alarm_snapshot_t *snap, int index)
+{
+    for (int i = 0; i < snap->date_count; i++) {
+        if (snap->dates[i].index == index) {
+            snap->dates[i] = snap->dates[--snap->date_count];
+            return;
+        }
+    }
+}
+
+static void set_date(alarm_snapshot_t *snap, int index, int32_t day)
+{
+    remove_date(snap, index);
+    snap->alarms[index].has_date = day >= 0;
+    if (day >= 0) {
+        snap->dates[snap->date_count].index = index;
+        snap->dates[snap->date_count].day = day;
+        snap->date_count++;
+    }
+}
+
+// Ids crescem em vez de reusar o menor livre: um PUT/DELETE atrasado para um
+// alarme apagado dá 404 em vez de acertar o que foi criado depois. Só depois de
+// dar a volta em ALARM_ID_LIMIT um id antigo é reusado, pulando os em uso.
+static uint16_t alloc_id(const alarm_snapshot_t *snap)
+{
+    uint16_t id = next_id;
+    // Ao alocar há menos de MAX_ALARMS ids em uso: MAX_ALARMS tentativas bastam
+    for (int tries = 0; tries < MAX_ALARMS && alarm_snapshot_find(snap, id) >= 0; tries++) {
+        id = (id + 1) % ALARM_ID_LIMIT;
+    }
+    next_id = (id + 1) % ALARM_ID_LIMIT;
+    nvs_storage_set_next_alarm_id(next_id);
+    return id;
+}
+
+// Registra a edição e publica; chamada com write_lock, consome `next`
+static esp_err_t commit(alarm_snapshot_t *next, int index)
+{
+    alarm_record_t record = snapshot_record(next, index);
+    if (!nvs_storage_put_alarm(&record)) {
+        free(next);
+        return ESP_FAIL;
+    }
+    publish(next);
+    schedule_flush();
+    return ESP_OK;
+}
+
+bool alarm_snapshot_date(const alarm_snapshot_t *snapshot, int index, uint16_t *day)
+{
+    for (int i = 0; i < snapshot->date_count; i++) {
+        if (snapshot->dates[i].index == index) {
+            *day = snapshot->dates[i].day;
+            return true;
+        }
+    }
+    return false;
+}
+
+int alarm_snapshot_find(const alarm_snapshot_t *snapshot, uint16_t id)
+{
+    for (int i = 0; i < snapshot->count; i++) {
+        if (snapshot->ids[i] == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+esp_err_t alarm_store_add(const alarm_t *alarm, int32_t day, uint16_t *id)
+{
+    if (!write_lock) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(write_lock, portMAX_DELAY);
+    int count = current->count;
+    if (count >= MAX_ALARMS) {
+        xSemaphoreGive(write_lock);
+        ESP_LOGW(TAG, "Limite máximo de alarmes atingido");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (day >= 0 && current->date_count >= MAX_ALARM_DATES) {
+        xSemaphoreGive(write_lock);
+        ESP_LOGW(TAG, "Limite de alarmes com data atingido");
+        return ESP_ERR_NO_MEM;
+    }
+
+    alarm_snapshot_t *next = copy_current(count, 1);
+    if (!next) {
+        xSemaphoreGive(write_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    next->alarms[count] = *alarm;
+    next->ids[count] = alloc_id(current);
+    next->alarms[count].has_date = 0;
+    set_date(next, count, day);
+    if (id) {
+        *id = next->ids[count];
+    }
+
+    esp_err_t err = commit(next, count);
+    xSemaphoreGive(write_lock);
+    return err;
+}
+
+esp_err_t alarm_store_add_batch(const alarm_t *alarms, const int32_t *days, int count, int *added)
+{
+    *added = 0;
+    if (!write_lock) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    int dated = 0;
+    for (int i = 0; i < count; i++) {
+        dated += days[i] >= 0;
+    }
+
+    xSemaphoreTake(write_lock, portMAX_DELAY);
+    int base = current->count;
+    if (base + count > MAX_ALARMS || current->date_count + dated > MAX_ALARM_DATES) {
+        xSemaphoreGive(write_lock);
+        ESP_LOGW(TAG, "Lote de %d alarmes não cabe na lista", count);
+        return ESP_ERR_NO_MEM;
+    }
+
+    alarm_snapshot_t *next = copy_current(base, count);
+    if (!next) {
+        xSemaphoreGive(write_lock);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Um lote, uma publicação e uma gravação (o flush junta tudo num nvs_commit)
+    esp_err_t err = ESP_OK;
+    next->count = base;
+    nvs_storage_begin();
+    for (int i = 0; i < count; i++) {
+        int index = next->count;
+        next->alarms[index] = alarms[i];
+        next->alarms[index].has_date = 0;
+        next->ids[index] = alloc_id(next);
+        next->count++;
+        set_date(next, index, days[i]);
+
+        alarm_record_t record = snapshot_record(next, index);
+        if (!nvs_storage_put_alarm(&record)) {
+            // Os anteriores já estão no log; a lista publicada fica igual a ele
+            next->count--;
+            remove_date(next, index);
+            err = ESP_FAIL;
+            break;
+        }
+    }
+    nvs_storage_commit();
+
+    *added = next->count - base;
+    publish(next);
+    schedule_flush();
+    xSemaphoreGive(write_lock);
+    return err;
+}
+
+esp_err_t alarm_store_flush(void)
+{
+    if (!write_lock || xSemaphoreTake(write_lock, pdMS_TO_TICKS(SHUTDOWN_LOCK_WAIT_MS)) != pdTRUE) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t err = nvs_storage_flush() ? ESP_OK : ESP_FAIL;
+    xSemaphoreGive(write_lock);
+    return err;
+}
+
+esp_err_t alarm_store_update(uint16_t id, const alarm_t *alarm, int32_t day)
+{
+    if (!write_lock) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(write_lock, portMAX_DELAY);
+    int index = alarm_snapshot_find(current, id);
+    if (index < 0) {
+        xSemaphoreGive(write_lock);
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (day >= 0 && !current->alarms[index].has_date && current->date_count >= MAX_ALARM_DATES) {
+        xSemaphoreGive(write_lock);
+        ESP_LOGW(TAG, "Limite de alarmes com data atingido");
+        return ESP_ERR_NO_MEM;
+    }
+
+    alarm_snapshot_t *next = copy_current(current->count, 0);
+    if (!next) {
+        xSemaphoreGive(write_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    next->alarms[index] = *alarm;
+    set_date(next, index, day);
+
+    esp_err_t err = commit(next, index);
+    xSemaphoreGive(write_lock);
+    return err;
+}
+
+esp_err_t alarm_store_delete(uint16_t id)
+{
+    if (!write_lock) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(write_lock, portMAX_DELAY);
+    int index = alarm_snapshot_find(current, id);
+    if (index < 0) {
+        xSemaphoreGive(write_lock);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    alarm_snapshot_t *next = copy_current(current->count, 0);
+    if (!next) {
+        xSemaphoreGive(write_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    // Fecha o buraco mantendo a ordem; datas de quem vinha depois andam uma posição
+    int tail = current->count - index - 1;
+    remove_date(next, index);
+    memmove(&next->alarms[index], &next->alarms[index + 1], tail * sizeof(alarm_t));
+    memmove(&next->ids[index], &next->ids[index + 1], tail * sizeof(uint16_t));
+    next->count--;
+    for (int i = 0; i < next->date_count; i++) {
+        if (next->dates[i].index > index) {
+            next->dates[i].index--;
+        }
+    }
+
+    esp_err_t err = ESP_FAIL;
+    if (nvs_storage_delete_alarm(id)) {
+        publish(next);
+        schedule_flush();
+        err = ESP_OK;
+    } else {
+        free(next);
+    }
+    xSemaphoreGive(write_lock);
+    return err;
+}
+
+esp_err_t alarm_store_clear(void)
+{
+    if (!write_lock) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    alarm_snapshot_t *next = snapshot_alloc(0);
+    if (!next) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    xSemaphoreTake(write_lock, portMAX_DELAY);
+    if (!nvs_storage_clear_alarms()) {
+        xSemaphoreGive(write_lock);
+        free(next);
+        return ESP_FAIL;
+    }
+    publish(next);
+    xSemaphoreGive(write_lock);
+    return ESP_OK;
+}
+
+esp_err_t alarm_store_subscribe(alarm_store_listener_t listener, void *ctx)
+{
+    if (listener_count >= ALARM_STORE_MAX_LISTENERS) {
+        return ESP_ERR_NO_MEM;
+    }
+    // Feito na inicialização, antes de qualquer edição
+    listeners[listener_count].listener = listener;
+    listeners[listener_count].ctx = ctx;
+    listener_count++;
+    return ESP_OK;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+#include "esp_err.h"
+
+#define ALARM_ACTIONS_MAX_PER_ALARM 4
+
+typedef enum {
+    ALARM_ACTION_MELODY,    // param = buzzer_melody_t
+    ALARM_ACTION_AUDIO,     // param = alarm_audio_type_t
+    ALARM_ACTION_LED,       // param = alarm_led_pattern_t
+    ALARM_ACTION_NOTIFY     // POST no webhook (CONFIG_ALARM_WEBHOOK_URL); param = id do alarme
+} alarm_action_type_t;
+
+typedef enum {
+    ALARM_LED_PATTERN_FLASH,    // Verde por 1 s
+    ALARM_LED_PATTERN_BLINK,    // Vermelho piscando
+} alarm_led_pattern_t;
+
+typedef struct {
+    alarm_action_type_t type;
+    uint16_t param;
+} alarm_action_t;
+
+typedef struct {
+    uint32_t submitted;
+    uint32_t started;
+    uint32_t coalesced;         // Ação idêntica no mesmo disparo, executada uma vez só
+    uint32_t retried;
+    uint32_t failed;            // Desistiu após ALARM_ACTIONS_MAX_ATTEMPTS
+    uint32_t dropped;           // Fila cheia
+    uint32_t notify_sent;
+    uint32_t notify_failed;
+    uint32_t last_start_latency_us; // Do instante do disparo até todas as ações de um alarme começarem
+    uint32_t max_start_latency_us;
+} alarm_action_stats_t;
+
+esp_err_t alarm_actions_init(void);
+
+/**
+ * @brief Enfileira as ações de um alarme; não bloqueia.
+ *
+ * @param fire_at Instante teórico do disparo, base da medida de latência.
+ */
+esp_err_t alarm_actions_submit(const alarm_action_t *actions, int count, time_t fire_at);
+
+void alarm_actions_get_stats(alarm_action_stats_t *stats);
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "alarm_store.h"
+
+#define ALARM_NO_DATE (-1)
+
+// Próximo disparo de cada alarme, ordenado por um min-heap (topo = mais cedo)
+typedef struct {
+    time_t fire_at;     // Instante absoluto (UTC) do próximo disparo
+    uint16_t index;     // Posição do alarme na lista do alarm_manager
+} alarm_schedule_entry_t;
+
+typedef struct {
+    alarm_schedule_entry_t entries[MAX_ALARMS];
+    int count;
+} alarm_schedule_t;
+
+/**
+ * @brief Primeiro disparo do alarme estritamente depois de `after`.
+ *
+ * O horário é resolvido no fuso local vigente (TZ) para o dia alvo, então
+ * mudanças de horário de verão entre agora e o disparo já saem corretas.
+ *
+ * @param day Data marcada (dias desde 2000-01-01) ou ALARM_NO_DATE.
+ * @return Instante do disparo, ou -1 se o alarme estiver desligado, vencido ou inválido.
+ */
+time_t alarm_schedule_next_fire(const alarm_t *alarm, int32_t day, time_t after);
+
+/**
+ * @brief Converte uma data do calendário em dias desde 2000-01-01, e de volta.
+ */
+int32_t alarm_day_from_date(int year, int month, int mday);
+void alarm_day_to_date(int32_t day, int *year, int *month, int *mday);
+
+/**
+ * @brief Recalcula o heap inteiro a partir da lista de alarmes (O(n)).
+ */
+void alarm_schedule_build(alarm_schedule_t *sched, const alarm_snapshot_t *alarms, time_t after);
+
+/**
+ * @brief Consulta o disparo mais cedo sem removê-lo.
+ *
+ * @return false se não houver alarmes agendados.
+ */
+bool alarm_schedule_peek(const alarm_schedule_t *sched, alarm_schedule_entry_t *entry);
+
+/**
+ * @brief Reagenda o topo para `fire_at` (ou o remove, se -1), em O(log n).
+ */
+void alarm_schedule_replace_top(alarm_schedule_t *sched, time_t fire_at);
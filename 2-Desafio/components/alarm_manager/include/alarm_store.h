@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "nvs_storage.h"
+
+#define ALARM_STORE_MAX_LISTENERS 4
+
+// Lista imutável de alarmes; só é liberada quando o último leitor a solta
+typedef struct {
+    uint32_t refcount;
+    uint32_t generation;    // Incrementa a cada edição publicada
+    int count;
+    int date_count;
+    uint16_t *ids;          // Id estável de cada posição; no mesmo bloco da lista
+    alarm_date_t dates[MAX_ALARM_DATES];
+    alarm_t alarms[];
+} alarm_snapshot_t;
+
+// Chamado na task de quem editou, depois que a nova lista já está publicada
+typedef void (*alarm_store_listener_t)(const alarm_snapshot_t *snapshot, void *ctx);
+
+/**
+ * @brief Carrega os alarmes da NVS e publica a primeira lista.
+ */
+esp_err_t alarm_store_init(void);
+
+/**
+ * @brief Pega uma referência à lista atual, sem bloquear.
+ *
+ * A lista não muda enquanto a referência existir; devolva com alarm_store_release().
+ */
+const alarm_snapshot_t *alarm_store_acquire(void);
+void alarm_store_release(const alarm_snapshot_t *snapshot);
+
+/**
+ * @brief Data marcada do alarme único `index`, se houver.
+ */
+bool alarm_snapshot_date(const alarm_snapshot_t *snapshot, int index, uint16_t *day);
+
+/**
+ * @brief Posição do alarme `id` na lista, ou -1.
+ */
+int alarm_snapshot_find(const alarm_snapshot_t *snapshot, uint16_t id);
+
+/**
+ * @brief Acrescenta um alarme, persiste na NVS e publica a nova lista.
+ *
+ * A lista publicada muda na hora; o registro vai para a NVS em até
+ * ~1 s (write-behind), junto com as edições próximas.
+ *
+ * @param day Data (dias desde 2000-01-01) de um alarme único, ou -1.
+ * @param id Recebe o id do alarme novo (pode ser NULL).
+ * @return ESP_ERR_NO_MEM se a lista estiver cheia; a lista publicada só muda
+ *         se a gravação der certo.
+ */
+esp_err_t alarm_store_add(const alarm_t *alarm, int32_t day, uint16_t *id);
+
+/**
+ * @brief Acrescenta vários alarmes numa única publicação e gravação.
+ *
+ * @param days Data de cada alarme, ou -1.
+ * @param added Recebe quantos entraram; em erro de gravação, os primeiros ficam.
+ * @return ESP_ERR_NO_MEM se o lote não couber (nada é acrescentado).
+ */
+esp_err_t alarm_store_add_batch(const alarm_t *alarms, const int32_t *days, int count, int *added);
+
+/**
+ * @brief Grava já as edições que ainda estão em RAM.
+ *
+ * Chamada automaticamente em esp_restart(). Num brownout o chip reinicia sem
+ * passar por aqui; perde-se no máximo o último segundo de edições.
+ */
+esp_err_t alarm_store_flush(void);
+
+/**
+ * @brief Substitui o alarme `id` (ex.: desligar um alarme único que disparou).
+ *
+ * @param day Data do alarme único, ou -1 para nenhuma.
+ * @return ESP_ERR_NOT_FOUND se o id não existir.
+ */
+esp_err_t alarm_store_update(uint16_t id, const alarm_t *alarm, int32_t day);
+
+/**
+ * @brief Apaga o alarme `id`; os ids dos demais não mudam.
+ */
+esp_err_t alarm_store_delete(uint16_t id);
+
+/**
+ * @brief Apaga todos os alarmes, persiste e publica a lista vazia.
+ */
+esp_err_t alarm_store_clear(void);
+
+/**
+ * @brief Registra um ouvinte de mudanças.
+ */
+esp_err_t alarm_store_subscribe(alarm_store_listener_t listener, void *ctx);
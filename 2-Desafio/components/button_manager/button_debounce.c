@@ -0,0 +1,21 @@
+#include "button_debounce.h"
+
+void button_debounce_init(button_debounce_t *db, uint64_t initial_state)
+{
+    db->state = initial_state;
+    db->cnt0 = 0;
+    db->cnt1 = 0;
+}
+
+uint64_t button_debounce_update(button_debounce_t *db, uint64_t sample)
+{
+    uint64_t delta = sample ^ db->state;
+
+    // Canais sem diferença zeram o contador; os demais contam 1, 2, 3, 0 (vira)
+    db->cnt1 = (db->cnt1 ^ db->cnt0) & delta;
+    db->cnt0 = ~db->cnt0 & delta;
+
+    uint64_t toggle = delta & ~(db->cnt0 | db->cnt1);
+    db->state ^= toggle;
+    return toggle;
+}
@@ -0,0 +1,112 @@
+#include "button_gesture.h"
+#include <string.h>
+
+static bool is_held(const button_gesture_t *g)
+{
+    return g->state == GESTURE_DOWN || g->state == GESTURE_DOWN_SECOND;
+}
+
+void button_gesture_init(button_gesture_t *g, const button_gesture_config_t *config)
+{
+    memset(g, 0, sizeof(*g));
+    g->config = *config;
+    g->state = GESTURE_IDLE;
+    // Intervalo nulo faria o repeat emitir indefinidamente
+    if (g->config.repeat_min_us < 1000) {
+        g->config.repeat_min_us = 1000;
+    }
+    if (g->config.repeat_start_us < g->config.repeat_min_us) {
+        g->config.repeat_start_us = g->config.repeat_min_us;
+    }
+}
+
+void button_gesture_poll(button_gesture_t *g, int64_t now_us, button_gesture_emit_t emit, void *ctx)
+{
+    const button_gesture_config_t *cfg = &g->config;
+
+    if (is_held(g)) {
+        if (!g->long_sent && cfg->long_press_us > 0 && now_us - g->press_us >= cfg->long_press_us) {
+            g->long_sent = true;
+            emit(ctx, BUTTON_EVENT_LONG_PRESS, g->press_us + cfg->long_press_us);
+        }
+
+        while (cfg->repeat_delay_us > 0 && now_us >= g->next_repeat_us) {
+            g->repeated = true;
+            emit(ctx, BUTTON_EVENT_REPEAT, g->next_repeat_us);
+
+            // Acelera até o intervalo mínimo
+            g->next_repeat_us += g->repeat_interval_us;
+            uint32_t next = (uint32_t)((uint64_t)g->repeat_interval_us * cfg->repeat_accel_pct / 100);
+            g->repeat_interval_us = (next < cfg->repeat_min_us) ? cfg->repeat_min_us : next;
+        }
+    } else if (g->state == GESTURE_WAIT_SECOND) {
+        if (now_us - g->release_us >= cfg->double_click_us) {
+            g->state = GESTURE_IDLE;
+            emit(ctx, BUTTON_EVENT_CLICK, g->release_us);
+        }
+    }
+}
+
+void button_gesture_feed(button_gesture_t *g, bool pressed, int64_t timestamp_us,
+                         button_gesture_emit_t emit, void *ctx)
+{
+    const button_gesture_config_t *cfg = &g->config;
+
+    // Prazos vencidos antes desta borda são resolvidos primeiro
+    button_gesture_poll(g, timestamp_us, emit, ctx);
+
+    if (pressed) {
+        if (is_held(g)) {
+            return; // Borda repetida
+        }
+        g->state = (g->state == GESTURE_WAIT_SECOND) ? GESTURE_DOWN_SECOND : GESTURE_DOWN;
+        g->press_us = timestamp_us;
+        g->long_sent = false;
+        g->repeated = false;
+        g->next_repeat_us = timestamp_us + cfg->repeat_delay_us;
+        g->repeat_interval_us = cfg->repeat_start_us;
+        emit(ctx, BUTTON_EVENT_PRESS, timestamp_us);
+        return;
+    }
+
+    if (!is_held(g)) {
+        return;
+    }
+    emit(ctx, BUTTON_EVENT_RELEASE, timestamp_us);
+
+    // Um pressionamento que virou long-press ou repeat não conta como clique
+    bool consumed = g->long_sent || g->repeated;
+
+    if (g->state == GESTURE_DOWN_SECOND) {
+        g->state = GESTURE_IDLE;
+        if (!consumed) {
+            emit(ctx, BUTTON_EVENT_DOUBLE_CLICK, timestamp_us);
+        }
+    } else if (consumed) {
+        g->state = GESTURE_IDLE;
+    } else if (cfg->double_click_us > 0) {
+        g->state = GESTURE_WAIT_SECOND;
+        g->release_us = timestamp_us;
+    } else {
+        g->state = GESTURE_IDLE;
+        emit(ctx, BUTTON_EVENT_CLICK, timestamp_us);
+    }
+}
+
+int64_t button_gesture_next_deadline(const button_gesture_t *g)
+{
+    const button_gesture_config_t *cfg = &g->config;
+    int64_t deadline = BUTTON_GESTURE_NO_DEADLINE;
+
+    if (is_held(g)) {
+        if (!g->long_sent && cfg->long_press_us > 0) {
+            deadline = g->press_us + cfg->long_press_us;
+        }
+        if (cfg->repeat_delay_us > 0 && g->next_repeat_us < deadline) {
+            deadline = g->next_repeat_us;
+        }
+    } else if (g->state == GESTURE_WAIT_SECOND) {
+        deadline = g->release_us + cfg->double_click_us;
+    }
+    return deadline;
+}
@@ -1,12 +1,17 @@
 #include "button_hal.h"
 #include "driver/gpio.h"
+#include "esp_attr.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+
+static bool isr_service_installed = false;
 
 void button_hal_configure(gpio_num_t gpio, button_pull_t pull)
 {
     gpio_config_t io_conf = {
         .pin_bit_mask = 1ULL << gpio,
         .mode = GPIO_MODE_INPUT,
-        .intr_type = GPIO_INTR_DISABLE
+        .intr_type = GPIO_INTR_ANYEDGE
     };
 
     switch (pull) {
@@ -31,3 +36,33 @@ bool button_hal_is_pressed(gpio_num_t gpio)
 {
     return gpio_get_level(gpio) == 0; // Pressionado = nível baixo
 }
+
+uint64_t IRAM_ATTR button_hal_read_levels(void)
+{
+    // GPIO_IN_REG cobre GPIO0-31 e GPIO_IN1_REG os demais
+    uint64_t low = REG_READ(GPIO_IN_REG);
+    uint64_t high = REG_READ(GPIO_IN1_REG);
+    return low | (high << 32);
+}
+
+esp_err_t button_hal_attach_isr(gpio_num_t gpio, gpio_isr_t handler, void *arg)
+{
+    if (!isr_service_installed) {
+        esp_err_t err = gpio_install_isr_service(0);
+        if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) { // INVALID_STATE = já instalado
+            return err;
+        }
+        isr_service_installed = true;
+    }
+    return gpio_isr_handler_add(gpio, handler, arg);
+}
+
+void IRAM_ATTR button_hal_intr_enable(gpio_num_t gpio)
+{
+    gpio_intr_enable(gpio);
+}
+
+void IRAM_ATTR button_hal_intr_disable(gpio_num_t gpio)
+{
+    gpio_intr_disable(gpio);
+}
@@ -1,67 +1,273 @@
 #include "button_manager.h"
 #include "button_hal.h"
+#include "button_debounce.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
+#include "freertos/semphr.h"
 #include <string.h>
 
-#define MAX_BUTTONS 10
-#define DEBOUNCE_TIME_MS 50
+#define TAG "BUTTON_MANAGER"
+
+#define MAX_BUTTONS 32
+#define SAMPLE_PERIOD_MS 10 // 4 amostras iguais = 40 ms de debounce
+#define EVENT_RING_SIZE 16 // Potência de 2
+#define GPIO_BIT(gpio) (1ULL << (gpio))
 
 typedef struct {
     gpio_num_t gpio_num;
     button_pull_t pull;
     button_callback_t callback;
-    bool last_state;
-    uint32_t last_change_time;
-    bool pressed_flag;
+    int64_t edge_time_us;       // Borda da ISR ainda não usada por um toggle; 0 se não houve
+    esp_timer_handle_t gesture_timer;
+    button_gesture_t gesture;
 } button_t;
 
 static button_t buttons[MAX_BUTTONS];
 static int button_count = 0;
+static int8_t button_index[GPIO_NUM_MAX]; // GPIO -> posição em buttons[], -1 se livre
+
+// Amostragem em lote: um bit por GPIO, todos os botões debounced de uma vez
+static portMUX_TYPE button_mux = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t sampler_timer = NULL;
+static button_debounce_t debounce;
+static uint64_t button_mask = 0;        // GPIOs configurados como botão
+static uint64_t irq_masked = 0;         // Pinos com interrupção desligada até estabilizar
+static bool sampler_running = false;
+static uint64_t pressed_state = 0;      // Cópia publicada de debounce.state
+static uint64_t pressed_latch = 0;      // Pressionamentos ainda não consumidos
+
+// Fila SPSC sem lock: produtor = task do esp_timer, consumidor = quem chama wait_event
+static button_event_t event_ring[EVENT_RING_SIZE];
+static uint32_t ring_head = 0; // Escrito só pelo produtor
+static uint32_t ring_tail = 0; // Escrito só pelo consumidor
+static SemaphoreHandle_t event_sem = NULL;
+
+static button_stats_t stats;
+
+static bool ring_push(const button_event_t *event)
+{
+    uint32_t head = __atomic_load_n(&ring_head, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= EVENT_RING_SIZE) {
+        return false;
+    }
+    event_ring[head & (EVENT_RING_SIZE - 1)] = *event;
+    __atomic_store_n(&ring_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static bool ring_pop(button_event_t *event)
+{
+    uint32_t tail = __atomic_load_n(&ring_tail, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+        return false;
+    }
+    *event = event_ring[tail & (EVENT_RING_SIZE - 1)];
+    __atomic_store_n(&ring_tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Chamada pelo reconhecedor de gestos, sempre na task do esp_timer
+static void emit_event(void *ctx, button_event_type_t type, int64_t timestamp_us)
+{
+    button_t *btn = (button_t *)ctx;
+    button_event_t event = {
+        .gpio = btn->gpio_num,
+        .type = type,
+        .timestamp_us = timestamp_us,
+    };
+
+    if (ring_push(&event)) {
+        stats.events++;
+        xSemaphoreGive(event_sem);
+    } else {
+        stats.dropped++;
+    }
+
+    if (type == BUTTON_EVENT_PRESS) {
+        if (btn->callback) {
+            btn->callback(btn->gpio_num);
+        }
+    }
+}
+
+static void schedule_gesture_timer(button_t *btn)
+{
+    esp_timer_stop(btn->gesture_timer);
+
+    int64_t deadline = button_gesture_next_deadline(&btn->gesture);
+    if (deadline == BUTTON_GESTURE_NO_DEADLINE) {
+        return;
+    }
+    int64_t delay_us = deadline - esp_timer_get_time();
+    esp_timer_start_once(btn->gesture_timer, delay_us > 0 ? delay_us : 0);
+}
+
+static void gesture_timer_cb(void *arg)
+{
+    button_t *btn = (button_t *)arg;
+    button_gesture_poll(&btn->gesture, esp_timer_get_time(), emit_event, btn);
+    schedule_gesture_timer(btn);
+}
+
+static inline uint64_t read_pressed(void)
+{
+    return ~button_hal_read_levels() & button_mask; // Ativo em nível baixo
+}
+
+static void IRAM_ATTR start_sampler_from_isr(void)
+{
+    bool start = false;
+    portENTER_CRITICAL_ISR(&button_mux);
+    if (!sampler_running) {
+        sampler_running = true;
+        start = true;
+    }
+    portEXIT_CRITICAL_ISR(&button_mux);
+    if (start) {
+        esp_timer_start_periodic(sampler_timer, SAMPLE_PERIOD_MS * 1000);
+    }
+}
+
+// Qualquer borda: silencia o pino e acorda o amostrador
+static void IRAM_ATTR button_isr_handler(void *arg)
+{
+    button_t *btn = (button_t *)arg;
+    button_hal_intr_disable(btn->gpio_num);
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL_ISR(&button_mux);
+    btn->edge_time_us = now;
+    irq_masked |= GPIO_BIT(btn->gpio_num);
+    portEXIT_CRITICAL_ISR(&button_mux);
+
+    start_sampler_from_isr();
+}
 
-static bool is_debounced_change(button_t *btn, bool current_state, uint32_t now_ms)
+static void handle_toggle(button_t *btn, bool pressed, int64_t sample_us)
 {
-    if (current_state != btn->last_state) {
-        if (now_ms - btn->last_change_time > DEBOUNCE_TIME_MS) {
-            btn->last_change_time = now_ms;
-            btn->last_state = current_state;
-            return true;
+    portENTER_CRITICAL(&button_mux);
+    int64_t edge_us = btn->edge_time_us;
+    btn->edge_time_us = 0;
+    portEXIT_CRITICAL(&button_mux);
+
+    // Sem borda nova da ISR o pino mudou mascarado (outro botão ainda instável, ou
+    // borda entre a última amostra e a reabilitação): vale o instante da amostra
+    if (edge_us == 0) {
+        edge_us = sample_us;
+    } else {
+        uint32_t latency_us = (uint32_t)(esp_timer_get_time() - edge_us);
+        if (latency_us > stats.max_latency_us) {
+            stats.max_latency_us = latency_us;
         }
     }
-    return false;
+
+    button_gesture_feed(&btn->gesture, pressed, edge_us, emit_event, btn);
+    schedule_gesture_timer(btn);
 }
 
-static void button_manager_task(void *arg)
+static void sampler_timer_cb(void *arg)
 {
-    while (1) {
-        uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
-        for (int i = 0; i < button_count; i++) {
-            bool pressed = button_hal_is_pressed(buttons[i].gpio_num);
-            if (is_debounced_change(&buttons[i], pressed, now)) {
-                if (pressed) {
-                    buttons[i].pressed_flag = true;
-                    if (buttons[i].callback) {
-                        buttons[i].callback(buttons[i].gpio_num);
-                    }
-                }
-            }
+    int64_t sample_us = esp_timer_get_time();
+    uint64_t sample = read_pressed();
+    uint64_t toggled = button_debounce_update(&debounce, sample);
+
+    portENTER_CRITICAL(&button_mux);
+    pressed_state = debounce.state;
+    pressed_latch |= toggled & debounce.state;
+    portEXIT_CRITICAL(&button_mux);
+
+    // Custo proporcional aos botões que mudaram, não ao total
+    while (toggled) {
+        int gpio = __builtin_ctzll(toggled);
+        toggled &= toggled - 1;
+        handle_toggle(&buttons[button_index[gpio]], (debounce.state >> gpio) & 1, sample_us);
+    }
+
+    if (button_debounce_busy(&debounce, sample)) {
+        return;
+    }
+
+    // Tudo estável: para de amostrar e volta a esperar interrupções
+    esp_timer_stop(sampler_timer);
+    portENTER_CRITICAL(&button_mux);
+    uint64_t masked = irq_masked;
+    irq_masked = 0;
+    sampler_running = false;
+    portEXIT_CRITICAL(&button_mux);
+
+    // Borda de um repique que não virou toggle não pode datar o próximo
+    while (masked) {
+        int gpio = __builtin_ctzll(masked);
+        masked &= masked - 1;
+        buttons[button_index[gpio]].edge_time_us = 0;
+        button_hal_intr_enable(gpio);
+    }
+
+    // Uma borda entre a última amostra e a reabilitação seria perdida
+    if (read_pressed() != debounce.state) {
+        portENTER_CRITICAL(&button_mux);
+        bool start = !sampler_running;
+        sampler_running = true;
+        portEXIT_CRITICAL(&button_mux);
+        if (start) {
+            esp_timer_start_periodic(sampler_timer, SAMPLE_PERIOD_MS * 1000);
         }
-        vTaskDelay(pdMS_TO_TICKS(10));
     }
 }
 
 esp_err_t button_manager_add_button(gpio_num_t gpio, button_pull_t pull, button_callback_t callback)
 {
     if (button_count >= MAX_BUTTONS) return ESP_ERR_NO_MEM;
+    if (gpio < 0 || gpio >= GPIO_NUM_MAX || button_index[gpio] >= 0) return ESP_ERR_INVALID_ARG;
+
+    button_t *btn = &buttons[button_count];
 
     button_hal_configure(gpio, pull);
 
-    buttons[button_count].gpio_num = gpio;
-    buttons[button_count].pull = pull;
-    buttons[button_count].callback = callback;
-    buttons[button_count].last_state = false;
-    buttons[button_count].last_change_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-    buttons[button_count].pressed_flag = false;
+    btn->gpio_num = gpio;
+    btn->pull = pull;
+    btn->callback = callback;
+    btn->edge_time_us = 0;
+
+    button_gesture_config_t config = BUTTON_GESTURE_CONFIG_DEFAULT();
+    button_gesture_init(&btn->gesture, &config);
+
+    const esp_timer_create_args_t gesture_args = {
+        .callback = gesture_timer_cb,
+        .arg = btn,
+        .name = "button_gesture"
+    };
+    esp_err_t err = esp_timer_create(&gesture_args, &btn->gesture_timer);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Erro ao criar timer de gestos: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    // Entra no lote com o nível atual como estado estável
+    portENTER_CRITICAL(&button_mux);
+    button_index[gpio] = button_count;
+    button_mask |= GPIO_BIT(gpio);
+    if (button_hal_is_pressed(gpio)) {
+        debounce.state |= GPIO_BIT(gpio);
+    }
+    pressed_state = debounce.state;
+    portEXIT_CRITICAL(&button_mux);
+
+    err = button_hal_attach_isr(gpio, button_isr_handler, btn);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Erro ao registrar ISR do GPIO %d: %s", gpio, esp_err_to_name(err));
+        portENTER_CRITICAL(&button_mux);
+        button_index[gpio] = -1;
+        button_mask &= ~GPIO_BIT(gpio);
+        debounce.state &= ~GPIO_BIT(gpio);
+        portEXIT_CRITICAL(&button_mux);
+        esp_timer_delete(btn->gesture_timer);
+        return err;
+    }
 
     button_count++;
     return ESP_OK;
@@ -69,7 +275,15 @@ esp_err_t button_manager_add_button(gpio_num_t gpio, button_pull_t pull, button_
 
 void button_manager_init(void)
 {
-    xTaskCreate(button_manager_task, "button_manager_task", 2048, NULL, 5, NULL);
+    memset(button_index, -1, sizeof(button_index));
+    button_debounce_init(&debounce, 0);
+    event_sem = xSemaphoreCreateBinary();
+
+    const esp_timer_create_args_t sampler_args = {
+        .callback = sampler_timer_cb,
+        .name = "button_sampler"
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&sampler_args, &sampler_timer));
 }
 
 bool button_manager_is_pressed(gpio_num_t gpio)
@@ -79,13 +293,57 @@ bool button_manager_is_pressed(gpio_num_t gpio)
 
 bool button_manager_was_pressed(gpio_num_t gpio)
 {
-    for (int i = 0; i < button_count; i++) {
-        if (buttons[i].gpio_num == gpio) {
-            if (buttons[i].pressed_flag) {
-                buttons[i].pressed_flag = false;
-                return true;
-            }
+    if (gpio < 0 || gpio >= GPIO_NUM_MAX) {
+        return false;
+    }
+    portENTER_CRITICAL(&button_mux);
+    bool pressed = (pressed_latch & GPIO_BIT(gpio)) != 0;
+    pressed_latch &= ~GPIO_BIT(gpio);
+    portEXIT_CRITICAL(&button_mux);
+    return pressed;
+}
+
+uint64_t button_manager_pressed_mask(void)
+{
+    portENTER_CRITICAL(&button_mux);
+    uint64_t mask = pressed_state;
+    portEXIT_CRITICAL(&button_mux);
+    return mask;
+}
+
+uint64_t button_manager_take_pressed_mask(void)
+{
+    portENTER_CRITICAL(&button_mux);
+    uint64_t mask = pressed_latch;
+    pressed_latch = 0;
+    portEXIT_CRITICAL(&button_mux);
+    return mask;
+}
+
+bool button_manager_wait_event(button_event_t *event, TickType_t timeout)
+{
+    // Tenta a fila antes de bloquear para não perder um give já consumido
+    while (!ring_pop(event)) {
+        if (xSemaphoreTake(event_sem, timeout) != pdTRUE) {
+            return ring_pop(event);
         }
     }
-    return false;
-}
\ No newline at end of file
+    return true;
+}
+
+void button_manager_get_stats(button_stats_t *out)
+{
+    *out = stats;
+}
+
+esp_err_t button_manager_set_gesture_config(gpio_num_t gpio, const button_gesture_config_t *config)
+{
+    if (gpio < 0 || gpio >= GPIO_NUM_MAX || button_index[gpio] < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    button_t *btn = &buttons[button_index[gpio]];
+    // Feito na configuração, antes de o botão estar em uso
+    esp_timer_stop(btn->gesture_timer);
+    button_gesture_init(&btn->gesture, config);
+    return ESP_OK;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+
+// Debounce bit-paralelo com contadores verticais de 2 bits: cada bit das
+// palavras é um canal independente, então o custo não depende de quantos
+// botões existem. Um bit só muda após 4 amostras seguidas diferentes do
+// estado atual. Lógica pura, sem acesso a hardware.
+
+typedef struct {
+    uint64_t state;     // Estado debounced
+    uint64_t cnt0;      // Bit menos significativo dos contadores
+    uint64_t cnt1;      // Bit mais significativo dos contadores
+} button_debounce_t;
+
+void button_debounce_init(button_debounce_t *db, uint64_t initial_state);
+
+/**
+ * @brief Processa uma amostra de todos os canais.
+ *
+ * @return Máscara dos canais cujo estado debounced mudou nesta amostra.
+ */
+uint64_t button_debounce_update(button_debounce_t *db, uint64_t sample);
+
+/**
+ * @brief Indica se algum canal ainda está em transição.
+ */
+static inline int button_debounce_busy(const button_debounce_t *db, uint64_t sample)
+{
+    return ((sample ^ db->state) | db->cnt0 | db->cnt1) != 0;
+}
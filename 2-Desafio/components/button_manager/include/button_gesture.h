@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Lógica pura de gestos: recebe bordas já debounced com timestamp e emite eventos.
+// Não depende de GPIO, timers ou FreeRTOS.
+
+typedef enum {
+    BUTTON_EVENT_PRESS,
+    BUTTON_EVENT_RELEASE,
+    BUTTON_EVENT_CLICK,
+    BUTTON_EVENT_DOUBLE_CLICK,
+    BUTTON_EVENT_LONG_PRESS,
+    BUTTON_EVENT_REPEAT
+} button_event_type_t;
+
+typedef struct {
+    uint32_t double_click_us;   // Janela para o segundo clique (0 = CLICK imediato)
+    uint32_t long_press_us;     // Tempo segurando até LONG_PRESS (0 = desabilitado)
+    uint32_t repeat_delay_us;   // Atraso até o primeiro REPEAT (0 = desabilitado)
+    uint32_t repeat_start_us;   // Intervalo inicial entre REPEATs
+    uint32_t repeat_min_us;     // Intervalo mínimo após a aceleração
+    uint8_t repeat_accel_pct;   // Cada REPEAT reduz o intervalo para esta porcentagem
+} button_gesture_config_t;
+
+#define BUTTON_GESTURE_CONFIG_DEFAULT() {   \
+    .double_click_us = 300000,              \
+    .long_press_us = 800000,                \
+    .repeat_delay_us = 0,                   \
+    .repeat_start_us = 200000,              \
+    .repeat_min_us = 40000,                 \
+    .repeat_accel_pct = 80,                 \
+}
+
+#define BUTTON_GESTURE_NO_DEADLINE INT64_MAX
+
+typedef void (*button_gesture_emit_t)(void *ctx, button_event_type_t type, int64_t timestamp_us);
+
+typedef enum {
+    GESTURE_IDLE,
+    GESTURE_DOWN,           // Primeiro pressionamento
+    GESTURE_WAIT_SECOND,    // Solto, aguardando possível duplo clique
+    GESTURE_DOWN_SECOND     // Segundo pressionamento dentro da janela
+} button_gesture_state_t;
+
+typedef struct {
+    button_gesture_config_t config;
+    button_gesture_state_t state;
+    int64_t press_us;
+    int64_t release_us;
+    int64_t next_repeat_us;
+    uint32_t repeat_interval_us;
+    bool long_sent;
+    bool repeated;
+} button_gesture_t;
+
+void button_gesture_init(button_gesture_t *g, const button_gesture_config_t *config);
+
+/**
+ * @brief Processa uma borda debounced.
+ *
+ * @param pressed Novo estado do botão.
+ * @param timestamp_us Instante da borda.
+ */
+void button_gesture_feed(button_gesture_t *g, bool pressed, int64_t timestamp_us,
+                         button_gesture_emit_t emit, void *ctx);
+
+/**
+ * @brief Emite os eventos cujo prazo venceu até now_us (long-press, repeat, clique pendente).
+ */
+void button_gesture_poll(button_gesture_t *g, int64_t now_us, button_gesture_emit_t emit, void *ctx);
+
+/**
+ * @brief Próximo instante em que button_gesture_poll() precisa ser chamada.
+ *
+ * @return Timestamp em us, ou BUTTON_GESTURE_NO_DEADLINE.
+ */
+int64_t button_gesture_next_deadline(const button_gesture_t *g);
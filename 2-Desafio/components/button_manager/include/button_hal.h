@@ -2,6 +2,7 @@
 
 #include "driver/gpio.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef enum {
     BUTTON_PULL_NONE,
@@ -11,3 +12,15 @@ typedef enum {
 
 void button_hal_configure(gpio_num_t gpio, button_pull_t pull);
 bool button_hal_is_pressed(gpio_num_t gpio);
+
+/**
+ * @brief Lê o nível de todos os GPIOs de uma vez (bit n = GPIO n).
+ *
+ * Um bit em 1 significa nível alto; os botões são ativos em nível baixo.
+ */
+uint64_t button_hal_read_levels(void);
+
+// Interrupção em ambas as bordas; o serviço de ISR é instalado na primeira chamada
+esp_err_t button_hal_attach_isr(gpio_num_t gpio, gpio_isr_t handler, void *arg);
+void button_hal_intr_enable(gpio_num_t gpio);
+void button_hal_intr_disable(gpio_num_t gpio);
@@ -2,11 +2,50 @@
 
 #include "driver/gpio.h"
 #include "esp_err.h"
+#include "freertos/FreeRTOS.h"
 #include "button_hal.h"
+#include "button_gesture.h"
 
 typedef void (*button_callback_t)(gpio_num_t gpio);
 
+typedef struct {
+    gpio_num_t gpio;
+    button_event_type_t type;
+    int64_t timestamp_us;   // Instante do gesto (esp_timer_get_time)
+} button_event_t;
+
+typedef struct {
+    uint32_t events;
+    uint32_t dropped;           // Eventos perdidos com a fila cheia
+    uint32_t max_latency_us;    // Maior atraso entre a borda e o evento
+} button_stats_t;
+
 esp_err_t button_manager_add_button(gpio_num_t gpio, button_pull_t pull, button_callback_t callback);
 void button_manager_init(void);
 bool button_manager_is_pressed(gpio_num_t gpio);
 bool button_manager_was_pressed(gpio_num_t gpio);
+
+/**
+ * @brief Estado debounced de todos os botões (bit n = GPIO n pressionado).
+ */
+uint64_t button_manager_pressed_mask(void);
+
+/**
+ * @brief Botões pressionados desde a última chamada (bit n = GPIO n); limpa os bits.
+ */
+uint64_t button_manager_take_pressed_mask(void);
+
+/**
+ * @brief Ajusta os limites de tempo dos gestos de um botão já registrado.
+ */
+esp_err_t button_manager_set_gesture_config(gpio_num_t gpio, const button_gesture_config_t *config);
+
+/**
+ * @brief Aguarda o próximo evento de botão (press, release, clique, long-press, repeat...).
+ *
+ * @param event Evento recebido.
+ * @param timeout Tempo máximo de espera em ticks.
+ * @return true se um evento foi recebido, false em caso de timeout.
+ */
+bool button_manager_wait_event(button_event_t *event, TickType_t timeout);
+void button_manager_get_stats(button_stats_t *stats);
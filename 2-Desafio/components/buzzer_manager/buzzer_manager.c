@@ -1,84 +1,265 @@
 #include "buzzer_manager.h"
 #include "buzzer_hal.h"
+#include "buzzer_sequencer.h"
+#include "buzzer_rtttl.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include <stdlib.h>
 
 #define TAG "BUZZER_MANAGER"
 
-typedef struct {
-    int freq;
-    int duration_ms;
-} buzzer_note_t;
+#define BUZZER_QUEUE_LEN 8
+#define BUZZER_PENDING_MAX 4
+#define BUZZER_RTTTL_MAX_NOTES 64
 
-static const buzzer_note_t melody_beep[] = {
-    { 1000, 100 }, { -1, 0 }
-};
+// Bits de notificação da buzzer_task
+#define BUZZER_NOTIFY_CMD  (1 << 0) // Há comandos na fila
+#define BUZZER_NOTIFY_DONE (1 << 1) // O sequenciador terminou a melodia done_seq_id
 
-static const buzzer_note_t melody_normal[] = {
-    { 880, 150 }, { 0, 100 },
-    { 880, 150 }, { 0, 100 },
-    { 988, 200 }, { 0, 300 },
-    { -1, 0 },
-};
+typedef enum {
+    BUZZER_CMD_PLAY,
+    BUZZER_CMD_ENQUEUE,
+    BUZZER_CMD_STOP
+} buzzer_cmd_type_t;
 
-static const buzzer_note_t melody_alarm[] = {
-    { 1200, 200 }, { 0, 100 }, { 1200, 200 }, { -1, 0 }
-};
+typedef struct {
+    buzzer_cmd_type_t type;
+    buzzer_melody_t melody;
+    const char *rtttl;  // Se não for NULL, substitui melody
+    uint32_t duration_ms;
+    buzzer_priority_t priority;
+    int64_t request_us;
+} buzzer_cmd_t;
 
-static const buzzer_note_t melody_special[] = {
-    { 800, 100 }, { 1000, 100 }, { 1200, 100 }, { -1, 0 }
+// Melodias embutidas em RTTTL, compiladas uma vez no init pelo mesmo caminho de
+// buzzer_manager_play_rtttl. Com b=150: 16 = 100 ms, 16 pontuada = 150 ms, 8 = 200 ms, 8 pontuada = 300 ms
+static const char *const builtin_rtttl[] = {
+    [BUZZER_MELODY_BEEP] = "beep:d=16,o=5,b=150:b",
+    [BUZZER_MELODY_NORMAL] = "normal:d=16,o=5,b=150:a.,p,a.,p,8b,8p.",
+    [BUZZER_MELODY_ALARM] = "alarm:d=8,o=6,b=150:d,16p,d",
+    [BUZZER_MELODY_SPECIAL] = "special:d=16,o=5,b=150:g,b,d6",
 };
 
+#define BUILTIN_COUNT (sizeof(builtin_rtttl) / sizeof(builtin_rtttl[0]))
+#define BUILTIN_MAX_NOTES 8
+
+static QueueHandle_t buzzer_queue = NULL;
 static TaskHandle_t buzzer_task_handle = NULL;
-static volatile bool stop_requested = false;
+static volatile uint32_t done_seq_id = 0;
+static volatile bool playing = false;
+static buzzer_stats_t stats;                  // Escrito por send_cmd, na task de quem chama, e pela buzzer_task
+static portMUX_TYPE stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Estado do player, acessado só pela buzzer_task
+static buzzer_cmd_t current;
+static uint32_t current_seq_id = 0;
+static buzzer_cmd_t pending[BUZZER_PENDING_MAX];
+static int pending_count = 0;
+static buzzer_note_t rtttl_notes[2][BUZZER_RTTTL_MAX_NOTES]; // Alterna para não sobrescrever a melodia em curso
+static int rtttl_slot = 0;
+static buzzer_note_t builtin_notes[BUILTIN_COUNT][BUILTIN_MAX_NOTES];
+
+static void compile_builtin_melodies(void) {
+    for (size_t i = 0; i < BUILTIN_COUNT; i++) {
+        builtin_notes[i][0] = (buzzer_note_t) { -1, 0 };
+        if (builtin_rtttl[i] && buzzer_rtttl_compile(builtin_rtttl[i], builtin_notes[i], BUILTIN_MAX_NOTES) <= 0) {
+            ESP_LOGE(TAG, "Melodia embutida %u inválida", (unsigned)i);
+        }
+    }
+}
 
 static const buzzer_note_t* get_melody(buzzer_melody_t melody) {
-    switch (melody) {
-        case BUZZER_MELODY_BEEP: return melody_beep;
-        case BUZZER_MELODY_NORMAL: return melody_normal;
-        case BUZZER_MELODY_ALARM: return melody_alarm;
-        case BUZZER_MELODY_SPECIAL: return melody_special;
-        default: return NULL;
+    if (melody <= BUZZER_MELODY_NONE || melody >= BUILTIN_COUNT || builtin_notes[melody][0].freq == -1) {
+        return NULL;
     }
+    return builtin_notes[melody];
 }
 
-static void buzzer_task(void *param) {
-    buzzer_melody_t melody = (buzzer_melody_t)(intptr_t)param;
-    const buzzer_note_t *notes = get_melody(melody);
+// Notificação em vez da fila: com a fila cheia o fim da melodia não pode se perder,
+// senão `playing` ficaria preso e toda melodia de prioridade menor seria descartada
+static void on_sequence_done(uint32_t seq_id) {
+    done_seq_id = seq_id;
+    xTaskNotify(buzzer_task_handle, BUZZER_NOTIFY_DONE, eSetBits);
+}
 
-    uint32_t elapsed = 0;
-    const uint32_t max_duration = 10000; // fallback
+static const buzzer_note_t* resolve_notes(const buzzer_cmd_t *cmd) {
+    if (!cmd->rtttl) {
+        return get_melody(cmd->melody);
+    }
+    rtttl_slot ^= 1;
+    if (buzzer_rtttl_compile(cmd->rtttl, rtttl_notes[rtttl_slot], BUZZER_RTTTL_MAX_NOTES) <= 0) {
+        ESP_LOGW(TAG, "Melodia RTTTL inválida");
+        return NULL;
+    }
+    return rtttl_notes[rtttl_slot];
+}
+
+static void player_start(const buzzer_cmd_t *cmd) {
+    const buzzer_note_t *notes = resolve_notes(cmd);
+    if (!notes) {
+        return;
+    }
+
+    current = *cmd;
+    playing = true;
+    current_seq_id = buzzer_sequencer_start(notes, cmd->duration_ms);
 
-    while (notes && notes->freq != -1 && !stop_requested && elapsed < max_duration) {
-        buzzer_hal_play_note(notes->freq, notes->duration_ms);
-        vTaskDelay(pdMS_TO_TICKS(notes->duration_ms));
-        elapsed += notes->duration_ms;
-        notes++;
+    uint32_t latency_us = (uint32_t)(esp_timer_get_time() - cmd->request_us);
+    portENTER_CRITICAL(&stats_mux);
+    stats.played++;
+    stats.last_start_latency_us = latency_us;
+    if (latency_us > stats.max_start_latency_us) {
+        stats.max_start_latency_us = latency_us;
     }
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+static void player_next(void) {
+    playing = false;
+    if (pending_count > 0) {
+        buzzer_cmd_t next = pending[0];
+        for (int i = 1; i < pending_count; i++) {
+            pending[i - 1] = pending[i];
+        }
+        pending_count--;
+        player_start(&next);
+    }
+}
 
-    buzzer_hal_stop();
-    buzzer_task_handle = NULL;
-    vTaskDelete(NULL);
+static void handle_cmd(const buzzer_cmd_t *cmd) {
+    switch (cmd->type) {
+        case BUZZER_CMD_STOP:
+            pending_count = 0;
+            buzzer_sequencer_stop();
+            playing = false;
+            break;
+        case BUZZER_CMD_PLAY:
+            if (playing && cmd->priority < current.priority) {
+                portENTER_CRITICAL(&stats_mux);
+                stats.dropped++;
+                portEXIT_CRITICAL(&stats_mux);
+                break;
+            }
+            if (playing) {
+                portENTER_CRITICAL(&stats_mux);
+                stats.preempted++;
+                portEXIT_CRITICAL(&stats_mux);
+            }
+            player_start(cmd);
+            break;
+        case BUZZER_CMD_ENQUEUE:
+            if (!playing) {
+                player_start(cmd);
+            } else if (pending_count < BUZZER_PENDING_MAX) {
+                pending[pending_count++] = *cmd;
+            } else {
+                portENTER_CRITICAL(&stats_mux);
+                stats.dropped++;
+                portEXIT_CRITICAL(&stats_mux);
+            }
+            break;
+    }
+}
+
+// A task só trata comandos; as trocas de nota ficam com o esp_timer do sequenciador
+static void buzzer_task(void *param) {
+    buzzer_cmd_t cmd;
+    while (1) {
+        uint32_t bits = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &bits, portMAX_DELAY);
+
+        // Conclusões de melodias já interrompidas são ignoradas
+        if ((bits & BUZZER_NOTIFY_DONE) && playing && done_seq_id == current_seq_id) {
+            player_next();
+        }
+        while (xQueueReceive(buzzer_queue, &cmd, 0) == pdTRUE) {
+            handle_cmd(&cmd);
+        }
+    }
 }
 
 void buzzer_manager_init(void) {
     buzzer_hal_init();
+    compile_builtin_melodies();
+    buzzer_sequencer_init(on_sequence_done);
+
+    buzzer_queue = xQueueCreate(BUZZER_QUEUE_LEN, sizeof(buzzer_cmd_t));
+    if (buzzer_queue == NULL) {
+        ESP_LOGE(TAG, "Erro ao criar fila do buzzer");
+        return;
+    }
+    xTaskCreate(buzzer_task, "buzzer_task", 2048, NULL, 5, &buzzer_task_handle);
 }
 
-esp_err_t buzzer_manager_play(buzzer_melody_t melody, uint32_t duration_ms) {
-    if (buzzer_task_handle != NULL) return ESP_FAIL;
+static esp_err_t send_cmd(buzzer_cmd_type_t type, buzzer_melody_t melody, const char *rtttl,
+                          uint32_t duration_ms, buzzer_priority_t priority) {
+    if (buzzer_queue == NULL) return ESP_ERR_INVALID_STATE;
+
+    buzzer_cmd_t cmd = {
+        .type = type,
+        .melody = melody,
+        .rtttl = rtttl,
+        .duration_ms = duration_ms,
+        .priority = priority,
+        .request_us = esp_timer_get_time(),
+    };
+
+    BaseType_t ok = (type == BUZZER_CMD_STOP)
+        ? xQueueSendToFront(buzzer_queue, &cmd, 0)
+        : xQueueSend(buzzer_queue, &cmd, 0);
+    if (ok != pdTRUE) {
+        portENTER_CRITICAL(&stats_mux);
+        stats.dropped++;
+        portEXIT_CRITICAL(&stats_mux);
+        return ESP_FAIL;
+    }
+    xTaskNotify(buzzer_task_handle, BUZZER_NOTIFY_CMD, eSetBits);
 
-    stop_requested = false;
-    xTaskCreate(buzzer_task, "buzzer_task", 2048, (void *)(intptr_t)melody, 5, &buzzer_task_handle);
+    UBaseType_t depth = uxQueueMessagesWaiting(buzzer_queue);
+    portENTER_CRITICAL(&stats_mux);
+    if (depth > stats.max_queue_depth) {
+        stats.max_queue_depth = depth;
+    }
+    portEXIT_CRITICAL(&stats_mux);
     return ESP_OK;
 }
 
+esp_err_t buzzer_manager_play(buzzer_melody_t melody, uint32_t duration_ms) {
+    return send_cmd(BUZZER_CMD_PLAY, melody, NULL, duration_ms, BUZZER_PRIORITY_UI);
+}
+
+esp_err_t buzzer_manager_play_priority(buzzer_melody_t melody, uint32_t duration_ms, buzzer_priority_t priority) {
+    return send_cmd(BUZZER_CMD_PLAY, melody, NULL, duration_ms, priority);
+}
+
+esp_err_t buzzer_manager_enqueue(buzzer_melody_t melody, uint32_t duration_ms, buzzer_priority_t priority) {
+    return send_cmd(BUZZER_CMD_ENQUEUE, melody, NULL, duration_ms, priority);
+}
+
+esp_err_t buzzer_manager_play_rtttl(const char *rtttl, uint32_t duration_ms, buzzer_priority_t priority) {
+    if (rtttl == NULL) return ESP_ERR_INVALID_ARG;
+    return send_cmd(BUZZER_CMD_PLAY, BUZZER_MELODY_NONE, rtttl, duration_ms, priority);
+}
+
 void buzzer_manager_stop(void) {
-    stop_requested = true;
+    send_cmd(BUZZER_CMD_STOP, BUZZER_MELODY_NONE, NULL, 0, BUZZER_PRIORITY_UI);
 }
 
 bool buzzer_manager_is_playing(void) {
-    return buzzer_task_handle != NULL;
+    return playing;
+}
+
+void buzzer_manager_get_stats(buzzer_stats_t *out) {
+    portENTER_CRITICAL(&stats_mux);
+    *out = stats;
+    portEXIT_CRITICAL(&stats_mux);
+    out->queue_depth = buzzer_queue ? uxQueueMessagesWaiting(buzzer_queue) : 0;
+
+    buzzer_timing_stats_t timing;
+    buzzer_sequencer_get_timing(&timing);
+    out->timing_max_error_us = timing.max_error_us;
+    out->timing_avg_error_us = timing.avg_error_us;
 }
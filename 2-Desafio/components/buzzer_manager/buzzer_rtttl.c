@@ -0,0 +1,132 @@
+#include "buzzer_rtttl.h"
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Frequências da oitava 4 (Hz x 100) para c, c#, d, d#, e, f, f#, g, g#, a, a#, b
+static const uint32_t octave4_centihz[12] = {
+    26163, 27718, 29366, 31113, 32963, 34923, 36999, 39200, 41530, 44000, 46616, 49388
+};
+
+static int parse_int(const char **p)
+{
+    int value = 0;
+    while (isdigit((unsigned char)**p)) {
+        value = value * 10 + (**p - '0');
+        (*p)++;
+    }
+    return value;
+}
+
+static int note_index(char c)
+{
+    switch (c) {
+        case 'c': return 0;
+        case 'd': return 2;
+        case 'e': return 4;
+        case 'f': return 5;
+        case 'g': return 7;
+        case 'a': return 9;
+        case 'b': return 11;
+        default: return -1;
+    }
+}
+
+static int16_t note_freq(int index, int octave)
+{
+    uint32_t centihz = octave4_centihz[index];
+    if (octave >= 4) {
+        centihz <<= (octave - 4);
+    } else {
+        centihz >>= (4 - octave);
+    }
+    return (int16_t)((centihz + 50) / 100);
+}
+
+int buzzer_rtttl_compile(const char *rtttl, buzzer_note_t *out, int max_notes)
+{
+    if (!rtttl || !out || max_notes < 1) {
+        return -1;
+    }
+
+    // Nome
+    const char *p = strchr(rtttl, ':');
+    if (!p) {
+        return -1;
+    }
+    p++;
+
+    // Padrões: d=duração, o=oitava, b=batidas por minuto
+    int def_duration = 4, def_octave = 6, bpm = 63;
+    while (*p && *p != ':') {
+        char key = tolower((unsigned char)*p);
+        if (key == ' ' || key == ',') {
+            p++;
+            continue;
+        }
+        p++;
+        if (*p != '=') {
+            return -1;
+        }
+        p++;
+        int value = parse_int(&p);
+        if (key == 'd' && value > 0) def_duration = value;
+        else if (key == 'o' && value >= 3 && value <= 7) def_octave = value;
+        else if (key == 'b' && value > 0) bpm = value;
+    }
+    if (*p != ':') {
+        return -1;
+    }
+    p++;
+
+    // Semibreve em ms: 4 batidas
+    uint32_t whole_ms = (60000UL * 4) / bpm;
+    int count = 0;
+
+    while (*p && count < max_notes - 1) {
+        while (*p == ' ' || *p == ',') p++;
+        if (!*p) break;
+
+        int duration = parse_int(&p);
+        if (duration <= 0) duration = def_duration;
+
+        char c = tolower((unsigned char)*p);
+        if (!c) break;
+        p++;
+        int index = note_index(c);
+        if (index < 0 && c != 'p') {
+            return -1;
+        }
+        if (*p == '#') {
+            index++;
+            p++;
+        }
+
+        bool dotted = false;
+        if (*p == '.') {
+            dotted = true;
+            p++;
+        }
+        int octave = isdigit((unsigned char)*p) ? parse_int(&p) : def_octave;
+        if (*p == '.') {
+            dotted = true;
+            p++;
+        }
+
+        uint32_t ms = whole_ms / duration;
+        if (dotted) ms += ms / 2;
+        if (ms == 0) {
+            return -1; // bpm ou duração altos demais: a nota não dura nem 1 ms
+        }
+        if (ms > UINT16_MAX) ms = UINT16_MAX;
+
+        out[count].freq = (c == 'p') ? 0 : note_freq(index % 12, octave + index / 12);
+        out[count].duration_ms = (uint16_t)ms;
+        count++;
+    }
+
+    out[count].freq = -1;
+    out[count].duration_ms = 0;
+    return count;
+}
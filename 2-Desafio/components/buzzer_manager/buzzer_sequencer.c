@@ -0,0 +1,144 @@
+#include "buzzer_sequencer.h"
+#include "buzzer_hal.h"
+#include "esp_timer.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <stdbool.h>
+
+#define SEQUENCER_MAX_DURATION_MS 10000 // Limite de uma melodia tocada uma vez (duration_ms == 0)
+
+static esp_timer_handle_t note_timer = NULL;
+static SemaphoreHandle_t seq_mutex = NULL;
+static buzzer_sequencer_done_cb_t on_done = NULL;
+
+// Estado protegido por seq_mutex
+static const buzzer_note_t *melody_start = NULL;
+static const buzzer_note_t *note = NULL;
+static bool looping = false;
+static int64_t end_us = 0;          // Fim absoluto da reprodução
+static int64_t next_change_us = 0;  // Próxima troca de nota no cronograma ideal
+static uint32_t current_id = 0;
+
+static uint32_t timing_notes = 0;
+static uint32_t timing_max_us = 0;
+static uint64_t timing_sum_us = 0;
+
+// Toca a nota atual e agenda a próxima troca; false se a melodia acabou
+static bool play_current(void)
+{
+    // Notas de duração zero são puladas: em laço, só elas rearmariam o timer para sempre
+    bool wrapped = false;
+    while (note->freq == -1 || note->duration_ms == 0) {
+        if (note->freq != -1) {
+            note++;
+            continue;
+        }
+        if (!looping || wrapped) {
+            return false;
+        }
+        wrapped = true;
+        note = melody_start;
+    }
+    if (next_change_us >= end_us) {
+        return false;
+    }
+
+    int64_t change_us = next_change_us + (int64_t)note->duration_ms * 1000;
+    if (change_us > end_us) {
+        change_us = end_us; // Trunca a última nota
+    }
+    buzzer_hal_play_note(note->freq, (int)((change_us - next_change_us) / 1000));
+    next_change_us = change_us;
+
+    int64_t delay_us = next_change_us - esp_timer_get_time();
+    esp_timer_start_once(note_timer, delay_us > 0 ? delay_us : 0);
+    return true;
+}
+
+static void note_timer_cb(void *arg)
+{
+    xSemaphoreTake(seq_mutex, portMAX_DELAY);
+    if (note == NULL) {
+        xSemaphoreGive(seq_mutex);
+        return; // Parado enquanto o timer disparava
+    }
+
+    int64_t late_us = esp_timer_get_time() - next_change_us;
+    uint32_t error_us = (uint32_t)(late_us < 0 ? -late_us : late_us);
+    timing_notes++;
+    timing_sum_us += error_us;
+    if (error_us > timing_max_us) {
+        timing_max_us = error_us;
+    }
+
+    note++;
+    bool more = play_current();
+    uint32_t id = current_id;
+    if (!more) {
+        note = NULL;
+        buzzer_hal_stop();
+    }
+    xSemaphoreGive(seq_mutex);
+
+    if (!more && on_done) {
+        on_done(id);
+    }
+}
+
+void buzzer_sequencer_init(buzzer_sequencer_done_cb_t done_cb)
+{
+    on_done = done_cb;
+    seq_mutex = xSemaphoreCreateMutex();
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = note_timer_cb,
+        .name = "buzzer_note"
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &note_timer));
+}
+
+uint32_t buzzer_sequencer_start(const buzzer_note_t *notes, uint32_t duration_ms)
+{
+    xSemaphoreTake(seq_mutex, portMAX_DELAY);
+    esp_timer_stop(note_timer);
+
+    uint32_t limit_ms = duration_ms ? duration_ms : SEQUENCER_MAX_DURATION_MS;
+
+    uint32_t id = ++current_id;
+    melody_start = notes;
+    note = notes;
+    looping = (duration_ms != 0);
+    next_change_us = esp_timer_get_time();
+    end_us = next_change_us + (int64_t)limit_ms * 1000;
+
+    bool started = notes && notes->freq != -1 && play_current();
+    if (!started) {
+        note = NULL;
+        buzzer_hal_stop();
+    }
+    xSemaphoreGive(seq_mutex);
+
+    if (!started && on_done) {
+        on_done(id);
+    }
+    return id;
+}
+
+void buzzer_sequencer_stop(void)
+{
+    xSemaphoreTake(seq_mutex, portMAX_DELAY);
+    esp_timer_stop(note_timer);
+    note = NULL;
+    buzzer_hal_stop();
+    xSemaphoreGive(seq_mutex);
+}
+
+void buzzer_sequencer_get_timing(buzzer_timing_stats_t *stats)
+{
+    xSemaphoreTake(seq_mutex, portMAX_DELAY);
+    stats->notes = timing_notes;
+    stats->max_error_us = timing_max_us;
+    stats->avg_error_us = timing_notes ? (uint32_t)(timing_sum_us / timing_notes) : 0;
+    xSemaphoreGive(seq_mutex);
+}
@@ -2,6 +2,7 @@
 
 #include "esp_err.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef enum {
     BUZZER_MELODY_NONE = 0,
@@ -11,7 +12,50 @@ typedef enum {
     BUZZER_MELODY_SPECIAL
 } buzzer_melody_t;
 
+// Prioridade maior interrompe a melodia em curso; menor é descartada
+typedef enum {
+    BUZZER_PRIORITY_UI = 0,
+    BUZZER_PRIORITY_NORMAL,
+    BUZZER_PRIORITY_ALARM
+} buzzer_priority_t;
+
+typedef struct {
+    uint32_t played;
+    uint32_t preempted;
+    uint32_t dropped;
+    uint32_t queue_depth;           // Comandos aguardando na fila agora
+    uint32_t max_queue_depth;
+    uint32_t last_start_latency_us; // Do pedido até a primeira nota
+    uint32_t max_start_latency_us;
+    uint32_t timing_max_error_us;   // Atraso das trocas de nota vs. cronograma ideal
+    uint32_t timing_avg_error_us;
+} buzzer_stats_t;
+
+/**
+ * @brief Inicializa o buzzer e a task do player.
+ */
 void buzzer_manager_init(void);
+
+/**
+ * @brief Toca uma melodia com prioridade de interface.
+ *
+ * @param duration_ms Duração total; a melodia repete ou é truncada. 0 toca uma vez.
+ */
 esp_err_t buzzer_manager_play(buzzer_melody_t melody, uint32_t duration_ms);
+esp_err_t buzzer_manager_play_priority(buzzer_melody_t melody, uint32_t duration_ms, buzzer_priority_t priority);
+
+/**
+ * @brief Toca uma melodia RTTTL ("nome:d=4,o=5,b=100:8e6,8d#6,...").
+ *
+ * @param rtttl Texto constante (em flash); é compilado na task do player.
+ */
+esp_err_t buzzer_manager_play_rtttl(const char *rtttl, uint32_t duration_ms, buzzer_priority_t priority);
+
+/**
+ * @brief Toca a melodia depois da que estiver em curso.
+ */
+esp_err_t buzzer_manager_enqueue(buzzer_melody_t melody, uint32_t duration_ms, buzzer_priority_t priority);
+
 void buzzer_manager_stop(void);
 bool buzzer_manager_is_playing(void);
+void buzzer_manager_get_stats(buzzer_stats_t *stats);
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "buzzer_sequencer.h"
+
+/**
+ * @brief Compila uma melodia RTTTL ("nome:d=4,o=5,b=100:8e6,8d#6,p,...") em notas.
+ *
+ * @param rtttl Texto RTTTL.
+ * @param out Buffer de saída; a última posição usada recebe o terminador (freq -1).
+ * @param max_notes Capacidade de out, incluindo o terminador.
+ * @return Número de notas compiladas (sem o terminador), ou -1 se o texto for inválido
+ *         ou tiver nota com menos de 1 ms.
+ */
+int buzzer_rtttl_compile(const char *rtttl, buzzer_note_t *out, int max_notes);
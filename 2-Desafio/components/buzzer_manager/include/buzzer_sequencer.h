@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+
+// Nota compacta (4 bytes); freq 0 = pausa, freq -1 = fim da melodia
+typedef struct {
+    int16_t freq;
+    uint16_t duration_ms;
+} buzzer_note_t;
+
+typedef struct {
+    uint32_t notes;             // Trocas de nota medidas
+    uint32_t max_error_us;      // Maior atraso em relação ao cronograma ideal
+    uint32_t avg_error_us;
+} buzzer_timing_stats_t;
+
+// Chamado na task do esp_timer quando a melodia termina sozinha
+typedef void (*buzzer_sequencer_done_cb_t)(uint32_t seq_id);
+
+void buzzer_sequencer_init(buzzer_sequencer_done_cb_t done_cb);
+
+/**
+ * @brief Inicia a melodia; as trocas de nota são feitas por um esp_timer one-shot
+ * agendado contra o cronograma absoluto, então o erro não acumula.
+ *
+ * @param notes Melodia terminada em freq -1; precisa continuar válida até o fim.
+ * @param duration_ms Duração total (repete ou trunca); 0 toca uma vez, por até 10 s.
+ *        Notas de duração zero são puladas.
+ * @return Identificador da reprodução, repassado ao done_cb.
+ */
+uint32_t buzzer_sequencer_start(const buzzer_note_t *notes, uint32_t duration_ms);
+void buzzer_sequencer_stop(void);
+void buzzer_sequencer_get_timing(buzzer_timing_stats_t *stats);
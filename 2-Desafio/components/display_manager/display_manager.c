@@ -2,28 +2,140 @@
 #include "ssd1306.h"
 #include "ntp_manager.h"
 #include "alarm_manager.h"
+#include "alarm_schedule.h"
+#include "display_widgets.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
 #include <string.h>
 #include <stdio.h>
+#include <sys/time.h>
+
+#define DISPLAY_QUEUE_LEN 8
+#define DISPLAY_TICK_MARGIN_US 500 // Dispara logo após a virada do segundo
+
+static const char *TAG = "DISPLAY_MANAGER";
+
+typedef enum {
+    DISPLAY_EVENT_TICK,
+    DISPLAY_EVENT_SCREEN,       // arg: tela nova
+    DISPLAY_EVENT_MENU,         // arg: passo na lista do menu
+    DISPLAY_EVENT_ALARM_LIST,   // arg: passo na lista de alarmes (0 = lista mudou)
+    DISPLAY_EVENT_REFRESH
+} display_event_type_t;
+
+typedef struct {
+    display_event_type_t type;
+    int arg;
+} display_event_t;
 
 static SSD1306_t dev;
+static QueueHandle_t display_queue = NULL;
+static esp_timer_handle_t second_timer = NULL;
 
-static char current_time_text[9] = {0};
-static bool current_alarm_status = false;
+// Estado de navegação: só a task do display escreve; os outros módulos mandam eventos
 static screen_t current_screen = SCREEN_MAIN;
 static screen_t last_screen_displayed = SCREEN_MAIN;
 static int menu_index = 0;
 static int alarm_list_index = 0;
 
 static bool force_screen_update = true;
-static bool force_menu_update = true;
-static bool force_alarm_list_update = true;
 
-static int last_displayed_second = -1;
+// Cópias para os getters, atualizadas pela task depois de cada evento
+static volatile screen_t published_screen = SCREEN_MAIN;
+static volatile int published_menu_index = 0;
+
+// Horário e alarmes lidos uma vez por renderização e compartilhados pelas fontes de dados
+static struct tm now;
+static bool time_valid = false;
+static bool time_provisional = false; // Relógio recuperado, ainda sem NTP
+static const alarm_snapshot_t *alarms = NULL;
 
 static const char *dias_semana[] = {
     "Dom", "Seg", "Ter", "Qua", "Qui", "Sex", "Sab"
 };
 
+static const char *menu_items[] = {
+    "Lista Alarmes", "Voltar"
+};
+
+// Comandos de navegação esperam vaga na fila; ticks e avisos podem se perder
+static void post_event(display_event_type_t type, int arg, TickType_t wait)
+{
+    display_event_t event = { .type = type, .arg = arg };
+    if (display_queue) {
+        xQueueSend(display_queue, &event, wait);
+    }
+}
+
+// Rearma o timer para a próxima virada de segundo do relógio de parede
+static void arm_second_timer(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    uint64_t delay_us = 1000000 - tv.tv_usec + DISPLAY_TICK_MARGIN_US;
+    esp_timer_start_once(second_timer, delay_us);
+}
+
+static void second_timer_cb(void *arg)
+{
+    arm_second_timer();
+    post_event(DISPLAY_EVENT_TICK, 0, 0);
+}
+
+static void display_manager_render(void);
+
+static void on_alarms_changed(const alarm_snapshot_t *snapshot, void *ctx)
+{
+    post_event(DISPLAY_EVENT_ALARM_LIST, 0, 0);
+}
+
+static int menu_count(void);
+
+static void apply_event(const display_event_t *event)
+{
+    switch (event->type) {
+        case DISPLAY_EVENT_SCREEN:
+            current_screen = (screen_t)event->arg;
+            force_screen_update = true;
+            break;
+        case DISPLAY_EVENT_MENU:
+            menu_index = (menu_index + event->arg % menu_count() + menu_count()) % menu_count();
+            break;
+        case DISPLAY_EVENT_ALARM_LIST:
+            // O limite superior depende da lista atual e é aplicado na renderização
+            alarm_list_index += event->arg;
+            if (alarm_list_index < 0) {
+                alarm_list_index = 0;
+            }
+            break;
+        case DISPLAY_EVENT_REFRESH:
+            force_screen_update = true;
+            break;
+        case DISPLAY_EVENT_TICK:
+            break;
+    }
+    published_screen = current_screen;
+    published_menu_index = menu_index;
+}
+
+static void display_manager_task(void *arg)
+{
+    display_event_t event;
+    while (1) {
+        if (xQueueReceive(display_queue, &event, portMAX_DELAY) == pdTRUE) {
+            apply_event(&event);
+            // Eventos de tick só importam na tela principal
+            if (event.type == DISPLAY_EVENT_TICK && current_screen != SCREEN_MAIN) {
+                continue;
+            }
+            display_manager_render();
+        }
+    }
+}
+
 void display_manager_init(void)
 {
     // Inicializa I2C com os pinos definidos no menuconfig
@@ -42,132 +154,189 @@ void display_manager_init(void)
     #endif
 
     ssd1306_clear_screen(&dev, false);
+
+    display_queue = xQueueCreate(DISPLAY_QUEUE_LEN, sizeof(display_event_t));
+    if (display_queue == NULL) {
+        ESP_LOGE(TAG, "Falha ao criar fila de eventos do display");
+        return;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = second_timer_cb,
+        .name = "display_second"
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &second_timer));
+    arm_second_timer();
+
+    xTaskCreate(display_manager_task, "display_manager_task", 4096, NULL, 5, NULL);
+    alarm_store_subscribe(on_alarms_changed, NULL);
 }
 
-void display_manager_update(void)
+// Fontes de dados dos widgets
+
+static void time_source(char *buf, size_t len)
 {
-    struct tm timeinfo;
-    bool time_valid = ntp_manager_get_time(&timeinfo);
-
-    if (current_screen == SCREEN_MAIN) {
-        char new_time_text[9];
-        char new_weekday_text[16];
-        if (time_valid) {
-            snprintf(new_time_text, sizeof(new_time_text), "%02d:%02d:%02d", timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
-            snprintf(new_weekday_text, sizeof(new_weekday_text), "Dia: %s", dias_semana[timeinfo.tm_wday]);
-        } else {
-            snprintf(new_time_text, sizeof(new_time_text), "--:--:--");
-            snprintf(new_weekday_text, sizeof(new_weekday_text), "Dia: ---");
-        }
+    if (time_valid) {
+        snprintf(buf, len, "%s%02d:%02d:%02d", time_provisional ? "~" : "", now.tm_hour, now.tm_min, now.tm_sec);
+    } else {
+        snprintf(buf, len, "--:--:--");
+    }
+}
 
-        bool alarm_on = alarm_manager_is_enabled();
+static void alarm_status_source(char *buf, size_t len)
+{
+    snprintf(buf, len, "%s", alarm_manager_is_enabled() ? "Alarmes ON" : "Alarmes OFF");
+}
 
-        if (timeinfo.tm_sec != last_displayed_second || current_alarm_status != alarm_on || force_screen_update) {
-            //ssd1306_clear_screen(&dev, false);
-            //ssd1306_display_text(&dev, 2, new_time_text, strlen(new_time_text), false);
+static void weekday_source(char *buf, size_t len)
+{
+    snprintf(buf, len, "Dia: %s", time_valid ? dias_semana[now.tm_wday] : "---");
+}
 
-            ssd1306_clear_line(&dev, 2, false);
-            ssd1306_display_text(&dev, 2, new_time_text, strlen(new_time_text), false);
+static int menu_count(void)
+{
+    return sizeof(menu_items) / sizeof(menu_items[0]);
+}
 
-            ssd1306_clear_line(&dev, 4, false);
-            const char *status_text = alarm_on ? "Alarmes ON" : "Alarmes OFF";
-            ssd1306_display_text(&dev, 4, status_text, strlen(status_text), false);
+static bool menu_item(int index, char *buf, size_t len)
+{
+    snprintf(buf, len, "%s", menu_items[index]);
+    return true;
+}
 
-            ssd1306_clear_line(&dev, 5, false);
-            ssd1306_display_text(&dev, 5, new_weekday_text, strlen(new_weekday_text), false);
+static int alarm_count(void)
+{
+    return alarms ? alarms->count : 0;
+}
 
-            strcpy(current_time_text, new_time_text);
-            current_alarm_status = alarm_on;
-            force_screen_update = false;
-            last_screen_displayed = SCREEN_MAIN;
-            last_displayed_second = timeinfo.tm_sec;
-        }
+static bool alarm_item(int index, char *buf, size_t len)
+{
+    if (index < 0 || index >= alarm_count()) {
+        return false;
     }
-    else if (current_screen == SCREEN_MENU) {
-        if (force_screen_update || force_menu_update) {
-            ssd1306_clear_screen(&dev, false);
-
-            if (menu_index == 0) {
-                ssd1306_display_text(&dev, 2, "> Lista Alarmes", strlen("> Lista Alarmes"), false);
-            } else if (menu_index == 1) {
-                ssd1306_display_text(&dev, 2, "> Voltar", strlen("> Voltar"), false);
-            }
+    const alarm_t *alarm = &alarms->alarms[index];
+    int hour = alarm_hour(alarm), minute = alarm_minute(alarm);
+    uint16_t day;
 
-            force_screen_update = false;
-            force_menu_update = false;
-            last_screen_displayed = SCREEN_MENU;
+    if (!alarm->enabled) {
+        snprintf(buf, len, "%02d:%02d (off)", hour, minute);
+    } else if (alarm->has_date && alarm_snapshot_date(alarms, index, &day)) {
+        int y, m, d;
+        alarm_day_to_date(day, &y, &m, &d);
+        snprintf(buf, len, "%02d:%02d %02d/%02d", hour, minute, d, m);
+    } else {
+        // Inicial de cada dia marcado, '-' nos demais: "07:00 -STQQS-"
+        char days[8];
+        for (int wday = 0; wday < 7; wday++) {
+            days[wday] = alarm_on_weekday(alarm, wday) ? "DSTQQSS"[wday] : '-';
         }
+        days[7] = '\0';
+        snprintf(buf, len, "%02d:%02d %s", hour, minute, days);
     }
-    else if (current_screen == SCREEN_ALARMS) {
-        if (force_screen_update || force_alarm_list_update) {
-            ssd1306_clear_screen(&dev, false);
-
-            alarm_t alarm;
-            if (alarm_manager_get_alarm(alarm_list_index, &alarm)) {
-                char alarm_text[32];
-                snprintf(alarm_text, sizeof(alarm_text), "%02d:%02d dia:%d", alarm.hour, alarm.minute, alarm.weekday);
-                ssd1306_display_text(&dev, 2, alarm_text, strlen(alarm_text), false);
-            } else {
-                ssd1306_display_text(&dev, 2, "Sem alarmes", strlen("Sem alarmes"), false);
-            }
+    return true;
+}
 
-            force_screen_update = false;
-            force_alarm_list_update = false;
-            last_screen_displayed = SCREEN_ALARMS;
-        }
+// Telas
+
+static widget_t main_widgets[] = {
+    { .type = WIDGET_VALUE, .page = 2, .value = time_source },
+    { .type = WIDGET_VALUE, .page = 4, .value = alarm_status_source },
+    { .type = WIDGET_VALUE, .page = 5, .value = weekday_source },
+};
+
+static widget_t menu_widgets[] = {
+    { .type = WIDGET_LIST, .page = 2, .rows = 2, .count = menu_count, .item = menu_item, .selected = &menu_index },
+};
+
+static widget_t alarm_widgets[] = {
+    { .type = WIDGET_LIST, .page = 2, .rows = 4, .text = "Sem alarmes",
+      .count = alarm_count, .item = alarm_item, .selected = &alarm_list_index },
+};
+
+static widget_t emergency_widgets[] = {
+    { .type = WIDGET_BANNER, .page = 3, .text = "!! EMERGENCIA !!" },
+};
+
+#define SCREEN_WIDGETS(w) (w), (sizeof(w) / sizeof((w)[0]))
+
+static widget_screen_t screens[] = {
+    [SCREEN_MAIN]      = { SCREEN_WIDGETS(main_widgets), false },
+    [SCREEN_MENU]      = { SCREEN_WIDGETS(menu_widgets), false },
+    [SCREEN_ALARMS]    = { SCREEN_WIDGETS(alarm_widgets), false },
+    [SCREEN_EMERGENCY] = { SCREEN_WIDGETS(emergency_widgets), true },
+};
+
+static void display_manager_render(void)
+{
+    // Cópia do horário já convertido pelo ntp_manager, sem localtime_r aqui
+    time_valid = ntp_manager_get_time(&now);
+    time_provisional = !ntp_manager_is_time_synced();
+
+    // A lista pode ter encolhido por uma edição via web
+    alarms = alarm_store_acquire();
+    if (alarm_list_index >= alarm_count()) {
+        alarm_list_index = alarm_count() > 0 ? alarm_count() - 1 : 0;
     }
-    else if (current_screen == SCREEN_EMERGENCY) {
-        if (force_screen_update) {
-            ssd1306_clear_screen(&dev, true);
-            ssd1306_display_text(&dev, 3, "!!! EMERGENCIA !!!", strlen("!!! EMERGENCIA !!!"), true);
-            force_screen_update = false;
-            last_screen_displayed = SCREEN_EMERGENCY;
-        }
+
+    screen_t screen = current_screen;
+    int bytes;
+    if (force_screen_update || screen != last_screen_displayed) {
+        force_screen_update = false;
+        bytes = widget_screen_show(&dev, &screens[screen]);
+        last_screen_displayed = screen;
+    } else {
+        bytes = widget_screen_update(&dev, &screens[screen]);
+    }
+
+    if (bytes > 0) {
+        ESP_LOGD(TAG, "Tela %d: %d bytes enviados", screen, bytes);
     }
+
+    alarm_store_release(alarms);
+    alarms = NULL;
+}
+
+void display_manager_update(void)
+{
+    post_event(DISPLAY_EVENT_REFRESH, 0, portMAX_DELAY);
 }
 
 // Getters e Setters
+//
+// A task do display tem prioridade maior que a de quem navega, então o evento
+// já foi aplicado quando o envio retorna e os getters veem o valor novo.
 
 void display_manager_set_screen(screen_t screen)
 {
-    current_screen = screen;
-    force_screen_update = true;
+    post_event(DISPLAY_EVENT_SCREEN, screen, portMAX_DELAY);
 }
 
 screen_t display_manager_get_screen(void)
 {
-    return current_screen;
+    return published_screen;
 }
 
 void display_manager_next_menu(void)
 {
-    menu_index = (menu_index + 1) % 2;
-    force_menu_update = true;
+    post_event(DISPLAY_EVENT_MENU, 1, portMAX_DELAY);
 }
 
 void display_manager_prev_menu(void)
 {
-    menu_index = (menu_index == 0) ? 1 : (menu_index - 1);
-    force_menu_update = true;
+    post_event(DISPLAY_EVENT_MENU, -1, portMAX_DELAY);
 }
 
 int display_manager_get_menu_index(void)
 {
-    return menu_index;
+    return published_menu_index;
 }
 
 void display_manager_next_alarm(void)
 {
-    if (alarm_list_index < (alarm_manager_count() - 1)) {
-        alarm_list_index++;
-        force_alarm_list_update = true;
-    }
+    post_event(DISPLAY_EVENT_ALARM_LIST, 1, portMAX_DELAY);
 }
 
 void display_manager_prev_alarm(void)
 {
-    if (alarm_list_index > 0) {
-        alarm_list_index--;
-        force_alarm_list_update = true;
-    }
+    post_event(DISPLAY_EVENT_ALARM_LIST, -1, portMAX_DELAY);
 }
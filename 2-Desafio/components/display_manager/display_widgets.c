@@ -0,0 +1,149 @@
+#include "display_widgets.h"
+#include "font8x8_basic.h"
+#include <string.h>
+#include <stdio.h>
+
+// Copia o texto para uma linha de largura fixa, completando com espaços
+static void pad_row(char *row, const char *text)
+{
+    size_t len = text ? strnlen(text, WIDGET_COLS) : 0;
+    if (len > 0) {
+        memcpy(row, text, len);
+    }
+    memset(row + len, ' ', WIDGET_COLS - len);
+}
+
+static void center_row(char *row, const char *text)
+{
+    size_t len = strnlen(text, WIDGET_COLS);
+    size_t left = (WIDGET_COLS - len) / 2;
+    memset(row, ' ', WIDGET_COLS);
+    memcpy(row + left, text, len);
+}
+
+// Envia somente o trecho contíguo de caracteres que mudou na linha
+static int draw_row(SSD1306_t *dev, widget_t *w, int r, const char *row, bool invert)
+{
+    int first = 0;
+    int last = WIDGET_COLS - 1;
+
+    if (w->valid && w->shown_invert[r] == invert) {
+        while (first < WIDGET_COLS && row[first] == w->shown[r][first]) first++;
+        if (first == WIDGET_COLS) {
+            return 0;
+        }
+        while (row[last] == w->shown[r][last]) last--;
+    }
+
+    uint8_t image[WIDGET_COLS * 8];
+    int len = 0;
+    for (int i = first; i <= last; i++) {
+        memcpy(&image[len], font8x8_basic_tr[(uint8_t)row[i] & 0x7F], 8);
+        if (invert) ssd1306_invert(&image[len], 8);
+        if (dev->_flip) ssd1306_flip(&image[len], 8);
+        len += 8;
+    }
+    ssd1306_display_image(dev, w->page + r, first * 8, image, len);
+
+    memcpy(w->shown[r], row, WIDGET_COLS);
+    w->shown_invert[r] = invert;
+    return len;
+}
+
+static int widget_rows(const widget_t *w)
+{
+    if (w->type != WIDGET_LIST || w->rows < 1) {
+        return 1;
+    }
+    return w->rows > WIDGET_MAX_ROWS ? WIDGET_MAX_ROWS : w->rows;
+}
+
+static int update_list(SSD1306_t *dev, widget_t *w, bool invert)
+{
+    int rows = widget_rows(w);
+    int count = w->count ? w->count() : 0;
+    int selected = w->selected ? *w->selected : 0;
+    int top = (selected < rows) ? 0 : selected - rows + 1;
+    int bytes = 0;
+
+    for (int r = 0; r < rows; r++) {
+        char text[WIDGET_COLS + 1] = {0};
+        char row[WIDGET_COLS];
+        int index = top + r;
+
+        if (count == 0) {
+            if (r == 0) {
+                snprintf(text, sizeof(text), "%s", w->text ? w->text : "");
+            }
+        } else if (index < count) {
+            char item[WIDGET_COLS + 1] = {0};
+            if (w->item(index, item, sizeof(item))) {
+                snprintf(text, sizeof(text), "%s%s", index == selected ? "> " : "  ", item);
+            }
+        }
+
+        pad_row(row, text);
+        bytes += draw_row(dev, w, r, row, invert);
+    }
+    return bytes;
+}
+
+static int update_widget(SSD1306_t *dev, widget_t *w, bool screen_invert)
+{
+    char text[WIDGET_COLS + 1] = {0};
+    char row[WIDGET_COLS];
+    int bytes;
+
+    switch (w->type) {
+        case WIDGET_LABEL:
+            pad_row(row, w->text);
+            bytes = draw_row(dev, w, 0, row, screen_invert);
+            break;
+        case WIDGET_VALUE:
+            if (w->value) {
+                w->value(text, sizeof(text));
+            }
+            pad_row(row, text);
+            bytes = draw_row(dev, w, 0, row, screen_invert);
+            break;
+        case WIDGET_BANNER:
+            center_row(row, w->text ? w->text : "");
+            bytes = draw_row(dev, w, 0, row, !screen_invert);
+            break;
+        case WIDGET_LIST:
+            bytes = update_list(dev, w, screen_invert);
+            break;
+        default:
+            return 0;
+    }
+
+    w->valid = true;
+    return bytes;
+}
+
+int widget_screen_show(SSD1306_t *dev, widget_screen_t *screen)
+{
+    ssd1306_clear_screen(dev, screen->invert);
+    int bytes = ssd1306_get_pages(dev) * WIDGET_COLS * 8;
+
+    // Após a limpeza todas as linhas estão em branco; só o texto é enviado
+    for (int i = 0; i < screen->count; i++) {
+        widget_t *w = &screen->widgets[i];
+        for (int r = 0; r < WIDGET_MAX_ROWS; r++) {
+            memset(w->shown[r], ' ', WIDGET_COLS);
+            w->shown_invert[r] = screen->invert;
+        }
+        w->valid = true;
+    }
+
+    return bytes + widget_screen_update(dev, screen);
+}
+
+int widget_screen_update(SSD1306_t *dev, widget_screen_t *screen)
+{
+    int bytes = 0;
+    for (int i = 0; i < screen->count; i++) {
+        bytes += update_widget(dev, &screen->widgets[i], screen->invert);
+    }
+    return bytes;
+}
@@ -10,7 +10,9 @@ typedef enum {
     SCREEN_EMERGENCY
 } screen_t;
 
+// Cria a task do display, que redesenha sob demanda e a cada virada de segundo
 void display_manager_init(void);
+// Força o redesenho completo da tela atual
 void display_manager_update(void);
 
 // Controle de tela
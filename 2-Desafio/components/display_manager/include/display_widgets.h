@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "ssd1306.h"
+
+#define WIDGET_COLS 16      // 128 px / fonte 8x8
+#define WIDGET_MAX_ROWS 4   // Linhas máximas de uma lista
+
+typedef enum {
+    WIDGET_LABEL,   // Texto fixo
+    WIDGET_VALUE,   // Texto formatado por uma fonte de dados
+    WIDGET_LIST,    // Lista rolável com item selecionado
+    WIDGET_BANNER   // Faixa invertida centralizada
+} widget_type_t;
+
+// Fonte de dados de um WIDGET_VALUE
+typedef void (*widget_value_fn)(char *buf, size_t len);
+// Fontes de dados de um WIDGET_LIST
+typedef int (*widget_count_fn)(void);
+typedef bool (*widget_item_fn)(int index, char *buf, size_t len);
+
+typedef struct {
+    widget_type_t type;
+    int page;                   // Primeira linha (página) ocupada
+    int rows;                   // Linhas ocupadas por WIDGET_LIST
+    const char *text;           // LABEL/BANNER, ou texto de lista vazia
+    widget_value_fn value;
+    widget_count_fn count;
+    widget_item_fn item;
+    const int *selected;
+
+    // Estado retido: o que está atualmente no display
+    char shown[WIDGET_MAX_ROWS][WIDGET_COLS];
+    bool shown_invert[WIDGET_MAX_ROWS];
+    bool valid;
+} widget_t;
+
+typedef struct {
+    widget_t *widgets;
+    int count;
+    bool invert;                // Fundo da tela invertido
+} widget_screen_t;
+
+/**
+ * @brief Limpa o display e redesenha todos os widgets da tela.
+ *
+ * @return Bytes de imagem enviados ao driver.
+ */
+int widget_screen_show(SSD1306_t *dev, widget_screen_t *screen);
+
+/**
+ * @brief Reavalia as fontes de dados e envia apenas as regiões alteradas.
+ *
+ * @return Bytes de imagem enviados ao driver.
+ */
+int widget_screen_update(SSD1306_t *dev, widget_screen_t *screen);
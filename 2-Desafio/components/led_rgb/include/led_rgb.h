@@ -2,5 +2,22 @@
 
 #include <stdint.h>
 
+// Passo de um padrão de LED; duration_ms 0 encerra o padrão
+typedef struct {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint16_t duration_ms;
+} led_rgb_step_t;
+
 void led_rgb_init(void);
 void led_rgb_set_color(uint8_t r, uint8_t g, uint8_t b);
+
+/**
+ * @brief Toca um padrão em segundo plano (esp_timer), substituindo o anterior.
+ *
+ * @param steps Precisa continuar válido até o fim (tipicamente const).
+ * @param repeat Quantas vezes tocar o padrão (mínimo 1); o LED apaga no fim.
+ */
+void led_rgb_play_pattern(const led_rgb_step_t *steps, uint8_t repeat);
+void led_rgb_stop_pattern(void);
@@ -1,10 +1,43 @@
 #include "led_rgb.h"
 #include "driver/gpio.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
 
 #define LED_RED_GPIO   14
 #define LED_GREEN_GPIO 13
 #define LED_BLUE_GPIO  12
 
+static esp_timer_handle_t pattern_timer = NULL;
+static portMUX_TYPE pattern_mux = portMUX_INITIALIZER_UNLOCKED;
+static const led_rgb_step_t *pattern = NULL;
+static int pattern_pos = 0;
+static uint8_t pattern_left = 0;
+
+// Roda na task do esp_timer: aplica o passo atual e agenda o próximo
+static void pattern_timer_cb(void *arg)
+{
+    portENTER_CRITICAL(&pattern_mux);
+    const led_rgb_step_t *step = NULL;
+    if (pattern) {
+        if (pattern[pattern_pos].duration_ms == 0 && --pattern_left > 0) {
+            pattern_pos = 0;
+        }
+        if (pattern[pattern_pos].duration_ms != 0) {
+            step = &pattern[pattern_pos++];
+        } else {
+            pattern = NULL;
+        }
+    }
+    portEXIT_CRITICAL(&pattern_mux);
+
+    if (step) {
+        led_rgb_set_color(step->r, step->g, step->b);
+        esp_timer_start_once(pattern_timer, step->duration_ms * 1000ULL);
+    } else {
+        led_rgb_set_color(0, 0, 0);
+    }
+}
+
 void led_rgb_init(void)
 {
     gpio_set_direction(LED_RED_GPIO, GPIO_MODE_OUTPUT);
@@ -14,6 +47,12 @@ void led_rgb_init(void)
     gpio_set_level(LED_RED_GPIO, 0);
     gpio_set_level(LED_GREEN_GPIO, 0);
     gpio_set_level(LED_BLUE_GPIO, 0);
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = pattern_timer_cb,
+        .name = "led_pattern"
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &pattern_timer));
 }
 
 void led_rgb_set_color(uint8_t r, uint8_t g, uint8_t b)
@@ -22,3 +61,31 @@ void led_rgb_set_color(uint8_t r, uint8_t g, uint8_t b)
     gpio_set_level(LED_GREEN_GPIO, g > 0 ? 1 : 0);
     gpio_set_level(LED_BLUE_GPIO, b > 0 ? 1 : 0);
 }
+
+void led_rgb_play_pattern(const led_rgb_step_t *steps, uint8_t repeat)
+{
+    if (!pattern_timer || !steps) {
+        return;
+    }
+    esp_timer_stop(pattern_timer);
+
+    portENTER_CRITICAL(&pattern_mux);
+    pattern = steps;
+    pattern_pos = 0;
+    pattern_left = repeat > 0 ? repeat : 1;
+    portEXIT_CRITICAL(&pattern_mux);
+
+    esp_timer_start_once(pattern_timer, 0);
+}
+
+void led_rgb_stop_pattern(void)
+{
+    if (!pattern_timer) {
+        return;
+    }
+    esp_timer_stop(pattern_timer);
+    portENTER_CRITICAL(&pattern_mux);
+    pattern = NULL;
+    portEXIT_CRITICAL(&pattern_mux);
+    led_rgb_set_color(0, 0, 0);
+}
@@ -0,0 +1,68 @@
+#include "clock_cache.h"
+#include "esp_timer.h"
+#include <sys/time.h>
+
+#define CLOCK_TICK_MARGIN_US 500 // Dispara logo após a virada do segundo
+
+// Seqlock: ímpar enquanto o único escritor (task do esp_timer) está no meio da cópia
+static uint32_t seq = 0;
+static ntp_time_snapshot_t cache;
+static esp_timer_handle_t tick_timer = NULL;
+
+static void publish(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+
+    ntp_time_snapshot_t next = {
+        .utc = tv.tv_sec,
+        .mono_us = esp_timer_get_time(),
+        .quality = ntp_manager_get_quality(),
+    };
+    localtime_r(&next.utc, &next.local);
+
+    __atomic_store_n(&seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    cache = next;
+    __atomic_store_n(&seq, seq + 1, __ATOMIC_RELEASE);
+
+    // Rearma para a próxima virada de segundo do relógio de parede
+    gettimeofday(&tv, NULL);
+    esp_timer_start_once(tick_timer, 1000000 - tv.tv_usec + CLOCK_TICK_MARGIN_US);
+}
+
+static void tick_timer_cb(void *arg)
+{
+    publish();
+}
+
+void clock_cache_init(void)
+{
+    const esp_timer_create_args_t timer_args = {
+        .callback = tick_timer_cb,
+        .name = "clock_tick"
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &tick_timer));
+    esp_timer_start_once(tick_timer, 0);
+}
+
+void clock_cache_refresh(void)
+{
+    if (tick_timer) {
+        // A publicação continua só na task do esp_timer: um escritor só
+        esp_timer_stop(tick_timer);
+        esp_timer_start_once(tick_timer, 0);
+    }
+}
+
+bool clock_cache_read(ntp_time_snapshot_t *out)
+{
+    uint32_t begin;
+    do {
+        begin = __atomic_load_n(&seq, __ATOMIC_ACQUIRE);
+        *out = cache;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((begin & 1) || __atomic_load_n(&seq, __ATOMIC_RELAXED) != begin);
+
+    return out->quality != NTP_CLOCK_INVALID;
+}
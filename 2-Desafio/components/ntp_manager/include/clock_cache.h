@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdbool.h>
+#include "ntp_manager.h"
+
+/**
+ * @brief Cria o timer que republica o horário a cada virada de segundo.
+ */
+void clock_cache_init(void);
+
+/**
+ * @brief Republica já (relógio acertado, fuso ou qualidade mudaram).
+ */
+void clock_cache_refresh(void);
+
+/**
+ * @brief Cópia consistente do último horário publicado, sem lock nem alocação.
+ *
+ * @return false se ainda não houver horário válido.
+ */
+bool clock_cache_read(ntp_time_snapshot_t *out);
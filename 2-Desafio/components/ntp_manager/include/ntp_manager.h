@@ -1,10 +1,94 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <time.h> 
 
 typedef void (*wifi_connected_callback_t)(void);
 
+// Chamado quando o relógio é (re)sincronizado ou o fuso muda; roda na task do cliente SNTP
+typedef void (*ntp_time_changed_cb_t)(void);
+
+// Confiança no relógio; do pior para o melhor
+typedef enum {
+    NTP_CLOCK_INVALID = 0,  // Nenhum horário conhecido
+    NTP_CLOCK_RESTORED,     // Último horário salvo na NVS; atrasado pelo tempo sem energia
+    NTP_CLOCK_RTC,          // O RTC continuou contando através do reset
+    NTP_CLOCK_SYNCED,       // Sincronizado via NTP
+} ntp_clock_quality_t;
+
+typedef struct {
+    ntp_clock_quality_t quality;
+    int64_t time_to_valid_us;       // Do reset até haver um horário utilizável
+    int64_t time_to_sync_us;        // Do reset até a primeira sincronização NTP
+    int32_t provisional_error_ms;   // Erro do relógio provisório medido na primeira sincronização
+    int32_t last_offset_ms;         // Correção aplicada na última sincronização
+    int32_t drift_ppb;              // Positivo: o relógio local atrasa
+    uint32_t slews;                 // Correções suaves (adjtime)
+    uint32_t steps;                 // Saltos (settimeofday)
+} ntp_clock_stats_t;
+
+#define NTP_MAX_SERVERS 4
+
+// Qualidade de cada servidor consultado
+typedef struct {
+    char name[32];
+    uint8_t reach;                  // Últimas 8 consultas; bit 0 = a mais recente respondeu
+    uint8_t stratum;
+    int64_t offset_us;              // Da amostra de menor atraso na última consulta
+    int32_t delay_us;               // Ida e volta
+    int32_t jitter_us;              // Média móvel da variação do offset entre consultas
+    int64_t updated_us;             // esp_timer da última amostra; 0 se nunca respondeu
+} ntp_server_stats_t;
+
+// Horário publicado uma vez por segundo; lido sem lock
+typedef struct {
+    struct tm local;                // Já convertido para o fuso vigente
+    time_t utc;
+    int64_t mono_us;                // esp_timer no instante da publicação
+    ntp_clock_quality_t quality;
+} ntp_time_snapshot_t;
+
+/**
+ * @brief Aplica o fuso e recupera um relógio provisório (RTC ou NVS).
+ *
+ * Chamar logo após nvs_storage_init(), antes de quem depende do horário.
+ */
+void ntp_manager_init(void);
+
+/**
+ * @brief Começa a consultar os servidores NTP (o local, se configurado, e os públicos).
+ *
+ * Chamar a cada conexão do Wi-Fi; depois da primeira só antecipa a próxima consulta.
+ */
 void ntp_manager_start(void);
 bool ntp_manager_is_time_synced(void);
+
+/**
+ * @brief Há um horário utilizável, mesmo que provisório.
+ */
+bool ntp_manager_is_time_valid(void);
+ntp_clock_quality_t ntp_manager_get_quality(void);
+void ntp_manager_get_clock_stats(ntp_clock_stats_t *stats);
+
+/**
+ * @brief Copia o estado de cada servidor NTP.
+ *
+ * @return Quantidade de servidores copiados (até max).
+ */
+int ntp_manager_get_server_stats(ntp_server_stats_t *stats, int max);
+
+/**
+ * @brief Horário local do segundo corrente, copiado do cache (sem localtime_r).
+ *
+ * @return false se ainda não houver horário válido.
+ */
 bool ntp_manager_get_time(struct tm *time_info);
+bool ntp_manager_get_snapshot(ntp_time_snapshot_t *snapshot);
+
+/**
+ * @brief Milissegundos desde o boot; não salta com o relógio de parede.
+ */
+int64_t ntp_manager_monotonic_ms(void);
+void ntp_manager_set_timezone(const char *tz);
+void ntp_manager_set_time_changed_callback(ntp_time_changed_cb_t cb);
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "ntp_manager.h"
+#include <stdbool.h>
+
+/**
+ * Recebe a correção combinada dos servidores; roda na task do cliente SNTP.
+ * Com step_only (meio da rajada inicial), só corrige se for saltar o relógio.
+ * Retorna se corrigiu; a correção gradual (adjtime) é acompanhada pelo cliente.
+ */
+typedef bool (*sntp_client_sync_cb_t)(int64_t offset_us, bool step_only);
+
+/**
+ * @brief Inicia a task que consulta os servidores.
+ *
+ * Até a primeira sincronização faz rajadas de consultas; depois consulta uma
+ * vez a cada intervalo. Chamadas seguintes só antecipam a próxima consulta.
+ *
+ * @param servers Nomes ou IPs (até NTP_MAX_SERVERS); precisam continuar válidos.
+ */
+void sntp_client_start(const char *const *servers, int count, sntp_client_sync_cb_t on_sync);
+
+int sntp_client_get_server_stats(ntp_server_stats_t *stats, int max);
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Codificação e cálculo de uma troca SNTP (RFC 4330); sem dependência do ESP-IDF
+#define SNTP_PORT 123
+#define SNTP_PACKET_SIZE 48
+
+typedef struct {
+    int64_t offset_us;  // Quanto somar ao relógio local para acertá-lo
+    int64_t delay_us;   // Ida e volta, descontado o tempo de processamento do servidor
+    uint8_t stratum;
+} sntp_sample_t;
+
+/**
+ * @brief Monta uma requisição cliente com o horário de envio como carimbo de transmissão.
+ *
+ * @param packet Buffer de SNTP_PACKET_SIZE bytes.
+ * @param t1_us Relógio local no envio (µs desde 1970).
+ */
+void sntp_packet_build_request(uint8_t *packet, int64_t t1_us);
+
+/**
+ * @brief Valida a resposta e calcula deslocamento e atraso.
+ *
+ * Rejeita respostas que não ecoam o carimbo da requisição, de servidores
+ * não sincronizados (stratum 0/16, LI = 3) ou com atraso negativo.
+ *
+ * @param t1_us Horário de envio usado em sntp_packet_build_request().
+ * @param t4_us Relógio local na recepção.
+ * @return true se a amostra for utilizável.
+ */
+bool sntp_packet_parse_response(const uint8_t *packet, size_t len, int64_t t1_us, int64_t t4_us,
+                                sntp_sample_t *sample);
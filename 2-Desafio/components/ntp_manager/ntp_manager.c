@@ -1,43 +1,266 @@
 #include "ntp_manager.h"
+#include "clock_cache.h"
+#include "sntp_client.h"
 #include "esp_log.h"
-#include "esp_sntp.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
 #include "time.h"
+#include <sys/time.h>
+#include <stdlib.h>
 
 static const char *TAG = "NTP_MANAGER";
 
-static bool time_synced = false;
+#define CLOCK_NAMESPACE "clock"
+#define CLOCK_SAVE_PERIOD_MS (60 * 1000)    // Erro máximo do relógio restaurado, fora o tempo desligado
+#define CLOCK_MIN_VALID_UTC 1704067200      // 2024-01-01: antes disso o relógio nunca foi acertado
+#define CLOCK_SLEW_LIMIT_US 1000000         // Antes da 1ª sincronização, só desacelera erros de até 1 s
+#define CLOCK_STEP_LIMIT_US (60 * 1000000LL) // Depois, só salta se algo deu muito errado
+#define CLOCK_MAX_DRIFT_PPB 500000          // Deriva acima de 500 ppm é erro de medida
+#define CLOCK_MIN_DRIFT_WINDOW_S 600        // Intervalo mínimo entre sincronizações para medir deriva
 
-static void time_sync_notification_cb(struct timeval *tv)
+static volatile ntp_clock_quality_t quality = NTP_CLOCK_INVALID;
+static ntp_time_changed_cb_t time_changed_cb = NULL;
+static TaskHandle_t saver_task = NULL;
+static ntp_clock_stats_t stats;
+
+// O servidor local vem primeiro; vazio é ignorado pelo cliente
+static const char *const ntp_servers[] = {
+    CONFIG_NTP_LOCAL_SERVER,
+    "a.st1.ntp.br",
+    "pool.ntp.org",
+    "time.google.com",
+};
+
+// Persistido na NVS a cada minuto e a cada sincronização
+static int64_t last_sync_utc = 0;   // Último acerto do relógio (NTP ou correção de deriva)
+static int32_t drift_ppb = 0;       // Positivo: o relógio local atrasa
+
+static int64_t now_us(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static void set_time_us(int64_t us)
+{
+    struct timeval tv = { .tv_sec = us / 1000000, .tv_usec = us % 1000000 };
+    settimeofday(&tv, NULL);
+}
+
+static void mark_valid(ntp_clock_quality_t q)
+{
+    if (stats.time_to_valid_us == 0) {
+        stats.time_to_valid_us = esp_timer_get_time();
+        ESP_LOGI(TAG, "Relógio válido %lld ms após o reset (qualidade %d)",
+                 (long long)(stats.time_to_valid_us / 1000), q);
+    }
+    quality = q;
+    stats.quality = q;
+    clock_cache_refresh();
+}
+
+static void save_clock(void)
+{
+    nvs_handle_t handle;
+    if (nvs_open(CLOCK_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+        return;
+    }
+    nvs_set_i64(handle, "utc", now_us() / 1000000);
+    nvs_set_i64(handle, "last_sync", last_sync_utc);
+    nvs_set_i32(handle, "drift_ppb", drift_ppb);
+    nvs_commit(handle);
+    nvs_close(handle);
+}
+
+// Grava o horário periodicamente; acordada antes do prazo quando sincroniza
+static void clock_saver_task(void *param)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CLOCK_SAVE_PERIOD_MS));
+        if (quality != NTP_CLOCK_INVALID) {
+            save_clock();
+        }
+    }
+}
+
+// Recupera um relógio provisório: o do RTC se sobreviveu ao reset, senão o último salvo
+static void restore_clock(void)
+{
+    int64_t saved_utc = 0;
+    nvs_handle_t handle;
+    if (nvs_open(CLOCK_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        nvs_get_i64(handle, "utc", &saved_utc);
+        nvs_get_i64(handle, "last_sync", &last_sync_utc);
+        nvs_get_i32(handle, "drift_ppb", &drift_ppb);
+        nvs_close(handle);
+    }
+    stats.drift_ppb = drift_ppb;
+
+    int64_t now = now_us();
+    if (now / 1000000 >= CLOCK_MIN_VALID_UTC) {
+        // Reset sem perda de energia: o RTC continuou contando; corrige a deriva conhecida
+        if (last_sync_utc > 0) {
+            int64_t elapsed_s = now / 1000000 - last_sync_utc;
+            int64_t correction_us = elapsed_s * drift_ppb / 1000;
+            if (llabs(correction_us) >= 1000) {
+                set_time_us(now + correction_us);
+                // Conta como acerto, para um novo reset não aplicar a mesma correção de novo
+                last_sync_utc = now_us() / 1000000;
+                save_clock();
+            }
+        }
+        mark_valid(NTP_CLOCK_RTC);
+        ESP_LOGI(TAG, "Relógio mantido pelo RTC através do reset");
+    } else if (saved_utc >= CLOCK_MIN_VALID_UTC) {
+        // Perdeu energia: volta ao último horário salvo, atrasado pelo tempo desligado
+        set_time_us(saved_utc * 1000000);
+        mark_valid(NTP_CLOCK_RESTORED);
+        ESP_LOGI(TAG, "Relógio provisório restaurado da NVS");
+    } else {
+        ESP_LOGW(TAG, "Sem horário conhecido até a sincronização NTP");
+    }
+}
+
+// Atualiza a estimativa de deriva quando o relógio correu sem interrupção desde a última sincronização
+static void update_drift(int64_t offset_us, int64_t ntp_utc)
 {
-    ESP_LOGI(TAG, "Horário sincronizado via NTP");
-    time_synced = true;
+    int64_t elapsed_s = ntp_utc - last_sync_utc;
+    if (quality != NTP_CLOCK_SYNCED || last_sync_utc == 0 || elapsed_s < CLOCK_MIN_DRIFT_WINDOW_S) {
+        return;
+    }
+    int64_t measured = offset_us * 1000 / elapsed_s;
+    if (llabs(measured) > CLOCK_MAX_DRIFT_PPB) {
+        return;
+    }
+    drift_ppb = (int32_t)((3 * (int64_t)drift_ppb + measured) / 4);
+    stats.drift_ppb = drift_ppb;
+}
+
+static bool slew(int64_t offset_us)
+{
+    struct timeval delta = { .tv_sec = offset_us / 1000000, .tv_usec = offset_us % 1000000 };
+    return adjtime(&delta, NULL) == 0;
+}
+
+// Até a primeira sincronização qualquer erro grande salta; depois o relógio só é
+// desacelerado ou acelerado, para nunca pular nem repetir segundos. Com step_only
+// a correção gradual fica para depois: o cliente ainda está medindo
+static bool apply_offset(int64_t offset_us, bool step_only)
+{
+    int64_t ntp_us = now_us() + offset_us;
+    bool was_valid = quality != NTP_CLOCK_INVALID;
+    bool was_synced = quality == NTP_CLOCK_SYNCED;
+    int64_t slew_limit = was_synced ? CLOCK_STEP_LIMIT_US : CLOCK_SLEW_LIMIT_US;
+    bool may_slew = was_valid && llabs(offset_us) < slew_limit;
+    if (step_only && may_slew) {
+        return false;
+    }
+
+    update_drift(offset_us, ntp_us / 1000000);
+
+    if (may_slew && slew(offset_us)) {
+        stats.slews++;
+    } else {
+        set_time_us(ntp_us);
+        stats.steps++;
+        if (was_synced) {
+            ESP_LOGW(TAG, "Relógio saltou %lld ms depois de sincronizado", (long long)(offset_us / 1000));
+        }
+    }
+
+    if (!was_synced) {
+        stats.time_to_sync_us = esp_timer_get_time();
+        stats.provisional_error_ms = was_valid ? (int32_t)(offset_us / 1000) : 0;
+        ESP_LOGI(TAG, "Horário sincronizado via NTP (relógio provisório errava %ld ms)",
+                 (long)stats.provisional_error_ms);
+    }
+    stats.last_offset_ms = (int32_t)(offset_us / 1000);
+    last_sync_utc = ntp_us / 1000000;
+    mark_valid(NTP_CLOCK_SYNCED);
+
+    if (saver_task) {
+        xTaskNotifyGive(saver_task);
+    }
+    if (time_changed_cb) {
+        time_changed_cb();
+    }
+    return true;
+}
+
+void ntp_manager_init(void)
+{
+    clock_cache_init();
+    ntp_manager_set_timezone("America/Sao_Paulo");
+    restore_clock();
+    xTaskCreate(clock_saver_task, "clock_saver", 2560, NULL, 2, &saver_task);
 }
 
 void ntp_manager_start(void)
 {
     ESP_LOGI(TAG, "Inicializando sincronização NTP...");
-    setenv("TZ", "America/Sao_Paulo", 1);
+    sntp_client_start(ntp_servers, sizeof(ntp_servers) / sizeof(ntp_servers[0]), apply_offset);
+}
+
+void ntp_manager_set_timezone(const char *tz)
+{
+    setenv("TZ", tz, 1);
     tzset();
-    esp_sntp_setoperatingmode(SNTP_OPMODE_POLL);
-    esp_sntp_setservername(0, "pool.ntp.org"); 
-    esp_sntp_set_time_sync_notification_cb(time_sync_notification_cb);
-    esp_sntp_init();
+    clock_cache_refresh();
+    if (time_changed_cb) {
+        time_changed_cb();
+    }
+}
+
+void ntp_manager_set_time_changed_callback(ntp_time_changed_cb_t cb)
+{
+    time_changed_cb = cb;
 }
 
 bool ntp_manager_is_time_synced(void)
 {
-    return time_synced;
+    return quality == NTP_CLOCK_SYNCED;
+}
+
+bool ntp_manager_is_time_valid(void)
+{
+    return quality != NTP_CLOCK_INVALID;
+}
+
+ntp_clock_quality_t ntp_manager_get_quality(void)
+{
+    return quality;
+}
+
+void ntp_manager_get_clock_stats(ntp_clock_stats_t *out)
+{
+    *out = stats;
+}
+
+int ntp_manager_get_server_stats(ntp_server_stats_t *out, int max)
+{
+    return sntp_client_get_server_stats(out, max);
+}
+
+bool ntp_manager_get_snapshot(ntp_time_snapshot_t *snapshot)
+{
+    return clock_cache_read(snapshot);
 }
 
 bool ntp_manager_get_time(struct tm *time_info)
 {
-    if (!time_synced) {
-        ESP_LOGW(TAG, "Tentativa de pegar o horário antes da sincronização");
+    ntp_time_snapshot_t snapshot;
+    if (!clock_cache_read(&snapshot)) {
         return false;
     }
-
-    time_t now;
-    time(&now);
-    localtime_r(&now, time_info);
+    *time_info = snapshot.local;
     return true;
 }
+
+int64_t ntp_manager_monotonic_ms(void)
+{
+    return esp_timer_get_time() / 1000;
+}
@@ -0,0 +1,334 @@
+#include "sntp_client.h"
+#include "sntp_packet.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+static const char *TAG = "SNTP_CLIENT";
+
+#define BURST_ROUNDS 4                      // Rodadas por rajada, como o iburst do ntpd
+#define BURST_SPACING_MS 2000
+#define ROUND_TIMEOUT_US (1000 * 1000)      // Espera pelas respostas de uma rodada
+#define POLL_INTERVAL_MS (1024 * 1000)
+#define RETRY_INTERVAL_MS (16 * 1000)       // Sem nenhuma resposta ainda
+
+typedef struct {
+    const char *name;
+    struct sockaddr_in addr;
+    bool resolved;
+    sntp_sample_t best;         // Menor atraso da rajada corrente
+    bool has_best;
+    int64_t residual_us;        // Offset esperado após a última correção, base do jitter
+    bool has_residual;
+} server_t;
+
+static server_t servers[NTP_MAX_SERVERS];
+static int server_count = 0;
+static sntp_client_sync_cb_t sync_cb = NULL;
+static TaskHandle_t client_task = NULL;
+static int64_t pending_slew_us = 0;     // Correção entregue ao adjtime, ainda não descontada das amostras
+
+static portMUX_TYPE stats_mux = portMUX_INITIALIZER_UNLOCKED;
+static ntp_server_stats_t stats[NTP_MAX_SERVERS];
+
+static int64_t now_us(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+// Resolvido a cada ciclo: o pool troca de endereço e o Wi-Fi pode ter caído
+static void resolve_servers(void)
+{
+    struct addrinfo hints = { .ai_family = AF_INET, .ai_socktype = SOCK_DGRAM };
+    for (int i = 0; i < server_count; i++) {
+        struct addrinfo *res = NULL;
+        servers[i].resolved = getaddrinfo(servers[i].name, "123", &hints, &res) == 0 && res != NULL;
+        if (servers[i].resolved) {
+            memcpy(&servers[i].addr, res->ai_addr, sizeof(servers[i].addr));
+        }
+        if (res) {
+            freeaddrinfo(res);
+        }
+    }
+}
+
+static int match_server(const struct sockaddr_in *from, const bool *pending, int start)
+{
+    for (int i = start; i < server_count; i++) {
+        if (pending[i] && servers[i].addr.sin_addr.s_addr == from->sin_addr.s_addr &&
+            servers[i].addr.sin_port == from->sin_port) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Uma requisição para cada servidor ao mesmo tempo; as respostas chegam em qualquer ordem
+static void query_round(int sock, sntp_sample_t *samples, bool *got)
+{
+    uint8_t packet[SNTP_PACKET_SIZE];
+    int64_t t1[NTP_MAX_SERVERS];
+    bool pending[NTP_MAX_SERVERS] = { 0 };
+    int waiting = 0;
+
+    for (int i = 0; i < server_count; i++) {
+        got[i] = false;
+        if (!servers[i].resolved) {
+            continue;
+        }
+        t1[i] = now_us();
+        sntp_packet_build_request(packet, t1[i]);
+        if (sendto(sock, packet, sizeof(packet), 0, (struct sockaddr *)&servers[i].addr,
+                   sizeof(servers[i].addr)) == sizeof(packet)) {
+            pending[i] = true;
+            waiting++;
+        }
+    }
+
+    int64_t deadline = esp_timer_get_time() + ROUND_TIMEOUT_US;
+    while (waiting > 0) {
+        int64_t left = deadline - esp_timer_get_time();
+        if (left <= 0) {
+            break;
+        }
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(sock, &fds);
+        struct timeval tv = { .tv_sec = left / 1000000, .tv_usec = left % 1000000 };
+        if (select(sock + 1, &fds, NULL, NULL, &tv) <= 0) {
+            break;
+        }
+
+        struct sockaddr_in from;
+        socklen_t from_len = sizeof(from);
+        int len = recvfrom(sock, packet, sizeof(packet), 0, (struct sockaddr *)&from, &from_len);
+        int64_t t4 = now_us();
+        if (len < 0) {
+            break;
+        }
+        // Dois nomes podem apontar para o mesmo IP; o carimbo de origem desempata
+        for (int i = match_server(&from, pending, 0); i >= 0; i = match_server(&from, pending, i + 1)) {
+            if (sntp_packet_parse_response(packet, len, t1[i], t4, &samples[i])) {
+                got[i] = true;
+                pending[i] = false;
+                waiting--;
+                break;
+            }
+        }
+    }
+
+    portENTER_CRITICAL(&stats_mux);
+    for (int i = 0; i < server_count; i++) {
+        stats[i].reach = (stats[i].reach << 1) | (got[i] ? 1 : 0);
+    }
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+static int compare_offsets(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Com três ou mais servidores vale a mediana (um servidor errado não arrasta o relógio);
+// com menos, o de menor atraso
+static bool combine(int64_t *offset_us)
+{
+    int64_t offsets[NTP_MAX_SERVERS];
+    int n = 0;
+    const server_t *nearest = NULL;
+    for (int i = 0; i < server_count; i++) {
+        if (!servers[i].has_best) {
+            continue;
+        }
+        offsets[n++] = servers[i].best.offset_us;
+        if (!nearest || servers[i].best.delay_us < nearest->best.delay_us) {
+            nearest = &servers[i];
+        }
+    }
+    if (n == 0) {
+        return false;
+    }
+    if (n >= 3) {
+        qsort(offsets, n, sizeof(offsets[0]), compare_offsets);
+        *offset_us = (n % 2) ? offsets[n / 2] : (offsets[n / 2 - 1] + offsets[n / 2]) / 2;
+    } else {
+        *offset_us = nearest->best.offset_us;
+    }
+    return true;
+}
+
+// O que falta do adjtime em andamento; 0 se o relógio não está sendo corrigido
+static int64_t slew_left_us(void)
+{
+    struct timeval left;
+    if (adjtime(NULL, &left) != 0) {
+        return 0;
+    }
+    return (int64_t)left.tv_sec * 1000000 + left.tv_usec;
+}
+
+// Com step_only, só corrige se o relógio for saltar
+static bool apply(int64_t offset_us, bool step_only)
+{
+    if (!sync_cb(offset_us, step_only)) {
+        return false;
+    }
+    if (slew_left_us() != 0) {
+        // Correção gradual em andamento: as amostras só mudam de base quando ela terminar
+        pending_slew_us = offset_us;
+        return true;
+    }
+    // As amostras guardadas passam a valer em relação ao relógio corrigido
+    for (int i = 0; i < server_count; i++) {
+        servers[i].best.offset_us -= offset_us;
+        servers[i].residual_us -= offset_us;
+    }
+    return true;
+}
+
+// Antes de novas amostras: a correção gradual anterior terminou, ou o jitter perde a base
+static void settle_pending_slew(void)
+{
+    if (pending_slew_us == 0) {
+        return;
+    }
+    bool done = slew_left_us() == 0;
+    for (int i = 0; i < server_count; i++) {
+        if (done) {
+            servers[i].residual_us -= pending_slew_us;
+        } else {
+            servers[i].has_residual = false;
+        }
+    }
+    pending_slew_us = 0;
+}
+
+static void publish_stats(void)
+{
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&stats_mux);
+    for (int i = 0; i < server_count; i++) {
+        server_t *server = &servers[i];
+        ntp_server_stats_t *s = &stats[i];
+        if (!server->has_best) {
+            continue;
+        }
+        if (s->updated_us != 0 && server->has_residual) {
+            int64_t change = llabs(server->best.offset_us - server->residual_us);
+            s->jitter_us = (int32_t)((3 * (int64_t)s->jitter_us + change) / 4);
+        }
+        s->offset_us = server->best.offset_us;
+        s->delay_us = (int32_t)server->best.delay_us;
+        s->stratum = server->best.stratum;
+        s->updated_us = now;
+        server->residual_us = server->best.offset_us;
+        server->has_residual = true;
+    }
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+// Várias rodadas e fica, por servidor, a amostra de menor atraso (a menos afetada por filas);
+// se o relógio precisa saltar, a primeira resposta de todas já o acerta, sem esperar a
+// rajada terminar. Uma correção gradual espera o fim: o adjtime mudaria o relógio entre
+// as rodadas, e as amostras anteriores não teriam como ser descontadas
+static bool sync_cycle(int sock, int rounds, bool first_sync)
+{
+    sntp_sample_t samples[NTP_MAX_SERVERS];
+    bool got[NTP_MAX_SERVERS];
+    int64_t offset;
+
+    resolve_servers();
+    settle_pending_slew();
+    for (int i = 0; i < server_count; i++) {
+        servers[i].has_best = false;
+    }
+
+    for (int round = 0; round < rounds; round++) {
+        if (round > 0) {
+            vTaskDelay(pdMS_TO_TICKS(BURST_SPACING_MS));
+        }
+        query_round(sock, samples, got);
+        for (int i = 0; i < server_count; i++) {
+            if (got[i] && (!servers[i].has_best || samples[i].delay_us < servers[i].best.delay_us)) {
+                servers[i].best = samples[i];
+                servers[i].has_best = true;
+            }
+        }
+        if (first_sync && combine(&offset)) {
+            apply(offset, true);
+            first_sync = false;
+        }
+    }
+
+    // Publicado antes da correção final: offset de cada servidor em relação ao relógio atual
+    publish_stats();
+    if (!combine(&offset)) {
+        return false;
+    }
+    apply(offset, false);
+    return true;
+}
+
+static void sntp_client_task(void *param)
+{
+    bool synced = false;
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "Falha ao criar socket UDP");
+        client_task = NULL;
+        vTaskDelete(NULL);
+        return;
+    }
+
+    while (1) {
+        if (sync_cycle(sock, synced ? 1 : BURST_ROUNDS, !synced)) {
+            if (!synced) {
+                ESP_LOGI(TAG, "Primeira sincronização concluída");
+            }
+            synced = true;
+        }
+        // Reconexão do Wi-Fi acorda antes do prazo
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(synced ? POLL_INTERVAL_MS : RETRY_INTERVAL_MS));
+    }
+}
+
+void sntp_client_start(const char *const *names, int count, sntp_client_sync_cb_t on_sync)
+{
+    if (client_task) {
+        xTaskNotifyGive(client_task);
+        return;
+    }
+
+    server_count = 0;
+    for (int i = 0; i < count && server_count < NTP_MAX_SERVERS; i++) {
+        if (names[i] == NULL || names[i][0] == '\0') {
+            continue;
+        }
+        servers[server_count].name = names[i];
+        snprintf(stats[server_count].name, sizeof(stats[server_count].name), "%s", names[i]);
+        server_count++;
+    }
+    sync_cb = on_sync;
+    xTaskCreate(sntp_client_task, "sntp_client", 4096, NULL, 3, &client_task);
+}
+
+int sntp_client_get_server_stats(ntp_server_stats_t *out, int max)
+{
+    int n = server_count < max ? server_count : max;
+    portENTER_CRITICAL(&stats_mux);
+    memcpy(out, stats, n * sizeof(out[0]));
+    portEXIT_CRITICAL(&stats_mux);
+    return n;
+}
@@ -0,0 +1,88 @@
+#include "sntp_packet.h"
+#include <string.h>
+
+#define NTP_UNIX_DELTA_S 2208988800LL   // 1900-01-01 a 1970-01-01
+#define NTP_ERA_S (1LL << 32)
+#define NTP_LI_ALARM 3
+#define NTP_VERSION 4
+#define NTP_MODE_CLIENT 3
+#define NTP_MODE_SERVER 4
+#define NTP_STRATUM_MAX 15
+
+#define OFF_FLAGS 0
+#define OFF_STRATUM 1
+#define OFF_ORIGINATE 24
+#define OFF_RECEIVE 32
+#define OFF_TRANSMIT 40
+
+static uint32_t read_u32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void write_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+// Segundos NTP abaixo de 2^31 são da era 1 (a partir de 2036)
+static int64_t timestamp_to_us(const uint8_t *p)
+{
+    int64_t sec = read_u32(p);
+    uint32_t frac = read_u32(p + 4);
+    if (sec < (1LL << 31)) {
+        sec += NTP_ERA_S;
+    }
+    return (sec - NTP_UNIX_DELTA_S) * 1000000 + (((uint64_t)frac * 1000000) >> 32);
+}
+
+static void timestamp_from_us(uint8_t *p, int64_t us)
+{
+    int64_t sec = us / 1000000 + NTP_UNIX_DELTA_S;
+    uint32_t frac = (uint32_t)((((uint64_t)(us % 1000000)) << 32) / 1000000);
+    write_u32(p, (uint32_t)sec);
+    write_u32(p + 4, frac);
+}
+
+void sntp_packet_build_request(uint8_t *packet, int64_t t1_us)
+{
+    memset(packet, 0, SNTP_PACKET_SIZE);
+    packet[OFF_FLAGS] = (NTP_VERSION << 3) | NTP_MODE_CLIENT;
+    timestamp_from_us(packet + OFF_TRANSMIT, t1_us);
+}
+
+bool sntp_packet_parse_response(const uint8_t *packet, size_t len, int64_t t1_us, int64_t t4_us,
+                                sntp_sample_t *sample)
+{
+    if (len < SNTP_PACKET_SIZE) {
+        return false;
+    }
+    uint8_t li = packet[OFF_FLAGS] >> 6;
+    uint8_t mode = packet[OFF_FLAGS] & 0x07;
+    uint8_t stratum = packet[OFF_STRATUM];
+    if (mode != NTP_MODE_SERVER || li == NTP_LI_ALARM || stratum == 0 || stratum > NTP_STRATUM_MAX) {
+        return false;
+    }
+
+    // O servidor devolve nosso carimbo de transmissão; descarta respostas atrasadas ou forjadas
+    uint8_t expected[8];
+    timestamp_from_us(expected, t1_us);
+    if (memcmp(packet + OFF_ORIGINATE, expected, sizeof(expected)) != 0) {
+        return false;
+    }
+
+    int64_t t2_us = timestamp_to_us(packet + OFF_RECEIVE);
+    int64_t t3_us = timestamp_to_us(packet + OFF_TRANSMIT);
+    int64_t delay = (t4_us - t1_us) - (t3_us - t2_us);
+    if (delay < 0) {
+        return false;
+    }
+
+    sample->offset_us = ((t2_us - t1_us) + (t3_us - t4_us)) / 2;
+    sample->delay_us = delay;
+    sample->stratum = stratum;
+    return true;
+}
@@ -3,36 +3,159 @@
 #include <stdint.h>
 #include <stdbool.h>
 
-#define MAX_ALARMS 20  // Número máximo de alarmes armazenados
+#define MAX_ALARMS 256      // Número máximo de alarmes armazenados
+#define MAX_ALARM_DATES 16  // Alarmes únicos com data marcada
+#define ALARM_LOG_COMPACT_AT 32 // Entradas no log que justificam regravar a tabela
+#define ALARM_PENDING_MAX 32    // Edições guardadas em RAM antes de ir para a NVS
+#define ALARM_ID_LIMIT 0x8000   // Ids vão de 0 a 0x7FFF; o bit de cima marca remoção no log
 
+#define ALARM_MINUTES_PER_DAY 1440
+#define ALARM_WEEKDAY_BIT(wday) (1u << (wday)) // wday como tm_wday: 0 = domingo
+#define ALARM_WEEKDAYS_ALL 0x7F
+#define ALARM_WEEKDAYS_WORK 0x3E
+
+// Registro compacto (4 bytes), gravado na NVS do jeito que está na RAM
 typedef struct {
-    int hour;
-    int minute;
-    int weekday;
-    int melody;
+    uint32_t minute_of_day : 11;    // 0..1439
+    uint32_t weekdays : 7;          // Um bit por dia; 0 em alarme único = qualquer dia
+    uint32_t melody : 8;
+    uint32_t enabled : 1;
+    uint32_t one_shot : 1;          // Desliga sozinho depois de disparar
+    uint32_t snooze : 1;            // Aceita soneca
+    uint32_t has_date : 1;          // Data em alarm_date_t (só alarmes únicos)
+    uint32_t reserved : 2;
 } alarm_t;
 
+_Static_assert(sizeof(alarm_t) == 4, "alarm_t deve ocupar 4 bytes");
+
+// Extensão de data de um alarme único, na lista em RAM
+typedef struct {
+    uint16_t index;     // Posição do alarme na lista
+    uint16_t day;       // Dias desde 2000-01-01 (data local)
+} alarm_date_t;
+
+// Registro persistido (8 bytes): o alarme com id estável e a data, se tiver
+typedef struct {
+    uint16_t id;        // 0..ALARM_ID_LIMIT-1; não muda quando outros alarmes saem
+    uint16_t day;       // Dias desde 2000-01-01; só vale com alarm.has_date
+    alarm_t alarm;
+} alarm_record_t;
+
+_Static_assert(sizeof(alarm_record_t) == 8, "alarm_record_t deve ocupar 8 bytes");
+
+typedef struct {
+    uint32_t appends;           // Entradas acrescentadas ao log
+    uint32_t compactions;
+    uint32_t bytes_written;     // Estimado pelo formato da NVS (entradas de 32 bytes)
+    uint32_t last_bytes;        // Da última operação
+    int log_length;             // Entradas ainda não incorporadas à tabela
+    int pending;                // Edições em RAM, ainda não gravadas
+    uint32_t transactions;      // nvs_storage_begin()/commit() concluídos
+    uint32_t flushes;           // Vezes que as edições pendentes foram para a NVS (um nvs_commit cada)
+    uint32_t last_flush_us;
+    uint32_t max_flush_us;
+    uint32_t load_us;           // Última carga: validação da tabela (CRC) e log
+} nvs_storage_alarm_stats_t;
+
+static inline int alarm_hour(const alarm_t *alarm)
+{
+    return alarm->minute_of_day / 60;
+}
+
+static inline int alarm_minute(const alarm_t *alarm)
+{
+    return alarm->minute_of_day % 60;
+}
+
+static inline bool alarm_on_weekday(const alarm_t *alarm, int wday)
+{
+    return (alarm->weekdays & ALARM_WEEKDAY_BIT(wday)) != 0;
+}
+
 /**
  * @brief Inicializa o sistema de armazenamento NVS.
  */
 void nvs_storage_init(void);
 
 /**
- * @brief Salva um alarme na memória.
+ * @brief Carrega a tabela de alarmes e aplica o log de edições por cima.
+ *
+ * A tabela tem cabeçalho versionado com CRC (persist_record); corrompida,
+ * é descartada. Formatos antigos (lista única de 16 ou 4 bytes por alarme,
+ * tabela sem CRC) são convertidos e regravados no formato atual na primeira leitura.
+ *
+ * @param records Array onde os registros serão armazenados.
+ * @param max_records Capacidade máxima do array.
+ * @return Número de registros carregados.
+ */
+int nvs_storage_load_alarms(alarm_record_t *records, int max_records);
+
+/**
+ * @brief Abre uma transação: as edições seguintes formam um lote só.
+ *
+ * As funções de escrita não são thread-safe; o alarm_store as serializa.
+ */
+void nvs_storage_begin(void);
+
+/**
+ * @brief Registra um alarme novo ou editado como uma entrada do log.
+ *
+ * A entrada fica em RAM (write-behind) até nvs_storage_flush(); com o
+ * buffer cheio, é gravada na hora.
+ *
+ * @return true se aceito, false em caso de erro.
+ */
+bool nvs_storage_put_alarm(const alarm_record_t *record);
+
+/**
+ * @brief Registra a remoção do alarme `id`.
+ */
+bool nvs_storage_delete_alarm(uint16_t id);
+
+/**
+ * @brief Fecha a transação aberta por nvs_storage_begin().
  *
- * @param alarm Alarme a ser salvo.
- * @return true se salvo com sucesso, false em caso de erro.
+ * Não grava nada: quem chama agenda o nvs_storage_flush(), agrupando
+ * edições próximas numa gravação só.
  */
-bool nvs_storage_save_alarm(const alarm_t *alarm);
+void nvs_storage_commit(void);
 
 /**
- * @brief Carrega todos os alarmes salvos.
+ * @brief Grava as edições pendentes na NVS com um único nvs_commit.
  *
- * @param alarms Array onde os alarmes serão armazenados.
- * @param max_alarms Capacidade máxima do array.
- * @return Número de alarmes carregados.
+ * Chamar também antes de desligar/reiniciar; o que estiver só em RAM se perde.
  */
-int nvs_storage_load_alarms(alarm_t *alarms, int max_alarms);
+bool nvs_storage_flush(void);
+
+/**
+ * @brief Quantidade de edições ainda só em RAM.
+ */
+int nvs_storage_pending(void);
+
+/**
+ * @brief Regrava a tabela com a lista atual e descarta o log.
+ *
+ * @param records Lista completa, já com todas as edições (inclusive as pendentes,
+ *                que são descartadas).
+ */
+bool nvs_storage_compact_alarms(const alarm_record_t *records, int count);
+
+/**
+ * @brief Próximo id a alocar, como gravado na NVS (0 se nunca foi gravado e não há alarmes).
+ */
+uint16_t nvs_storage_next_alarm_id(void);
+
+/**
+ * @brief Atualiza o próximo id; vai para a NVS no próximo flush ou compactação.
+ */
+void nvs_storage_set_next_alarm_id(uint16_t id);
+
+/**
+ * @brief Entradas no log desde a última compactação.
+ */
+int nvs_storage_alarm_log_length(void);
+
+void nvs_storage_get_alarm_stats(nvs_storage_alarm_stats_t *stats);
 
 /**
  * @brief Limpa todos os alarmes da memória.
@@ -1,12 +1,78 @@
 #include "nvs_storage.h"
+#include "persist_record.h"
 #include "nvs.h"
 #include "nvs_flash.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 static const char *TAG = "NVS_STORAGE";
 static const char *NAMESPACE = "alarms";
-static const char *KEY = "alarm_list";
+static const char *LEGACY_KEY = "alarm_list";
+static const char *NEXT_ID_KEY = "alarm_next_id";
+
+#define ALARM_SCHEMA_VERSION 1  // Registros na tabela com cabeçalho e CRC (persist_record)
+#define ALARM_TABLE_V3 3        // Formatos de antes do cabeçalho com CRC
+#define ALARM_BLOB_V2 2
+#define LOG_KEY_FMT "alog%lu"
+#define LOG_DELETE_FLAG 0x8000  // No id de uma entrada do log: o alarme foi apagado
+#define NVS_ENTRY_SIZE 32       // Unidade de escrita da NVS
+
+// Edições vão para um log de entradas u64 (uma por chave, "alog<seq>"); a tabela
+// só é regravada na compactação. A tabela guarda o trecho do log que já
+// incorporou, para descartar entradas que sobraram de uma compactação interrompida.
+typedef struct {
+    uint32_t log_start;     // Primeira entrada do log incorporada
+    uint32_t log_end;       // Primeira entrada do log posterior à tabela
+} alarm_table_meta_t;
+
+static const persist_schema_t alarm_schema = {
+    .key = "alarm_tab",
+    .version = ALARM_SCHEMA_VERSION,
+    .record_size = sizeof(alarm_record_t),
+    .meta_size = sizeof(alarm_table_meta_t),
+};
+
+// Formato da versão 3: o trecho do log num cabeçalho próprio, sem CRC
+typedef struct {
+    uint8_t version;
+    uint8_t reserved;
+    uint16_t count;
+    uint32_t log_start;
+    uint32_t log_end;
+} alarm_table_v3_header_t;
+
+// Formato da versão 2: alarmes e datas em arrays separados, id = posição
+typedef struct {
+    uint8_t version;
+    uint8_t reserved;
+    uint16_t count;
+    uint16_t date_count;
+    uint16_t reserved2;
+} alarm_blob_v2_header_t;
+
+// Formato antigo (versão 1, chave LEGACY_KEY): um dia da semana por alarme
+typedef struct {
+    int hour;
+    int minute;
+    int weekday;
+    int melody;
+} alarm_legacy_t;
+
+static uint32_t table_seq = 0;  // Log a partir daqui ainda não está na tabela
+static uint32_t next_seq = 0;   // Próxima entrada do log
+static uint16_t next_id = 0;    // Próximo id a alocar (quem aloca é o alarm_store)
+static bool next_id_dirty = false;
+static nvs_storage_alarm_stats_t stats;
+
+// Handle aberto na primeira leitura e mantido; edições esperam em RAM pelo flush
+static nvs_handle_t alarms_handle;
+static bool handle_open = false;
+static alarm_record_t pending[ALARM_PENDING_MAX];
+static int pending_count = 0;
+static bool in_transaction = false;
 
 void nvs_storage_init(void)
 {
@@ -18,80 +84,576 @@ void nvs_storage_init(void)
     ESP_ERROR_CHECK(ret);
 }
 
-bool nvs_storage_save_alarm(const alarm_t *alarm)
+static void log_key(char *key, size_t len, uint32_t seq)
+{
+    snprintf(key, len, LOG_KEY_FMT, (unsigned long)seq);
+}
+
+// Blob na NVS: entrada de índice + cabeçalho do pedaço + dados arredondados para entradas
+static uint32_t blob_bytes(size_t size)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NAMESPACE, NVS_READWRITE, &handle);
+    return 2 * NVS_ENTRY_SIZE + (size + NVS_ENTRY_SIZE - 1) / NVS_ENTRY_SIZE * NVS_ENTRY_SIZE;
+}
+
+static void account(uint32_t bytes)
+{
+    stats.bytes_written += bytes;
+    stats.last_bytes = bytes;
+}
+
+static esp_err_t open_alarms(void)
+{
+    if (handle_open) {
+        return ESP_OK;
+    }
+    esp_err_t err = nvs_open(NAMESPACE, NVS_READWRITE, &alarms_handle);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Erro ao abrir NVS: %s", esp_err_to_name(err));
-        return false;
+        return err;
     }
+    handle_open = true;
+    return ESP_OK;
+}
 
-    alarm_t alarms[MAX_ALARMS];
-    size_t required_size = sizeof(alarms);
-    err = nvs_get_blob(handle, KEY, alarms, &required_size);
-    int num_alarms = (err == ESP_OK) ? required_size / sizeof(alarm_t) : 0;
+static bool valid_record(const alarm_record_t *record)
+{
+    return record->id < ALARM_ID_LIMIT && record->alarm.minute_of_day < ALARM_MINUTES_PER_DAY;
+}
 
-    if (num_alarms >= MAX_ALARMS) {
-        ESP_LOGW(TAG, "Limite máximo de alarmes atingido");
-        nvs_close(handle);
+// Registros inválidos vindos da tabela são descartados; os demais mantêm a ordem
+static int drop_invalid(alarm_record_t *records, int count)
+{
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        if (valid_record(&records[i])) {
+            records[kept++] = records[i];
+        }
+    }
+    if (kept < count) {
+        ESP_LOGW(TAG, "%d registros inválidos descartados da tabela", count - kept);
+    }
+    return kept;
+}
+
+static int find_record(const alarm_record_t *records, int count, uint16_t id)
+{
+    for (int i = 0; i < count; i++) {
+        if (records[i].id == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Aplica uma entrada do log à lista; a ordem dos demais alarmes é mantida
+static int apply_log_entry(alarm_record_t *records, int count, int max_records, const alarm_record_t *entry)
+{
+    alarm_record_t record = *entry;
+    bool deleted = record.id & LOG_DELETE_FLAG;
+    record.id &= ~LOG_DELETE_FLAG;
+    if (!deleted && !valid_record(&record)) {
+        ESP_LOGW(TAG, "Entrada inválida no log (id %u)", record.id);
+        return count;
+    }
+
+    int pos = find_record(records, count, record.id);
+    if (deleted) {
+        if (pos >= 0) {
+            memmove(&records[pos], &records[pos + 1], (count - pos - 1) * sizeof(alarm_record_t));
+            count--;
+        }
+    } else if (pos >= 0) {
+        records[pos] = record;
+    } else if (count < max_records) {
+        records[count++] = record;
+    }
+    return count;
+}
+
+static bool queue_entry(const alarm_record_t *entry)
+{
+    // Buffer cheio (lote grande): grava o que tem, mesmo no meio da transação
+    if (pending_count >= ALARM_PENDING_MAX && !nvs_storage_flush()) {
         return false;
     }
+    pending[pending_count++] = *entry;
+    if (!in_transaction) {
+        stats.transactions++;
+    }
+    return true;
+}
+
+void nvs_storage_begin(void)
+{
+    in_transaction = true;
+}
+
+void nvs_storage_commit(void)
+{
+    if (in_transaction) {
+        in_transaction = false;
+        stats.transactions++;
+    }
+}
+
+bool nvs_storage_put_alarm(const alarm_record_t *record)
+{
+    return valid_record(record) && queue_entry(record);
+}
 
-    alarms[num_alarms] = *alarm;
-    num_alarms++;
+bool nvs_storage_delete_alarm(uint16_t id)
+{
+    if (id >= ALARM_ID_LIMIT) {
+        return false;
+    }
+    alarm_record_t entry = { .id = id | LOG_DELETE_FLAG };
+    return queue_entry(&entry);
+}
 
-    // Salva de volta
-    err = nvs_set_blob(handle, KEY, alarms, num_alarms * sizeof(alarm_t));
+// Junto do próximo nvs_commit; chamada com o handle aberto
+static esp_err_t save_next_id(void)
+{
+    if (!next_id_dirty) {
+        return ESP_OK;
+    }
+    esp_err_t err = nvs_set_u16(alarms_handle, NEXT_ID_KEY, next_id);
     if (err == ESP_OK) {
-        nvs_commit(handle);
-        nvs_close(handle);
+        next_id_dirty = false;
+    }
+    return err;
+}
+
+// As entradas vão para o log em ordem; sem transação na NVS, uma queda no meio
+// deixa as primeiras gravadas e as demais perdidas, nunca fora de ordem
+bool nvs_storage_flush(void)
+{
+    if (pending_count == 0 && !next_id_dirty) {
         return true;
-    } else {
-        ESP_LOGE(TAG, "Erro ao salvar alarme: %s", esp_err_to_name(err));
-        nvs_close(handle);
+    }
+    if (open_alarms() != ESP_OK) {
         return false;
     }
+
+    int64_t start = esp_timer_get_time();
+    char key[16];
+    uint64_t value;
+    esp_err_t err = ESP_OK;
+    int written = 0;
+    while (written < pending_count) {
+        log_key(key, sizeof(key), next_seq);
+        memcpy(&value, &pending[written], sizeof(value));
+        err = nvs_set_u64(alarms_handle, key, value);
+        if (err != ESP_OK) {
+            break;
+        }
+        next_seq++;
+        written++;
+    }
+    if (err == ESP_OK) {
+        err = save_next_id();
+    }
+    if (written > 0 || err == ESP_OK) {
+        esp_err_t commit_err = nvs_commit(alarms_handle);
+        err = err == ESP_OK ? commit_err : err;
+    }
+
+    // O que não foi gravado continua pendente para a próxima tentativa
+    memmove(pending, pending + written, (pending_count - written) * sizeof(pending[0]));
+    pending_count -= written;
+    stats.appends += written;
+    account(written * NVS_ENTRY_SIZE);
+
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+    stats.flushes++;
+    stats.last_flush_us = elapsed;
+    if (elapsed > stats.max_flush_us) {
+        stats.max_flush_us = elapsed;
+    }
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Erro ao salvar alarmes: %s", esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+
+int nvs_storage_pending(void)
+{
+    return pending_count;
+}
+
+// Trecho [first, end) ocupado pelas chaves do log que existem na NVS; false se não há nenhuma.
+// Vem do iterador, não da tabela: acha também as sobras que ela não registra
+static bool find_log_keys(uint32_t *first, uint32_t *end)
+{
+    bool found = false;
+    nvs_iterator_t it = NULL;
+    esp_err_t err = nvs_entry_find(NVS_DEFAULT_PART_NAME, NAMESPACE, NVS_TYPE_U64, &it);
+    while (err == ESP_OK) {
+        nvs_entry_info_t info;
+        unsigned long seq;
+        if (nvs_entry_info(it, &info) == ESP_OK && sscanf(info.key, LOG_KEY_FMT, &seq) == 1) {
+            if (!found || seq < *first) {
+                *first = seq;
+            }
+            if (!found || seq >= *end) {
+                *end = seq + 1;
+            }
+            found = true;
+        }
+        err = nvs_entry_next(&it);
+    }
+    nvs_release_iterator(it);
+    return found;
 }
 
-int nvs_storage_load_alarms(alarm_t *alarms, int max_alarms)
+static void erase_log(nvs_handle_t handle, uint32_t from, uint32_t to)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NAMESPACE, NVS_READONLY, &handle);
+    char key[16];
+    for (uint32_t seq = from; seq < to; seq++) {
+        log_key(key, sizeof(key), seq);
+        nvs_erase_key(handle, key);
+    }
+    nvs_commit(handle);
+}
+
+bool nvs_storage_compact_alarms(const alarm_record_t *records, int count)
+{
+    if (count < 0 || count > MAX_ALARMS) {
+        return false;
+    }
+
+    alarm_table_meta_t meta = {
+        .log_start = table_seq,
+        .log_end = next_seq,
+    };
+    if (open_alarms() != ESP_OK) {
+        return false;
+    }
+
+    esp_err_t err = persist_record_save(alarms_handle, &alarm_schema, &meta, records, count);
+    if (err == ESP_OK) {
+        err = save_next_id();
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(alarms_handle);
+    }
     if (err != ESP_OK) {
-        ESP_LOGW(TAG, "Nenhum alarme salvo ainda.");
+        ESP_LOGE(TAG, "Erro ao compactar alarmes: %s", esp_err_to_name(err));
+        return false;
+    }
+
+    // A tabela já vale; se cair aqui, o próximo boot termina de apagar o log
+    erase_log(alarms_handle, table_seq, next_seq);
+
+    ESP_LOGI(TAG, "Log de %lu entradas e %d edições pendentes incorporados à tabela (%d alarmes)",
+             (unsigned long)(next_seq - table_seq), pending_count, count);
+    table_seq = next_seq;
+    pending_count = 0;
+    stats.compactions++;
+    account(blob_bytes(persist_record_blob_size(&alarm_schema, count)));
+    return true;
+}
+
+// Agrupa alarmes antigos de mesmo horário e melodia num único registro com máscara de dias
+static int migrate_legacy(const alarm_legacy_t *legacy, int legacy_count, alarm_record_t *records, int max_records)
+{
+    int count = 0;
+    for (int i = 0; i < legacy_count; i++) {
+        const alarm_legacy_t *old = &legacy[i];
+        if (old->hour < 0 || old->hour > 23 || old->minute < 0 || old->minute > 59 ||
+            old->weekday < 0 || old->weekday > 6 || old->melody < 0 || old->melody > UINT8_MAX) {
+            continue;
+        }
+        uint32_t minute_of_day = old->hour * 60 + old->minute;
+
+        int j = 0;
+        while (j < count && (records[j].alarm.minute_of_day != minute_of_day ||
+                             records[j].alarm.melody != old->melody)) {
+            j++;
+        }
+        if (j == count) {
+            if (count >= max_records) {
+                break;
+            }
+            records[count] = (alarm_record_t) {
+                .id = count,
+                .alarm = {
+                    .minute_of_day = minute_of_day,
+                    .melody = old->melody,
+                    .enabled = 1,
+                },
+            };
+            count++;
+        }
+        records[j].alarm.weekdays |= ALARM_WEEKDAY_BIT(old->weekday);
+    }
+    return count;
+}
+
+static int load_legacy(nvs_handle_t handle, alarm_record_t *records, int max_records)
+{
+    size_t size = 0;
+    if (nvs_get_blob(handle, LEGACY_KEY, NULL, &size) != ESP_OK || size == 0) {
+        return 0;
+    }
+    alarm_legacy_t *legacy = malloc(size);
+    if (!legacy) {
         return 0;
     }
 
-    size_t required_size = max_alarms * sizeof(alarm_t);
-    err = nvs_get_blob(handle, KEY, alarms, &required_size);
-    nvs_close(handle);
+    int count = 0;
+    if (nvs_get_blob(handle, LEGACY_KEY, legacy, &size) == ESP_OK) {
+        int legacy_count = size / sizeof(alarm_legacy_t);
+        count = migrate_legacy(legacy, legacy_count, records, max_records);
+        ESP_LOGI(TAG, "Migrando %d alarmes do formato antigo para %d registros", legacy_count, count);
+    }
+    free(legacy);
+    return count;
+}
 
-    if (err == ESP_OK) {
-        return required_size / sizeof(alarm_t);
-    } else {
-        ESP_LOGW(TAG, "Erro ao carregar alarmes: %s", esp_err_to_name(err));
+// Versão 2: o id passa a ser a posição que o alarme tinha na lista
+static int load_v2(const uint8_t *blob, size_t size, alarm_record_t *records, int max_records)
+{
+    alarm_blob_v2_header_t header;
+    memcpy(&header, blob, sizeof(header));
+    size_t expected = sizeof(header) + header.count * sizeof(alarm_t) + header.date_count * sizeof(alarm_date_t);
+    if (header.count > MAX_ALARMS || header.date_count > MAX_ALARM_DATES || size != expected) {
+        return -1;
+    }
+
+    const uint8_t *alarms = blob + sizeof(header);
+    const uint8_t *dates = alarms + header.count * sizeof(alarm_t);
+    int count = header.count < max_records ? header.count : max_records;
+    for (int i = 0; i < count; i++) {
+        records[i].id = i;
+        records[i].day = 0;
+        memcpy(&records[i].alarm, alarms + i * sizeof(alarm_t), sizeof(alarm_t));
+    }
+    for (int i = 0; i < header.date_count; i++) {
+        alarm_date_t date;
+        memcpy(&date, dates + i * sizeof(date), sizeof(date));
+        if (date.index < count) {
+            records[date.index].day = date.day;
+        }
+    }
+    ESP_LOGI(TAG, "Convertendo %d alarmes da versão 2", count);
+    return count;
+}
+
+// Versão 3: os mesmos registros, com o trecho do log no cabeçalho antigo
+static int load_v3(const uint8_t *blob, size_t size, alarm_record_t *records, int max_records,
+                   alarm_table_meta_t *meta)
+{
+    alarm_table_v3_header_t header;
+    if (size < sizeof(header)) {
+        return -1;
+    }
+    memcpy(&header, blob, sizeof(header));
+    if (header.count > MAX_ALARMS || size != sizeof(header) + header.count * sizeof(alarm_record_t) ||
+        header.log_start > header.log_end) {
+        return -1;
+    }
+    int count = header.count < max_records ? header.count : max_records;
+    memcpy(records, blob + sizeof(header), count * sizeof(alarm_record_t));
+    meta->log_start = header.log_start;
+    meta->log_end = header.log_end;
+    ESP_LOGI(TAG, "Convertendo %d alarmes da versão 3", count);
+    return count;
+}
+
+// Tabela de antes do cabeçalho com CRC; retorna -1 se for inválida
+static int load_old_table(nvs_handle_t handle, alarm_record_t *records, int max_records,
+                          alarm_table_meta_t *meta)
+{
+    size_t size = 0;
+    if (nvs_get_blob(handle, alarm_schema.key, NULL, &size) != ESP_OK || size == 0) {
+        return -1;
+    }
+    uint8_t *blob = malloc(size);
+    if (!blob) {
+        return -1;
+    }
+
+    int count = -1;
+    if (nvs_get_blob(handle, alarm_schema.key, blob, &size) == ESP_OK && size >= sizeof(alarm_blob_v2_header_t)) {
+        if (blob[0] == ALARM_BLOB_V2) {
+            count = load_v2(blob, size, records, max_records);
+        } else if (blob[0] == ALARM_TABLE_V3) {
+            count = load_v3(blob, size, records, max_records, meta);
+        }
+    }
+    if (count < 0) {
+        ESP_LOGE(TAG, "Lista de alarmes inválida (versão %d, %u bytes)", blob[0], (unsigned)size);
+    }
+    free(blob);
+    return count;
+}
+
+int nvs_storage_load_alarms(alarm_record_t *records, int max_records)
+{
+    int64_t start = esp_timer_get_time();
+    table_seq = next_seq = 0;
+    pending_count = 0;
+    next_id_dirty = false;
+
+    // Recarga: começa de um handle novo
+    if (handle_open) {
+        nvs_close(alarms_handle);
+        handle_open = false;
+    }
+    if (open_alarms() != ESP_OK) {
         return 0;
     }
+    nvs_handle_t handle = alarms_handle;
+
+    int count = 0;
+    bool migrate = false;
+    bool lost = false;      // Havia tabela, mas ela não pôde ser lida
+    alarm_table_meta_t meta = { 0 };
+    persist_record_info_t info;
+    esp_err_t err = persist_record_load(handle, &alarm_schema, &meta, records, max_records, &info);
+    if (err == ESP_OK && meta.log_start > meta.log_end) {
+        ESP_LOGE(TAG, "Trecho do log inválido na tabela (%lu a %lu)", (unsigned long)meta.log_start,
+                 (unsigned long)meta.log_end);
+        lost = true;
+    } else if (err == ESP_OK) {
+        count = info.count;
+        migrate = info.migrated;
+    } else if (err == ESP_ERR_NOT_SUPPORTED) {
+        count = load_old_table(handle, records, max_records, &meta);
+        migrate = true;
+        lost = count < 0;
+    } else if (err == ESP_ERR_NOT_FOUND) {
+        count = load_legacy(handle, records, max_records);
+        migrate = count > 0;
+    } else {
+        lost = true;
+    }
+    int valid = drop_invalid(records, count);
+    migrate |= valid < count;
+    count = valid;
+
+    // Sem a tabela, o trecho que ela registrava se perdeu; o log que sobrou é reaplicado
+    // desde a primeira chave. Cada entrada é o registro inteiro, então voltam os alarmes
+    // editados desde a última compactação, e a tabela é regravada com eles
+    uint32_t log_first = 0, log_end = 0;
+    bool has_log = find_log_keys(&log_first, &log_end);
+    if (lost) {
+        count = 0;
+        memset(&meta, 0, sizeof(meta));
+        meta.log_start = meta.log_end = has_log ? log_first : 0;
+        migrate = true;
+    }
+
+    // Sem o próximo id gravado (antes dele existir), segue depois do maior id visto
+    uint32_t seen_next = 0;
+    for (int i = 0; i < count; i++) {
+        if (records[i].id >= seen_next) {
+            seen_next = records[i].id + 1u;
+        }
+    }
+
+    // Reaplica as edições feitas depois da última compactação. O fim vem das chaves que
+    // existem: o log novo nunca grava por cima de uma entrada que sobrou depois de um buraco
+    char key[16];
+    uint64_t value;
+    int missing = 0;
+    table_seq = meta.log_end;
+    next_seq = has_log && log_end > table_seq ? log_end : table_seq;
+    for (uint32_t seq = table_seq; seq < next_seq; seq++) {
+        log_key(key, sizeof(key), seq);
+        if (nvs_get_u64(handle, key, &value) != ESP_OK) {
+            missing++;
+            continue;
+        }
+        alarm_record_t entry;
+        memcpy(&entry, &value, sizeof(entry));
+        count = apply_log_entry(records, count, max_records, &entry);
+        uint16_t id = entry.id & ~LOG_DELETE_FLAG;
+        if (id >= seen_next) {
+            seen_next = id + 1u;
+        }
+    }
+    if (missing > 0) {
+        ESP_LOGW(TAG, "%d entradas faltando no log; as demais foram reaplicadas em ordem", missing);
+    }
+    if (lost) {
+        ESP_LOGE(TAG, "Tabela de alarmes perdida: %d alarmes recuperados do log, os não editados "
+                 "desde a última compactação se perderam", count);
+    }
+    if (nvs_get_u16(handle, NEXT_ID_KEY, &next_id) != ESP_OK) {
+        next_id = seen_next % ALARM_ID_LIMIT;
+        next_id_dirty = seen_next > 0;
+    }
+
+    // Compactação interrompida: a tabela já vale, mas sobrou parte do log que ela incorporou.
+    // A queda pode ter sido em qualquer ponto do trecho, então vale qualquer chave antes dela
+    if (has_log && log_first < table_seq) {
+        ESP_LOGW(TAG, "Terminando compactação interrompida");
+        erase_log(handle, log_first, table_seq);
+    }
+
+    // Grava a tabela (formato novo, ou refeita sem o que foi descartado) e só então apaga a antiga
+    if (migrate && nvs_storage_compact_alarms(records, count)) {
+        nvs_erase_key(handle, LEGACY_KEY);
+        nvs_commit(handle);
+    }
+    if (count == 0) {
+        ESP_LOGW(TAG, "Nenhum alarme salvo ainda.");
+    }
+    stats.load_us = (uint32_t)(esp_timer_get_time() - start);
+    return count;
+}
+
+uint16_t nvs_storage_next_alarm_id(void)
+{
+    return next_id;
+}
+
+void nvs_storage_set_next_alarm_id(uint16_t id)
+{
+    if (id != next_id) {
+        next_id = id;
+        next_id_dirty = true;
+    }
+}
+
+int nvs_storage_alarm_log_length(void)
+{
+    return next_seq - table_seq;
+}
+
+void nvs_storage_get_alarm_stats(nvs_storage_alarm_stats_t *out)
+{
+    *out = stats;
+    out->log_length = next_seq - table_seq;
+    out->pending = pending_count;
 }
 
 bool nvs_storage_clear_alarms(void)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Erro ao abrir NVS para limpar: %s", esp_err_to_name(err));
+    if (open_alarms() != ESP_OK) {
         return false;
     }
 
-    err = nvs_erase_key(handle, KEY);
-    if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND) {
-        nvs_commit(handle);
-        nvs_close(handle);
-        return true;
-    } else {
+    // Tabela, log e a chave antiga (senão seria migrada de novo no próximo boot).
+    // O próximo id volta no mesmo commit: os ids continuam de onde estavam, mesmo
+    // com a lista vazia e um reboot antes de qualquer outra gravação
+    esp_err_t err = nvs_erase_all(alarms_handle);
+    if (err == ESP_OK) {
+        err = nvs_set_u16(alarms_handle, NEXT_ID_KEY, next_id);
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(alarms_handle);
+    }
+    if (err != ESP_OK) {
         ESP_LOGE(TAG, "Erro ao limpar alarmes: %s", esp_err_to_name(err));
-        nvs_close(handle);
         return false;
     }
+    table_seq = next_seq = 0;
+    pending_count = 0;
+    next_id_dirty = false;
+    account(0);
+    return true;
 }
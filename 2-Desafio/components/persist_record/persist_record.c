@@ -0,0 +1,206 @@
+#include "persist_record.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_crc.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "PERSIST_RECORD";
+
+// Registros já conferidos, ainda na versão em que estavam na NVS
+typedef struct {
+    uint16_t version;
+    int count;
+    const uint8_t *records;
+} stored_records_t;
+
+static uint32_t blob_crc(const persist_header_t *header, const uint8_t *payload, size_t len)
+{
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)header, offsetof(persist_header_t, crc32));
+    return esp_rom_crc32_le(crc, payload, len);
+}
+
+static const persist_migration_t *find_migration(const persist_schema_t *schema, uint16_t from_version)
+{
+    for (int i = 0; i < schema->migration_count; i++) {
+        if (schema->migrations[i].from_version == from_version) {
+            return &schema->migrations[i];
+        }
+    }
+    return NULL;
+}
+
+// Tamanho do registro numa versão; 0 se ela não leva à versão atual
+static uint16_t record_size_at(const persist_schema_t *schema, uint16_t version)
+{
+    if (version == schema->version) {
+        return schema->record_size;
+    }
+    const persist_migration_t *migration = find_migration(schema, version);
+    return migration ? migration->from_record_size : 0;
+}
+
+size_t persist_record_blob_size(const persist_schema_t *schema, int count)
+{
+    return sizeof(persist_header_t) + schema->meta_size + (size_t)count * schema->record_size;
+}
+
+esp_err_t persist_record_save(nvs_handle_t handle, const persist_schema_t *schema, const void *meta,
+                              const void *records, int count)
+{
+    if (count < 0 || count > UINT16_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t size = persist_record_blob_size(schema, count);
+    uint8_t *blob = malloc(size);
+    if (!blob) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    persist_header_t header = {
+        .magic = PERSIST_RECORD_MAGIC,
+        .version = schema->version,
+        .record_size = schema->record_size,
+        .count = count,
+        .meta_size = schema->meta_size,
+    };
+    uint8_t *payload = blob + sizeof(header);
+    if (meta) {
+        memcpy(payload, meta, schema->meta_size);
+    } else {
+        memset(payload, 0, schema->meta_size);
+    }
+    memcpy(payload + schema->meta_size, records, (size_t)count * schema->record_size);
+    header.crc32 = blob_crc(&header, payload, size - sizeof(header));
+    memcpy(blob, &header, sizeof(header));
+
+    esp_err_t err = nvs_set_blob(handle, schema->key, blob, size);
+    free(blob);
+    return err;
+}
+
+// Confere o blob; caminho rápido da versão atual: só o cabeçalho e um CRC
+static esp_err_t check_blob(const persist_schema_t *schema, const uint8_t *blob, size_t size, void *meta,
+                            stored_records_t *out)
+{
+    persist_header_t header;
+    if (size >= sizeof(header)) {
+        memcpy(&header, blob, sizeof(header));
+    }
+
+    if (size < sizeof(header) || header.magic != PERSIST_RECORD_MAGIC) {
+        // Sem cabeçalho: formato de antes desta camada, versão 0 se houver migração
+        const persist_migration_t *migration = find_migration(schema, 0);
+        if (!migration || size % migration->from_record_size != 0) {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+        out->version = 0;
+        out->count = size / migration->from_record_size;
+        out->records = blob;
+        return ESP_OK;
+    }
+
+    size_t payload = size - sizeof(header);
+    if (payload != header.meta_size + (size_t)header.count * header.record_size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (blob_crc(&header, blob + sizeof(header), payload) != header.crc32) {
+        return ESP_ERR_INVALID_CRC;
+    }
+    if (header.record_size != record_size_at(schema, header.version)) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    if (meta) {
+        memcpy(meta, blob + sizeof(header),
+               header.meta_size < schema->meta_size ? header.meta_size : schema->meta_size);
+    }
+    out->version = header.version;
+    out->count = header.count;
+    out->records = blob + sizeof(header) + header.meta_size;
+    return ESP_OK;
+}
+
+// Leva os registros, uma versão por vez, até a atual; *buffer fica com a última cópia
+static esp_err_t migrate_records(const persist_schema_t *schema, stored_records_t *stored, uint8_t **buffer)
+{
+    while (stored->version != schema->version) {
+        const persist_migration_t *migration = find_migration(schema, stored->version);
+        uint16_t next_size = record_size_at(schema, stored->version + 1);
+        if (!migration || next_size == 0) {
+            return ESP_ERR_INVALID_VERSION;
+        }
+
+        uint8_t *next = calloc(stored->count ? stored->count : 1, next_size);
+        if (!next) {
+            return ESP_ERR_NO_MEM;
+        }
+        int kept = 0;
+        for (int i = 0; i < stored->count; i++) {
+            if (migration->migrate(stored->records + i * migration->from_record_size, next + kept * next_size)) {
+                kept++;
+            } else {
+                memset(next + kept * next_size, 0, next_size);
+            }
+        }
+
+        free(*buffer);
+        *buffer = next;
+        stored->records = next;
+        stored->count = kept;
+        stored->version++;
+    }
+    return ESP_OK;
+}
+
+esp_err_t persist_record_load(nvs_handle_t handle, const persist_schema_t *schema, void *meta,
+                              void *records, int max_records, persist_record_info_t *info)
+{
+    int64_t start = esp_timer_get_time();
+    persist_record_info_t result = { 0 };
+    if (meta) {
+        memset(meta, 0, schema->meta_size);
+    }
+
+    size_t size = 0;
+    esp_err_t err = nvs_get_blob(handle, schema->key, NULL, &size);
+    if (err != ESP_OK) {
+        return err == ESP_ERR_NVS_NOT_FOUND ? ESP_ERR_NOT_FOUND : err;
+    }
+    uint8_t *blob = malloc(size ? size : 1);
+    if (!blob) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    stored_records_t stored = { 0 };
+    uint8_t *migrated = NULL;
+    err = nvs_get_blob(handle, schema->key, blob, &size);
+    if (err == ESP_OK) {
+        err = check_blob(schema, blob, size, meta, &stored);
+    }
+    if (err == ESP_OK) {
+        result.version = stored.version;
+        result.migrated = stored.version != schema->version;
+        err = migrate_records(schema, &stored, &migrated);
+    }
+    if (err == ESP_OK) {
+        result.count = stored.count < max_records ? stored.count : max_records;
+        memcpy(records, stored.records, (size_t)result.count * schema->record_size);
+    }
+    free(migrated);
+    free(blob);
+
+    result.load_us = (uint32_t)(esp_timer_get_time() - start);
+    if (info) {
+        *info = result;
+    }
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "%s: %u registros da versão %u em %lu us%s", schema->key, result.count, result.version,
+                 (unsigned long)result.load_us, result.migrated ? " (migrados)" : "");
+    } else if (err != ESP_ERR_NOT_SUPPORTED) {
+        ESP_LOGE(TAG, "%s: blob inválido (%s, %u bytes)", schema->key, esp_err_to_name(err), (unsigned)size);
+    }
+    return err;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Escrita de JSON em streaming num buffer fixo, sem heap; cheio, o buffer vai para o flush
+#define JSON_WRITER_MAX_DEPTH 31
+
+typedef esp_err_t (*json_writer_flush_fn_t)(void *ctx, const char *data, size_t len);
+
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;
+    size_t total;               // Bytes já entregues ao flush
+    uint32_t nonempty;          // Um bit por nível: o container já tem itens
+    uint8_t depth;
+    esp_err_t err;              // Primeiro erro; a partir dele nada mais é escrito
+    json_writer_flush_fn_t flush;
+    void *ctx;
+} json_writer_t;
+
+void json_writer_init(json_writer_t *writer, char *buf, size_t size, json_writer_flush_fn_t flush, void *ctx);
+
+/**
+ * Em todas as funções abaixo, `key` é o nome do campo dentro de um objeto, ou
+ * NULL dentro de uma lista. A chave vai sem escape: use só nomes literais.
+ */
+void json_writer_begin_array(json_writer_t *writer, const char *key);
+void json_writer_end_array(json_writer_t *writer);
+void json_writer_begin_object(json_writer_t *writer, const char *key);
+void json_writer_end_object(json_writer_t *writer);
+
+void json_writer_int(json_writer_t *writer, const char *key, int32_t value);
+void json_writer_bool(json_writer_t *writer, const char *key, bool value);
+void json_writer_string(json_writer_t *writer, const char *key, const char *value);
+
+/**
+ * @brief Entrega o resto do buffer ao flush.
+ *
+ * @return ESP_OK, ou o primeiro erro do flush (ex.: cliente desconectou).
+ */
+esp_err_t json_writer_finish(json_writer_t *writer);
@@ -0,0 +1,157 @@
+#include "json_writer.h"
+#include <string.h>
+
+void json_writer_init(json_writer_t *writer, char *buf, size_t size, json_writer_flush_fn_t flush, void *ctx)
+{
+    *writer = (json_writer_t) {
+        .buf = buf,
+        .size = size,
+        .err = ESP_OK,
+        .flush = flush,
+        .ctx = ctx,
+    };
+}
+
+static void flush_buffer(json_writer_t *writer)
+{
+    if (writer->len > 0 && writer->err == ESP_OK) {
+        writer->err = writer->flush(writer->ctx, writer->buf, writer->len);
+        writer->total += writer->len;
+    }
+    writer->len = 0;
+}
+
+static void put(json_writer_t *writer, const char *data, size_t len)
+{
+    while (len > 0 && writer->err == ESP_OK) {
+        if (writer->len == writer->size) {
+            flush_buffer(writer);
+            continue;
+        }
+        size_t room = writer->size - writer->len;
+        size_t n = len < room ? len : room;
+        memcpy(writer->buf + writer->len, data, n);
+        writer->len += n;
+        data += n;
+        len -= n;
+    }
+}
+
+static void put_char(json_writer_t *writer, char c)
+{
+    put(writer, &c, 1);
+}
+
+// Vírgula se o container já tem itens, e a chave se for campo de objeto
+static void begin_value(json_writer_t *writer, const char *key)
+{
+    uint32_t bit = 1u << writer->depth;
+    if (writer->nonempty & bit) {
+        put_char(writer, ',');
+    }
+    writer->nonempty |= bit;
+    if (key) {
+        put_char(writer, '"');
+        put(writer, key, strlen(key));
+        put(writer, "\":", 2);
+    }
+}
+
+static void begin_container(json_writer_t *writer, const char *key, char open)
+{
+    if (writer->depth >= JSON_WRITER_MAX_DEPTH) {
+        writer->err = ESP_ERR_INVALID_STATE;
+        return;
+    }
+    begin_value(writer, key);
+    put_char(writer, open);
+    writer->depth++;
+    writer->nonempty &= ~(1u << writer->depth);
+}
+
+static void end_container(json_writer_t *writer, char close)
+{
+    if (writer->depth > 0) {
+        writer->depth--;
+    }
+    put_char(writer, close);
+}
+
+void json_writer_begin_array(json_writer_t *writer, const char *key)
+{
+    begin_container(writer, key, '[');
+}
+
+void json_writer_end_array(json_writer_t *writer)
+{
+    end_container(writer, ']');
+}
+
+void json_writer_begin_object(json_writer_t *writer, const char *key)
+{
+    begin_container(writer, key, '{');
+}
+
+void json_writer_end_object(json_writer_t *writer)
+{
+    end_container(writer, '}');
+}
+
+void json_writer_int(json_writer_t *writer, const char *key, int32_t value)
+{
+    char digits[12];
+    int pos = sizeof(digits);
+    uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+    do {
+        digits[--pos] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) {
+        digits[--pos] = '-';
+    }
+
+    begin_value(writer, key);
+    put(writer, digits + pos, sizeof(digits) - pos);
+}
+
+void json_writer_bool(json_writer_t *writer, const char *key, bool value)
+{
+    begin_value(writer, key);
+    if (value) {
+        put(writer, "true", 4);
+    } else {
+        put(writer, "false", 5);
+    }
+}
+
+void json_writer_string(json_writer_t *writer, const char *key, const char *value)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    begin_value(writer, key);
+    put_char(writer, '"');
+    const char *run = value;    // Trecho que não precisa de escape, copiado de uma vez
+    for (const char *p = value; *p; p++) {
+        unsigned char c = *p;
+        if (c != '"' && c != '\\' && c >= 0x20) {
+            continue;
+        }
+        put(writer, run, p - run);
+        if (c == '"' || c == '\\') {
+            char escaped[2] = { '\\', c };
+            put(writer, escaped, 2);
+        } else {
+            char escaped[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+            put(writer, escaped, 6);
+        }
+        run = p + 1;
+    }
+    put(writer, run, strlen(run));
+    put_char(writer, '"');
+}
+
+esp_err_t json_writer_finish(json_writer_t *writer)
+{
+    flush_buffer(writer);
+    return writer->err;
+}
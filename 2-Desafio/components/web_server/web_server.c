@@ -1,72 +1,331 @@
 #include "web_server.h"
-#include "nvs_storage.h"
+#include "alarm_store.h"
+#include "alarm_schedule.h"
+#include "json_writer.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "esp_http_server.h"
+#include "esp_random.h"
 #include "cJSON.h"
 #include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
 
 static const char *TAG = "WEB_SERVER";
 static httpd_handle_t server = NULL;
+static uint32_t boot_tag;   // No ETag: a geração da lista recomeça a cada boot
 
+#define MAX_BODY_LEN 8192   // ~80 alarmes por importação
+#define JSON_CHUNK_LEN 512
+
+static esp_err_t send_json_chunk(void *ctx, const char *data, size_t len)
+{
+    return httpd_resp_send_chunk(ctx, data, len);
+}
+
+// Lista gerada direto no buffer da pilha e enviada em pedaços, sem heap.
+// O ETag vem da geração da lista: sem edições, o navegador recebe 304.
 static esp_err_t get_alarms_handler(httpd_req_t *req)
 {
-    alarm_t alarms[MAX_ALARMS];
-    int num_alarms = nvs_storage_load_alarms(alarms, MAX_ALARMS);
+    const alarm_snapshot_t *alarms = alarm_store_acquire();
 
-    cJSON *root = cJSON_CreateArray();
-    for (int i = 0; i < num_alarms; i++) {
-        cJSON *item = cJSON_CreateObject();
-        cJSON_AddNumberToObject(item, "hour", alarms[i].hour);
-        cJSON_AddNumberToObject(item, "minute", alarms[i].minute);
-        cJSON_AddNumberToObject(item, "weekday", alarms[i].weekday);
-        cJSON_AddNumberToObject(item, "melody", alarms[i].melody);
-        cJSON_AddItemToArray(root, item);
+    char etag[24];
+    snprintf(etag, sizeof(etag), "\"%08lx-%lu\"", (unsigned long)boot_tag,
+             (unsigned long)(alarms ? alarms->generation : 0));
+    httpd_resp_set_hdr(req, "ETag", etag);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+
+    char if_none_match[64];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) == ESP_OK &&
+        strstr(if_none_match, etag)) {
+        alarm_store_release(alarms);
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
     }
 
-    const char *response = cJSON_Print(root);
+    // A lista fica presa até o fim do envio; edições nesse meio tempo publicam outra
+    char buffer[JSON_CHUNK_LEN];
+    json_writer_t json;
+    json_writer_init(&json, buffer, sizeof(buffer), send_json_chunk, req);
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, response);
 
-    cJSON_Delete(root);
-    free((void *)response);
+    json_writer_begin_array(&json, NULL);
+    for (int i = 0; alarms && i < alarms->count; i++) {
+        const alarm_t *alarm = &alarms->alarms[i];
+        json_writer_begin_object(&json, NULL);
+        json_writer_int(&json, "id", alarms->ids[i]);
+        json_writer_int(&json, "hour", alarm_hour(alarm));
+        json_writer_int(&json, "minute", alarm_minute(alarm));
+        json_writer_int(&json, "weekdays", alarm->weekdays);
+        json_writer_int(&json, "melody", alarm->melody);
+        json_writer_bool(&json, "enabled", alarm->enabled);
+        json_writer_bool(&json, "one_shot", alarm->one_shot);
+        json_writer_bool(&json, "snooze", alarm->snooze);
 
-    return ESP_OK;
+        uint16_t day;
+        if (alarm->has_date && alarm_snapshot_date(alarms, i, &day)) {
+            int y, m, d;
+            char date[12];
+            alarm_day_to_date(day, &y, &m, &d);
+            snprintf(date, sizeof(date), "%04d-%02d-%02d", y, m, d);
+            json_writer_string(&json, "date", date);
+        }
+        json_writer_end_object(&json);
+    }
+    json_writer_end_array(&json);
+    alarm_store_release(alarms);
+
+    esp_err_t err = json_writer_finish(&json);
+    if (err == ESP_OK) {
+        err = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    return err;
 }
 
-static esp_err_t post_alarm_handler(httpd_req_t *req)
+static int json_int(const cJSON *root, const char *name, int fallback)
 {
-    char buf[200];
-    int ret = httpd_req_recv(req, buf, sizeof(buf));
-    if (ret <= 0) {
-        return ESP_FAIL;
+    const cJSON *item = cJSON_GetObjectItem(root, name);
+    return cJSON_IsNumber(item) ? item->valueint : fallback;
+}
+
+static bool json_bool(const cJSON *root, const char *name, bool fallback)
+{
+    const cJSON *item = cJSON_GetObjectItem(root, name);
+    return cJSON_IsBool(item) ? cJSON_IsTrue(item) : fallback;
+}
+
+// Aceita "weekdays" (máscara, bit 0 = domingo) ou o antigo "weekday" (um dia só)
+static bool parse_alarm(const cJSON *root, alarm_t *alarm, int32_t *day)
+{
+    int hour = json_int(root, "hour", -1);
+    int minute = json_int(root, "minute", -1);
+    int melody = json_int(root, "melody", 0);
+    int weekdays = json_int(root, "weekdays", -1);
+    if (weekdays < 0) {
+        int weekday = json_int(root, "weekday", -1);
+        weekdays = (weekday >= 0 && weekday < 7) ? (int)ALARM_WEEKDAY_BIT(weekday) : 0;
     }
-    buf[ret] = '\0';
+    if (hour < 0 || hour > 23 || minute < 0 || minute > 59 || melody < 0 || melody > UINT8_MAX ||
+        weekdays > ALARM_WEEKDAYS_ALL) {
+        return false;
+    }
+
+    *alarm = (alarm_t) {
+        .minute_of_day = hour * 60 + minute,
+        .weekdays = weekdays,
+        .melody = melody,
+        .enabled = json_bool(root, "enabled", true),
+        .one_shot = json_bool(root, "one_shot", false),
+        .snooze = json_bool(root, "snooze", false),
+    };
+
+    *day = ALARM_NO_DATE;
+    const cJSON *date = cJSON_GetObjectItem(root, "date");
+    if (cJSON_IsString(date)) {
+        int y, m, d;
+        if (sscanf(date->valuestring, "%d-%d-%d", &y, &m, &d) != 3 || y < 2000 || y > 2099 ||
+            m < 1 || m > 12 || d < 1 || d > 31) {
+            return false;
+        }
+        *day = alarm_day_from_date(y, m, d);
+        alarm->one_shot = 1; // Com data, o alarme só pode tocar uma vez
+    }
+    return alarm->one_shot || weekdays != 0;
+}
 
-    cJSON *root = cJSON_Parse(buf);
+// Corpo inteiro, terminado em '\0'; em caso de erro a resposta já foi enviada
+static char *recv_body(httpd_req_t *req)
+{
+    if (req->content_len == 0 || req->content_len > MAX_BODY_LEN) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Tamanho do corpo inválido");
+        return NULL;
+    }
+    char *body = malloc(req->content_len + 1);
+    if (!body) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Sem memória");
+        return NULL;
+    }
+
+    size_t received = 0;
+    while (received < req->content_len) {
+        int ret = httpd_req_recv(req, body + received, req->content_len - received);
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
+            continue;
+        }
+        if (ret <= 0) {
+            free(body);
+            return NULL;
+        }
+        received += ret;
+    }
+    body[received] = '\0';
+    return body;
+}
+
+static cJSON *recv_json(httpd_req_t *req)
+{
+    char *body = recv_body(req);
+    if (!body) {
+        return NULL;
+    }
+    cJSON *root = cJSON_Parse(body);
+    free(body);
     if (!root) {
         httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "JSON inválido");
-        return ESP_FAIL;
     }
+    return root;
+}
 
-    alarm_t alarm;
-    alarm.hour = cJSON_GetObjectItem(root, "hour")->valueint;
-    alarm.minute = cJSON_GetObjectItem(root, "minute")->valueint;
-    alarm.weekday = cJSON_GetObjectItem(root, "weekday")->valueint;
-    alarm.melody = cJSON_GetObjectItem(root, "melody")->valueint;
+// Lê e valida o alarme do corpo; em caso de erro a resposta já foi enviada
+static bool recv_alarm(httpd_req_t *req, alarm_t *alarm, int32_t *day)
+{
+    cJSON *root = recv_json(req);
+    if (!root) {
+        return false;
+    }
+
+    bool ok = parse_alarm(root, alarm, day);
+    cJSON_Delete(root);
+    if (!ok) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Alarme inválido");
+    }
+    return ok;
+}
 
-    if (nvs_storage_save_alarm(&alarm)) {
-        httpd_resp_sendstr(req, "Alarme salvo com sucesso!");
+// Id no fim da URI: /alarms/<id>
+static bool uri_alarm_id(httpd_req_t *req, uint16_t *id)
+{
+    const char *start = req->uri + strlen("/alarms/");
+    char *end;
+    unsigned long value = strtoul(start, &end, 10);
+    if (end == start || (*end != '\0' && *end != '?') || value >= ALARM_ID_LIMIT) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Alarme inexistente");
+        return false;
+    }
+    *id = (uint16_t)value;
+    return true;
+}
+
+static esp_err_t send_store_result(httpd_req_t *req, esp_err_t err, const char *ok_msg)
+{
+    if (err == ESP_OK) {
+        httpd_resp_sendstr(req, ok_msg);
+    } else if (err == ESP_ERR_NOT_FOUND) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Alarme inexistente");
     } else {
         httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Falha ao salvar alarme");
     }
+    return ESP_OK;
+}
+
+// Lista de alarmes (importação): tudo numa única edição da store
+static esp_err_t post_alarm_list(httpd_req_t *req, const cJSON *root)
+{
+    int count = cJSON_GetArraySize(root);
+    if (count == 0 || count > MAX_ALARMS) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Lista vazia ou grande demais");
+        return ESP_OK;
+    }
+    alarm_t *alarms = malloc(count * sizeof(alarm_t));
+    int32_t *days = malloc(count * sizeof(int32_t));
+    if (!alarms || !days) {
+        free(alarms);
+        free(days);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Sem memória");
+        return ESP_OK;
+    }
+
+    int parsed = 0;
+    const cJSON *item;
+    cJSON_ArrayForEach(item, root) {
+        if (!parse_alarm(item, &alarms[parsed], &days[parsed])) {
+            break;
+        }
+        parsed++;
+    }
+
+    int added = 0;
+    int64_t start = esp_timer_get_time();
+    esp_err_t err = parsed == count ? alarm_store_add_batch(alarms, days, count, &added) : ESP_ERR_INVALID_ARG;
+    int64_t elapsed_us = esp_timer_get_time() - start;
+    free(alarms);
+    free(days);
+
+    if (err == ESP_ERR_INVALID_ARG) {
+        char msg[40];
+        snprintf(msg, sizeof(msg), "Alarme %d inválido", parsed);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, msg);
+        return ESP_OK;
+    }
+    ESP_LOGI(TAG, "Importados %d de %d alarmes em %lld us", added, count, (long long)elapsed_us);
+    if (err != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Falha ao salvar alarmes");
+        return ESP_OK;
+    }
+    char response[24];
+    snprintf(response, sizeof(response), "{\"added\":%d}", added);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, response);
+    return ESP_OK;
+}
+
+// Um alarme (objeto) ou vários de uma vez (lista)
+static esp_err_t post_alarm_handler(httpd_req_t *req)
+{
+    cJSON *root = recv_json(req);
+    if (!root) {
+        return ESP_FAIL;
+    }
+    if (cJSON_IsArray(root)) {
+        esp_err_t err = post_alarm_list(req, root);
+        cJSON_Delete(root);
+        return err;
+    }
 
+    alarm_t alarm;
+    int32_t day;
+    bool ok = parse_alarm(root, &alarm, &day);
     cJSON_Delete(root);
+    if (!ok) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Alarme inválido");
+        return ESP_FAIL;
+    }
+
+    uint16_t id;
+    if (alarm_store_add(&alarm, day, &id) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Falha ao salvar alarme");
+        return ESP_OK;
+    }
+    char response[24];
+    snprintf(response, sizeof(response), "{\"id\":%u}", id);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, response);
     return ESP_OK;
 }
 
+static esp_err_t put_alarm_handler(httpd_req_t *req)
+{
+    uint16_t id;
+    alarm_t alarm;
+    int32_t day;
+    if (!uri_alarm_id(req, &id) || !recv_alarm(req, &alarm, &day)) {
+        return ESP_FAIL;
+    }
+    return send_store_result(req, alarm_store_update(id, &alarm, day), "Alarme atualizado!");
+}
+
+static esp_err_t delete_alarm_handler(httpd_req_t *req)
+{
+    uint16_t id;
+    if (!uri_alarm_id(req, &id)) {
+        return ESP_FAIL;
+    }
+    return send_store_result(req, alarm_store_delete(id), "Alarme apagado!");
+}
+
 static esp_err_t delete_alarms_handler(httpd_req_t *req)
 {
-    if (nvs_storage_clear_alarms()) {
+    if (alarm_store_clear() == ESP_OK) {
         httpd_resp_sendstr(req, "Alarmes apagados com sucesso!");
     } else {
         httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Falha ao apagar alarmes");
@@ -98,6 +357,8 @@ void web_server_start(void)
 {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = 80;
+    config.uri_match_fn = httpd_uri_match_wildcard;
+    boot_tag = esp_random();
 
     ESP_LOGI(TAG, "Iniciando Web Server na porta %d...", config.server_port);
 
@@ -139,6 +400,24 @@ void web_server_start(void)
         };
         httpd_register_uri_handler(server, &delete_alarms_uri);
 
+        // PUT /alarms/<id>
+        httpd_uri_t put_alarm_uri = {
+            .uri       = "/alarms/*",
+            .method    = HTTP_PUT,
+            .handler   = put_alarm_handler,
+            .user_ctx  = NULL
+        };
+        httpd_register_uri_handler(server, &put_alarm_uri);
+
+        // DELETE /alarms/<id>
+        httpd_uri_t delete_alarm_uri = {
+            .uri       = "/alarms/*",
+            .method    = HTTP_DELETE,
+            .handler   = delete_alarm_handler,
+            .user_ctx  = NULL
+        };
+        httpd_register_uri_handler(server, &delete_alarm_uri);
+
     } else {
         ESP_LOGE(TAG, "Falha ao iniciar Web Server");
     }
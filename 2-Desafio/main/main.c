@@ -12,6 +12,7 @@
 #include "esp_spiffs.h"
 #include "esp_log.h"
 #include "alarm_audio_manager.h"
+#include "led_rgb.h"
 
 static const char *TAG = "MAIN";
 
@@ -56,6 +57,10 @@ void app_main(void)
     ESP_LOGI(TAG, "Inicializando armazenamento NVS...");
     nvs_storage_init();
 
+    // Relógio provisório antes de qualquer módulo que dependa do horário
+    ESP_LOGI(TAG, "Recuperando relógio...");
+    ntp_manager_init();
+
     ESP_LOGI(TAG, "Inicializando Wi-Fi Manager...");
     wifi_manager_init(NULL, NULL, on_wifi_connected);
 
@@ -66,6 +71,9 @@ void app_main(void)
     buzzer_manager_init();
     //ntp_manager_start();
 
+    ESP_LOGI(TAG, "Inicializando LED RGB...");
+    led_rgb_init();
+
     ESP_LOGI(TAG, "Inicializando Alarm Manager...");
     alarm_manager_init();
 
@@ -83,39 +91,73 @@ void app_main(void)
     button_manager_add_button(GPIO_NUM_3, BUTTON_PULL_UP, NULL); // BT_B
     button_manager_add_button(GPIO_NUM_2, BUTTON_PULL_UP, NULL); // BT_A
 
+    // BT_UP/BT_DOWN: auto-repeat acelerado para rolar listas longas, sem espera de duplo clique
+    button_gesture_config_t nav_config = BUTTON_GESTURE_CONFIG_DEFAULT();
+    nav_config.double_click_us = 0;
+    nav_config.long_press_us = 0;
+    nav_config.repeat_delay_us = 500000;
+    button_manager_set_gesture_config(GPIO_NUM_7, &nav_config);
+    button_manager_set_gesture_config(GPIO_NUM_4, &nav_config);
+
     while (1) {
+        button_event_t event;
+
+        // Bloqueia até o próximo evento de botão
+        if (!button_manager_wait_event(&event, portMAX_DELAY)) {
+            continue;
+        }
+        gpio_num_t bt = event.gpio;
+        screen_t screen = display_manager_get_screen();
 
-       
-        display_manager_update();
+        // Segurar BT_LEFT volta direto para a tela principal
+        if (event.type == BUTTON_EVENT_LONG_PRESS && bt == GPIO_NUM_6 &&
+            screen != SCREEN_MAIN && screen != SCREEN_EMERGENCY) {
+            display_manager_set_screen(SCREEN_MAIN);
+            buzzer_manager_play(BUZZER_MELODY_BEEP, 100);
+            continue;
+        }
+
+        // Rolagem contínua enquanto BT_UP/BT_DOWN estiverem pressionados
+        if (event.type == BUTTON_EVENT_REPEAT) {
+            if (screen == SCREEN_MENU) {
+                if (bt == GPIO_NUM_4) display_manager_next_menu();
+                if (bt == GPIO_NUM_7) display_manager_prev_menu();
+            } else if (screen == SCREEN_ALARMS) {
+                if (bt == GPIO_NUM_4) display_manager_next_alarm();
+                if (bt == GPIO_NUM_7) display_manager_prev_alarm();
+            }
+            continue;
+        }
+
+        if (event.type != BUTTON_EVENT_PRESS) {
+            continue;
+        }
 
         // Emergência: BT_B (GPIO_NUM_3)
-        if (button_manager_was_pressed(GPIO_NUM_3)) {
+        if (bt == GPIO_NUM_3) {
             display_manager_set_screen(SCREEN_EMERGENCY);
             alarm_audio_manager_play(ALARM_AUDIO_TYPE_EMERGENCY);
-            vTaskDelay(pdMS_TO_TICKS(100)); // debounce
             continue;
         }
 
-        screen_t screen = display_manager_get_screen();
-
         switch (screen) {
             case SCREEN_MAIN:
-                if (button_manager_was_pressed(GPIO_NUM_2)) {  // BT_A = ENTER
+                if (bt == GPIO_NUM_2) {  // BT_A = ENTER
                     display_manager_set_screen(SCREEN_MENU);
                     buzzer_manager_play(BUZZER_MELODY_BEEP, 100);
                 }
                 break;
 
             case SCREEN_MENU:
-                if (button_manager_was_pressed(GPIO_NUM_4)) { // BT_DOWN
+                if (bt == GPIO_NUM_4) { // BT_DOWN
                     display_manager_next_menu();
                     buzzer_manager_play(BUZZER_MELODY_BEEP, 100);
                 }
-                if (button_manager_was_pressed(GPIO_NUM_7)) { // BT_UP
+                if (bt == GPIO_NUM_7) { // BT_UP
                     display_manager_prev_menu();
                     buzzer_manager_play(BUZZER_MELODY_BEEP, 100);
                 }
-                if (button_manager_was_pressed(GPIO_NUM_2)) { // BT_A = ENTER
+                if (bt == GPIO_NUM_2) { // BT_A = ENTER
                     if (display_manager_get_menu_index() == 0) {
                         display_manager_set_screen(SCREEN_ALARMS);
                     } else {
@@ -123,29 +165,29 @@ void app_main(void)
                     }
                     buzzer_manager_play(BUZZER_MELODY_BEEP, 100);
                 }
-                if (button_manager_was_pressed(GPIO_NUM_6)) { // BT_LEFT = VOLTAR
+                if (bt == GPIO_NUM_6) { // BT_LEFT = VOLTAR
                     display_manager_set_screen(SCREEN_MAIN);
                     buzzer_manager_play(BUZZER_MELODY_BEEP, 100);
                 }
                 break;
 
             case SCREEN_ALARMS:
-                if (button_manager_was_pressed(GPIO_NUM_4)) { // BT_DOWN
+                if (bt == GPIO_NUM_4) { // BT_DOWN
                     display_manager_next_alarm();
                     buzzer_manager_play(BUZZER_MELODY_BEEP, 100);
                 }
-                if (button_manager_was_pressed(GPIO_NUM_7)) { // BT_UP
+                if (bt == GPIO_NUM_7) { // BT_UP
                     display_manager_prev_alarm();
                     buzzer_manager_play(BUZZER_MELODY_BEEP, 100);
                 }
-                if (button_manager_was_pressed(GPIO_NUM_2) || button_manager_was_pressed(GPIO_NUM_6)) {
+                if (bt == GPIO_NUM_2 || bt == GPIO_NUM_6) {
                     display_manager_set_screen(SCREEN_MENU);
                     buzzer_manager_play(BUZZER_MELODY_BEEP, 100);
                 }
                 break;
 
             case SCREEN_EMERGENCY:
-                if (button_manager_was_pressed(GPIO_NUM_2) || button_manager_was_pressed(GPIO_NUM_6)) {
+                if (bt == GPIO_NUM_2 || bt == GPIO_NUM_6) {
                     display_manager_set_screen(SCREEN_MAIN);
                     alarm_audio_manager_stop();
                     buzzer_manager_play(BUZZER_MELODY_BEEP, 100);
@@ -155,7 +197,5 @@ void app_main(void)
             default:
                 break;
         }
-
-        vTaskDelay(pdMS_TO_TICKS(50)); // Loop interval
     }
-}
\ No newline at end of file
+}
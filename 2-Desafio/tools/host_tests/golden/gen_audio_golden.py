@@ -0,0 +1,190 @@
+#!/usr/bin/env python3
+"""Gera os vetores de referência de test_audio_golden.c.
+
+Cada caso WAV vira <nome>.wav (entrada) e <nome>.u8 (saída esperada do
+audio_source_wav, 8 bits sem sinal na taxa do DAC). Cada caso do reamostrador
+vira rs_<entrada>.bin com as amostras de entrada e a saída esperada.
+
+As saídas vêm de um modelo em Python escrito a partir da especificação de cada
+etapa (G.711, IMA-ADPCM de wav2adpcm.py, Q16.16 linear com fração em Q15), não
+do código C. Os arquivos gerados ficam no repositório: só rode de novo se o
+comportamento mudar de propósito, e revise a diferença.
+
+Uso:
+    python gen_audio_golden.py
+"""
+
+import math
+import os
+import random
+import struct
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(HERE, "..", ".."))
+import wav2adpcm  # noqa: E402
+
+DAC_RATE = 11025
+
+
+def s16(x):
+    return max(-32768, min(32767, int(x)))
+
+
+def signal(rate, seconds, seed):
+    """Varredura de 200 Hz a 3 kHz com ruído, saturando nas pontas."""
+    rng = random.Random(seed)
+    n = int(rate * seconds)
+    out = []
+    phase = 0.0
+    for i in range(n):
+        f = 200 + 2800 * i / n
+        phase += 2 * math.pi * f / rate
+        out.append(s16(36000 * math.sin(phase) + rng.randint(-2000, 2000)))
+    return out
+
+
+# --- Modelo de referência ---------------------------------------------------
+
+def resample(samples, in_rate):
+    step = (in_rate << 16) // DAC_RATE
+    last = (len(samples) - 1) << 16
+    out = []
+    pos = 0
+    while pos < last:
+        a = samples[pos >> 16]
+        b = samples[(pos >> 16) + 1]
+        frac = (pos & 0xFFFF) >> 1
+        out.append(a + (((b - a) * frac) >> 15))
+        pos += step
+    return out
+
+
+def to_u8(samples):
+    return bytes(((s >> 8) + 128) & 0xFF for s in samples)
+
+
+def ulaw_to_s16(u):
+    # G.711: expoente nos bits 4-6, mantissa nos bits 0-3, bias de 0x84
+    u = ~u & 0xFF
+    magnitude = ((((u & 0x0F) << 3) + 0x84) << ((u >> 4) & 7)) - 0x84
+    return -magnitude if u & 0x80 else magnitude
+
+
+def alaw_to_s16(a):
+    a ^= 0x55
+    seg = (a >> 4) & 7
+    mant = a & 0x0F
+    magnitude = (mant << 4) + 8 if seg == 0 else ((mant << 4) + 0x108) << (seg - 1)
+    return magnitude if a & 0x80 else -magnitude
+
+
+# --- Codificadores das entradas -----------------------------------------------
+
+def ulaw_encode(s):
+    sign = 0x80 if s < 0 else 0
+    m = min(abs(s), 32635) + 0x84
+    exp = max(0, m.bit_length() - 8)
+    exp = min(exp, 7)
+    mant = (m >> (exp + 3)) & 0x0F
+    return ~(sign | (exp << 4) | mant) & 0xFF
+
+
+def alaw_encode(s):
+    sign = 0x80 if s >= 0 else 0
+    m = min(abs(s), 32767) >> 3
+    if m < 32:
+        code = m >> 1
+    else:
+        exp = m.bit_length() - 5
+        code = (exp << 4) | ((m >> exp) & 0x0F)
+    return (sign | code) ^ 0x55
+
+
+def chunk(tag, data):
+    out = tag + struct.pack("<I", len(data)) + data
+    return out + b"\0" if len(data) % 2 else out
+
+
+def fmt_chunk(tag, channels, rate, bits, extra=b""):
+    block = channels * max(bits, 8) // 8
+    return chunk(b"fmt ", struct.pack("<HHIIHH", tag, channels, rate, rate * block, block, bits) + extra)
+
+
+def riff(*chunks):
+    body = b"WAVE" + b"".join(chunks)
+    return b"RIFF" + struct.pack("<I", len(body)) + body
+
+
+def pcm16(samples):
+    return struct.pack("<%dh" % len(samples), *samples)
+
+
+def write(name, data):
+    with open(os.path.join(HERE, name), "wb") as f:
+        f.write(data)
+
+
+def wav_case(name, wav, decoded, in_rate):
+    """decoded: amostras int16 mono na taxa de entrada, já como o dispositivo as vê."""
+    write(name + ".wav", wav)
+    write(name + ".u8", to_u8(resample(decoded, in_rate)))
+
+
+def main():
+    # PCM 16 bits estéreo 22050 Hz; fmt com cbSize e um LIST de tamanho ímpar antes do data
+    left = signal(22050, 0.2, 1)
+    right = signal(22050, 0.2, 2)
+    stereo = [v for pair in zip(left, right) for v in pair]
+    wav_case("pcm16_stereo_22050",
+             riff(fmt_chunk(1, 2, 22050, 16, struct.pack("<H", 0)), chunk(b"LIST", b"INFOabc"),
+                  chunk(b"data", pcm16(stereo))),
+             [(l + r) >> 1 for l, r in zip(left, right)], 22050)
+
+    # PCM 8 bits mono 8000 Hz, chunk desconhecido antes do fmt
+    mono8 = [((s >> 8) + 128) & 0xFF for s in signal(8000, 0.2, 3)]
+    wav_case("pcm8_mono_8000",
+             riff(chunk(b"junk", b"\x01\x02\x03"), fmt_chunk(1, 1, 8000, 8), chunk(b"data", bytes(mono8))),
+             [(b - 128) << 8 for b in mono8], 8000)
+
+    # PCM 8 bits mono na taxa do DAC: passa direto, sem conversão
+    direct = bytes(((s >> 8) + 128) & 0xFF for s in signal(DAC_RATE, 0.1, 4))
+    write("pcm8_passthrough.wav", riff(fmt_chunk(1, 1, DAC_RATE, 8), chunk(b"data", direct)))
+    write("pcm8_passthrough.u8", direct)
+
+    # PCM 16 bits mono 44100 Hz em WAVE_FORMAT_EXTENSIBLE (fmt de 40 bytes)
+    mono16 = signal(44100, 0.1, 5)
+    ext = struct.pack("<HHI16s", 22, 16, 4, b"\x01\x00\x00\x00\x00\x00\x10\x00\x80\x00\x00\xaa\x00\x38\x9b\x71")
+    wav_case("pcm16_ext_44100",
+             riff(fmt_chunk(0xFFFE, 1, 44100, 16, ext), chunk(b"data", pcm16(mono16))), mono16, 44100)
+
+    # µ-law mono 8000 Hz e A-law estéreo 16000 Hz
+    ulaw = bytes(ulaw_encode(s) for s in signal(8000, 0.2, 6))
+    wav_case("ulaw_mono_8000",
+             riff(fmt_chunk(7, 1, 8000, 8), chunk(b"data", ulaw)), [ulaw_to_s16(u) for u in ulaw], 8000)
+    alaw_l = [alaw_encode(s) for s in signal(16000, 0.1, 7)]
+    alaw_r = [alaw_encode(s) for s in signal(16000, 0.1, 8)]
+    alaw = bytes(v for pair in zip(alaw_l, alaw_r) for v in pair)
+    wav_case("alaw_stereo_16000",
+             riff(fmt_chunk(6, 2, 16000, 8), chunk(b"data", alaw)),
+             [(alaw_to_s16(l) + alaw_to_s16(r)) >> 1 for l, r in zip(alaw_l, alaw_r)], 16000)
+
+    # IMA-ADPCM mono 11025 Hz, blocos de 256 bytes e o último incompleto
+    adpcm_in = signal(DAC_RATE, 0.25, 9)
+    adpcm = wav2adpcm.encode(adpcm_in, 256)
+    per_block = 1 + (256 - wav2adpcm.HEADER_BYTES) * 2
+    fmt = struct.pack("<HHIIHHHH", 0x11, 1, DAC_RATE, DAC_RATE * 256 // per_block, 256, 4, 2, per_block)
+    wav_case("adpcm_mono_11025",
+             riff(chunk(b"fmt ", fmt), chunk(b"fact", struct.pack("<I", len(adpcm_in))), chunk(b"data", adpcm)),
+             wav2adpcm.decode(adpcm, 256, 1 << 30), DAC_RATE)
+
+    # Reamostrador sozinho: int16 com saltos de fundo de escala entre amostras vizinhas
+    rng = random.Random(10)
+    for in_rate in (7350, 8000, 11025, 22050, 44100, 48000):
+        samples = [rng.choice((-32768, 32767, rng.randint(-32768, 32767))) for _ in range(in_rate // 10)]
+        out = resample(samples, in_rate)
+        write("rs_%d.bin" % in_rate, struct.pack("<II", len(samples), len(out)) + pcm16(samples) + pcm16(out))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,64 @@
+#!/bin/sh
+# Compila e roda os testes de host (Linux, gcc) dos componentes sem dependência de hardware.
+# Stand-ins do ESP-IDF: tools/nvs_host (esp_err, esp_log, esp_timer, NVS) e stubs/.
+# Uso, de qualquer diretório: tools/host_tests/run.sh
+set -e
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+ROOT=$(cd "$HERE/../.." && pwd)
+C=$ROOT/components
+OUT=${OUT:-/tmp/host_tests}
+CFLAGS="-O2 -Wall -Wextra -Wno-unused-parameter -I$HERE/stubs -I$ROOT/tools/nvs_host"
+mkdir -p "$OUT"
+
+run() {
+    name=$1
+    shift
+    echo "== $name"
+    gcc $CFLAGS "$@" -o "$OUT/$name" -lm -lpthread
+    (cd "$HERE" && "$OUT/$name")
+}
+
+run test_display_widgets -I$C/display_manager/include -I$ROOT/managed_components/nopnop2002__ssd1306 \
+    $C/display_manager/display_widgets.c $HERE/test_display_widgets.c
+
+run test_button_gesture -I$C/button_manager/include \
+    $C/button_manager/button_gesture.c $HERE/test_button_gesture.c
+
+run test_button_debounce -I$C/button_manager/include \
+    $C/button_manager/button_debounce.c $HERE/test_button_debounce.c
+
+run test_audio_ring -I$C/alarm_audio_manager/include \
+    $C/alarm_audio_manager/audio_ring.c $HERE/test_audio_ring.c
+
+A=$C/alarm_audio_manager
+run test_audio_golden -I$A/include \
+    $A/audio_wav.c $A/audio_convert.c $A/audio_adpcm.c $A/audio_resampler.c $A/audio_source_mem.c \
+    $HERE/test_audio_golden.c
+
+run test_audio_mixer -I$A/include \
+    $A/audio_mixer.c $A/audio_pipeline.c $A/audio_ring.c $A/audio_source_mem.c $HERE/stubs/freertos_host.c \
+    $HERE/test_audio_mixer.c
+
+run test_clock_cache -I$C/ntp_manager/include \
+    $C/ntp_manager/clock_cache.c $HERE/test_clock_cache.c
+
+run test_json_writer -I$C/web_server/include \
+    $C/web_server/json_writer.c $HERE/test_json_writer.c
+
+B=$C/buzzer_manager
+run test_buzzer_sequencer -I$B/include \
+    $B/buzzer_rtttl.c $B/buzzer_sequencer.c $HERE/stubs/freertos_host.c $HERE/test_buzzer_sequencer.c
+
+run test_alarm_schedule -I$C/alarm_manager/include -I$C/nvs_storage/include \
+    $C/alarm_manager/alarm_schedule.c $HERE/test_alarm_schedule.c
+
+run test_alarm_actions -I$C/alarm_manager/include -I$C/buzzer_manager/include -I$A/include -I$C/led_rgb/include \
+    $C/alarm_manager/alarm_actions.c $HERE/stubs/freertos_host.c $HERE/test_alarm_actions.c
+
+run test_nvs_storage -I$C/nvs_storage/include -I$C/persist_record/include \
+    $C/nvs_storage/nvs_storage.c $C/persist_record/persist_record.c $ROOT/tools/nvs_host/nvs_file.c \
+    $HERE/test_nvs_storage.c
+
+run test_audio_synth -I$A/include \
+    $A/audio_synth.c $HERE/test_audio_synth.c
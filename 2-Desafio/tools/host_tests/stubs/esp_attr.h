@@ -0,0 +1,4 @@
+#pragma once
+// Stand-in do esp_attr.h para os testes de host: sem seções de IRAM/DRAM
+#define IRAM_ATTR
+#define DRAM_ATTR
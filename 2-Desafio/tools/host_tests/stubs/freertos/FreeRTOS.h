@@ -0,0 +1,34 @@
+#pragma once
+// Stand-in do FreeRTOS para os testes de host, sobre pthreads (freertos_host.c).
+// Só o que os componentes testados usam; as seções críticas viram um mutex global.
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY ((TickType_t)0xffffffffu)
+
+// Mesmo tick do firmware (CONFIG_FREERTOS_HZ=100)
+#define configTICK_RATE_HZ 100
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+
+typedef struct {
+    int unused;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED { 0 }
+#define portMUX_INITIALIZE(mux) ((void)(mux))
+
+void freertos_host_enter_critical(void);
+void freertos_host_exit_critical(void);
+
+#define portENTER_CRITICAL(mux) ((void)(mux), freertos_host_enter_critical())
+#define portEXIT_CRITICAL(mux) ((void)(mux), freertos_host_exit_critical())
+#define portENTER_CRITICAL_ISR(mux) portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux) portEXIT_CRITICAL(mux)
@@ -0,0 +1,261 @@
+#define _GNU_SOURCE
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct freertos_host_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    uint8_t *items;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+struct freertos_host_semaphore {
+    pthread_mutex_t lock;
+};
+
+typedef struct {
+    TaskFunction_t fn;
+    void *param;
+    pthread_mutex_t lock;
+    pthread_cond_t notified;
+    uint32_t notify_count;
+} freertos_host_task_t;
+
+static __thread freertos_host_task_t *current_task = NULL;
+
+// Recursivo como as seções críticas aninhadas do ESP-IDF
+static pthread_mutex_t critical = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+void freertos_host_enter_critical(void)
+{
+    pthread_mutex_lock(&critical);
+}
+
+void freertos_host_exit_critical(void)
+{
+    pthread_mutex_unlock(&critical);
+}
+
+static int64_t monotonic_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void init_cond(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static struct timespec deadline_after(TickType_t wait)
+{
+    int64_t us = monotonic_us() + (int64_t)wait * portTICK_PERIOD_MS * 1000;
+    return (struct timespec) { us / 1000000, (us % 1000000) * 1000 };
+}
+
+// O estado da task fica vivo até o fim do processo: o handle pode ser notificado a qualquer hora
+static void *task_entry(void *arg)
+{
+    current_task = arg;
+    current_task->fn(current_task->param);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *param, UBaseType_t priority,
+                       TaskHandle_t *handle)
+{
+    freertos_host_task_t *task = calloc(1, sizeof(*task));
+    if (!task) {
+        return pdFAIL;
+    }
+    task->fn = fn;
+    task->param = param;
+    pthread_mutex_init(&task->lock, NULL);
+    init_cond(&task->notified);
+    if (handle) {
+        *handle = task;
+    }
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, task_entry, task) != 0) {
+        if (handle) {
+            *handle = NULL;
+        }
+        free(task);
+        return pdFAIL;
+    }
+    pthread_detach(thread);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t wait)
+{
+    freertos_host_task_t *task = current_task;
+    struct timespec deadline = deadline_after(wait);
+    pthread_mutex_lock(&task->lock);
+    while (task->notify_count == 0 && wait != 0) {
+        if (wait == portMAX_DELAY) {
+            pthread_cond_wait(&task->notified, &task->lock);
+        } else if (pthread_cond_timedwait(&task->notified, &task->lock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    uint32_t count = task->notify_count;
+    if (count > 0) {
+        task->notify_count = clear_on_exit ? 0 : count - 1;
+    }
+    pthread_mutex_unlock(&task->lock);
+    return count;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t handle)
+{
+    freertos_host_task_t *task = handle;
+    pthread_mutex_lock(&task->lock);
+    task->notify_count++;
+    pthread_cond_signal(&task->notified);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t handle, BaseType_t *higher_priority_woken)
+{
+    xTaskNotifyGive(handle);
+    if (higher_priority_woken) {
+        *higher_priority_woken = pdFALSE;
+    }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    int64_t us = (int64_t)ticks * portTICK_PERIOD_MS * 1000;
+    struct timespec ts = { us / 1000000, (us % 1000000) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(monotonic_us() / (portTICK_PERIOD_MS * 1000));
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    QueueHandle_t queue = calloc(1, sizeof(*queue));
+    if (!queue) {
+        return NULL;
+    }
+    queue->items = malloc((size_t)length * item_size);
+    if (!queue->items) {
+        free(queue);
+        return NULL;
+    }
+    init_cond(&queue->changed);
+    pthread_mutex_init(&queue->lock, NULL);
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+// Espera a condição até o prazo; false se o tempo acabou antes
+static bool wait_until(QueueHandle_t queue, bool (*ready)(QueueHandle_t), TickType_t wait)
+{
+    struct timespec deadline = deadline_after(wait);
+    while (!ready(queue)) {
+        if (wait == 0) {
+            return false;
+        }
+        if (wait == portMAX_DELAY) {
+            pthread_cond_wait(&queue->changed, &queue->lock);
+        } else if (pthread_cond_timedwait(&queue->changed, &queue->lock, &deadline) == ETIMEDOUT) {
+            return ready(queue);
+        }
+    }
+    return true;
+}
+
+static bool has_room(QueueHandle_t queue)
+{
+    return queue->count < queue->length;
+}
+
+static bool has_item(QueueHandle_t queue)
+{
+    return queue->count > 0;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait)
+{
+    pthread_mutex_lock(&queue->lock);
+    bool ok = wait_until(queue, has_room, wait);
+    if (ok) {
+        UBaseType_t tail = (queue->head + queue->count) % queue->length;
+        memcpy(queue->items + (size_t)tail * queue->item_size, item, queue->item_size);
+        queue->count++;
+        pthread_cond_broadcast(&queue->changed);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait)
+{
+    pthread_mutex_lock(&queue->lock);
+    bool ok = wait_until(queue, has_item, wait);
+    if (ok) {
+        memcpy(item, queue->items + (size_t)queue->head * queue->item_size, queue->item_size);
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        pthread_cond_broadcast(&queue->changed);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    SemaphoreHandle_t sem = calloc(1, sizeof(*sem));
+    if (sem) {
+        pthread_mutex_init(&sem->lock, NULL);
+    }
+    return sem;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t wait)
+{
+    if (wait == portMAX_DELAY) {
+        return pthread_mutex_lock(&sem->lock) == 0 ? pdTRUE : pdFALSE;
+    }
+    if (wait == 0) {
+        return pthread_mutex_trylock(&sem->lock) == 0 ? pdTRUE : pdFALSE;
+    }
+    struct timespec deadline = deadline_after(wait);
+    return pthread_mutex_clocklock(&sem->lock, CLOCK_MONOTONIC, &deadline) == 0 ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    return pthread_mutex_unlock(&sem->lock) == 0 ? pdTRUE : pdFALSE;
+}
@@ -0,0 +1,3 @@
+#pragma once
+// Stand-in do sdkconfig.h para os testes de host
+#define CONFIG_ALARM_WEBHOOK_URL "http://host.test/alarm"
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Substituto do driver SSD1306: guarda a imagem em RAM e conta os bytes enviados
+typedef struct {
+    int _pages;
+    bool _flip;
+    uint8_t page[8][128];
+    size_t bytes_sent;
+    int transfers;
+} SSD1306_t;
+
+static inline int ssd1306_get_pages(SSD1306_t *dev)
+{
+    return dev->_pages;
+}
+
+static inline void ssd1306_display_image(SSD1306_t *dev, int page, int seg, const uint8_t *images, int width)
+{
+    for (int i = 0; i < width && seg + i < 128; i++) {
+        dev->page[page][seg + i] = images[i];
+    }
+    dev->bytes_sent += width;
+    dev->transfers++;
+}
+
+static inline void ssd1306_clear_screen(SSD1306_t *dev, bool invert)
+{
+    for (int p = 0; p < dev->_pages; p++) {
+        for (int i = 0; i < 128; i++) {
+            dev->page[p][i] = invert ? 0xFF : 0x00;
+        }
+    }
+    dev->bytes_sent += dev->_pages * 128;
+    dev->transfers += dev->_pages;
+}
+
+static inline void ssd1306_invert(uint8_t *buf, size_t blen)
+{
+    for (size_t i = 0; i < blen; i++) {
+        buf[i] = ~buf[i];
+    }
+}
+
+static inline void ssd1306_flip(uint8_t *buf, size_t blen)
+{
+    (void)buf;
+    (void)blen;
+}
@@ -0,0 +1,258 @@
+// Executor de ações dos alarmes sobre o FreeRTOS de host (stubs/freertos_host.c),
+// com buzzer, áudio, LED e webhook falsos que só registram a chamada. Confere
+// aglutinação, novas tentativas e a contabilidade das estatísticas, lidas o tempo
+// todo por outra thread, e mede a latência do disparo ao início das ações. Os
+// falsos retornam na hora: a medida é o custo do executor (fila, troca de thread,
+// despacho), não o do buzzer ou do DAC, que têm estatísticas próprias.
+#include "alarm_actions.h"
+#include "buzzer_manager.h"
+#include "alarm_audio_manager.h"
+#include "led_rgb.h"
+#include "esp_http_client.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#define LATENCY_ALARMS 1000
+#define BURST_ROUNDS 100
+#define BURST_ALARMS 4
+
+static atomic_int audio_failures = 0;       // Próximas chamadas do áudio que falham
+static atomic_int stop_reader = 0;
+static atomic_int failed = 0;
+
+esp_err_t buzzer_manager_play_priority(buzzer_melody_t melody, uint32_t duration_ms, buzzer_priority_t priority)
+{
+    return ESP_OK;
+}
+
+esp_err_t buzzer_manager_enqueue(buzzer_melody_t melody, uint32_t duration_ms, buzzer_priority_t priority)
+{
+    return ESP_OK;
+}
+
+esp_err_t alarm_audio_manager_play(alarm_audio_type_t type)
+{
+    if (audio_failures > 0) {
+        audio_failures--;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void led_rgb_play_pattern(const led_rgb_step_t *steps, uint8_t repeat)
+{
+}
+
+static int http_client;
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config)
+{
+    return (esp_http_client_handle_t)&http_client;
+}
+
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char *key, const char *value)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_post_field(esp_http_client_handle_t client, const char *data, int len)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_perform(esp_http_client_handle_t client)
+{
+    return ESP_OK;
+}
+
+int esp_http_client_get_status_code(esp_http_client_handle_t client)
+{
+    return 200;
+}
+
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client)
+{
+    return ESP_OK;
+}
+
+static int64_t wall_us(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static uint32_t finished(const alarm_action_stats_t *s)
+{
+    return s->started + s->coalesced + s->failed + s->dropped;
+}
+
+// Espera o executor tirar da fila tudo o que foi enviado
+static void wait_idle(alarm_action_stats_t *out)
+{
+    do {
+        sched_yield();
+        alarm_actions_get_stats(out);
+    } while (finished(out) < out->submitted);
+}
+
+// Cópias sempre coerentes: nada sai do executor sem ter sido contado na entrada
+static void *stats_reader(void *arg)
+{
+    uint32_t reads = 0;
+    while (!stop_reader && !failed) {
+        alarm_action_stats_t s;
+        alarm_actions_get_stats(&s);
+        if (finished(&s) > s.submitted || s.last_start_latency_us > s.max_start_latency_us) {
+            printf("FALHOU leitura %u: enviadas %u, finalizadas %u, latência %u > máx %u\n", (unsigned)reads,
+                   (unsigned)s.submitted, (unsigned)finished(&s), (unsigned)s.last_start_latency_us,
+                   (unsigned)s.max_start_latency_us);
+            failed = 1;
+        }
+        reads++;
+        sched_yield();  // Com um só núcleo, o executor precisa rodar
+    }
+    return NULL;
+}
+
+static void check(const char *name, uint32_t got, uint32_t expected)
+{
+    if (got != expected) {
+        printf("FALHOU %s: %u, esperado %u\n", name, (unsigned)got, (unsigned)expected);
+        failed = 1;
+    }
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void report(const char *name, uint32_t *samples, int n)
+{
+    qsort(samples, n, sizeof(*samples), compare_u32);
+    printf("%s: mín %u us, mediana %u us, p99 %u us, máx %u us (%d medidas)\n", name, (unsigned)samples[0],
+           (unsigned)samples[n / 2], (unsigned)samples[n * 99 / 100], (unsigned)samples[n - 1], n);
+}
+
+static void test_accounting(void)
+{
+    alarm_action_stats_t before, after;
+    alarm_actions_get_stats(&before);
+    time_t fire_at = time(NULL);
+
+    // Duas melodias iguais no mesmo disparo: a segunda é aglutinada
+    alarm_action_t first[] = {
+        { ALARM_ACTION_MELODY, 1 }, { ALARM_ACTION_AUDIO, 0 }, { ALARM_ACTION_LED, 0 }, { ALARM_ACTION_NOTIFY, 7 },
+    };
+    alarm_action_t second[] = { { ALARM_ACTION_MELODY, 1 } };
+    alarm_actions_submit(first, 4, fire_at);
+    alarm_actions_submit(second, 1, fire_at);
+    wait_idle(&after);
+    check("enviadas", after.submitted - before.submitted, 5);
+    check("iniciadas", after.started - before.started, 4);
+    check("aglutinadas", after.coalesced - before.coalesced, 1);
+
+    // Falha uma vez e começa na segunda tentativa
+    before = after;
+    audio_failures = 1;
+    alarm_action_t audio[] = { { ALARM_ACTION_AUDIO, 1 } };
+    alarm_actions_submit(audio, 1, fire_at);
+    wait_idle(&after);
+    check("repetidas", after.retried - before.retried, 1);
+    check("iniciadas após repetir", after.started - before.started, 1);
+
+    // Falha sempre: desiste após ALARM_ACTIONS_MAX_ATTEMPTS
+    before = after;
+    audio_failures = 1000;
+    audio[0].param = 2;     // Outro clipe, para não ser aglutinado com o anterior
+    alarm_actions_submit(audio, 1, fire_at);
+    wait_idle(&after);
+    audio_failures = 0;
+    check("desistências", after.failed - before.failed, 1);
+    check("repetidas até desistir", after.retried - before.retried, 2);
+
+    // O webhook roda na própria task; espera ela terminar
+    for (int i = 0; i < 1000 && after.notify_sent == 0; i++) {
+        sched_yield();
+        alarm_actions_get_stats(&after);
+    }
+    check("webhooks", after.notify_sent, 1);
+}
+
+// Latência do lote: o alarme é enviado com um disparo já passado, e a parte
+// anterior ao envio é descontada da medida do executor
+static uint32_t executor_latency(const alarm_action_stats_t *s, int64_t submit_us, time_t fire_at)
+{
+    int64_t before_submit = submit_us - (int64_t)fire_at * 1000000;
+    int64_t latency = (int64_t)s->last_start_latency_us - before_submit;
+    return latency > 0 ? (uint32_t)latency : 0;
+}
+
+static void test_latency(void)
+{
+    static uint32_t samples[LATENCY_ALARMS > BURST_ROUNDS ? LATENCY_ALARMS : BURST_ROUNDS];
+    alarm_action_stats_t s;
+
+    // Um alarme por vez, com o executor parado na fila; melodias distintas para não aglutinar
+    for (int i = 0; i < LATENCY_ALARMS; i++) {
+        alarm_action_t actions[] = {
+            { ALARM_ACTION_MELODY, i }, { ALARM_ACTION_AUDIO, i }, { ALARM_ACTION_LED, 0 },
+        };
+        int64_t submit_us = wall_us();
+        time_t fire_at = submit_us / 1000000;
+        alarm_actions_submit(actions, 3, fire_at);
+        wait_idle(&s);
+        samples[i] = executor_latency(&s, submit_us, fire_at);
+    }
+    report("Disparo -> início, alarme isolado (3 ações)", samples, LATENCY_ALARMS);
+
+    // Alarmes no mesmo segundo, enviados em sequência: vale o último a começar
+    for (int round = 0; round < BURST_ROUNDS; round++) {
+        int64_t submit_us = wall_us();
+        time_t fire_at = submit_us / 1000000;
+        for (int a = 0; a < BURST_ALARMS; a++) {
+            uint16_t param = round * BURST_ALARMS + a;
+            alarm_action_t actions[] = {
+                { ALARM_ACTION_MELODY, param }, { ALARM_ACTION_AUDIO, param }, { ALARM_ACTION_LED, 0 },
+                { ALARM_ACTION_NOTIFY, param },
+            };
+            alarm_actions_submit(actions, 4, fire_at);
+        }
+        wait_idle(&s);
+        samples[round] = executor_latency(&s, submit_us, fire_at);
+    }
+    report("Disparo -> início, 4 alarmes juntos (16 ações)", samples, BURST_ROUNDS);
+    check("descartadas", s.dropped, 0);
+}
+
+int main(void)
+{
+    if (alarm_actions_init() != ESP_OK) {
+        printf("FALHOU init\n");
+        return 1;
+    }
+
+    pthread_t reader;
+    pthread_create(&reader, NULL, stats_reader, NULL);
+    test_accounting();
+    test_latency();
+    stop_reader = 1;
+    pthread_join(reader, NULL);
+
+    alarm_action_stats_t s;
+    alarm_actions_get_stats(&s);
+    check("enviadas = finalizadas", finished(&s), s.submitted);
+    if (failed) {
+        return 1;
+    }
+    printf("OK: %u ações, %u aglutinadas, %u repetidas, %u desistências, %u webhooks\n", (unsigned)s.submitted,
+           (unsigned)s.coalesced, (unsigned)s.retried, (unsigned)s.failed, (unsigned)s.notify_sent);
+    return 0;
+}
@@ -0,0 +1,307 @@
+// Agenda dos alarmes (alarm_schedule.c): o próximo disparo pela máscara de dias
+// girada + ctz contra uma busca minuto a minuto em fusos fixos e com horário de
+// verão; os casos de transição (hora que não existe, hora repetida, máscara
+// atravessando a troca) com tm_isdst=-1; a conversão de datas civis num vaivém de
+// 40000 dias contra o gmtime; e o heap contra uma lista simples, disparo a disparo.
+#define _GNU_SOURCE
+#include "alarm_schedule.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define EPOCH_2000 946684800    // 2000-01-01 00:00 UTC
+#define SEARCH_DAYS 8
+#define RANDOM_CASES 150
+#define HEAP_STEPS 3000
+
+static int failed = 0;
+
+static void check(const char *name, long got, long expected)
+{
+    if (got != expected) {
+        printf("FALHOU %s: %ld, esperado %ld\n", name, got, expected);
+        failed = 1;
+    }
+}
+
+static long ns_now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000000L + t.tv_nsec;
+}
+
+static void set_tz(const char *tz)
+{
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+// alarm_store.c fica de fora: a data marcada vem da lista do próprio snapshot
+bool alarm_snapshot_date(const alarm_snapshot_t *snapshot, int index, uint16_t *day)
+{
+    for (int i = 0; i < snapshot->date_count; i++) {
+        if (snapshot->dates[i].index == index) {
+            *day = snapshot->dates[i].day;
+            return true;
+        }
+    }
+    return false;
+}
+
+static alarm_t make_alarm(int hour, int minute, uint32_t weekdays, bool one_shot)
+{
+    return (alarm_t) {
+        .minute_of_day = hour * 60 + minute,
+        .weekdays = weekdays,
+        .enabled = 1,
+        .one_shot = one_shot,
+    };
+}
+
+// Referência: o primeiro minuto depois de `after` com o horário e o dia da semana do alarme
+static time_t brute_next_fire(const alarm_t *alarm, time_t after)
+{
+    uint32_t mask = alarm->weekdays ? alarm->weekdays : (alarm->one_shot ? ALARM_WEEKDAYS_ALL : 0);
+    if (!mask) {
+        return -1;
+    }
+    for (time_t t = after - after % 60 + 60; t <= after + SEARCH_DAYS * 86400; t += 60) {
+        struct tm local;
+        localtime_r(&t, &local);
+        if (local.tm_hour * 60 + local.tm_min == (int)alarm->minute_of_day && local.tm_sec == 0 &&
+            (mask & ALARM_WEEKDAY_BIT(local.tm_wday))) {
+            return t;
+        }
+    }
+    return -1;
+}
+
+// Máscaras e horários aleatórios contra a busca; com horário de verão, longe da hora que
+// some ou repete (2h nesses fusos), onde "o minuto" não é único
+static void test_mask_against_search(void)
+{
+    static const struct {
+        const char *tz;
+        bool dst;
+    } zones[] = {
+        { "UTC0", false },
+        { "<-03>3", false },
+        { "<+0545>-5:45", false },
+        { "CET-1CEST,M3.5.0,M10.5.0/3", true },
+        { "EST5EDT,M3.2.0,M11.1.0", true },
+        { "NZST-12NZDT,M9.5.0,M4.1.0/3", true },
+    };
+    srand(40);
+    for (size_t z = 0; z < sizeof(zones) / sizeof(zones[0]); z++) {
+        set_tz(zones[z].tz);
+        int mismatches = 0;
+        for (int i = 0; i < RANDOM_CASES; i++) {
+            int hour = rand() % 24;
+            if (zones[z].dst && hour == 2) {
+                hour = 14;
+            }
+            uint32_t mask = rand() % 4 == 0 ? ALARM_WEEKDAY_BIT(rand() % 7) : (uint32_t)(rand() & ALARM_WEEKDAYS_ALL);
+            alarm_t alarm = make_alarm(hour, rand() % 60, mask, rand() % 2);
+            // Entre 2000 e 2037, às vezes em cima de um minuto cheio
+            time_t after = EPOCH_2000 + (time_t)(((uint64_t)rand() << 16 ^ rand()) % (37ull * 365 * 86400));
+            if (i % 5 == 0) {
+                after -= after % 60;
+            }
+            time_t got = alarm_schedule_next_fire(&alarm, ALARM_NO_DATE, after);
+            time_t want = brute_next_fire(&alarm, after);
+            if (got != want && mismatches++ < 3) {
+                printf("FALHOU máscara em %s: %02d:%02d dias 0x%02x depois de %lld: %lld, esperado %lld\n",
+                       zones[z].tz, hour, alarm.minute_of_day % 60, (unsigned)mask, (long long)after,
+                       (long long)got, (long long)want);
+                failed = 1;
+            }
+        }
+        printf("ok máscara contra a busca em %s: %d casos\n", zones[z].tz, RANDOM_CASES);
+    }
+
+    // Desligado, sem dias e repetitivo, e horário inválido
+    alarm_t off = make_alarm(7, 0, ALARM_WEEKDAYS_ALL, false);
+    off.enabled = 0;
+    check("desligado", alarm_schedule_next_fire(&off, ALARM_NO_DATE, EPOCH_2000), -1);
+    alarm_t no_days = make_alarm(7, 0, 0, false);
+    check("repetitivo sem dias", alarm_schedule_next_fire(&no_days, ALARM_NO_DATE, EPOCH_2000), -1);
+    alarm_t invalid = make_alarm(7, 0, ALARM_WEEKDAYS_ALL, false);
+    invalid.minute_of_day = ALARM_MINUTES_PER_DAY + 30;
+    check("horário inválido", alarm_schedule_next_fire(&invalid, ALARM_NO_DATE, EPOCH_2000), -1);
+}
+
+static time_t utc(int year, int month, int mday, int hour, int minute)
+{
+    struct tm t = { .tm_year = year - 1900, .tm_mon = month - 1, .tm_mday = mday, .tm_hour = hour, .tm_min = minute };
+    return timegm(&t);
+}
+
+static void expect_fire(const char *name, const alarm_t *alarm, int32_t day, time_t after, time_t want)
+{
+    time_t got = alarm_schedule_next_fire(alarm, day, after);
+    if (got != want) {
+        struct tm local;
+        char text[32] = "-1";
+        if (got >= 0) {
+            localtime_r(&got, &local);
+            strftime(text, sizeof(text), "%Y-%m-%d %H:%M %Z", &local);
+        }
+        printf("FALHOU %s: %lld (%s), esperado %lld\n", name, (long long)got, text, (long long)want);
+        failed = 1;
+    } else {
+        printf("ok %s\n", name);
+    }
+}
+
+// Transições de 2026 na Europa Central: 29/03 02:00 CET -> 03:00 CEST e 25/10 03:00 CEST -> 02:00 CET
+static void test_dst(void)
+{
+    set_tz("CET-1CEST,M3.5.0,M10.5.0/3");
+
+    // 07:00 todo dia: no sábado é 06:00 UTC, no domingo já é 05:00 UTC
+    alarm_t daily = make_alarm(7, 0, ALARM_WEEKDAYS_ALL, false);
+    expect_fire("diário antes da troca", &daily, ALARM_NO_DATE, utc(2026, 3, 27, 12, 0), utc(2026, 3, 28, 6, 0));
+    expect_fire("diário no dia da troca", &daily, ALARM_NO_DATE, utc(2026, 3, 28, 6, 0), utc(2026, 3, 29, 5, 0));
+
+    // Só segunda, pedido numa sexta de horário de verão: a segunda já é CET
+    alarm_t monday = make_alarm(7, 0, ALARM_WEEKDAY_BIT(1), false);
+    expect_fire("máscara atravessando o fim do horário de verão", &monday, ALARM_NO_DATE, utc(2026, 10, 23, 12, 0),
+                utc(2026, 10, 26, 6, 0));
+    expect_fire("máscara atravessando o início do horário de verão", &monday, ALARM_NO_DATE,
+                utc(2026, 3, 27, 12, 0), utc(2026, 3, 30, 5, 0));
+
+    // 02:30 não existe em 29/03: o mktime com tm_isdst=-1 leva para 03:30 CEST, no mesmo dia
+    alarm_t gap = make_alarm(2, 30, ALARM_WEEKDAYS_ALL, false);
+    expect_fire("hora que não existe", &gap, ALARM_NO_DATE, utc(2026, 3, 28, 23, 0), utc(2026, 3, 29, 1, 30));
+    expect_fire("hora que não existe: dia seguinte normal", &gap, ALARM_NO_DATE, utc(2026, 3, 29, 1, 30),
+                utc(2026, 3, 30, 0, 30));
+
+    // 02:30 acontece duas vezes em 25/10: dispara numa delas e a próxima é só no dia 26
+    time_t first = alarm_schedule_next_fire(&gap, ALARM_NO_DATE, utc(2026, 10, 24, 22, 0));
+    check("hora repetida: uma das duas", first == utc(2026, 10, 25, 0, 30) || first == utc(2026, 10, 25, 1, 30), 1);
+    expect_fire("hora repetida: uma vez só", &gap, ALARM_NO_DATE, first, utc(2026, 10, 26, 1, 30));
+
+    // Data marcada no dia da troca, resolvida no fuso daquele dia
+    alarm_t dated = make_alarm(8, 15, 0, true);
+    int32_t day = alarm_day_from_date(2026, 3, 29);
+    expect_fire("data marcada no dia da troca", &dated, day, utc(2026, 1, 1, 0, 0), utc(2026, 3, 29, 6, 15));
+    expect_fire("data marcada já passada", &dated, day, utc(2026, 3, 29, 6, 15), -1);
+}
+
+// Vaivém dia -> data -> dia em 40000 dias seguidos, com a data conferida contra o gmtime
+static void test_civil_dates(void)
+{
+    int errors = 0;
+    int prev_year = 0, prev_month = 0, prev_mday = 0;
+    for (int32_t day = -10000; day < 30000; day++) {
+        int year, month, mday;
+        alarm_day_to_date(day, &year, &month, &mday);
+        time_t t = EPOCH_2000 + (time_t)day * 86400;
+        struct tm tm;
+        gmtime_r(&t, &tm);
+        bool ok = alarm_day_from_date(year, month, mday) == day && year == tm.tm_year + 1900 &&
+                  month == tm.tm_mon + 1 && mday == tm.tm_mday;
+        // Datas seguidas: o dia avança um, ou vira o mês/ano no dia 1
+        ok &= day == -10000 || (mday == prev_mday + 1 && month == prev_month && year == prev_year) ||
+              (mday == 1 && (month == prev_month + 1 || (month == 1 && prev_month == 12 && year == prev_year + 1)));
+        if (!ok && errors++ < 3) {
+            printf("FALHOU data do dia %ld: %04d-%02d-%02d, gmtime %04d-%02d-%02d\n", (long)day, year, month, mday,
+                   tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday);
+        }
+        prev_year = year;
+        prev_month = month;
+        prev_mday = mday;
+    }
+    check("datas civis: erros em 40000 dias", errors, 0);
+    check("2000-01-01", alarm_day_from_date(2000, 1, 1), 0);
+    check("2000-02-29 (bissexto de 400)", alarm_day_from_date(2000, 3, 1) - alarm_day_from_date(2000, 2, 28), 2);
+    check("2100-02-28 (não bissexto)", alarm_day_from_date(2100, 3, 1) - alarm_day_from_date(2100, 2, 28), 1);
+}
+
+// Heap: o topo é sempre o mais cedo, disparando e reagendando como o alarm_manager
+static void test_heap(void)
+{
+    set_tz("CET-1CEST,M3.5.0,M10.5.0/3");
+    alarm_snapshot_t *snap = calloc(1, sizeof(alarm_snapshot_t) + MAX_ALARMS * sizeof(alarm_t));
+    snap->count = MAX_ALARMS;
+    srand(41);
+    for (int i = 0; i < MAX_ALARMS; i++) {
+        bool one_shot = i % 10 == 0;
+        snap->alarms[i] = make_alarm(rand() % 24, rand() % 60, rand() & ALARM_WEEKDAYS_ALL, one_shot);
+        snap->alarms[i].enabled = i % 17 != 0;
+        if (one_shot && snap->date_count < MAX_ALARM_DATES) {
+            snap->alarms[i].has_date = 1;
+            snap->dates[snap->date_count++] = (alarm_date_t) { (uint16_t)i, (uint16_t)(9600 + rand() % 30) };
+        }
+    }
+
+    time_t now = utc(2026, 3, 20, 12, 0);
+    static time_t model[MAX_ALARMS];
+    int scheduled = 0;
+    for (int i = 0; i < MAX_ALARMS; i++) {
+        uint16_t day;
+        int32_t date = snap->alarms[i].has_date && alarm_snapshot_date(snap, i, &day) ? day : ALARM_NO_DATE;
+        model[i] = alarm_schedule_next_fire(&snap->alarms[i], date, now);
+        scheduled += model[i] >= 0;
+    }
+
+    static alarm_schedule_t sched;
+    long t0 = ns_now();
+    alarm_schedule_build(&sched, snap, now);
+    long build_ns = ns_now() - t0;
+    check("heap: agendados", sched.count, scheduled);
+
+    long replace_ns = 0;
+    int steps = 0;
+    time_t last = now;
+    alarm_schedule_entry_t top;
+    while (steps < HEAP_STEPS && alarm_schedule_peek(&sched, &top)) {
+        time_t min = -1;
+        for (int i = 0; i < MAX_ALARMS; i++) {
+            if (model[i] >= 0 && (min < 0 || model[i] < min)) {
+                min = model[i];
+            }
+        }
+        if (top.fire_at != min || model[top.index] != top.fire_at || top.fire_at < last) {
+            printf("FALHOU heap no passo %d: topo %lld (alarme %u), mais cedo %lld\n", steps, (long long)top.fire_at,
+                   top.index, (long long)min);
+            failed = 1;
+            break;
+        }
+        last = top.fire_at;
+
+        const alarm_t *alarm = &snap->alarms[top.index];
+        time_t next = alarm->one_shot ? -1 : alarm_schedule_next_fire(alarm, ALARM_NO_DATE, top.fire_at);
+        model[top.index] = next;
+        t0 = ns_now();
+        alarm_schedule_replace_top(&sched, next);
+        replace_ns += ns_now() - t0;
+        steps++;
+    }
+    check("heap: passos", steps, HEAP_STEPS);
+
+    t0 = ns_now();
+    for (int i = 0; i < 10000; i++) {
+        alarm_schedule_next_fire(&snap->alarms[1 + i % 9], ALARM_NO_DATE, now + i * 61);
+    }
+    long next_ns = ns_now() - t0;
+    printf("heap de %d alarmes: build %ld us, %d disparos em ordem (%.0f ns por reagendamento); "
+           "próximo disparo %.0f ns\n",
+           scheduled, build_ns / 1000, steps, (double)replace_ns / steps, next_ns / 10000.0);
+    free(snap);
+}
+
+int main(void)
+{
+    test_mask_against_search();
+    test_dst();
+    test_civil_dates();
+    test_heap();
+    if (failed) {
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,228 @@
+// Vetores de referência do caminho WAV: cada golden/<caso>.wav passa pelo
+// audio_source_wav e a saída tem que bater byte a byte com golden/<caso>.u8, em
+// leituras de vários tamanhos. O reamostrador Q16.16 é conferido sozinho contra
+// golden/rs_<taxa>.bin, com a entrada chegando em blocos como no audio_wav.c.
+// Os vetores vêm de golden/gen_audio_golden.py, um modelo independente do código C.
+#include "audio_wav.h"
+#include "audio_resampler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DAC_RATE 11025
+
+static int failures = 0;
+
+static uint8_t *load(const char *name, size_t *len)
+{
+    char path[128];
+    snprintf(path, sizeof(path), "golden/%s", name);
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        printf("FALHOU: não abriu %s\n", path);
+        exit(1);
+    }
+    fseek(f, 0, SEEK_END);
+    *len = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *data = malloc(*len ? *len : 1);
+    if (fread(data, 1, *len, f) != *len) {
+        exit(1);
+    }
+    fclose(f);
+    return data;
+}
+
+static void compare(const char *name, const uint8_t *got, size_t got_len, const uint8_t *want, size_t want_len,
+                    size_t sample_size)
+{
+    size_t n = got_len < want_len ? got_len : want_len;
+    size_t i = 0;
+    while (i < n && memcmp(&got[i], &want[i], sample_size) == 0) {
+        i += sample_size;
+    }
+    if (i < n || got_len != want_len) {
+        printf("FALHOU %s: %zu bytes (esperado %zu), primeira diferença no byte %zu\n", name, got_len, want_len, i);
+        failures++;
+    } else {
+        printf("ok %s: %zu bytes\n", name, got_len);
+    }
+}
+
+// Decodifica o WAV inteiro, pedindo a cada read() um tamanho da lista
+static void wav_case(const char *name, const size_t *sizes, int size_count)
+{
+    char file[64];
+    size_t wav_len, want_len;
+    snprintf(file, sizeof(file), "%s.wav", name);
+    uint8_t *wav_data = load(file, &wav_len);
+    snprintf(file, sizeof(file), "%s.u8", name);
+    uint8_t *want = load(file, &want_len);
+
+    audio_source_mem_t mem;
+    static audio_source_wav_t wav;
+    audio_source_mem_init(&mem, wav_data, wav_len);
+    audio_source_wav_init(&wav, &mem.base, DAC_RATE);
+
+    size_t cap = want_len + 4096;
+    uint8_t *got = malloc(cap);
+    size_t got_len = 0;
+    if (wav.base.open(&wav.base) != ESP_OK) {
+        printf("FALHOU %s: open\n", name);
+        failures++;
+    } else {
+        for (int i = 0; got_len < cap; i++) {
+            size_t want_now = sizes[i % size_count];
+            if (want_now > cap - got_len) {
+                want_now = cap - got_len;
+            }
+            int n = wav.base.read(&wav.base, &got[got_len], want_now);
+            if (n <= 0) {
+                break;
+            }
+            got_len += (size_t)n;
+        }
+        wav.base.close(&wav.base);
+
+        char label[96];
+        snprintf(label, sizeof(label), "%s (leituras de %zu%s)", name, sizes[0], size_count > 1 ? "..." : "");
+        compare(label, got, got_len, want, want_len, 1);
+    }
+    free(got);
+    free(want);
+    free(wav_data);
+}
+
+// Como em wav_read(): a entrada chega em blocos num buffer de trabalho
+static void resampler_case(int in_rate)
+{
+    char file[32];
+    size_t len;
+    snprintf(file, sizeof(file), "rs_%d.bin", in_rate);
+    uint8_t *data = load(file, &len);
+    uint32_t n_in, n_out;
+    memcpy(&n_in, data, 4);
+    memcpy(&n_out, data + 4, 4);
+    const int16_t *in = (const int16_t *)(data + 8);
+    const int16_t *want = in + n_in;
+
+    static const size_t blocks[] = { 1, 2, 37, 256, 3, 500 };
+    int16_t work[1024];
+    int16_t *got = malloc((n_out + 1024) * sizeof(int16_t));
+    size_t work_len = 0, fed = 0, got_len = 0;
+    audio_resampler_t rs;
+    audio_resampler_init(&rs, (uint32_t)in_rate, DAC_RATE);
+
+    for (int b = 0; fed < n_in; b++) {
+        size_t take = blocks[b % 6];
+        if (take > n_in - fed) {
+            take = n_in - fed;
+        }
+        memcpy(&work[work_len], &in[fed], take * sizeof(int16_t));
+        work_len += take;
+        fed += take;
+
+        size_t n;
+        while ((n = audio_resample_linear(&rs, work, work_len, &got[got_len], 17)) > 0) {
+            got_len += n;
+        }
+        size_t drop = audio_resampler_advance(&rs, work_len);
+        memmove(work, &work[drop], (work_len - drop) * sizeof(int16_t));
+        work_len -= drop;
+    }
+
+    char label[48];
+    snprintf(label, sizeof(label), "reamostrador %d -> %d Hz", in_rate, DAC_RATE);
+    compare(label, (const uint8_t *)got, got_len * 2, (const uint8_t *)want, (size_t)n_out * 2, 2);
+    free(got);
+    free(data);
+}
+
+// map(): só o PCM já no formato do DAC é exposto, e aponta para o chunk "data"
+static void wav_map_case(const char *name, int mapped)
+{
+    char file[64];
+    size_t wav_len, want_len;
+    snprintf(file, sizeof(file), "%s.wav", name);
+    uint8_t *wav_data = load(file, &wav_len);
+    snprintf(file, sizeof(file), "%s.u8", name);
+    uint8_t *want = load(file, &want_len);
+
+    audio_source_mem_t mem;
+    static audio_source_wav_t wav;
+    audio_source_mem_init(&mem, wav_data, wav_len);
+    audio_source_wav_init(&wav, &mem.base, DAC_RATE);
+
+    uint32_t len = 0;
+    const uint8_t *data = NULL;
+    if (wav.base.open(&wav.base) == ESP_OK) {
+        data = wav.base.map ? wav.base.map(&wav.base, &len) : NULL;
+        wav.base.close(&wav.base);
+    }
+    char label[96];
+    snprintf(label, sizeof(label), "map %s", name);
+    if (!mapped) {
+        if (data) {
+            printf("FALHOU %s: map devolveu %u bytes, esperado NULL\n", label, (unsigned)len);
+            failures++;
+        } else {
+            printf("ok %s: NULL\n", label);
+        }
+    } else if (!data || data < wav_data || data + len > wav_data + wav_len) {
+        printf("FALHOU %s: map não aponta para dentro do arquivo\n", label);
+        failures++;
+    } else {
+        compare(label, data, len, want, want_len, 1);
+    }
+    free(want);
+    free(wav_data);
+}
+
+static void wav_rejected(const char *name, const uint8_t *data, size_t len, esp_err_t want)
+{
+    audio_source_mem_t mem;
+    static audio_source_wav_t wav;
+    audio_source_mem_init(&mem, data, (uint32_t)len);
+    audio_source_wav_init(&wav, &mem.base, DAC_RATE);
+    esp_err_t err = wav.base.open(&wav.base);
+    if (err != want) {
+        printf("FALHOU %s: open devolveu 0x%x, esperado 0x%x\n", name, (unsigned)err, (unsigned)want);
+        failures++;
+    } else {
+        printf("ok %s: 0x%x\n", name, (unsigned)err);
+    }
+}
+
+int main(void)
+{
+    static const char *cases[] = {
+        "pcm16_stereo_22050", "pcm8_mono_8000", "pcm8_passthrough", "pcm16_ext_44100",
+        "ulaw_mono_8000", "alaw_stereo_16000", "adpcm_mono_11025",
+    };
+    static const size_t whole[] = { 65536 };
+    static const size_t odd[] = { 1, 7, 64, 300, 1000, 3 };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        wav_case(cases[i], whole, 1);
+        wav_case(cases[i], odd, 6);
+    }
+    wav_map_case("pcm8_passthrough", 1);
+    wav_map_case("pcm8_mono_8000", 0);
+    wav_map_case("adpcm_mono_11025", 0);
+
+    static const int rates[] = { 7350, 8000, 11025, 22050, 44100, 48000 };
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        resampler_case(rates[i]);
+    }
+
+    // Cabeçalhos inválidos: fmt de 24 bits, sem chunk "data" e arquivo que não é RIFF
+    static const uint8_t pcm24[] = "RIFF\x2c\0\0\0WAVEfmt \x10\0\0\0\x01\0\x01\0\x11\x2b\0\0\x33\x81\0\0\x03\0\x18\0"
+                                   "data\x00\0\0\0";
+    static const uint8_t no_data[] = "RIFF\x24\0\0\0WAVEfmt \x10\0\0\0\x01\0\x01\0\x11\x2b\0\0\x11\x2b\0\0\x01\0\x08\0";
+    static const uint8_t not_riff[] = "RIFX\x24\0\0\0WAVE";
+    wav_rejected("24 bits", pcm24, sizeof(pcm24) - 1, ESP_ERR_NOT_SUPPORTED);
+    wav_rejected("sem data", no_data, sizeof(no_data) - 1, ESP_ERR_INVALID_SIZE);
+    wav_rejected("não RIFF", not_riff, sizeof(not_riff) - 1, ESP_ERR_INVALID_ARG);
+
+    printf("%s\n", failures ? "FALHOU" : "ok");
+    return failures != 0;
+}
@@ -0,0 +1,283 @@
+// Mixer (audio_mixer.c) e a mixagem do pipeline (audio_pipeline.c) sobre o
+// FreeRTOS de host: núcleo contra a conta de referência, saturação, ganho por voz,
+// abafamento pela voz de prioridade maior e preempção. O teste faz o papel do sink,
+// chamando audio_pipeline_render como o callback do DMA. Depois mede o custo da
+// mixagem por voz e quanto de CPU ela toma a 11025 e a 22050 Hz (no host).
+#include "audio_pipeline.h"
+#include "audio_mixer.h"
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CLIP_SECONDS 30
+#define BENCH_CHUNKS 4000
+
+static int failed = 0;
+
+static void check(const char *name, long got, long expected)
+{
+    if (got != expected) {
+        printf("FALHOU %s: %ld, esperado %ld\n", name, got, expected);
+        failed = 1;
+    }
+}
+
+static long ns_now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000000L + t.tv_nsec;
+}
+
+static esp_err_t sink_start(audio_sink_t *sink, audio_pipeline_t *pipe)
+{
+    return ESP_OK;
+}
+
+static void sink_stop(audio_sink_t *sink)
+{
+}
+
+static audio_sink_t sink = { .start = sink_start, .stop = sink_stop, .flush_blocks = 1 };
+
+// Núcleo contra a conta direta, e a saturação nos dois lados
+static void test_kernel(void)
+{
+    uint8_t in[3][AUDIO_MIX_CHUNK], out[AUDIO_MIX_CHUNK];
+    int32_t acc[AUDIO_MIX_CHUNK];
+    int32_t gains[3];
+    srand(7);
+
+    for (int round = 0; round < 200; round++) {
+        memset(acc, 0, sizeof(acc));
+        for (int v = 0; v < 3; v++) {
+            gains[v] = rand() % (AUDIO_GAIN_UNITY + 1);
+            for (int i = 0; i < AUDIO_MIX_CHUNK; i++) {
+                in[v][i] = (uint8_t)rand();
+            }
+            audio_mix_accumulate(acc, in[v], gains[v], AUDIO_MIX_CHUNK);
+        }
+        audio_mix_output(acc, out, AUDIO_MIX_CHUNK);
+
+        for (int i = 0; i < AUDIO_MIX_CHUNK; i++) {
+            int64_t sum = 0;
+            for (int v = 0; v < 3; v++) {
+                sum += (int64_t)(in[v][i] - 128) * gains[v];
+            }
+            int64_t want = (sum >> 15) + 128;
+            want = want < 0 ? 0 : want > 255 ? 255 : want;
+            if (out[i] != want) {
+                printf("FALHOU núcleo: amostra %d da rodada %d: %u, esperado %ld\n", i, round, out[i], (long)want);
+                failed = 1;
+                return;
+            }
+        }
+    }
+
+    memset(in[0], 255, AUDIO_MIX_CHUNK);
+    memset(in[1], 0, AUDIO_MIX_CHUNK);
+    memset(acc, 0, sizeof(acc));
+    audio_mix_accumulate(acc, in[0], AUDIO_GAIN_UNITY, AUDIO_MIX_CHUNK);
+    audio_mix_accumulate(acc, in[0], AUDIO_GAIN_UNITY, AUDIO_MIX_CHUNK);
+    audio_mix_output(acc, out, AUDIO_MIX_CHUNK);
+    check("núcleo: satura em 255", out[0], 255);
+    memset(acc, 0, sizeof(acc));
+    audio_mix_accumulate(acc, in[1], AUDIO_GAIN_UNITY, AUDIO_MIX_CHUNK);
+    audio_mix_accumulate(acc, in[1], AUDIO_GAIN_UNITY, AUDIO_MIX_CHUNK);
+    audio_mix_output(acc, out, AUDIO_MIX_CHUNK);
+    check("núcleo: satura em 0", out[0], 0);
+}
+
+// Nível constante, lido pela fila (sem map) ou direto da memória
+typedef struct {
+    audio_source_mem_t mem;
+    uint8_t *data;
+} level_source_t;
+
+static void level_init(level_source_t *src, uint8_t level, uint32_t rate, bool mapped)
+{
+    uint32_t len = rate * CLIP_SECONDS;
+    src->data = malloc(len);
+    memset(src->data, level, len);
+    audio_source_mem_init(&src->mem, src->data, len);
+    if (!mapped) {
+        src->mem.base.map = NULL;
+    }
+}
+
+static audio_voice_t play(audio_pipeline_t *pipe, level_source_t *src, uint8_t priority, uint16_t gain, bool duck)
+{
+    audio_voice_params_t params = { .priority = priority, .gain = gain, .duck = duck };
+    return audio_pipeline_play(pipe, &src->mem.base, &params);
+}
+
+// Mixa como o sink até a saída ficar constante em `want` (a leitura roda em outra thread)
+static void expect_level(audio_pipeline_t *pipe, const char *name, uint8_t want)
+{
+    uint8_t out[64];
+    for (int tries = 0; tries < 2000; tries++) {
+        audio_pipeline_render(pipe, out, sizeof(out), false);
+        audio_pipeline_sink_done(pipe, false);
+        bool flat = true;
+        for (size_t i = 0; i < sizeof(out); i++) {
+            flat &= out[i] == want;
+        }
+        if (flat) {
+            printf("ok %s: %u\n", name, want);
+            return;
+        }
+        usleep(1000);
+    }
+    printf("FALHOU %s: saída %u, esperado %u\n", name, out[0], want);
+    failed = 1;
+}
+
+static void wait_inactive(audio_pipeline_t *pipe, audio_voice_t voice)
+{
+    uint8_t out[64];
+    for (int tries = 0; tries < 2000 && audio_pipeline_voice_active(pipe, voice); tries++) {
+        audio_pipeline_render(pipe, out, sizeof(out), false);
+        audio_pipeline_sink_done(pipe, false);
+        usleep(1000);
+    }
+}
+
+static void test_pipeline(audio_pipeline_t *pipe, uint32_t rate)
+{
+    static level_source_t a, b, c, d, e, f;
+    level_init(&a, 128 + 40, rate, false);
+    level_init(&b, 128 + 20, rate, false);
+    level_init(&c, 128 + 60, rate, true);
+    level_init(&d, 128 + 10, rate, false);
+    level_init(&e, 255, rate, false);
+    level_init(&f, 255, rate, true);
+
+    audio_voice_t va = play(pipe, &a, 1, AUDIO_GAIN_UNITY, false);
+    expect_level(pipe, "uma voz", 168);
+
+    // B abafa A para 1/4: 128 + 40/4 + 20
+    audio_voice_t vb = play(pipe, &b, 2, AUDIO_GAIN_UNITY, true);
+    expect_level(pipe, "abafada pela prioridade maior", 158);
+    audio_pipeline_stop_voice(pipe, vb);
+    wait_inactive(pipe, vb);
+    expect_level(pipe, "volta sem abafar", 168);
+
+    // C, mapeada, com meio ganho: 128 + 40 + 60/2
+    audio_voice_t vc = play(pipe, &c, 1, AUDIO_GAIN_UNITY / 2, false);
+    expect_level(pipe, "meio ganho (mapeada)", 198);
+
+    // Quatro vozes ocupadas: prioridade maior toma o lugar de uma, menor é recusada
+    audio_voice_t vd = play(pipe, &d, 1, AUDIO_GAIN_UNITY, false);
+    audio_voice_t ve = play(pipe, &e, 1, 0, false);
+    audio_pipeline_stats_t before, after;
+    audio_pipeline_get_stats(pipe, &before);
+    check("recusada com prioridade menor", play(pipe, &f, 0, AUDIO_GAIN_UNITY, false), AUDIO_VOICE_NONE);
+    audio_voice_t vf = play(pipe, &f, 3, AUDIO_GAIN_UNITY, false);
+    check("preempção aceita", vf != AUDIO_VOICE_NONE, 1);
+    audio_pipeline_get_stats(pipe, &after);
+    check("preempções", after.preempted - before.preempted, 1);
+    check("recusas", after.rejected - before.rejected, 1);
+
+    // Com a cheia de 255 somada às demais, a saída satura em vez de dar a volta
+    expect_level(pipe, "saturação", 255);
+
+    audio_pipeline_stop(pipe);
+    wait_inactive(pipe, va);
+    wait_inactive(pipe, vc);
+    wait_inactive(pipe, vd);
+    wait_inactive(pipe, ve);
+    wait_inactive(pipe, vf);
+    audio_pipeline_get_stats(pipe, &after);
+    check("sem falta de dados", after.underruns, 0);
+}
+
+// Custo de um trecho de AUDIO_MIX_CHUNK amostras com `voices` vozes mixando
+static double chunk_ns(audio_pipeline_t *pipe, level_source_t *srcs, int voices)
+{
+    audio_voice_t ids[AUDIO_PIPELINE_MAX_VOICES];
+    uint8_t out[AUDIO_MIX_CHUNK];
+    for (int v = 0; v < voices; v++) {
+        ids[v] = play(pipe, &srcs[v], 1, AUDIO_GAIN_UNITY / AUDIO_PIPELINE_MAX_VOICES, v == 0);
+    }
+    // Espera todas entrarem na mixagem
+    uint32_t want = 128 + voices * 10 / AUDIO_PIPELINE_MAX_VOICES;
+    for (int tries = 0; tries < 2000; tries++) {
+        audio_pipeline_render(pipe, out, 1, false);
+        if (out[0] == want && pipe->stats.active_voices == (uint32_t)voices) {
+            break;
+        }
+        usleep(1000);
+    }
+
+    long total = 0;
+    for (int i = 0; i < BENCH_CHUNKS; i++) {
+        long t0 = ns_now();
+        audio_pipeline_render(pipe, out, AUDIO_MIX_CHUNK, false);
+        total += ns_now() - t0;
+        audio_pipeline_sink_done(pipe, false);
+        sched_yield();  // A leitura repõe as filas das vozes sem map
+    }
+
+    audio_pipeline_stop(pipe);
+    for (int v = 0; v < voices; v++) {
+        wait_inactive(pipe, ids[v]);
+    }
+    return (double)total / BENCH_CHUNKS;
+}
+
+static void bench(audio_pipeline_t *pipe, uint32_t rate)
+{
+    static level_source_t mapped[AUDIO_PIPELINE_MAX_VOICES], streamed[AUDIO_PIPELINE_MAX_VOICES];
+    for (int v = 0; v < AUDIO_PIPELINE_MAX_VOICES; v++) {
+        level_init(&mapped[v], 138, rate, true);
+        level_init(&streamed[v], 138, rate, false);
+    }
+
+    const char *kinds[2] = { "mapeadas", "pela fila" };
+    level_source_t *srcs[2] = { mapped, streamed };
+    for (int k = 0; k < 2; k++) {
+        double one = chunk_ns(pipe, srcs[k], 1);
+        double all = chunk_ns(pipe, srcs[k], AUDIO_PIPELINE_MAX_VOICES);
+        double per_voice = (all - one) / (AUDIO_PIPELINE_MAX_VOICES - 1) / AUDIO_MIX_CHUNK;
+        double fixed = one / AUDIO_MIX_CHUNK - per_voice;
+        printf("%5u Hz, vozes %s: %.2f ns/amostra por voz + %.2f ns/amostra fixos;"
+               " por voz %.3f%% de CPU, 4 vozes %.3f%%\n",
+               (unsigned)rate, kinds[k], per_voice, fixed, per_voice * rate / 1e7,
+               all / AUDIO_MIX_CHUNK * rate / 1e7);
+    }
+
+    audio_pipeline_stats_t s;
+    audio_pipeline_get_stats(pipe, &s);
+    check("benchmark sem falta de dados", s.underruns, 0);
+}
+
+int main(void)
+{
+    static audio_pipeline_t pipes[2];
+    static const uint32_t rates[2] = { 11025, 22050 };
+
+    test_kernel();
+    for (int r = 0; r < 2; r++) {
+        audio_pipeline_config_t config = AUDIO_PIPELINE_CONFIG_DEFAULT();
+        config.sample_rate_hz = rates[r];
+        if (audio_pipeline_init(&pipes[r], &config, &sink) != ESP_OK) {
+            printf("FALHOU init\n");
+            return 1;
+        }
+        test_pipeline(&pipes[r], rates[r]);
+    }
+    if (failed) {
+        return 1;
+    }
+    for (int r = 0; r < 2; r++) {
+        bench(&pipes[r], rates[r]);
+    }
+    if (failed) {
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,117 @@
+// Estresse da fila SPSC: uma thread produtora e uma consumidora, como a task de
+// leitura e o callback do DMA, trocando uma sequência conhecida em pedaços de
+// tamanhos aleatórios. O consumidor confere cada byte e os dois lados conferem
+// que a ocupação nunca passa do tamanho da fila. Para conferir a ordenação das
+// barreiras, compile também com -fsanitize=thread.
+#include "audio_ring.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define RING_SIZE 1024
+#define TOTAL_BYTES (16u * 1024 * 1024)
+
+static audio_ring_t ring;
+static uint8_t ring_buf[RING_SIZE];
+static volatile int failed = 0;
+
+// Byte n da sequência: não se repete com o período da fila
+static uint8_t pattern(uint32_t n)
+{
+    return (uint8_t)(n * 2654435761u >> 24);
+}
+
+static uint32_t next_rand(uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+static void *producer(void *arg)
+{
+    uint32_t rng = 1;
+    uint32_t n = 0;
+    while (n < TOTAL_BYTES && !failed) {
+        uint8_t *ptr;
+        uint32_t len = audio_ring_write_region(&ring, &ptr);
+        if (audio_ring_used(&ring) > RING_SIZE) {
+            printf("FALHOU produtor: ocupação %u\n", (unsigned)audio_ring_used(&ring));
+            failed = 1;
+        }
+        if (len == 0) {
+            sched_yield();  // Com um só núcleo, a outra thread precisa rodar
+            continue;
+        }
+        uint32_t chunk = 1 + next_rand(&rng) % len;
+        if (chunk > TOTAL_BYTES - n) {
+            chunk = TOTAL_BYTES - n;
+        }
+        for (uint32_t i = 0; i < chunk; i++) {
+            ptr[i] = pattern(n + i);
+        }
+        audio_ring_commit(&ring, chunk);
+        n += chunk;
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    uint32_t rng = 2;
+    uint32_t n = 0;
+    while (n < TOTAL_BYTES && !failed) {
+        const uint8_t *ptr;
+        uint32_t len = audio_ring_read_region(&ring, &ptr);
+        if (audio_ring_used(&ring) > RING_SIZE) {
+            printf("FALHOU consumidor: ocupação %u\n", (unsigned)audio_ring_used(&ring));
+            failed = 1;
+        }
+        if (len == 0) {
+            sched_yield();  // Com um só núcleo, a outra thread precisa rodar
+            continue;
+        }
+        uint32_t chunk = 1 + next_rand(&rng) % len;
+        for (uint32_t i = 0; i < chunk; i++) {
+            if (ptr[i] != pattern(n + i)) {
+                printf("FALHOU byte %u: esperado %u, lido %u\n", (unsigned)(n + i), pattern(n + i), ptr[i]);
+                failed = 1;
+                return NULL;
+            }
+        }
+        audio_ring_consume(&ring, chunk);
+        n += chunk;
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    if (!audio_ring_init(&ring, ring_buf, RING_SIZE) || audio_ring_init(&ring, ring_buf, 1000)) {
+        printf("FALHOU init\n");
+        return 1;
+    }
+    audio_ring_init(&ring, ring_buf, RING_SIZE);
+
+    // head e tail começam perto do estouro de uint32_t para exercitar a volta dos contadores
+    ring.head = ring.tail = UINT32_MAX - 4096;
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    pthread_t prod, cons;
+    pthread_create(&cons, NULL, consumer, NULL);
+    pthread_create(&prod, NULL, producer, NULL);
+    pthread_join(prod, NULL);
+    pthread_join(cons, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    if (!failed && audio_ring_used(&ring) != 0) {
+        printf("FALHOU: %u bytes sobraram na fila\n", (unsigned)audio_ring_used(&ring));
+        failed = 1;
+    }
+    double s = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    printf("%s: %u MB por uma fila de %u bytes em %.2f s (%.0f MB/s)\n", failed ? "FALHOU" : "ok",
+           TOTAL_BYTES >> 20, RING_SIZE, s, (TOTAL_BYTES >> 20) / s);
+    return failed;
+}
@@ -0,0 +1,237 @@
+// Sintetizador DDS (audio_synth.c): o núcleo audio_synth_render conferido contra a
+// conta exata em ponto fixo, a saída de uma voz senoidal contra o seno ideal, a
+// saturação da soma de quatro vozes e a independência do tamanho das leituras.
+// Depois mede o núcleo e a origem completa em amostras por segundo por voz.
+#include "audio_synth.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RATE 11025
+#define BENCH_SAMPLES (20 * 1000 * 1000)
+
+static int failed = 0;
+
+static void check(const char *name, long got, long expected)
+{
+    if (got != expected) {
+        printf("FALHOU %s: %ld, esperado %ld\n", name, got, expected);
+        failed = 1;
+    }
+}
+
+static long ns_now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000000L + t.tv_nsec;
+}
+
+static const audio_synth_instrument_t flat = {
+    .wave = AUDIO_SYNTH_WAVE_SINE,
+    .sustain = INT16_MAX,
+    .gain = INT16_MAX,
+};
+
+// Lê a origem inteira em leituras de `chunk` bytes
+static size_t render_all(audio_source_synth_t *synth, uint8_t *out, size_t cap, size_t chunk)
+{
+    synth->base.open(&synth->base);
+    size_t len = 0;
+    int n;
+    while (len < cap && (n = synth->base.read(&synth->base, &out[len], chunk < cap - len ? chunk : cap - len)) > 0) {
+        len += (size_t)n;
+    }
+    synth->base.close(&synth->base);
+    return len;
+}
+
+// Núcleo: soma em acc (não sobrescreve), tabela indexada pelos 8 bits altos da fase
+static void test_kernel(void)
+{
+    int8_t table[AUDIO_SYNTH_TABLE_SIZE];
+    int32_t acc[100];
+    srand(1);
+    for (int i = 0; i < AUDIO_SYNTH_TABLE_SIZE; i++) {
+        table[i] = (int8_t)(rand() % 255 - 127);
+    }
+
+    for (int round = 0; round < 1000; round++) {
+        uint32_t phase = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+        uint32_t step = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+        int32_t amp = rand() % 32768;
+        int32_t base = rand() % 1000 - 500;
+        for (int i = 0; i < 100; i++) {
+            acc[i] = base;
+        }
+
+        uint32_t p = phase;
+        audio_synth_render(acc, table, &p, step, amp, 100);
+        for (int i = 0; i < 100; i++) {
+            uint32_t at = phase + (uint32_t)i * step;
+            if (acc[i] != base + table[at >> 24] * amp) {
+                printf("FALHOU núcleo: amostra %d da rodada %d\n", i, round);
+                failed = 1;
+                return;
+            }
+        }
+        check("núcleo: fase final", p, phase + 100u * step);
+    }
+}
+
+// Uma voz de 1 kHz com envelope cheio contra 127·sen(2πft): erro da tabela de 256
+// pontos com a fase truncada, mais o arredondamento de 8 bits
+static void test_sine(void)
+{
+    static const audio_synth_note_t notes[] = { { 1000, 1000 }, { -1, 0 } };
+    const audio_synth_track_t track = { notes, flat };
+    static uint8_t out[2 * RATE];
+    audio_source_synth_t synth;
+    audio_source_synth_init(&synth, &track, 1, RATE);
+    size_t len = render_all(&synth, out, sizeof(out), 4096);
+
+    // Fora o primeiro bloco de controle, onde o envelope sobe, e os dois últimos,
+    // onde a nota termina na borda de bloco e entra o release
+    double max_err = 0, sum_sq = 0;
+    int count = 0;
+    for (size_t i = AUDIO_SYNTH_CONTROL; i < RATE - 2 * AUDIO_SYNTH_CONTROL; i++) {
+        double ideal = 128.0 + 127.0 * sin(2.0 * M_PI * 1000.0 * i / RATE);
+        double err = fabs(out[i] - ideal);
+        max_err = err > max_err ? err : max_err;
+        sum_sq += err * err;
+        count++;
+    }
+    double rms = sqrt(sum_sq / count);
+    printf("seno de 1 kHz a %d Hz: erro máximo %.2f LSB, RMS %.2f LSB\n", RATE, max_err, rms);
+    check("seno: erro máximo até 5 LSB", max_err <= 5.0, 1);
+    check("seno: erro RMS até 2 LSB", rms <= 2.0, 1);
+    check("seno: duração (1 s, um bloco de release)", len >= RATE && len <= RATE + 2 * AUDIO_SYNTH_CONTROL, 1);
+}
+
+// Quatro vozes em fase somadas: satura em 0 e 255 em vez de dar a volta
+static void test_saturation(void)
+{
+    static const audio_synth_note_t notes[] = { { 500, 200 }, { -1, 0 } };
+    const audio_synth_track_t tracks[4] = { { notes, flat }, { notes, flat }, { notes, flat }, { notes, flat } };
+    static uint8_t out[RATE];
+    audio_source_synth_t synth;
+    audio_source_synth_init(&synth, tracks, 4, RATE);
+    size_t len = render_all(&synth, out, sizeof(out), 4096);
+
+    int low = 0, high = 0;
+    for (size_t i = AUDIO_SYNTH_CONTROL; i + AUDIO_SYNTH_CONTROL < len; i++) {
+        double s = sin(2.0 * M_PI * 500.0 * i / RATE);
+        low += out[i] == 0;
+        high += out[i] == 255;
+        if ((s > 0.1 && out[i] < 128) || (s < -0.1 && out[i] > 128)) {
+            printf("FALHOU saturação: amostra %zu deu a volta (%u)\n", i, out[i]);
+            failed = 1;
+            return;
+        }
+    }
+    check("saturação: chega a 0", low > 0, 1);
+    check("saturação: chega a 255", high > 0, 1);
+}
+
+// A partitura sai igual em leituras de qualquer tamanho (sobra de bloco entre leituras)
+static void test_read_sizes(void)
+{
+    static const audio_synth_note_t melody[] = {
+        { 880, 150 }, { 0, 100 }, { 988, 200 }, { 1319, 75 }, { -1, 0 },
+    };
+    static const audio_synth_note_t bass[] = { { 220, 400 }, { 165, 125 }, { -1, 0 } };
+    const audio_synth_track_t tracks[2] = {
+        { melody, { .wave = AUDIO_SYNTH_WAVE_SINE, .attack_ms = 5, .decay_ms = 40, .sustain = 20000,
+                    .release_ms = 30, .gain = 16000 } },
+        { bass, { .wave = AUDIO_SYNTH_WAVE_TRIANGLE, .attack_ms = 10, .decay_ms = 0, .sustain = 32767,
+                  .release_ms = 60, .gain = 12000 } },
+    };
+    static uint8_t want[RATE], got[RATE];
+    audio_source_synth_t synth;
+    audio_source_synth_init(&synth, tracks, 2, RATE);
+    size_t want_len = render_all(&synth, want, sizeof(want), 65536);
+
+    static const size_t sizes[] = { 1, 7, 31, 33, 500 };
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t len = render_all(&synth, got, sizeof(got), sizes[s]);
+        if (len != want_len || memcmp(got, want, len) != 0) {
+            printf("FALHOU leituras de %zu: %zu bytes, esperado %zu\n", sizes[s], len, want_len);
+            failed = 1;
+        }
+    }
+    // Trilha mais longa (525 ms) mais o release dela (60 ms), em blocos de controle
+    size_t expected = (size_t)RATE * 585 / 1000;
+    check("partitura: termina depois do release", want_len >= expected && want_len <= expected + 3 * AUDIO_SYNTH_CONTROL,
+          1);
+}
+
+static void bench_kernel(void)
+{
+    static int32_t acc[AUDIO_SYNTH_CONTROL];
+    int8_t table[AUDIO_SYNTH_TABLE_SIZE];
+    for (int i = 0; i < AUDIO_SYNTH_TABLE_SIZE; i++) {
+        table[i] = (int8_t)(127.0 * sin(2.0 * M_PI * i / AUDIO_SYNTH_TABLE_SIZE));
+    }
+    uint32_t phase = 0, step = (uint32_t)((440ull << 32) / RATE);
+    int64_t sum = 0;
+
+    long t0 = ns_now();
+    for (int done = 0; done < BENCH_SAMPLES; done += AUDIO_SYNTH_CONTROL) {
+        memset(acc, 0, sizeof(acc));
+        audio_synth_render(acc, table, &phase, step, 20000, AUDIO_SYNTH_CONTROL);
+        sum += acc[(done / AUDIO_SYNTH_CONTROL) & (AUDIO_SYNTH_CONTROL - 1)];
+    }
+    double secs = (ns_now() - t0) / 1e9;
+    printf("núcleo audio_synth_render (blocos de %d): %.1f M amostras/s por voz (soma %lld)\n", AUDIO_SYNTH_CONTROL,
+           BENCH_SAMPLES / secs / 1e6, (long long)sum);
+}
+
+// Origem completa: envelope, partitura e saturação por bloco, dividido pelo número de vozes
+static void bench_source(void)
+{
+    static const audio_synth_note_t notes[] = { { 440, 60000 }, { -1, 0 } };
+    const audio_synth_track_t tracks[AUDIO_SYNTH_MAX_TRACKS] = {
+        { notes, flat }, { notes, flat }, { notes, flat }, { notes, flat },
+    };
+    static uint8_t out[4096];
+
+    for (int voices = 1; voices <= AUDIO_SYNTH_MAX_TRACKS; voices++) {
+        audio_source_synth_t synth;
+        audio_source_synth_init(&synth, tracks, voices, RATE);
+        synth.base.open(&synth.base);
+        size_t total = 0;
+        unsigned check_sum = 0;
+        long t0 = ns_now();
+        while (total < BENCH_SAMPLES / 4) {
+            int n = synth.base.read(&synth.base, out, sizeof(out));
+            if (n <= 0) {
+                synth.base.open(&synth.base);
+                continue;
+            }
+            check_sum += out[n / 2];
+            total += (size_t)n;
+        }
+        double secs = (ns_now() - t0) / 1e9;
+        double per_voice = total * voices / secs;
+        printf("origem com %d voz(es): %.1f M amostras/s de saída, %.1f M amostras/s por voz, %.0fx o tempo real a %d Hz"
+               " (soma %u)\n",
+               voices, total / secs / 1e6, per_voice / 1e6, total / secs / RATE, RATE, check_sum);
+    }
+}
+
+int main(void)
+{
+    test_kernel();
+    test_sine();
+    test_saturation();
+    test_read_sizes();
+    if (failed) {
+        return 1;
+    }
+    bench_kernel();
+    bench_source();
+    printf("ok\n");
+    return 0;
+}
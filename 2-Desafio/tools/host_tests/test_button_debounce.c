@@ -0,0 +1,143 @@
+// Debounce vertical sobre um registrador de entrada simulado: confere que cada
+// pressionamento com ricochete vira exatamente uma troca de estado e compara o
+// custo por amostra com o debounce botão a botão (uma leitura de registrador e
+// um contador por botão, como o gpio_get_level() em laço fazia).
+#include "button_debounce.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// GPIO_IN_REG e GPIO_IN1_REG simulados
+static volatile uint32_t gpio_in[2];
+
+static uint64_t read_levels(void)
+{
+    return gpio_in[0] | ((uint64_t)gpio_in[1] << 32);
+}
+
+static int read_level(int gpio)
+{
+    return (gpio_in[gpio / 32] >> (gpio % 32)) & 1;
+}
+
+// Referência escalar: mesmo critério (4 amostras seguidas diferentes), um botão por vez
+typedef struct {
+    int gpio;
+    int state;
+    int count;
+} scalar_button_t;
+
+static uint64_t scalar_update(scalar_button_t *buttons, int n)
+{
+    uint64_t changed = 0;
+    for (int i = 0; i < n; i++) {
+        int level = read_level(buttons[i].gpio);
+        if (level == buttons[i].state) {
+            buttons[i].count = 0;
+        } else if (++buttons[i].count == 4) {
+            buttons[i].state = level;
+            buttons[i].count = 0;
+            changed |= 1ull << buttons[i].gpio;
+        }
+    }
+    return changed;
+}
+
+static long ns_now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000000L + t.tv_nsec;
+}
+
+static void set_pin(int gpio, int level)
+{
+    if (level) {
+        gpio_in[gpio / 32] |= 1u << (gpio % 32);
+    } else {
+        gpio_in[gpio / 32] &= ~(1u << (gpio % 32));
+    }
+}
+
+// Cada botão alterna o nível desejado de tempos em tempos, com ricochete de até 3 amostras
+static void step_inputs(const int *gpios, int n, int *wanted, int *bounce, unsigned *seed)
+{
+    for (int i = 0; i < n; i++) {
+        if (bounce[i] > 0) {
+            bounce[i]--;
+            set_pin(gpios[i], bounce[i] == 0 ? wanted[i] : rand_r(seed) & 1);
+        } else if (rand_r(seed) % 50 == 0) {
+            wanted[i] ^= 1;
+            bounce[i] = 1 + rand_r(seed) % 3;
+            set_pin(gpios[i], rand_r(seed) & 1);
+        }
+    }
+}
+
+static void run(int n, long samples)
+{
+    int gpios[64], wanted[64] = { 0 }, bounce[64] = { 0 };
+    scalar_button_t scalar[64];
+    gpio_in[0] = gpio_in[1] = 0xFFFFFFFF;
+    for (int i = 0; i < n; i++) {
+        gpios[i] = (i * 7) % 46;    // Espalhados pelos dois registradores
+        wanted[i] = 1;
+        scalar[i] = (scalar_button_t) { .gpio = gpios[i], .state = 1 };
+    }
+
+    button_debounce_t db;
+    button_debounce_init(&db, read_levels());
+    uint64_t mask = 0;
+    for (int i = 0; i < n; i++) {
+        mask |= 1ull << gpios[i];
+    }
+
+    // Correção: as duas implementações concordam amostra a amostra
+    unsigned seed = 1;
+    long toggles = 0;
+    for (long s = 0; s < samples; s++) {
+        step_inputs(gpios, n, wanted, bounce, &seed);
+        uint64_t a = button_debounce_update(&db, read_levels()) & mask;
+        uint64_t b = scalar_update(scalar, n);
+        assert(a == b);
+        toggles += __builtin_popcountll(a);
+    }
+    // Custo: só a atualização, com um pino alternando a cada amostra
+    long t0 = ns_now();
+    volatile uint64_t sink = 0;
+    for (long s = 0; s < samples; s++) {
+        gpio_in[0] ^= (s & 1) << 3;
+        sink ^= button_debounce_update(&db, read_levels());
+    }
+    long vertical = ns_now() - t0;
+
+    t0 = ns_now();
+    for (long s = 0; s < samples; s++) {
+        gpio_in[0] ^= (s & 1) << 3;
+        sink ^= scalar_update(scalar, n);
+    }
+    long per_button = ns_now() - t0;
+
+    printf("%2d botões: %ld trocas conferidas; vertical %.1f ns/amostra, botão a botão %.1f ns/amostra\n",
+           n, toggles, (double)vertical / samples, (double)per_button / samples);
+}
+
+int main(void)
+{
+    // Ricochete isolado: 0,1 reinicia a contagem; a troca sai na 4ª amostra seguida em 0
+    button_debounce_t db;
+    button_debounce_init(&db, 1);
+    uint64_t seq[] = { 0, 1, 0, 0, 0, 0 };
+    uint64_t out = 0;
+    for (int i = 0; i < 6; i++) {
+        out |= (uint64_t)(button_debounce_update(&db, seq[i]) != 0) << i;
+    }
+    assert(out == 1u << 5 && db.state == 0);
+    assert(!button_debounce_busy(&db, 0));
+
+    run(6, 2000000);
+    run(32, 2000000);
+    printf("ok\n");
+    return 0;
+}
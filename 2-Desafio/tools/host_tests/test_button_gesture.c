@@ -0,0 +1,116 @@
+// Roteiros de bordas com timestamp alimentados ao reconhecedor de gestos, que é
+// chamado como no button_manager: a cada borda e em cada prazo devolvido por
+// button_gesture_next_deadline().
+#include "button_gesture.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MS 1000
+
+typedef struct {
+    int64_t at_us;
+    bool pressed;
+} edge_t;
+
+static const char *names[] = { "PRESS", "RELEASE", "CLICK", "DOUBLE", "LONG", "REPEAT" };
+static char events[1024];
+
+static void emit(void *ctx, button_event_type_t type, int64_t timestamp_us)
+{
+    char item[32];
+    snprintf(item, sizeof(item), "%s%s@%lld", events[0] ? " " : "", names[type], (long long)(timestamp_us / MS));
+    strncat(events, item, sizeof(events) - strlen(events) - 1);
+}
+
+// Roda o roteiro e segue os prazos até `end_us`
+static const char *play(const button_gesture_config_t *config, const edge_t *edges, int count, int64_t end_us)
+{
+    button_gesture_t g;
+    button_gesture_init(&g, config);
+    events[0] = '\0';
+
+    for (int i = 0; i <= count; i++) {
+        int64_t next_edge = i < count ? edges[i].at_us : end_us;
+        int64_t deadline;
+        while ((deadline = button_gesture_next_deadline(&g)) <= next_edge) {
+            button_gesture_poll(&g, deadline, emit, NULL);
+        }
+        if (i < count) {
+            button_gesture_feed(&g, edges[i].pressed, edges[i].at_us, emit, NULL);
+        }
+    }
+    return events;
+}
+
+static int failures = 0;
+
+static void expect(const char *name, const char *got, const char *want)
+{
+    if (strcmp(got, want) != 0) {
+        printf("FALHOU %s\n  esperado: %s\n  obtido:   %s\n", name, want, got);
+        failures++;
+    } else {
+        printf("ok %s: %s\n", name, got);
+    }
+}
+
+int main(void)
+{
+    button_gesture_config_t def = BUTTON_GESTURE_CONFIG_DEFAULT();
+
+    const edge_t click[] = { { 0, true }, { 100 * MS, false } };
+    expect("clique", play(&def, click, 2, 2000 * MS), "PRESS@0 RELEASE@100 CLICK@100");
+
+    const edge_t dbl[] = { { 0, true }, { 100 * MS, false }, { 250 * MS, true }, { 320 * MS, false } };
+    expect("duplo clique", play(&def, dbl, 4, 2000 * MS), "PRESS@0 RELEASE@100 PRESS@250 RELEASE@320 DOUBLE@320");
+
+    // Segundo clique fora da janela de 300 ms: dois cliques separados
+    const edge_t two[] = { { 0, true }, { 100 * MS, false }, { 450 * MS, true }, { 500 * MS, false } };
+    expect("dois cliques", play(&def, two, 4, 2000 * MS),
+           "PRESS@0 RELEASE@100 CLICK@100 PRESS@450 RELEASE@500 CLICK@500");
+
+    // Segurar: LONG no prazo, e a soltura não vira clique
+    const edge_t hold[] = { { 0, true }, { 1200 * MS, false } };
+    expect("long press", play(&def, hold, 2, 3000 * MS), "PRESS@0 LONG@800 RELEASE@1200");
+
+    // Bordas repetidas (mesmo nível) são ignoradas
+    const edge_t bounce[] = { { 0, true }, { 5 * MS, true }, { 90 * MS, false }, { 95 * MS, false } };
+    expect("borda repetida", play(&def, bounce, 4, 2000 * MS), "PRESS@0 RELEASE@90 CLICK@90");
+
+    // Sem janela de duplo clique: CLICK na hora da soltura
+    button_gesture_config_t nav = def;
+    nav.double_click_us = 0;
+    nav.long_press_us = 0;
+    nav.repeat_delay_us = 500 * MS;
+    expect("clique imediato", play(&nav, click, 2, 2000 * MS), "PRESS@0 RELEASE@100 CLICK@100");
+
+    // Repeat acelerado: 200, 160, 128, 102.4 -> ... até o mínimo de 40 ms
+    const edge_t scroll[] = { { 0, true }, { 1400 * MS, false } };
+    expect("repeat acelerado", play(&nav, scroll, 2, 3000 * MS),
+           "PRESS@0 REPEAT@500 REPEAT@700 REPEAT@860 REPEAT@988 REPEAT@1090 REPEAT@1172 REPEAT@1237 "
+           "REPEAT@1290 REPEAT@1332 REPEAT@1372 RELEASE@1400");
+
+    // Poll atrasado (ex.: task ocupada) emite os repeats vencidos com o instante certo
+    button_gesture_t g;
+    button_gesture_init(&g, &nav);
+    events[0] = '\0';
+    button_gesture_feed(&g, true, 0, emit, NULL);
+    button_gesture_poll(&g, 900 * MS, emit, NULL);
+    expect("poll atrasado", events, "PRESS@0 REPEAT@500 REPEAT@700 REPEAT@860");
+
+    // Intervalo mínimo 0 é corrigido para não emitir sem parar
+    button_gesture_config_t zero = nav;
+    zero.repeat_start_us = 0;
+    zero.repeat_min_us = 0;
+    button_gesture_init(&g, &zero);
+    assert(g.config.repeat_min_us >= 1000 && g.config.repeat_start_us >= g.config.repeat_min_us);
+
+    // Duplo clique em que o segundo toque vira long press: só LONG
+    const edge_t dbl_long[] = { { 0, true }, { 100 * MS, false }, { 200 * MS, true }, { 1100 * MS, false } };
+    expect("duplo com long", play(&def, dbl_long, 4, 3000 * MS),
+           "PRESS@0 RELEASE@100 PRESS@200 LONG@1000 RELEASE@1100");
+
+    printf(failures ? "%d falhas\n" : "ok\n", failures);
+    return failures != 0;
+}
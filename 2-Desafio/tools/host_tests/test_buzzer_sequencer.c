@@ -0,0 +1,340 @@
+// Melodias do buzzer: o compilador RTTTL (buzzer_rtttl.c) contra durações e
+// frequências calculadas à mão, e o sequenciador (buzzer_sequencer.c) sobre um
+// esp_timer de host que atrasa cada disparo de propósito. As trocas de nota são
+// medidas no buzzer_hal e comparadas com o cronograma ideal: com os prazos
+// absolutos o erro fica no atraso de um disparo, em vez de somar nota a nota.
+#define _GNU_SOURCE
+#include "buzzer_rtttl.h"
+#include "buzzer_sequencer.h"
+#include "buzzer_hal.h"
+#include "esp_timer.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FIRE_LATENCY_US 500     // Atraso somado a cada disparo do timer
+#define TIMED_NOTES 60
+#define TIMED_NOTE_MS 20
+#define MAX_ERROR_US 10000      // Folga para o escalonador do host; somando, seriam 29,5 ms
+
+static int failed = 0;
+
+static void check(const char *name, long got, long expected)
+{
+    if (got != expected) {
+        printf("FALHOU %s: %ld, esperado %ld\n", name, got, expected);
+        failed = 1;
+    }
+}
+
+// buzzer_hal: guarda cada nota tocada e o instante
+typedef struct {
+    int64_t at_us;
+    int freq;
+    int duration_ms;
+} played_t;
+
+static pthread_mutex_t hal_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t hal_changed = PTHREAD_COND_INITIALIZER;
+static played_t played[256];
+static int played_count = 0;
+static int stops = 0;
+static uint32_t done_id = 0;
+
+void buzzer_hal_init(void)
+{
+}
+
+void buzzer_hal_play_note(int freq_hz, int duration_ms)
+{
+    pthread_mutex_lock(&hal_lock);
+    if (played_count < (int)(sizeof(played) / sizeof(played[0]))) {
+        played[played_count++] = (played_t) { esp_timer_get_time(), freq_hz, duration_ms };
+    }
+    pthread_mutex_unlock(&hal_lock);
+}
+
+void buzzer_hal_stop(void)
+{
+    pthread_mutex_lock(&hal_lock);
+    stops++;
+    pthread_mutex_unlock(&hal_lock);
+}
+
+static void on_done(uint32_t seq_id)
+{
+    pthread_mutex_lock(&hal_lock);
+    done_id = seq_id;
+    pthread_cond_broadcast(&hal_changed);
+    pthread_mutex_unlock(&hal_lock);
+}
+
+static void reset_played(void)
+{
+    pthread_mutex_lock(&hal_lock);
+    played_count = 0;
+    stops = 0;
+    done_id = 0;
+    pthread_mutex_unlock(&hal_lock);
+}
+
+static bool wait_done(uint32_t id, int timeout_ms)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000 + 1;
+    pthread_mutex_lock(&hal_lock);
+    while (done_id != id && pthread_cond_timedwait(&hal_changed, &hal_lock, &deadline) == 0) {
+    }
+    bool ok = done_id == id;
+    pthread_mutex_unlock(&hal_lock);
+    return ok;
+}
+
+// esp_timer de um disparo numa thread, FIRE_LATENCY_US depois do prazo
+static pthread_mutex_t timer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t timer_changed;
+static esp_timer_cb_t timer_cb;
+static void *timer_arg;
+static bool timer_armed = false;
+static int64_t timer_deadline_us;
+
+static struct timespec to_timespec(int64_t us)
+{
+    return (struct timespec) { us / 1000000, (us % 1000000) * 1000 };
+}
+
+static void *timer_thread(void *arg)
+{
+    pthread_mutex_lock(&timer_lock);
+    for (;;) {
+        if (!timer_armed) {
+            pthread_cond_wait(&timer_changed, &timer_lock);
+            continue;
+        }
+        int64_t fire_us = timer_deadline_us + FIRE_LATENCY_US;
+        if (esp_timer_get_time() < fire_us) {
+            struct timespec ts = to_timespec(fire_us);
+            pthread_cond_timedwait(&timer_changed, &timer_lock, &ts);
+            continue;   // Rearmado, parado ou no prazo: reavalia
+        }
+        timer_armed = false;
+        pthread_mutex_unlock(&timer_lock);
+        timer_cb(timer_arg);
+        pthread_mutex_lock(&timer_lock);
+    }
+    return NULL;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out_handle)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&timer_changed, &attr);
+    pthread_condattr_destroy(&attr);
+
+    timer_cb = args->callback;
+    timer_arg = args->arg;
+    pthread_t thread;
+    pthread_create(&thread, NULL, timer_thread, NULL);
+    *out_handle = (esp_timer_handle_t)&timer_cb;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    pthread_mutex_lock(&timer_lock);
+    timer_armed = true;
+    timer_deadline_us = esp_timer_get_time() + (int64_t)timeout_us;
+    pthread_cond_broadcast(&timer_changed);
+    pthread_mutex_unlock(&timer_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    pthread_mutex_lock(&timer_lock);
+    bool was_armed = timer_armed;
+    timer_armed = false;
+    pthread_cond_broadcast(&timer_changed);
+    pthread_mutex_unlock(&timer_lock);
+    return was_armed ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+static void expect_notes(const char *name, const char *rtttl, const buzzer_note_t *want, int want_count)
+{
+    buzzer_note_t out[32];
+    int count = buzzer_rtttl_compile(rtttl, out, 32);
+    bool same = count == want_count && out[count].freq == -1;
+    for (int i = 0; same && i < count; i++) {
+        same = out[i].freq == want[i].freq && out[i].duration_ms == want[i].duration_ms;
+    }
+    if (!same) {
+        printf("FALHOU %s: %d notas, esperado %d\n", name, count, want_count);
+        for (int i = 0; i < count && i < 32; i++) {
+            printf("  %d: %d Hz %u ms\n", i, out[i].freq, out[i].duration_ms);
+        }
+        failed = 1;
+    }
+}
+
+static void test_rtttl(void)
+{
+    // b=120: semibreve de 2000 ms; pontuada soma metade
+    static const buzzer_note_t mixed[] = {
+        { 523, 500 }, { 1245, 250 }, { 0, 500 }, { 880, 750 }, { 988, 187 }, { 3136, 62 },
+    };
+    expect_notes("durações, sustenido, ponto e oitava", "t:d=4,o=5,b=120:c,8d#6,p,4a.,16b.,32g7", mixed, 6);
+
+    // Sem padrões: d=4, o=6, b=63
+    static const buzzer_note_t defaults[] = { { 1047, 952 } };
+    expect_notes("padrões", "x::c", defaults, 1);
+
+    // As melodias embutidas do buzzer_manager.c
+    static const buzzer_note_t beep[] = { { 988, 100 } };
+    static const buzzer_note_t normal[] = { { 880, 150 }, { 0, 100 }, { 880, 150 }, { 0, 100 }, { 988, 200 }, { 0, 300 } };
+    static const buzzer_note_t alarm[] = { { 1175, 200 }, { 0, 100 }, { 1175, 200 } };
+    static const buzzer_note_t special[] = { { 784, 100 }, { 988, 100 }, { 1175, 100 } };
+    expect_notes("beep", "beep:d=16,o=5,b=150:b", beep, 1);
+    expect_notes("normal", "normal:d=16,o=5,b=150:a.,p,a.,p,8b,8p.", normal, 6);
+    expect_notes("alarm", "alarm:d=8,o=6,b=150:d,16p,d", alarm, 3);
+    expect_notes("special", "special:d=16,o=5,b=150:g,b,d6", special, 3);
+
+    // Todas as notas de 3 a 7 contra 440·2^(n/12): só o arredondamento para Hz inteiro
+    static const char *names[] = { "c", "c#", "d", "d#", "e", "f", "f#", "g", "g#", "a", "a#", "b" };
+    double worst = 0, worst_hz = 0;
+    for (int octave = 3; octave <= 7; octave++) {
+        for (int n = 0; n < 12; n++) {
+            char text[32];
+            buzzer_note_t out[2];
+            snprintf(text, sizeof(text), "f::%s%d", names[n], octave);
+            buzzer_rtttl_compile(text, out, 2);
+            double ideal = 440.0 * pow(2.0, (octave - 4) + (n - 9) / 12.0);
+            double cents = fabs(1200.0 * log2(out[0].freq / ideal));
+            double hz = fabs(out[0].freq - ideal);
+            worst = cents > worst ? cents : worst;
+            worst_hz = hz > worst_hz ? hz : worst_hz;
+        }
+    }
+    printf("frequências das oitavas 3 a 7: maior desvio %.2f Hz, %.2f cents\n", worst_hz, worst);
+    check("frequências: desvio até 0,6 Hz", worst_hz <= 0.6, 1);   // Meio Hz mais a tabela em centésimos
+
+    // Capacidade: trunca e ainda termina a lista
+    buzzer_note_t small[3];
+    check("capacidade: notas", buzzer_rtttl_compile("x:d=4,o=5,b=100:c,d,e,f", small, 3), 2);
+    check("capacidade: terminador", small[2].freq, -1);
+
+    buzzer_note_t out[4];
+    check("sem nome", buzzer_rtttl_compile("d=4:c", out, 4), -1);
+    check("padrão sem =", buzzer_rtttl_compile("x:d4:c", out, 4), -1);
+    check("nota desconhecida", buzzer_rtttl_compile("x::h", out, 4), -1);
+    check("nota de menos de 1 ms", buzzer_rtttl_compile("x:d=32,b=60000:c", out, 4), -1);
+}
+
+// Melodia tocada uma vez: cada troca no hal contra início + soma das durações anteriores
+static void test_schedule(void)
+{
+    static buzzer_note_t notes[TIMED_NOTES + 1];
+    for (int i = 0; i < TIMED_NOTES; i++) {
+        notes[i] = (buzzer_note_t) { (int16_t)(400 + 10 * i), TIMED_NOTE_MS };
+    }
+    notes[TIMED_NOTES] = (buzzer_note_t) { -1, 0 };
+
+    buzzer_timing_stats_t before, after;
+    buzzer_sequencer_get_timing(&before);
+    reset_played();
+    uint32_t id = buzzer_sequencer_start(notes, 0);
+    check("cronograma: terminou", wait_done(id, TIMED_NOTES * TIMED_NOTE_MS * 2), true);
+    int64_t done_us = esp_timer_get_time();
+    buzzer_sequencer_get_timing(&after);
+
+    check("cronograma: notas tocadas", played_count, TIMED_NOTES);
+    int64_t start_us = played[0].at_us;
+    int64_t max_err = 0, sum_err = 0, last_err = 0;
+    for (int i = 0; i < played_count; i++) {
+        int64_t err = played[i].at_us - (start_us + (int64_t)i * TIMED_NOTE_MS * 1000);
+        err = err < 0 ? -err : err;
+        max_err = err > max_err ? err : max_err;
+        sum_err += err;
+        last_err = err;
+        if (played[i].freq != notes[i].freq || played[i].duration_ms != TIMED_NOTE_MS) {
+            printf("FALHOU cronograma: nota %d tocou %d Hz por %d ms\n", i, played[i].freq, played[i].duration_ms);
+            failed = 1;
+        }
+    }
+    int64_t end_err = done_us - (start_us + (int64_t)TIMED_NOTES * TIMED_NOTE_MS * 1000);
+
+    printf("%d notas de %d ms, disparo atrasado %d us: erro vs ideal máx %lld us, médio %lld us, última nota %lld us, "
+           "fim %lld us (agendando a partir da troca anterior, a última nota atrasaria %d us); "
+           "medido pelo sequenciador: máx %u us, médio %u us\n",
+           TIMED_NOTES, TIMED_NOTE_MS, FIRE_LATENCY_US, (long long)max_err,
+           (long long)(played_count ? sum_err / played_count : 0), (long long)last_err, (long long)end_err,
+           (TIMED_NOTES - 1) * FIRE_LATENCY_US, (unsigned)after.max_error_us, (unsigned)after.avg_error_us);
+    // O máximo inclui os soluços do escalonador do host; o que importa é não crescer até o fim
+    check("cronograma: última nota no prazo", last_err < MAX_ERROR_US, 1);
+    check("cronograma: fim no prazo", end_err < MAX_ERROR_US, 1);
+    check("cronograma: trocas medidas", after.notes - before.notes, TIMED_NOTES);
+    check("cronograma: erro do sequenciador >= atraso do disparo", after.max_error_us >= FIRE_LATENCY_US, 1);
+}
+
+// Repetição com duração total: notas de 0 ms puladas e a última truncada no fim
+static void test_loop_and_truncate(void)
+{
+    static const buzzer_note_t notes[] = { { 1000, 100 }, { 1500, 0 }, { 0, 50 }, { -1, 0 } };
+    static const played_t want[] = {
+        { 0, 1000, 100 }, { 0, 0, 50 }, { 0, 1000, 100 }, { 0, 0, 50 }, { 0, 1000, 80 },
+    };
+
+    reset_played();
+    uint32_t id = buzzer_sequencer_start(notes, 380);
+    check("repetição: terminou", wait_done(id, 1000), true);
+    check("repetição: notas", played_count, 5);
+    for (int i = 0; i < played_count && i < 5; i++) {
+        if (played[i].freq != want[i].freq || played[i].duration_ms != want[i].duration_ms) {
+            printf("FALHOU repetição: nota %d tocou %d Hz por %d ms, esperado %d Hz por %d ms\n", i, played[i].freq,
+                   played[i].duration_ms, want[i].freq, want[i].duration_ms);
+            failed = 1;
+        }
+    }
+    check("repetição: buzzer desligado no fim", stops >= 1, 1);
+
+    // Só notas de 0 ms: termina na hora, sem rearmar o timer para sempre
+    static const buzzer_note_t silent[] = { { 1000, 0 }, { -1, 0 } };
+    reset_played();
+    id = buzzer_sequencer_start(silent, 1000);
+    check("só notas vazias: terminou", wait_done(id, 100), true);
+    check("só notas vazias: nada tocado", played_count, 0);
+}
+
+// Parada no meio: nenhuma nota depois, e sem aviso de fim
+static void test_stop(void)
+{
+    static const buzzer_note_t notes[] = { { 1000, 30 }, { 1100, 30 }, { 1200, 30 }, { 1300, 30 }, { -1, 0 } };
+    reset_played();
+    uint32_t id = buzzer_sequencer_start(notes, 0);
+    struct timespec ts = { 0, 45 * 1000000 };
+    nanosleep(&ts, NULL);
+    buzzer_sequencer_stop();
+    int count = played_count;
+    check("parada: fim não avisado", wait_done(id, 0), false);
+    check("parada: nada depois", played_count, count);
+    check("parada: tocou antes", count >= 1 && count < 4, 1);
+}
+
+int main(void)
+{
+    test_rtttl();
+    buzzer_sequencer_init(on_done);
+    test_schedule();
+    test_loop_and_truncate();
+    test_stop();
+    if (failed) {
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
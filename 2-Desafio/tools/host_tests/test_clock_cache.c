@@ -0,0 +1,247 @@
+// Cache do horário local (clock_cache.c): a cópia publicada bate com time() +
+// localtime_r em vários fusos e na virada do horário de verão, e o seqlock nunca
+// entrega uma cópia misturada com um escritor publicando sem parar em outra thread.
+// O teste faz o papel da task do esp_timer e do relógio de parede (gettimeofday),
+// e mede clock_cache_read contra time() + localtime_r.
+#define _GNU_SOURCE
+#include "clock_cache.h"
+#include "esp_timer.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+#define BENCH_CALLS 2000000
+#define RACE_SECONDS 2
+
+static int failed = 0;
+
+static void check(const char *name, long got, long expected)
+{
+    if (got != expected) {
+        printf("FALHOU %s: %ld, esperado %ld\n", name, got, expected);
+        failed = 1;
+    }
+}
+
+static long ns_now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000000L + t.tv_nsec;
+}
+
+// Relógio de parede: o real, ou um falso que avança `fake_step` segundos a cada leitura
+static volatile time_t fake_sec = 0;
+static volatile time_t fake_step = 0;
+
+int gettimeofday(struct timeval *restrict tv, void *restrict tz)
+{
+    if (fake_step == 0) {
+        struct timespec t;
+        clock_gettime(CLOCK_REALTIME, &t);
+        tv->tv_sec = t.tv_sec;
+        tv->tv_usec = t.tv_nsec / 1000;
+    } else {
+        tv->tv_sec = __atomic_fetch_add(&fake_sec, fake_step, __ATOMIC_RELAXED);
+        tv->tv_usec = 0;
+    }
+    return 0;
+}
+
+// Qualidade derivada do segundo publicado, para a leitura conferir que veio da mesma publicação
+static ntp_clock_quality_t quality = NTP_CLOCK_SYNCED;
+
+ntp_clock_quality_t ntp_manager_get_quality(void)
+{
+    if (fake_step == 0) {
+        return quality;
+    }
+    return (ntp_clock_quality_t)(1 + (fake_sec - fake_step) % 3);
+}
+
+// esp_timer: o callback só roda quando o teste chama tick()
+static esp_timer_cb_t tick_cb;
+static void *tick_arg;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out_handle)
+{
+    tick_cb = args->callback;
+    tick_arg = args->arg;
+    *out_handle = (esp_timer_handle_t)&tick_cb;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    return ESP_OK;
+}
+
+static void tick(void)
+{
+    tick_cb(tick_arg);
+}
+
+static bool same_tm(const struct tm *a, const struct tm *b)
+{
+    return a->tm_sec == b->tm_sec && a->tm_min == b->tm_min && a->tm_hour == b->tm_hour && a->tm_mday == b->tm_mday &&
+           a->tm_mon == b->tm_mon && a->tm_year == b->tm_year && a->tm_wday == b->tm_wday &&
+           a->tm_yday == b->tm_yday && a->tm_isdst == b->tm_isdst && a->tm_gmtoff == b->tm_gmtoff;
+}
+
+static void set_tz(const char *tz)
+{
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+// Relógio real: a cópia é a mesma conta que o chamador faria com time() + localtime_r
+static void test_matches_localtime(void)
+{
+    static const char *zones[] = { "UTC0", "<-03>3", "CET-1CEST,M3.5.0,M10.5.0/3", "NZST-12NZDT,M9.5.0,M4.1.0/3" };
+    for (size_t z = 0; z < sizeof(zones) / sizeof(zones[0]); z++) {
+        set_tz(zones[z]);
+        time_t before = time(NULL);
+        tick();
+        time_t after = time(NULL);
+
+        ntp_time_snapshot_t snap;
+        struct tm local;
+        check("relógio real: leitura válida", clock_cache_read(&snap), true);
+        localtime_r(&snap.utc, &local);
+        check(zones[z], same_tm(&snap.local, &local), true);
+        check("relógio real: segundo publicado", snap.utc >= before && snap.utc <= after, true);
+        check("relógio real: qualidade", snap.quality, NTP_CLOCK_SYNCED);
+    }
+
+    quality = NTP_CLOCK_INVALID;
+    tick();
+    ntp_time_snapshot_t snap;
+    check("sem horário: leitura inválida", clock_cache_read(&snap), false);
+    quality = NTP_CLOCK_SYNCED;
+    tick();
+}
+
+// Relógio falso atravessando as duas viradas do horário de verão europeu de 2026
+static void test_dst_edges(void)
+{
+    static const time_t edges[] = { 1774746000, 1792890000 };  // 29/03 e 25/10, 01:00 UTC
+    set_tz("CET-1CEST,M3.5.0,M10.5.0/3");
+    fake_step = 1;
+    for (size_t e = 0; e < 2; e++) {
+        int isdst_before = -1;
+        for (time_t t = edges[e] - 2; t < edges[e] + 2; t++) {
+            fake_sec = t;
+            tick();
+            ntp_time_snapshot_t snap;
+            struct tm local;
+            clock_cache_read(&snap);
+            localtime_r(&t, &local);
+            check("virada do horário de verão: segundo", snap.utc, t);
+            check("virada do horário de verão: hora local", same_tm(&snap.local, &local), true);
+            if (t == edges[e] - 1) {
+                isdst_before = snap.local.tm_isdst;
+            }
+            if (t == edges[e]) {
+                check("virada do horário de verão: isdst trocou", snap.local.tm_isdst != isdst_before, true);
+            }
+        }
+    }
+    fake_step = 0;
+}
+
+// Escritor publicando sem parar (cada publicação pula 1 dia, 1 hora, 1 minuto e 1 s):
+// toda cópia lida tem que ser uma publicação inteira
+static volatile bool racing;
+
+static void *writer(void *arg)
+{
+    long *count = arg;
+    while (racing) {
+        tick();
+        (*count)++;
+    }
+    return NULL;
+}
+
+static void test_concurrent_writer(void)
+{
+    set_tz("CET-1CEST,M3.5.0,M10.5.0/3");
+    fake_sec = 1700000000;
+    fake_step = 86400 + 3600 + 60 + 1;
+    tick();
+
+    long writes = 0, reads = 0, torn = 0;
+    time_t last = 0;
+    pthread_t thread;
+    racing = true;
+    pthread_create(&thread, NULL, writer, &writes);
+    long end = ns_now() + RACE_SECONDS * 1000000000L;
+    while (ns_now() < end) {
+        ntp_time_snapshot_t snap;
+        struct tm local;
+        clock_cache_read(&snap);
+        localtime_r(&snap.utc, &local);
+        if (!same_tm(&snap.local, &local) || snap.quality != (ntp_clock_quality_t)(1 + snap.utc % 3)) {
+            torn++;
+        }
+        check("escritor concorrente: não volta no tempo", snap.utc >= last, true);
+        last = snap.utc;
+        reads++;
+    }
+    racing = false;
+    pthread_join(thread, NULL);
+    fake_step = 0;
+
+    printf("escritor concorrente: %ld publicações, %ld leituras, %ld misturadas\n", writes, reads, torn);
+    check("escritor concorrente: cópias misturadas", torn, 0);
+    check("escritor concorrente: publicou", writes > 0, true);
+}
+
+static void bench(void)
+{
+    set_tz("CET-1CEST,M3.5.0,M10.5.0/3");
+    tick();
+    ntp_time_snapshot_t snap;
+    struct tm local;
+    int sum = 0;
+
+    long t0 = ns_now();
+    for (int i = 0; i < BENCH_CALLS; i++) {
+        time_t now = time(NULL);
+        localtime_r(&now, &local);
+        sum += local.tm_sec;
+    }
+    long direct = ns_now() - t0;
+
+    t0 = ns_now();
+    for (int i = 0; i < BENCH_CALLS; i++) {
+        clock_cache_read(&snap);
+        sum += snap.local.tm_sec;
+    }
+    long cached = ns_now() - t0;
+
+    printf("time() + localtime_r %.1f ns, clock_cache_read %.1f ns por chamada (soma %d)\n",
+           (double)direct / BENCH_CALLS, (double)cached / BENCH_CALLS, sum);
+}
+
+int main(void)
+{
+    clock_cache_init();
+    test_matches_localtime();
+    test_dst_edges();
+    test_concurrent_writer();
+    if (failed) {
+        return 1;
+    }
+    bench();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,123 @@
+// Bytes enviados ao display pelas telas de widgets, comparados com redesenhar as
+// linhas inteiras (o que o display_manager fazia antes dos widgets).
+#include "display_widgets.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+static int hour = 7, minute = 59, second = 58;
+static int selected = 0;
+static int alarm_total = 6;
+
+static void time_source(char *buf, size_t len)
+{
+    snprintf(buf, len, "%02d:%02d:%02d", hour, minute, second);
+}
+
+static void status_source(char *buf, size_t len)
+{
+    snprintf(buf, len, "Alarmes ON");
+}
+
+static void weekday_source(char *buf, size_t len)
+{
+    snprintf(buf, len, "Dia: Seg");
+}
+
+static int alarm_count(void)
+{
+    return alarm_total;
+}
+
+static bool alarm_item(int index, char *buf, size_t len)
+{
+    snprintf(buf, len, "%02d:%02d -STQQS-", 6 + index, 30);
+    return true;
+}
+
+static widget_t main_widgets[] = {
+    { .type = WIDGET_VALUE, .page = 2, .value = time_source },
+    { .type = WIDGET_VALUE, .page = 4, .value = status_source },
+    { .type = WIDGET_VALUE, .page = 5, .value = weekday_source },
+};
+
+static widget_t alarm_widgets[] = {
+    { .type = WIDGET_LIST, .page = 2, .rows = 4, .text = "Sem alarmes",
+      .count = alarm_count, .item = alarm_item, .selected = &selected },
+};
+
+static widget_screen_t main_screen = { main_widgets, 3, false };
+static widget_screen_t alarm_screen = { alarm_widgets, 1, false };
+
+// Antes: limpar a linha (128 bytes) e escrever o texto, em cada linha da tela
+static size_t full_rows_cost(const int *text_lens, int rows)
+{
+    size_t bytes = 0;
+    for (int i = 0; i < rows; i++) {
+        bytes += 128 + text_lens[i] * 8;
+    }
+    return bytes;
+}
+
+static void tick(void)
+{
+    if (++second == 60) {
+        second = 0;
+        if (++minute == 60) {
+            minute = 0;
+            hour = (hour + 1) % 24;
+        }
+    }
+}
+
+int main(void)
+{
+    SSD1306_t dev = { ._pages = 8 };
+
+    int shown = widget_screen_show(&dev, &main_screen);
+    assert(shown == (int)dev.bytes_sent);
+    printf("tela principal, desenho completo: %d bytes\n", shown);
+
+    // Sem mudança nenhuma, nada vai para o display
+    assert(widget_screen_update(&dev, &main_screen) == 0);
+
+    // 120 segundos: o tick de cada segundo troca um ou mais dígitos da hora
+    size_t before = dev.bytes_sent;
+    int max_tick = 0;
+    for (int i = 0; i < 120; i++) {
+        tick();
+        int bytes = widget_screen_update(&dev, &main_screen);
+        assert(bytes >= 8 && bytes <= 8 * 8);
+        max_tick = bytes > max_tick ? bytes : max_tick;
+    }
+    int main_lens[] = { 8, 10, 8 };
+    printf("tick do relógio: média %.1f bytes, máximo %d (linhas inteiras: %zu)\n",
+           (dev.bytes_sent - before) / 120.0, max_tick, full_rows_cost(main_lens, 3));
+
+    // A imagem final é a mesma de um desenho completo do zero
+    SSD1306_t fresh = { ._pages = 8 };
+    widget_t fresh_widgets[3];
+    memcpy(fresh_widgets, main_widgets, sizeof(fresh_widgets));
+    widget_screen_t fresh_screen = { fresh_widgets, 3, false };
+    widget_screen_show(&fresh, &fresh_screen);
+    assert(memcmp(fresh.page, dev.page, sizeof(dev.page)) == 0);
+
+    // Lista de alarmes: mover a seleção redesenha só as marcas "> "
+    widget_screen_show(&dev, &alarm_screen);
+    before = dev.bytes_sent;
+    selected = 1;
+    int bytes = widget_screen_update(&dev, &alarm_screen);
+    int list_lens[] = { 16, 16, 16, 16 };
+    printf("seleção na lista: %d bytes (linhas inteiras: %zu)\n", bytes, full_rows_cost(list_lens, 4));
+    assert(bytes == 2 * 8);
+
+    // Rolar a lista desloca todas as linhas visíveis
+    selected = 4;
+    bytes = widget_screen_update(&dev, &alarm_screen);
+    printf("rolagem da lista: %d bytes\n", bytes);
+    assert(bytes > 0 && bytes <= 4 * 16 * 8);
+    assert(dev.bytes_sent - before == (size_t)(16 + bytes));
+
+    printf("ok\n");
+    return 0;
+}
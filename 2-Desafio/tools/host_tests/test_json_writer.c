@@ -0,0 +1,420 @@
+// Escritor de JSON em streaming (json_writer.c): a lista de alarmes do GET /alarms
+// sai byte a byte igual a uma referência montada com snprintf e passa por um
+// validador de JSON estrito; escape de aspas, barra e caracteres de controle; os
+// pedaços entregues ao flush com o buffer de 512 bytes do servidor, com escapes
+// atravessando a borda; erro do flush; e zero alocações, contadas num malloc
+// interposto, enquanto mede o custo por alarme.
+#define _GNU_SOURCE
+#include "json_writer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CHUNK_LEN 512           // JSON_CHUNK_LEN do web_server.c
+#define ALARMS 80               // Uma importação de MAX_BODY_LEN
+#define BENCH_ROUNDS 20000
+
+static int failed = 0;
+
+static void check(const char *name, long got, long expected)
+{
+    if (got != expected) {
+        printf("FALHOU %s: %ld, esperado %ld\n", name, got, expected);
+        failed = 1;
+    }
+}
+
+static long ns_now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000000L + t.tv_nsec;
+}
+
+// Contagem de alocações: o malloc da glibc por baixo, contando quem passar por aqui
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+static volatile long allocations = 0;
+
+void *malloc(size_t size)
+{
+    allocations++;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+    allocations++;
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    allocations++;
+    return __libc_realloc(ptr, size);
+}
+
+// Destino do flush: junta os pedaços e guarda o tamanho de cada um
+typedef struct {
+    char data[64 * 1024];
+    size_t len;
+    size_t chunks[64 * 1024];
+    int count;
+    int fail_after;             // Devolve erro a partir deste pedaço; -1 nunca
+} sink_t;
+
+static esp_err_t sink_flush(void *ctx, const char *data, size_t len)
+{
+    sink_t *sink = ctx;
+    if (sink->fail_after >= 0 && sink->count >= sink->fail_after) {
+        return ESP_FAIL;
+    }
+    memcpy(sink->data + sink->len, data, len);
+    sink->len += len;
+    sink->chunks[sink->count++] = len;
+    return ESP_OK;
+}
+
+static void sink_reset(sink_t *sink)
+{
+    sink->len = 0;
+    sink->count = 0;
+    sink->fail_after = -1;
+}
+
+// Validador estrito (RFC 8259) só do que o escritor produz: sem espaços entre os tokens
+static const char *parse_value(const char *p, int depth);
+
+static const char *parse_string(const char *p)
+{
+    if (*p++ != '"') {
+        return NULL;
+    }
+    while (*p != '"') {
+        unsigned char c = *p++;
+        if (c < 0x20) {
+            return NULL;
+        }
+        if (c == '\\') {
+            c = *p++;
+            if (c == 'u') {
+                for (int i = 0; i < 4; i++, p++) {
+                    if (!strchr("0123456789abcdefABCDEF", *p) || !*p) {
+                        return NULL;
+                    }
+                }
+            } else if (!strchr("\"\\/bfnrt", c) || !c) {
+                return NULL;
+            }
+        }
+    }
+    return p + 1;
+}
+
+static const char *parse_number(const char *p)
+{
+    if (*p == '-') {
+        p++;
+    }
+    if (*p == '0') {
+        return p + 1;
+    }
+    if (*p < '1' || *p > '9') {
+        return NULL;
+    }
+    while (*p >= '0' && *p <= '9') {
+        p++;
+    }
+    return p;
+}
+
+static const char *parse_container(const char *p, int depth, char close, bool keys)
+{
+    p++;
+    if (*p == close) {
+        return p + 1;
+    }
+    for (;;) {
+        if (keys) {
+            p = parse_string(p);
+            if (!p || *p++ != ':') {
+                return NULL;
+            }
+        }
+        p = parse_value(p, depth + 1);
+        if (!p) {
+            return NULL;
+        }
+        if (*p == close) {
+            return p + 1;
+        }
+        if (*p++ != ',') {
+            return NULL;
+        }
+    }
+}
+
+static const char *parse_value(const char *p, int depth)
+{
+    if (depth > 64) {
+        return NULL;
+    }
+    switch (*p) {
+    case '[':
+        return parse_container(p, depth, ']', false);
+    case '{':
+        return parse_container(p, depth, '}', true);
+    case '"':
+        return parse_string(p);
+    case 't':
+        return strncmp(p, "true", 4) == 0 ? p + 4 : NULL;
+    case 'f':
+        return strncmp(p, "false", 5) == 0 ? p + 5 : NULL;
+    default:
+        return parse_number(p);
+    }
+}
+
+static bool valid_json(const char *text, size_t len)
+{
+    const char *end = parse_value(text, 0);
+    return end == text + len;
+}
+
+// Os mesmos campos do get_alarms_handler, com valores que cobrem sinal e tamanho
+typedef struct {
+    int32_t id, hour, minute, weekdays, melody;
+    bool enabled, one_shot, snooze;
+    const char *date;
+} alarm_row_t;
+
+static alarm_row_t rows[ALARMS];
+
+static void make_rows(void)
+{
+    for (int i = 0; i < ALARMS; i++) {
+        rows[i] = (alarm_row_t) {
+            .id = i == 7 ? INT32_MIN : i == 9 ? INT32_MAX : i * 37,
+            .hour = i % 24,
+            .minute = (i * 7) % 60,
+            .weekdays = i % 128,
+            .melody = i == 3 ? -1 : i % 5,
+            .enabled = i & 1,
+            .one_shot = (i & 2) != 0,
+            .snooze = (i & 4) != 0,
+            .date = i % 3 == 0 ? "2026-10-19" : NULL,
+        };
+    }
+}
+
+static void write_alarms(json_writer_t *json)
+{
+    json_writer_begin_array(json, NULL);
+    for (int i = 0; i < ALARMS; i++) {
+        const alarm_row_t *r = &rows[i];
+        json_writer_begin_object(json, NULL);
+        json_writer_int(json, "id", r->id);
+        json_writer_int(json, "hour", r->hour);
+        json_writer_int(json, "minute", r->minute);
+        json_writer_int(json, "weekdays", r->weekdays);
+        json_writer_int(json, "melody", r->melody);
+        json_writer_bool(json, "enabled", r->enabled);
+        json_writer_bool(json, "one_shot", r->one_shot);
+        json_writer_bool(json, "snooze", r->snooze);
+        if (r->date) {
+            json_writer_string(json, "date", r->date);
+        }
+        json_writer_end_object(json);
+    }
+    json_writer_end_array(json);
+}
+
+static size_t reference_alarms(char *out, size_t cap)
+{
+    size_t len = 0;
+    len += snprintf(out + len, cap - len, "[");
+    for (int i = 0; i < ALARMS; i++) {
+        const alarm_row_t *r = &rows[i];
+        len += snprintf(out + len, cap - len,
+                        "%s{\"id\":%ld,\"hour\":%ld,\"minute\":%ld,\"weekdays\":%ld,\"melody\":%ld,"
+                        "\"enabled\":%s,\"one_shot\":%s,\"snooze\":%s",
+                        i ? "," : "", (long)r->id, (long)r->hour, (long)r->minute, (long)r->weekdays,
+                        (long)r->melody, r->enabled ? "true" : "false", r->one_shot ? "true" : "false",
+                        r->snooze ? "true" : "false");
+        if (r->date) {
+            len += snprintf(out + len, cap - len, ",\"date\":\"%s\"", r->date);
+        }
+        len += snprintf(out + len, cap - len, "}");
+    }
+    len += snprintf(out + len, cap - len, "]");
+    return len;
+}
+
+// Todos os pedaços menos o último saem com o buffer cheio, e juntos dão `want`
+static void check_chunks(const char *name, const sink_t *sink, size_t size, const char *want, size_t want_len)
+{
+    bool full = true;
+    for (int i = 0; i + 1 < sink->count; i++) {
+        full &= sink->chunks[i] == size;
+    }
+    if (!full || sink->count == 0 || sink->chunks[sink->count - 1] > size || sink->len != want_len ||
+        memcmp(sink->data, want, want_len) != 0) {
+        printf("FALHOU %s: %d pedaços, %zu bytes (esperado %zu)\n", name, sink->count, sink->len, want_len);
+        failed = 1;
+    }
+}
+
+static void test_alarm_list(void)
+{
+    static sink_t sink;
+    static char want[64 * 1024];
+    size_t want_len = reference_alarms(want, sizeof(want));
+    check("referência: JSON válido", valid_json(want, want_len), true);
+
+    static const size_t sizes[] = { 1, 2, 7, 64, CHUNK_LEN, 4096, sizeof(want) };
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        static char buffer[sizeof(want)];
+        json_writer_t json;
+        sink_reset(&sink);
+        json_writer_init(&json, buffer, sizes[s], sink_flush, &sink);
+        write_alarms(&json);
+        check("lista: finish", json_writer_finish(&json), ESP_OK);
+        check("lista: total entregue", json.total, want_len);
+
+        char name[48];
+        snprintf(name, sizeof(name), "lista com buffer de %zu", sizes[s]);
+        check_chunks(name, &sink, sizes[s], want, want_len);
+        check("lista: JSON válido", valid_json(sink.data, sink.len), true);
+    }
+    printf("lista de %d alarmes: %zu bytes, %zu pedaços de até %d\n", ALARMS, want_len,
+           (want_len + CHUNK_LEN - 1) / CHUNK_LEN, CHUNK_LEN);
+}
+
+static void test_escaping(void)
+{
+    static const struct {
+        const char *in;
+        const char *out;
+    } cases[] = {
+        { "", "\"\"" },
+        { "simples", "\"simples\"" },
+        { "a\"b", "\"a\\\"b\"" },
+        { "c:\\dir\\", "\"c:\\\\dir\\\\\"" },
+        { "linha\nnova\ttab", "\"linha\\u000anova\\u0009tab\"" },
+        { "\x01\x1f\x7f", "\"\\u0001\\u001f\x7f\"" },
+        { "café ☕", "\"café ☕\"" },       // UTF-8 passa como está
+        { "/", "\"/\"" },
+    };
+    static sink_t sink;
+    char buffer[CHUNK_LEN];
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        json_writer_t json;
+        sink_reset(&sink);
+        json_writer_init(&json, buffer, sizeof(buffer), sink_flush, &sink);
+        json_writer_string(&json, NULL, cases[i].in);
+        json_writer_finish(&json);
+        size_t want_len = strlen(cases[i].out);
+        if (sink.len != want_len || memcmp(sink.data, cases[i].out, want_len) != 0) {
+            printf("FALHOU escape do caso %zu: %.*s, esperado %s\n", i, (int)sink.len, sink.data, cases[i].out);
+            failed = 1;
+        }
+        check("escape: JSON válido", valid_json(sink.data, sink.len), true);
+    }
+}
+
+// Escapes de 2 e 6 bytes começando em cada posição antes da borda do buffer de 512
+static void test_escape_across_boundary(void)
+{
+    static sink_t sink;
+    char buffer[CHUNK_LEN];
+    char value[CHUNK_LEN + 16], want[2 * CHUNK_LEN];
+
+    for (int special = 0; special < 2; special++) {
+        for (int offset = CHUNK_LEN - 8; offset <= CHUNK_LEN + 1; offset++) {
+            // `["` ocupa 2 bytes: o escape começa no byte `offset` da saída
+            int pad = offset - 2;
+            memset(value, 'x', pad);
+            value[pad] = special ? '\x02' : '"';
+            strcpy(value + pad + 1, "fim");
+
+            json_writer_t json;
+            sink_reset(&sink);
+            json_writer_init(&json, buffer, sizeof(buffer), sink_flush, &sink);
+            json_writer_begin_array(&json, NULL);
+            json_writer_string(&json, NULL, value);
+            json_writer_end_array(&json);
+            check("borda: finish", json_writer_finish(&json), ESP_OK);
+
+            int len = snprintf(want, sizeof(want), "[\"%.*s%sfim\"]", pad, value, special ? "\\u0002" : "\\\"");
+            char name[48];
+            snprintf(name, sizeof(name), "escape %s no byte %d", special ? "\\u" : "\\\"", offset);
+            check_chunks(name, &sink, CHUNK_LEN, want, (size_t)len);
+        }
+    }
+}
+
+// O flush falha no segundo pedaço: nada mais é entregue e finish devolve o erro
+static void test_flush_error(void)
+{
+    static sink_t sink;
+    char buffer[64];
+    json_writer_t json;
+    sink_reset(&sink);
+    sink.fail_after = 1;
+    json_writer_init(&json, buffer, sizeof(buffer), sink_flush, &sink);
+    write_alarms(&json);
+    check("erro do flush: devolvido", json_writer_finish(&json), ESP_FAIL);
+    check("erro do flush: pedaços entregues", sink.count, 1);
+
+    // Fundo demais: o container é recusado
+    sink_reset(&sink);
+    json_writer_init(&json, buffer, sizeof(buffer), sink_flush, &sink);
+    for (int i = 0; i <= JSON_WRITER_MAX_DEPTH; i++) {
+        json_writer_begin_array(&json, NULL);
+    }
+    check("profundidade máxima", json_writer_finish(&json), ESP_ERR_INVALID_STATE);
+}
+
+// Custo da lista inteira no buffer do servidor, sem nenhuma alocação no caminho
+static void bench(void)
+{
+    static sink_t sink;
+    char buffer[CHUNK_LEN];
+    long before = allocations;
+    long t0 = ns_now();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        json_writer_t json;
+        sink_reset(&sink);
+        json_writer_init(&json, buffer, sizeof(buffer), sink_flush, &sink);
+        write_alarms(&json);
+        json_writer_finish(&json);
+    }
+    long elapsed = ns_now() - t0;
+    long count = allocations - before;
+
+    printf("lista de %d alarmes: %.0f ns (%.1f ns por alarme, %.0f MB/s), %ld alocações\n", ALARMS,
+           (double)elapsed / BENCH_ROUNDS, (double)elapsed / BENCH_ROUNDS / ALARMS,
+           (double)sink.len * BENCH_ROUNDS / elapsed * 1000, count);
+    check("alocações durante a escrita", count, 0);
+}
+
+int main(void)
+{
+    make_rows();
+    test_alarm_list();
+    test_escaping();
+    test_escape_across_boundary();
+    test_flush_error();
+    if (failed) {
+        return 1;
+    }
+    bench();
+    if (failed) {
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
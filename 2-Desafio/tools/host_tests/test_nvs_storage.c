@@ -0,0 +1,292 @@
+// Recuperação do armazenamento de alarmes sobre a NVS de host (tools/nvs_host):
+// compactação interrompida em qualquer ponto do apagamento do log, tabela com
+// trecho do log inválido ou CRC errado, registros inválidos nas tabelas antigas e
+// buraco no log, e o próximo id depois de limpar a lista. Cada cenário parte da NVS apagada e termina num "reboot"
+// (nvs_host_reboot), como o aparelho depois de uma queda.
+#include "nvs_storage.h"
+#include "persist_record.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+#include "nvs_host.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failed = 0;
+
+static void check(const char *name, long got, long expected)
+{
+    if (got != expected) {
+        printf("FALHOU %s: %ld, esperado %ld\n", name, got, expected);
+        failed = 1;
+    }
+}
+
+static alarm_record_t record(uint16_t id, uint32_t minute_of_day)
+{
+    return (alarm_record_t) {
+        .id = id,
+        .alarm = { .minute_of_day = minute_of_day, .weekdays = ALARM_WEEKDAYS_ALL, .enabled = 1 },
+    };
+}
+
+static void fresh(void)
+{
+    nvs_flash_erase();
+    nvs_host_reboot();
+}
+
+static int reload(alarm_record_t *records)
+{
+    nvs_host_reboot();
+    return nvs_storage_load_alarms(records, MAX_ALARMS);
+}
+
+static nvs_handle_t open_ns(void)
+{
+    nvs_handle_t handle;
+    if (nvs_open("alarms", NVS_READWRITE, &handle) != ESP_OK) {
+        printf("FALHOU nvs_open\n");
+        exit(1);
+    }
+    return handle;
+}
+
+static void set_log(nvs_handle_t handle, uint32_t seq, const alarm_record_t *entry)
+{
+    char key[16];
+    uint64_t value;
+    snprintf(key, sizeof(key), "alog%lu", (unsigned long)seq);
+    memcpy(&value, entry, sizeof(value));
+    nvs_set_u64(handle, key, value);
+}
+
+static bool has_log(nvs_handle_t handle, uint32_t seq)
+{
+    char key[16];
+    uint64_t value;
+    snprintf(key, sizeof(key), "alog%lu", (unsigned long)seq);
+    return nvs_get_u64(handle, key, &value) == ESP_OK;
+}
+
+// A compactação gravou a tabela e caiu no meio do apagamento do log: as primeiras
+// entradas do trecho já foram, as do fim não
+static void test_interrupted_compaction(void)
+{
+    alarm_record_t records[MAX_ALARMS];
+    fresh();
+    nvs_storage_load_alarms(records, MAX_ALARMS);
+    for (int i = 0; i < 5; i++) {
+        records[i] = record(i, 60 * i);
+        nvs_storage_put_alarm(&records[i]);
+    }
+    nvs_storage_flush();
+    nvs_storage_compact_alarms(records, 5);
+
+    nvs_handle_t handle = open_ns();
+    for (uint32_t seq = 2; seq < 5; seq++) {
+        set_log(handle, seq, &records[seq]);
+    }
+    nvs_commit(handle);
+    nvs_close(handle);
+
+    int count = reload(records);
+    check("compactação interrompida: alarmes", count, 5);
+    check("compactação interrompida: log pendente", nvs_storage_alarm_log_length(), 0);
+    handle = open_ns();
+    for (uint32_t seq = 0; seq < 5; seq++) {
+        check("compactação interrompida: sobra apagada", has_log(handle, seq), false);
+    }
+    nvs_close(handle);
+
+    // O log continua depois do trecho incorporado
+    alarm_record_t extra = record(5, 600);
+    nvs_storage_put_alarm(&extra);
+    nvs_storage_flush();
+    handle = open_ns();
+    check("compactação interrompida: nova entrada", has_log(handle, 5), true);
+    nvs_close(handle);
+    check("compactação interrompida: após nova edição", reload(records), 6);
+}
+
+static const persist_schema_t table_schema = {
+    .key = "alarm_tab",
+    .version = 1,
+    .record_size = sizeof(alarm_record_t),
+    .meta_size = 2 * sizeof(uint32_t),
+};
+
+// Formato da versão 3, sem CRC: cabeçalho com o trecho do log e os registros
+static void save_v3_table(nvs_handle_t handle, const alarm_record_t *records, uint16_t count)
+{
+    size_t size = 12 + count * sizeof(alarm_record_t);
+    uint8_t *blob = calloc(1, size);
+    blob[0] = 3;
+    memcpy(blob + 2, &count, 2);
+    memcpy(blob + 12, records, count * sizeof(alarm_record_t));
+    nvs_set_blob(handle, "alarm_tab", blob, size);
+    free(blob);
+}
+
+// Trecho com início depois do fim: rejeitado, sem apagar o log ao contrário
+static void test_inverted_range(void)
+{
+    alarm_record_t records[MAX_ALARMS];
+    fresh();
+
+    uint32_t meta[2] = { 5, 2 };
+    records[0] = record(0, 480);
+    nvs_handle_t handle = open_ns();
+    persist_record_save(handle, &table_schema, meta, records, 1);
+    nvs_commit(handle);
+    nvs_close(handle);
+
+    int count = reload(records);
+    check("trecho invertido: alarmes da tabela", count, 0);
+    check("trecho invertido: log pendente", nvs_storage_alarm_log_length(), 0);
+}
+
+// Tabela com CRC errado: volta o que está no log, a tabela é refeita e o log novo
+// continua depois das chaves que sobraram
+static void test_corrupt_table(void)
+{
+    alarm_record_t records[MAX_ALARMS];
+    fresh();
+    nvs_storage_load_alarms(records, MAX_ALARMS);
+    for (int i = 0; i < 3; i++) {
+        records[i] = record(i, 60 * i);
+        nvs_storage_put_alarm(&records[i]);
+    }
+    nvs_storage_flush();
+    nvs_storage_compact_alarms(records, 3);
+    alarm_record_t edited = record(1, 700);
+    alarm_record_t added = record(3, 800);
+    nvs_storage_put_alarm(&edited);
+    nvs_storage_put_alarm(&added);
+    nvs_storage_flush();
+
+    nvs_handle_t handle = open_ns();
+    uint8_t blob[256];
+    size_t size = sizeof(blob);
+    nvs_get_blob(handle, "alarm_tab", blob, &size);
+    blob[size - 1] ^= 0xFF;
+    nvs_set_blob(handle, "alarm_tab", blob, size);
+    nvs_commit(handle);
+    nvs_close(handle);
+
+    int count = reload(records);
+    check("tabela corrompida: recuperados do log", count, 2);
+    check("tabela corrompida: alarme editado", count > 0 ? records[0].alarm.minute_of_day : -1, 700);
+    handle = open_ns();
+    check("tabela corrompida: log reaplicado apagado", has_log(handle, 3) || has_log(handle, 4), false);
+    nvs_close(handle);
+
+    // Tabela refeita: o próximo boot não vê mais erro, e o log segue depois do antigo
+    nvs_storage_put_alarm(&records[0]);
+    nvs_storage_flush();
+    handle = open_ns();
+    check("tabela corrompida: nova entrada depois do log antigo", has_log(handle, 5), true);
+    nvs_close(handle);
+    check("tabela corrompida: após reboot", reload(records), 2);
+}
+
+// Registro com horário impossível: descartado ao carregar a tabela e ao migrar a v3
+static void test_invalid_records(void)
+{
+    alarm_record_t records[MAX_ALARMS];
+    alarm_record_t table[3] = { record(0, 60), record(1, 60), record(2, 120) };
+    table[1].alarm.minute_of_day = ALARM_MINUTES_PER_DAY + 10;
+
+    fresh();
+    uint32_t meta[2] = { 0, 0 };
+    nvs_handle_t handle = open_ns();
+    persist_record_save(handle, &table_schema, meta, table, 3);
+    nvs_commit(handle);
+    nvs_close(handle);
+    check("registro inválido na tabela", reload(records), 2);
+    check("registro inválido na tabela: após regravar", reload(records), 2);
+
+    fresh();
+    handle = open_ns();
+    save_v3_table(handle, table, 3);
+    nvs_commit(handle);
+    nvs_close(handle);
+    check("registro inválido na versão 3", reload(records), 2);
+
+    // Mais alarmes que o máximo: a tabela inteira é rejeitada
+    static alarm_record_t many[MAX_ALARMS + 1];
+    for (int i = 0; i <= MAX_ALARMS; i++) {
+        many[i] = record(i, i % ALARM_MINUTES_PER_DAY);
+    }
+    fresh();
+    handle = open_ns();
+    save_v3_table(handle, many, MAX_ALARMS + 1);
+    nvs_commit(handle);
+    nvs_close(handle);
+    check("versão 3 acima do máximo", reload(records), 0);
+}
+
+// Entrada faltando no meio do log: as seguintes ainda são reaplicadas, e nada é regravado por cima
+static void test_log_gap(void)
+{
+    alarm_record_t records[MAX_ALARMS];
+    fresh();
+    nvs_handle_t handle = open_ns();
+    for (uint32_t seq = 0; seq < 4; seq++) {
+        if (seq != 2) {
+            alarm_record_t entry = record(seq, 100 + seq);
+            set_log(handle, seq, &entry);
+        }
+    }
+    nvs_commit(handle);
+    nvs_close(handle);
+
+    check("buraco no log: reaplicadas", reload(records), 3);
+    check("buraco no log: tamanho", nvs_storage_alarm_log_length(), 4);
+    alarm_record_t next = record(9, 900);
+    nvs_storage_put_alarm(&next);
+    nvs_storage_flush();
+    handle = open_ns();
+    check("buraco no log: nova entrada no fim", has_log(handle, 4), true);
+    nvs_close(handle);
+}
+
+// Limpar a lista não devolve os ids já usados, nem com um reboot logo em seguida
+static void test_clear_keeps_next_id(void)
+{
+    alarm_record_t records[MAX_ALARMS];
+    fresh();
+    nvs_storage_load_alarms(records, MAX_ALARMS);
+    for (int i = 0; i < 3; i++) {
+        records[i] = record(i, 60 * i);
+        nvs_storage_put_alarm(&records[i]);
+    }
+    nvs_storage_set_next_alarm_id(3);
+    nvs_storage_flush();
+
+    check("limpar: ok", nvs_storage_clear_alarms(), true);
+    check("limpar: alarmes após reboot", reload(records), 0);
+    check("limpar: próximo id após reboot", nvs_storage_next_alarm_id(), 3);
+}
+
+int main(void)
+{
+    const char *path = getenv("NVS_HOST_FILE");
+    if (!path) {
+        setenv("NVS_HOST_FILE", "/tmp/test_nvs_storage.bin", 1);
+    }
+    nvs_storage_init();
+
+    test_interrupted_compaction();
+    test_inverted_range();
+    test_corrupt_table();
+    test_invalid_records();
+    test_log_gap();
+    test_clear_keeps_next_id();
+
+    if (failed) {
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
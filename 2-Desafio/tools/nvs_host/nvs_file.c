@@ -0,0 +1,399 @@
+#include "nvs.h"
+#include "nvs_flash.h"
+#include "nvs_host.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ITEMS 1024
+#define MAX_HANDLES 16
+#define NAME_LEN 16     // Como na NVS: até 15 caracteres
+#define ENTRY_SIZE 32
+
+typedef struct {
+    char ns[NAME_LEN];
+    char key[NAME_LEN];
+    nvs_type_t type;
+    size_t len;
+    uint8_t *data;
+} item_t;
+
+struct nvs_opaque_iterator_t {
+    char ns[NAME_LEN];
+    nvs_type_t type;
+    int pos;        // Item corrente em items[]
+};
+
+typedef struct {
+    bool used;
+    bool writable;
+    char ns[NAME_LEN];
+} handle_t;
+
+static item_t items[MAX_ITEMS];
+static int item_count = 0;
+static handle_t handles[MAX_HANDLES];
+static size_t bytes_written = 0;
+static size_t commits = 0;
+static bool loaded = false;
+
+static const char *file_path(void)
+{
+    const char *path = getenv("NVS_HOST_FILE");
+    return path ? path : "nvs_host.bin";
+}
+
+static void clear_items(void)
+{
+    for (int i = 0; i < item_count; i++) {
+        free(items[i].data);
+    }
+    item_count = 0;
+}
+
+// Formato: por item, namespace e chave (NAME_LEN bytes cada), tipo u8, tamanho u32 e dados
+static void load_file(void)
+{
+    clear_items();
+    loaded = true;
+    FILE *f = fopen(file_path(), "rb");
+    if (!f) {
+        return;
+    }
+    item_t item;
+    uint8_t type;
+    uint32_t len;
+    while (item_count < MAX_ITEMS && fread(item.ns, NAME_LEN, 1, f) == 1 &&
+           fread(item.key, NAME_LEN, 1, f) == 1 && fread(&type, 1, 1, f) == 1 &&
+           fread(&len, sizeof(len), 1, f) == 1) {
+        item.type = type;
+        item.len = len;
+        item.data = malloc(len ? len : 1);
+        if (fread(item.data, 1, len, f) != len) {
+            free(item.data);
+            break;
+        }
+        items[item_count++] = item;
+    }
+    fclose(f);
+}
+
+static esp_err_t save_file(void)
+{
+    FILE *f = fopen(file_path(), "wb");
+    if (!f) {
+        return ESP_FAIL;
+    }
+    for (int i = 0; i < item_count; i++) {
+        uint8_t type = items[i].type;
+        uint32_t len = items[i].len;
+        fwrite(items[i].ns, NAME_LEN, 1, f);
+        fwrite(items[i].key, NAME_LEN, 1, f);
+        fwrite(&type, 1, 1, f);
+        fwrite(&len, sizeof(len), 1, f);
+        fwrite(items[i].data, 1, len, f);
+    }
+    fclose(f);
+    return ESP_OK;
+}
+
+static handle_t *get_handle(nvs_handle_t handle)
+{
+    if (handle == 0 || handle > MAX_HANDLES || !handles[handle - 1].used) {
+        return NULL;
+    }
+    return &handles[handle - 1];
+}
+
+static item_t *find(const char *ns, const char *key)
+{
+    for (int i = 0; i < item_count; i++) {
+        if (strcmp(items[i].ns, ns) == 0 && strcmp(items[i].key, key) == 0) {
+            return &items[i];
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t set_item(nvs_handle_t handle, const char *key, nvs_type_t type, const void *value, size_t len,
+                          size_t flash_bytes)
+{
+    handle_t *h = get_handle(handle);
+    if (!h || !h->writable) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (strlen(key) >= NAME_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    item_t *item = find(h->ns, key);
+    if (!item) {
+        if (item_count >= MAX_ITEMS) {
+            return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+        }
+        item = &items[item_count++];
+        memset(item, 0, sizeof(*item));
+        strcpy(item->ns, h->ns);
+        strcpy(item->key, key);
+    }
+    free(item->data);
+    item->data = malloc(len ? len : 1);
+    memcpy(item->data, value, len);
+    item->type = type;
+    item->len = len;
+    bytes_written += flash_bytes;
+    return ESP_OK;
+}
+
+static esp_err_t get_item(nvs_handle_t handle, const char *key, nvs_type_t type, void *value, size_t len)
+{
+    handle_t *h = get_handle(handle);
+    if (!h) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    item_t *item = find(h->ns, key);
+    if (!item) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (item->type != type) {
+        return ESP_ERR_NVS_TYPE_MISMATCH;
+    }
+    if (item->len != len) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    memcpy(value, item->data, len);
+    return ESP_OK;
+}
+
+const char *esp_err_to_name(esp_err_t err)
+{
+    static char name[16];
+    snprintf(name, sizeof(name), "0x%x", err);
+    return name;
+}
+
+esp_err_t nvs_flash_init(void)
+{
+    load_file();
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    clear_items();
+    return save_file();
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t mode, nvs_handle_t *handle)
+{
+    if (!loaded) {
+        load_file();
+    }
+    if (strlen(name) >= NAME_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // Como na NVS, abrir só para leitura um namespace que nunca foi gravado falha
+    bool exists = false;
+    for (int i = 0; i < item_count && !exists; i++) {
+        exists = strcmp(items[i].ns, name) == 0;
+    }
+    if (mode == NVS_READONLY && !exists) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    for (int i = 0; i < MAX_HANDLES; i++) {
+        if (!handles[i].used) {
+            handles[i].used = true;
+            handles[i].writable = mode == NVS_READWRITE;
+            strcpy(handles[i].ns, name);
+            *handle = i + 1;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    handle_t *h = get_handle(handle);
+    if (h) {
+        h->used = false;
+    }
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    if (!get_handle(handle)) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    commits++;
+    return save_file();
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    handle_t *h = get_handle(handle);
+    if (!h || !h->writable) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    item_t *item = find(h->ns, key);
+    if (!item) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    free(item->data);
+    *item = items[--item_count];
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_all(nvs_handle_t handle)
+{
+    handle_t *h = get_handle(handle);
+    if (!h || !h->writable) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    for (int i = 0; i < item_count;) {
+        if (strcmp(items[i].ns, h->ns) == 0) {
+            free(items[i].data);
+            items[i] = items[--item_count];
+        } else {
+            i++;
+        }
+    }
+    return ESP_OK;
+}
+
+#define SCALAR(name, type, nvs_type)                                                \
+    esp_err_t nvs_set_##name(nvs_handle_t handle, const char *key, type value)      \
+    {                                                                               \
+        return set_item(handle, key, nvs_type, &value, sizeof(value), ENTRY_SIZE);  \
+    }                                                                               \
+    esp_err_t nvs_get_##name(nvs_handle_t handle, const char *key, type *value)     \
+    {                                                                               \
+        return get_item(handle, key, nvs_type, value, sizeof(*value));              \
+    }
+
+SCALAR(u16, uint16_t, NVS_TYPE_U16)
+SCALAR(i32, int32_t, NVS_TYPE_I32)
+SCALAR(u32, uint32_t, NVS_TYPE_U32)
+SCALAR(i64, int64_t, NVS_TYPE_I64)
+SCALAR(u64, uint64_t, NVS_TYPE_U64)
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    size_t flash = 2 * ENTRY_SIZE + (length + ENTRY_SIZE - 1) / ENTRY_SIZE * ENTRY_SIZE;
+    return set_item(handle, key, NVS_TYPE_BLOB, value, length, flash);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *value, size_t *length)
+{
+    handle_t *h = get_handle(handle);
+    if (!h) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    item_t *item = find(h->ns, key);
+    if (!item) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (item->type != NVS_TYPE_BLOB) {
+        return ESP_ERR_NVS_TYPE_MISMATCH;
+    }
+    if (value == NULL) {
+        *length = item->len;
+        return ESP_OK;
+    }
+    if (*length < item->len) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    memcpy(value, item->data, item->len);
+    *length = item->len;
+    return ESP_OK;
+}
+
+// Próximo item a partir de pos que casa com o iterador; -1 se acabou
+static int next_match(const struct nvs_opaque_iterator_t *it, int pos)
+{
+    for (; pos < item_count; pos++) {
+        if ((it->ns[0] == '\0' || strcmp(items[pos].ns, it->ns) == 0) &&
+            (it->type == NVS_TYPE_ANY || items[pos].type == it->type)) {
+            return pos;
+        }
+    }
+    return -1;
+}
+
+esp_err_t nvs_entry_find(const char *part_name, const char *namespace_name, nvs_type_t type,
+                         nvs_iterator_t *iterator)
+{
+    *iterator = NULL;
+    if (!loaded) {
+        load_file();
+    }
+    if (strcmp(part_name, NVS_DEFAULT_PART_NAME) != 0) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    nvs_iterator_t it = calloc(1, sizeof(*it));
+    if (!it) {
+        return ESP_ERR_NO_MEM;
+    }
+    snprintf(it->ns, sizeof(it->ns), "%s", namespace_name ? namespace_name : "");
+    it->type = type;
+    it->pos = next_match(it, 0);
+    if (it->pos < 0) {
+        free(it);
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    *iterator = it;
+    return ESP_OK;
+}
+
+esp_err_t nvs_entry_next(nvs_iterator_t *iterator)
+{
+    if (!*iterator) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    (*iterator)->pos = next_match(*iterator, (*iterator)->pos + 1);
+    if ((*iterator)->pos < 0) {
+        free(*iterator);
+        *iterator = NULL;
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t nvs_entry_info(const nvs_iterator_t iterator, nvs_entry_info_t *info)
+{
+    if (!iterator || iterator->pos >= item_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const item_t *item = &items[iterator->pos];
+    memcpy(info->namespace_name, item->ns, NAME_LEN);
+    memcpy(info->key, item->key, NAME_LEN);
+    info->type = item->type;
+    return ESP_OK;
+}
+
+void nvs_release_iterator(nvs_iterator_t iterator)
+{
+    free(iterator);
+}
+
+size_t nvs_host_bytes_written(void)
+{
+    return bytes_written;
+}
+
+size_t nvs_host_commits(void)
+{
+    return commits;
+}
+
+void nvs_host_reset_bytes(void)
+{
+    bytes_written = 0;
+    commits = 0;
+}
+
+void nvs_host_reboot(void)
+{
+    memset(handles, 0, sizeof(handles));
+    load_file();
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stddef.h>
+
+/**
+ * Substituto da NVS para testar componentes no Linux.
+ *
+ * Guarda as chaves num arquivo (NVS_HOST_FILE ou "nvs_host.bin"), regravado a
+ * cada nvs_commit(), e conta os bytes que a NVS real gravaria no flash:
+ * 32 bytes por entrada escalar; índice + cabeçalho + dados arredondados para
+ * entradas de 32 bytes por blob. Apagar só marca a entrada e não conta.
+ * Também conta as chamadas a nvs_commit(). Cada chave guarda o tipo: ler com
+ * o tipo errado falha e o iterador (nvs_entry_find) filtra por ele, como na NVS.
+ *
+ * Compilar junto com o componente e um main próprio, por exemplo:
+ *     gcc -Itools/nvs_host -Icomponents/nvs_storage/include -Icomponents/persist_record/include \
+ *         components/nvs_storage/nvs_storage.c components/persist_record/persist_record.c \
+ *         tools/nvs_host/nvs_file.c teste.c
+ */
+
+size_t nvs_host_bytes_written(void);
+size_t nvs_host_commits(void);
+void nvs_host_reset_bytes(void);
+
+/**
+ * @brief Descarta o que não foi confirmado com nvs_commit() e relê o arquivo,
+ *        como depois de um reset.
+ */
+void nvs_host_reboot(void);
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""Empacota clipes WAV numa imagem para a partição de áudio crua ("audio").
+
+O firmware mapeia a partição com esp_partition_mmap e lê cada clipe do flash
+sem abrir arquivo. Clipes já no formato do DAC (PCM de 8 bits, mono, 11025 Hz)
+vão como estão: o pipeline os mixa direto do flash mapeado, sem fila nem task
+de leitura. Os demais são gravados como WAV IMA-ADPCM (wav2adpcm.py, blocos de
+256 bytes) e decodificados e reamostrados pelo audio_source_wav enquanto tocam.
+Com --pcm vão todos os arquivos originais, sem perda, mas a imagem (~540 KB) não
+cabe na partição de partitions.csv.
+
+Layout (little-endian):
+    cabeçalho: magic "ACLP", versão u16, quantidade u16, reservado u32, tamanho total u32
+    índice:    quantidade x (nome 16 bytes, deslocamento u32, tamanho u32)
+    dados:     arquivos WAV alinhados a 4 bytes, deslocamentos a partir do início
+
+Uso:
+    python pack_audio.py --out audio.bin [--size 0x60000] [--pcm] clipe.wav...
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+import wav2adpcm
+
+MAGIC = b"ACLP"
+VERSION = 2
+HEADER = struct.Struct("<4sHHII")
+ENTRY = struct.Struct("<16sII")
+NAME_LEN = 16
+BLOCK_BYTES = 256
+DAC_RATE = 11025    # AUDIO_SAMPLE_RATE_HZ
+
+
+def dac_native(path):
+    chunks = wav2adpcm.read_chunks(path)
+    tag, channels, rate, _, _, bits = struct.unpack("<HHIIHH", chunks[b"fmt "][:16])
+    return tag == wav2adpcm.WAVE_FORMAT_PCM and channels == 1 and bits == 8 and rate == DAC_RATE
+
+
+def encode_clip(path):
+    samples, rate = wav2adpcm.read_pcm_mono(path)
+    data = wav2adpcm.encode(samples, BLOCK_BYTES)
+    return wav2adpcm.wav_bytes(data, rate, BLOCK_BYTES, len(samples))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("clips", nargs="+")
+    parser.add_argument("--out", required=True)
+    parser.add_argument("--pcm", action="store_true", help="grava os originais, sem converter para ADPCM")
+    parser.add_argument("--size", type=lambda v: int(v, 0), default=0,
+                        help="tamanho da partição, para conferir se cabe")
+    args = parser.parse_args()
+
+    names = []
+    blobs = []
+    mapped = []
+    for path in args.clips:
+        name = os.path.splitext(os.path.basename(path))[0]
+        if len(name.encode()) >= NAME_LEN:
+            sys.exit("Nome de clipe longo demais: %s" % name)
+        names.append(name)
+        mapped.append(dac_native(path))
+        if args.pcm or mapped[-1]:
+            with open(path, "rb") as f:
+                blobs.append(f.read())
+        else:
+            blobs.append(encode_clip(path))
+
+    offset = HEADER.size + ENTRY.size * len(blobs)
+    index = b""
+    data = b""
+    for name, blob in zip(names, blobs):
+        pad = (-(offset + len(data))) % 4
+        data += b"\0" * pad
+        index += ENTRY.pack(name.encode(), offset + len(data), len(blob))
+        data += blob
+
+    total = offset + len(data)
+    image = HEADER.pack(MAGIC, VERSION, len(blobs), 0, total) + index + data
+    if args.size and total > args.size:
+        sys.exit("Imagem de %d bytes não cabe na partição de %d bytes" % (total, args.size))
+
+    with open(args.out, "wb") as f:
+        f.write(image)
+    for name, blob, direct in zip(names, blobs, mapped):
+        print("%-16s %7d bytes%s" % (name, len(blob), " (mixado direto do flash)" if direct else ""))
+    print("%s: %d bytes" % (args.out, total))
+
+
+if __name__ == "__main__":
+    main()
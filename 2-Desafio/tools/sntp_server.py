@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""Servidor SNTP mínimo para testar o ntp_manager numa máquina Linux.
+
+Responde com o relógio da máquina, opcionalmente adiantado ou atrasado, com
+atraso artificial e perda de pacotes, para exercitar a rajada inicial, a
+escolha entre servidores e a medida de offset, atraso e jitter.
+
+Uso:
+    sudo python sntp_server.py [--port 123] [--offset-ms 0] [--delay-ms 0]
+                               [--jitter-ms 0] [--drop 0.0] [--stratum 2]
+
+No firmware, aponte CONFIG_NTP_LOCAL_SERVER para o IP desta máquina.
+"""
+
+import argparse
+import random
+import socket
+import struct
+import sys
+import threading
+import time
+
+NTP_UNIX_DELTA = 2208988800
+PACKET = struct.Struct("!BBbbII4sQQQQ")
+MODE_CLIENT = 3
+MODE_SERVER = 4
+
+
+def to_ntp(t):
+    """Segundos Unix (float) para o formato NTP 32.32."""
+    sec = int(t)
+    frac = int((t - sec) * (1 << 32)) & 0xFFFFFFFF
+    return ((sec + NTP_UNIX_DELTA) & 0xFFFFFFFF) << 32 | frac
+
+
+def build_reply(request, args):
+    flags = request[0]
+    version = (flags >> 3) & 0x07
+    transmit = request[40:48]
+    now = time.time() + args.offset_ms / 1000.0   # Recepção e transmissão no mesmo instante
+    return PACKET.pack(
+        (0 << 6) | (version << 3) | MODE_SERVER,
+        args.stratum,
+        request[2],             # Intervalo de consulta: ecoa o do cliente
+        -20,                    # Precisão ~1 µs
+        0, 0,                   # Atraso e dispersão da raiz
+        b"LOCL",
+        to_ntp(now),            # Referência
+        struct.unpack("!Q", transmit)[0],   # Origem: carimbo de transmissão do cliente
+        to_ntp(now),
+        to_ntp(now),
+    )
+
+
+def reply_later(sock, addr, request, args):
+    wait = (args.delay_ms + random.uniform(0, args.jitter_ms)) / 2000.0
+    time.sleep(wait)            # Metade na ida...
+    reply = build_reply(request, args)
+    time.sleep(wait)            # ...metade na volta
+    sock.sendto(reply, addr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--bind", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=123)
+    parser.add_argument("--offset-ms", type=float, default=0.0,
+                        help="quanto este servidor está adiantado")
+    parser.add_argument("--delay-ms", type=float, default=0.0,
+                        help="atraso fixo de ida e volta")
+    parser.add_argument("--jitter-ms", type=float, default=0.0,
+                        help="atraso extra aleatório de 0 até este valor")
+    parser.add_argument("--drop", type=float, default=0.0,
+                        help="fração de requisições ignoradas")
+    parser.add_argument("--stratum", type=int, default=2)
+    args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((args.bind, args.port))
+    print(f"SNTP em {args.bind}:{args.port} (offset {args.offset_ms} ms, "
+          f"atraso {args.delay_ms}+{args.jitter_ms} ms, perda {args.drop:.0%})")
+
+    while True:
+        request, addr = sock.recvfrom(512)
+        if len(request) < 48 or (request[0] & 0x07) != MODE_CLIENT:
+            continue
+        if random.random() < args.drop:
+            print(f"{addr[0]}: descartado")
+            continue
+        print(f"{addr[0]}: respondendo")
+        threading.Thread(target=reply_later, args=(sock, addr, request, args),
+                         daemon=True).start()
+
+
+if __name__ == "__main__":
+    sys.exit(main())
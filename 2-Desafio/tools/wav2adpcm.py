@@ -0,0 +1,229 @@
+#!/usr/bin/env python3
+"""Converte WAV PCM (8/16 bits) ou G.711, mono/estéreo, para WAV IMA-ADPCM mono de 4 bits.
+
+A taxa de amostragem é mantida e o dispositivo reamostra para a taxa do DAC.
+O build usa o mesmo codificador (via pack_audio.py) para gravar os clipes de
+audio/ na partição "audio", com blocos de 256 bytes.
+
+A conversão tem perda. Os originais ficam em audio/ (sem perda, como vieram).
+SNR medida com --verify em relação ao original:
+
+    normal     14.7 dB      interval   17.6 dB
+    emergency  17.6 dB      special    22.5 dB
+
+É baixa porque os clipes são ruído de banda larga com bordas abruptas, que o
+passo adaptativo do IMA-ADPCM não acompanha; uma busca de duas amostras à
+frente no codificador ganhou só 0,5 dB. O ganho é metade do flash (~540 KB
+para ~274 KB): os originais já são de 8 bits (três em A-law), então não há 4x.
+O parser do firmware toca os originais sem conversão; para voltar a eles sem
+perda, use pack_audio.py --pcm.
+
+Uso:
+    python wav2adpcm.py entrada.wav saida.wav [--block 256] [--verify]
+"""
+
+import argparse
+import math
+import struct
+import sys
+
+STEP_TABLE = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767,
+]
+INDEX_TABLE = [-1, -1, -1, -1, 2, 4, 6, 8] * 2
+
+WAVE_FORMAT_PCM = 1
+WAVE_FORMAT_ALAW = 6
+WAVE_FORMAT_ULAW = 7
+WAVE_FORMAT_IMA_ADPCM = 0x11
+WAVE_FORMAT_EXTENSIBLE = 0xFFFE
+HEADER_BYTES = 4
+
+
+def decode_nibble(nibble, predictor, index):
+    step = STEP_TABLE[index]
+    diff = step >> 3
+    if nibble & 4:
+        diff += step
+    if nibble & 2:
+        diff += step >> 1
+    if nibble & 1:
+        diff += step >> 2
+    predictor = predictor - diff if nibble & 8 else predictor + diff
+    predictor = max(-32768, min(32767, predictor))
+    index = max(0, min(88, index + INDEX_TABLE[nibble]))
+    return predictor, index
+
+
+def encode_nibble(sample, predictor, index):
+    step = STEP_TABLE[index]
+    diff = sample - predictor
+    nibble = 0
+    if diff < 0:
+        nibble = 8
+        diff = -diff
+    if diff >= step:
+        nibble |= 4
+        diff -= step
+    step >>= 1
+    if diff >= step:
+        nibble |= 2
+        diff -= step
+    step >>= 1
+    if diff >= step:
+        nibble |= 1
+    predictor, index = decode_nibble(nibble, predictor, index)
+    return nibble, predictor, index
+
+
+def alaw_to_s16(a):
+    a ^= 0x55
+    t = (a & 0x0F) << 4
+    seg = (a & 0x70) >> 4
+    t = t + 8 if seg == 0 else (t + 0x108) << (seg - 1)
+    return t if a & 0x80 else -t
+
+
+def ulaw_to_s16(u):
+    u = ~u & 0xFF
+    t = (((u & 0x0F) << 3) + 0x84) << ((u & 0x70) >> 4)
+    return 0x84 - t if u & 0x80 else t - 0x84
+
+
+def read_chunks(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"RIFF" or data[8:12] != b"WAVE":
+        sys.exit("%s não é RIFF/WAVE" % path)
+
+    chunks = {}
+    pos = 12
+    while pos + 8 <= len(data):
+        cid = data[pos:pos + 4]
+        size = struct.unpack("<I", data[pos + 4:pos + 8])[0]
+        chunks.setdefault(cid, data[pos + 8:pos + 8 + size])
+        pos += 8 + size + (size & 1)
+    if b"fmt " not in chunks or b"data" not in chunks:
+        sys.exit("%s sem chunk fmt/data" % path)
+    return chunks
+
+
+def read_pcm_mono(path):
+    chunks = read_chunks(path)
+    tag, channels, rate, _, block_align, bits = struct.unpack("<HHIIHH", chunks[b"fmt "][:16])
+    raw = chunks[b"data"]
+
+    if tag == WAVE_FORMAT_IMA_ADPCM and channels == 1:
+        count = struct.unpack("<I", chunks[b"fact"][:4])[0] if b"fact" in chunks else len(raw) * 2
+        return decode(raw, block_align, count), rate
+    if tag == WAVE_FORMAT_ALAW and bits == 8:
+        samples = [alaw_to_s16(b) for b in raw]
+    elif tag == WAVE_FORMAT_ULAW and bits == 8:
+        samples = [ulaw_to_s16(b) for b in raw]
+    elif tag in (WAVE_FORMAT_PCM, WAVE_FORMAT_EXTENSIBLE) and bits == 8:
+        samples = [(b - 128) << 8 for b in raw]
+    elif tag in (WAVE_FORMAT_PCM, WAVE_FORMAT_EXTENSIBLE) and bits == 16:
+        samples = list(struct.unpack("<%dh" % (len(raw) // 2), raw[:len(raw) & ~1]))
+    else:
+        sys.exit("Formato não suportado: tag=%d, %d bits" % (tag, bits))
+
+    if channels == 2:
+        samples = [(samples[i] + samples[i + 1]) >> 1 for i in range(0, len(samples) - 1, 2)]
+    elif channels != 1:
+        sys.exit("Só mono ou estéreo é suportado")
+    return samples, rate
+
+
+def encode(samples, block_bytes):
+    per_block = 1 + (block_bytes - HEADER_BYTES) * 2
+    out = bytearray()
+    index = 0
+
+    for start in range(0, len(samples), per_block):
+        chunk = samples[start:start + per_block]
+        predictor = chunk[0]
+        out += struct.pack("<hBB", predictor, index, 0)
+
+        nibbles = []
+        for s in chunk[1:]:
+            nibble, predictor, index = encode_nibble(s, predictor, index)
+            nibbles.append(nibble)
+        if len(nibbles) % 2:
+            nibbles.append(0)
+        for i in range(0, len(nibbles), 2):
+            out.append(nibbles[i] | (nibbles[i + 1] << 4))
+    return bytes(out)
+
+
+def decode(data, block_bytes, count):
+    """Decodificação de referência, igual à do firmware (audio_adpcm.c)."""
+    samples = []
+    for start in range(0, len(data), block_bytes):
+        block = data[start:start + block_bytes]
+        predictor, index, _ = struct.unpack("<hBB", block[:HEADER_BYTES])
+        index = min(index, 88)
+        samples.append(predictor)
+        for byte in block[HEADER_BYTES:]:
+            for nibble in (byte & 0x0F, byte >> 4):
+                predictor, index = decode_nibble(nibble, predictor, index)
+                samples.append(predictor)
+    return samples[:count]
+
+
+def wav_bytes(data, rate, block_bytes, count):
+    per_block = 1 + (block_bytes - HEADER_BYTES) * 2
+    avg_bytes = rate * block_bytes // per_block
+    fmt = struct.pack("<HHIIHHHH", WAVE_FORMAT_IMA_ADPCM, 1, rate, avg_bytes,
+                      block_bytes, 4, 2, per_block)
+    body = b"WAVE"
+    body += b"fmt " + struct.pack("<I", len(fmt)) + fmt
+    body += b"fact" + struct.pack("<II", 4, count)
+    body += b"data" + struct.pack("<I", len(data)) + data
+    if len(data) % 2:
+        body += b"\0"
+    return b"RIFF" + struct.pack("<I", len(body)) + body
+
+
+def write_wav(path, data, rate, block_bytes, count):
+    with open(path, "wb") as f:
+        f.write(wav_bytes(data, rate, block_bytes, count))
+
+
+def snr_db(ref, test):
+    signal = sum(s * s for s in ref)
+    noise = sum((a - b) ** 2 for a, b in zip(ref, test))
+    if noise == 0:
+        return float("inf")
+    return 10 * math.log10(signal / noise) if signal else float("-inf")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input")
+    parser.add_argument("output")
+    parser.add_argument("--block", type=int, default=256,
+                        help="bytes por bloco ADPCM (máx. 512, limite do firmware)")
+    parser.add_argument("--verify", action="store_true",
+                        help="decodifica o resultado e mostra a SNR")
+    args = parser.parse_args()
+
+    if not HEADER_BYTES < args.block <= 512:
+        sys.exit("--block precisa estar entre 5 e 512")
+
+    samples, rate = read_pcm_mono(args.input)
+    data = encode(samples, args.block)
+    write_wav(args.output, data, rate, args.block, len(samples))
+
+    print("%s: %d amostras a %d Hz, %d bytes de dados ADPCM" % (args.output, len(samples), rate, len(data)))
+    if args.verify:
+        print("SNR: %.1f dB" % snr_db(samples, decode(data, args.block, len(samples))))
+
+
+if __name__ == "__main__":
+    main()
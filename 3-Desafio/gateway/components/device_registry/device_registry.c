@@ -1,5 +1,6 @@
 #include "device_registry.h"
 #include "common.h"
+#include "persist_record.h"
 #include "nvs_flash.h"
 #include "nvs.h"
 #include "esp_log.h"
@@ -7,6 +8,7 @@
 
 #define NVS_NAMESPACE "dev_registry"
 #define NVS_KEY "devices"
+#define REGISTRY_SCHEMA_VERSION 1
 
 static const char *TAG = "device_registry";
 
@@ -15,17 +17,60 @@ static size_t registry_size = 0;
 
 static nvs_handle_t s_nvs_handle;
 
+// Registro gravado na NVS, independente do layout de device_info_t (enum de 4 bytes)
+typedef struct {
+    uint8_t mac[6];
+    uint8_t type;
+    uint8_t id;
+} device_record_t;
+
+// Versão 0: array de device_info_t sem cabeçalho
+static bool migrate_v0(const void *old_record, void *new_record)
+{
+    const device_info_t *old = old_record;
+    device_record_t *record = new_record;
+    memcpy(record->mac, old->mac, 6);
+    record->type = old->type;
+    record->id = old->id;
+    return true;
+}
+
+static const persist_migration_t registry_migrations[] = {
+    { .from_version = 0, .from_record_size = sizeof(device_info_t), .migrate = migrate_v0 },
+};
+
+static const persist_schema_t registry_schema = {
+    .key = NVS_KEY,
+    .version = REGISTRY_SCHEMA_VERSION,
+    .record_size = sizeof(device_record_t),
+    .migrations = registry_migrations,
+    .migration_count = sizeof(registry_migrations) / sizeof(registry_migrations[0]),
+};
+
 // Carrega os dispositivos salvos da NVS
 static void load_registry_from_nvs()
 {
-    size_t required_size = sizeof(registry);
-    esp_err_t err = nvs_get_blob(s_nvs_handle, NVS_KEY, registry, &required_size);
+    device_record_t records[MAX_DEVICES];
+    persist_record_info_t info;
+    esp_err_t err = persist_record_load(s_nvs_handle, &registry_schema, NULL, records, MAX_DEVICES, &info);
+    registry_size = 0;
     if (err == ESP_OK) {
-        registry_size = required_size / sizeof(device_info_t);
-        ESP_LOGI(TAG, "Carregados %d dispositivos do registro", registry_size);
-    } else {
+        for (int i = 0; i < info.count; ++i) {
+            memcpy(registry[i].mac, records[i].mac, 6);
+            registry[i].type = (device_type_t)records[i].type;
+            registry[i].id = records[i].id;
+        }
+        registry_size = info.count;
+        ESP_LOGI(TAG, "Carregados %d dispositivos do registro em %lu us", registry_size,
+                 (unsigned long)info.load_us);
+        // Formato antigo: regrava com cabeçalho e CRC
+        if (info.migrated) {
+            device_registry_save_all();
+        }
+    } else if (err == ESP_ERR_NOT_FOUND) {
         ESP_LOGI(TAG, "Nenhum registro salvo na NVS");
-        registry_size = 0;
+    } else {
+        ESP_LOGW(TAG, "Registro na NVS descartado: %s", esp_err_to_name(err));
     }
 }
 
@@ -85,7 +130,14 @@ status_t device_registry_add(const device_info_t *device)
 // Salva todos os dispositivos no registro para a NVS
 esp_err_t device_registry_save_all(void)
 {
-    esp_err_t err = nvs_set_blob(s_nvs_handle, NVS_KEY, registry, registry_size * sizeof(device_info_t));
+    device_record_t records[MAX_DEVICES];
+    for (size_t i = 0; i < registry_size; ++i) {
+        memcpy(records[i].mac, registry[i].mac, 6);
+        records[i].type = registry[i].type;
+        records[i].id = registry[i].id;
+    }
+
+    esp_err_t err = persist_record_save(s_nvs_handle, &registry_schema, NULL, records, registry_size);
     if (err == ESP_OK) {
         err = nvs_commit(s_nvs_handle);
     }
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "nvs.h"
+
+/**
+ * Lista de registros de tamanho fixo gravada num blob da NVS, com cabeçalho
+ * versionado e CRC32:
+ *
+ *     persist_header_t | meta (meta_size bytes) | count registros de record_size bytes
+ *
+ * No boot, um blob da versão atual só passa pela conferência do cabeçalho e
+ * um CRC (rotina da ROM) antes de ser copiado; versões antigas passam pelas
+ * migrações registradas, uma versão por vez, e quem chama regrava no formato
+ * atual. Um blob sem cabeçalho vale como versão 0, se houver migração a partir dela.
+ */
+
+#define PERSIST_RECORD_MAGIC 0x43455250   // "PREC"
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;       // Versão do esquema dos registros
+    uint16_t record_size;
+    uint16_t count;
+    uint16_t meta_size;
+    uint32_t crc32;         // Dos campos acima, do meta e dos registros
+} persist_header_t;
+
+_Static_assert(sizeof(persist_header_t) == 16, "persist_header_t deve ocupar 16 bytes");
+
+/**
+ * @brief Converte um registro da versão `from_version` para a seguinte.
+ *
+ * @return false para descartar o registro.
+ */
+typedef bool (*persist_migrate_fn_t)(const void *old_record, void *new_record);
+
+typedef struct {
+    uint16_t from_version;
+    uint16_t from_record_size;  // Tamanho do registro em from_version
+    persist_migrate_fn_t migrate;
+} persist_migration_t;
+
+typedef struct {
+    const char *key;
+    uint16_t version;           // Versão atual, a que é gravada
+    uint16_t record_size;
+    uint16_t meta_size;         // Dados fixos antes dos registros; iguais em todas as versões
+    const persist_migration_t *migrations;
+    int migration_count;
+} persist_schema_t;
+
+typedef struct {
+    uint16_t version;           // Versão encontrada na NVS
+    uint16_t count;             // Registros entregues
+    bool migrated;              // Veio de versão antiga: regravar com persist_record_save()
+    uint32_t load_us;           // Leitura, validação e migração
+} persist_record_info_t;
+
+/**
+ * @brief Tamanho do blob com `count` registros.
+ */
+size_t persist_record_blob_size(const persist_schema_t *schema, int count);
+
+/**
+ * @brief Grava os registros no formato atual. Não chama nvs_commit().
+ *
+ * @param meta meta_size bytes, ou NULL se o esquema não tem meta.
+ */
+esp_err_t persist_record_save(nvs_handle_t handle, const persist_schema_t *schema, const void *meta,
+                              const void *records, int count);
+
+/**
+ * @brief Lê, valida e, se preciso, migra os registros para a versão atual.
+ *
+ * Registros além de `max_records` são descartados.
+ *
+ * @param meta Recebe meta_size bytes (zerados se o blob não tiver), ou NULL.
+ * @return ESP_OK; ESP_ERR_NOT_FOUND sem blob; ESP_ERR_NOT_SUPPORTED para blob sem
+ *         cabeçalho e sem migração da versão 0 (formato que quem chama pode conhecer);
+ *         ESP_ERR_INVALID_CRC para blob corrompido; ESP_ERR_INVALID_VERSION sem
+ *         caminho de migração.
+ */
+esp_err_t persist_record_load(nvs_handle_t handle, const persist_schema_t *schema, void *meta,
+                              void *records, int max_records, persist_record_info_t *info);